@@ -1,17 +1,16 @@
-#version 400 core
+#version 430 core
 
-uniform mat4 modelMatrix 	= mat4(1.0f);
 uniform mat4 viewMatrix 	= mat4(1.0f);
 uniform mat4 projMatrix 	= mat4(1.0f);
 uniform mat4 shadowMatrix 	= mat4(1.0f);
 
+#include "instances.glslh"
+
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec4 colour;
 layout(location = 2) in vec2 texCoord;
 layout(location = 3) in vec3 normal;
 
-uniform vec4 		objectColour = vec4(1,1,1,1);
-
 uniform bool hasVertexColours = false;
 
 out Vertex
@@ -25,18 +24,21 @@ out Vertex
 
 void main(void)
 {
-	mat4 mvp 		  = (projMatrix * viewMatrix * modelMatrix);
+	Instance instance = instances[instanceOffset + gl_InstanceID];
+	mat4 modelMatrix  = instance.modelMatrix;
+
+	vec4 worldPos 	  = modelMatrix * vec4(position, 1);
 	mat3 normalMatrix = transpose ( inverse ( mat3 ( modelMatrix )));
 
-	OUT.shadowProj 	=  shadowMatrix * vec4 ( position,1);
-	OUT.worldPos 	= ( modelMatrix * vec4 ( position ,1)). xyz ;
+	OUT.shadowProj 	=  shadowMatrix * worldPos;
+	OUT.worldPos 	= worldPos.xyz;
 	OUT.normal 		= normalize ( normalMatrix * normalize ( normal ));
 	
 	OUT.texCoord	= texCoord;
-	OUT.colour		= objectColour;
+	OUT.colour		= instance.colour;
 
 	if(hasVertexColours) {
-		OUT.colour		= objectColour * colour;
+		OUT.colour		= instance.colour * colour;
 	}
-	gl_Position		= mvp * vec4(position, 1.0);
-}
\ No newline at end of file
+	gl_Position		= projMatrix * viewMatrix * worldPos;
+}
@@ -1,6 +1,8 @@
-#version 400 core
+#version 430 core
 
-uniform mat4 mvpMatrix 		= mat4(1.0f);
+uniform mat4 viewProjMatrix = mat4(1.0f);
+
+#include "instances.glslh"
 
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec4 colour;
@@ -8,5 +10,6 @@ layout(location = 2) in vec2 texCoord;
 
 void main(void)
 {
-	gl_Position		= mvpMatrix * vec4(position, 1.0);
-}
\ No newline at end of file
+	mat4 modelMatrix = instances[instanceOffset + gl_InstanceID].modelMatrix;
+	gl_Position		= viewProjMatrix * modelMatrix * vec4(position, 1.0);
+}
@@ -0,0 +1,551 @@
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "AnimationBinary.h"
+#include "AnimationSampler.h"
+#include "AssetCache.h"
+#include "AssetId.h"
+#include "AssetLoader.h"
+#include "Assets.h"
+#include "Float4.h"
+#include "GameTimer.h"
+#include "LodBuilder.h"
+#include "Mesh.h"
+#include "MeshAnimation.h"
+#include "MeshBinary.h"
+#include "MshLoader.h"
+#include "Quaternion.h"
+#include "TextureBinary.h"
+#include "TextureCompressor.h"
+#include "TextureLoader.h"
+
+using namespace NCL::Rendering;
+using namespace NCL::Maths;
+
+namespace NCL::CSC8503::Benchmarks {
+	namespace {
+		class StubMesh : public Mesh {
+		public:
+			void UploadToGPU(Rendering::RendererBase* renderer) override {}
+		};
+
+		template <typename T>
+		bool sameData(const std::vector<T>& a, const std::vector<T>& b) {
+			return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+		}
+
+		// Everything a mesh loader fills in
+		bool sameMesh(const Mesh& a, const Mesh& b) {
+			bool same = a.GetPrimitiveType() == b.GetPrimitiveType();
+			same &= sameData(a.GetPositionData(), b.GetPositionData());
+			same &= sameData(a.GetTextureCoordData(), b.GetTextureCoordData());
+			same &= sameData(a.GetColourData(), b.GetColourData());
+			same &= sameData(a.GetNormalData(), b.GetNormalData());
+			same &= sameData(a.GetTangentData(), b.GetTangentData());
+			same &= sameData(a.GetSkinWeightData(), b.GetSkinWeightData());
+			same &= sameData(a.GetSkinIndexData(), b.GetSkinIndexData());
+			same &= sameData(a.GetIndexData(), b.GetIndexData());
+			same &= sameData(a.GetSubMeshes(), b.GetSubMeshes());
+			same &= sameData(a.GetJointParents(), b.GetJointParents());
+			same &= sameData(a.GetBindPose(), b.GetBindPose());
+			same &= sameData(a.GetInverseBindPose(), b.GetInverseBindPose());
+			same &= a.GetSubMeshNames() == b.GetSubMeshNames();
+			same &= a.GetJointNames() == b.GetJointNames();
+			same &= a.GetLods().size() == b.GetLods().size();
+			for (size_t i = 0; same && i < a.GetLods().size(); i++) {
+				same &= a.GetLods()[i].error == b.GetLods()[i].error;
+				same &= sameData(a.GetLods()[i].subMeshes, b.GetLods()[i].subMeshes);
+			}
+			return same;
+		}
+
+		const std::vector<std::string> GameMeshes = {
+			"Cube.msh", "Sphere.msh", "ORIGAMI_Chat.msh", "Kitten.msh", "Keeper.msh", "19463_Kitten_Head_v1.msh", "Capsule.msh"
+		};
+		const std::vector<std::string> GameTextures = { "checkerboard.png" };
+
+		// What GameTechRenderer does on a loader thread, without the upload
+		bool loadGameTexture(const std::string& name) {
+			char* data = nullptr;
+			uint32_t width, height, channels;
+			int flags = 0;
+			bool loaded = TextureLoader::LoadTexture(name, data, width, height, channels, flags);
+			TextureLoader::DeleteTextureData(data, flags);
+			return loaded;
+		}
+
+		// Every texture the game and skybox use, as textures() bakes them
+		const std::vector<std::string> BakedTextures = {
+			"Default.png", "checkerboard.png", "PressStart2P.png",
+			"Cubemap/skyrender0001.png", "Cubemap/skyrender0002.png", "Cubemap/skyrender0003.png",
+			"Cubemap/skyrender0004.png", "Cubemap/skyrender0005.png", "Cubemap/skyrender0006.png"
+		};
+
+		struct DecodedTexture {
+			std::string				name;
+			std::vector<uint8_t>	rgba;
+			uint32_t				width;
+			uint32_t				height;
+		};
+
+		// A made up skeleton, as no shipped mesh has one: a chain of joints each
+		// swinging about its own axis, stored in model space as .anm files are
+		std::unique_ptr<MeshAnimation> makeAnimation(size_t jointCount, size_t frameCount, float frameRate) {
+			std::vector<Matrix4> frames;
+			for (size_t frame = 0; frame < frameCount; frame++) {
+				float phase = 2.0f * 3.14159265f * frame / frameCount;
+				Matrix4 parent;
+				for (size_t joint = 0; joint < jointCount; joint++) {
+					Vector3 axis((float)(joint % 3 == 0), (float)(joint % 3 == 1), (float)(joint % 3 == 2));
+					float angle = 40.0f * std::sin(phase + joint * 0.5f);
+					parent = parent * Matrix::Translation(Vector3(0.0f, 0.1f, 0.0f)) * Matrix::Rotation(angle, axis);
+					frames.push_back(parent);
+				}
+			}
+			return std::make_unique<MeshAnimation>(jointCount, frameCount, frameRate, frames);
+		}
+
+		// The straightforward way to blend keys, a joint at a time with Quaternion::Slerp
+		void sampleScalar(const MeshAnimation& animation, float time, Matrix4* palette, const Matrix4* inverseBindPose) {
+			const AnimationKeys& keys = animation.GetKeys();
+			size_t frameCount = animation.GetFrameCount();
+			float position = std::fmod(time * animation.GetFrameRate(), (float)frameCount);
+			size_t frameA = std::min((size_t)position, frameCount - 1);
+			size_t frameB = (frameA + 1) % frameCount;
+			float t = position - frameA;
+			auto decode = [&](size_t frame, size_t joint, int c) {
+				AnimationKeys::Component component = (AnimationKeys::Component)c;
+				return keys.GetOffsets(component)[joint] + keys.GetFrame(frame)[c * keys.stride + joint] * keys.GetSteps(component)[joint];
+			};
+			for (size_t joint = 0; joint < animation.GetJointCount(); joint++) {
+				Quaternion a(decode(frameA, joint, 0), decode(frameA, joint, 1), decode(frameA, joint, 2), decode(frameA, joint, 3));
+				Quaternion b(decode(frameB, joint, 0), decode(frameB, joint, 1), decode(frameB, joint, 2), decode(frameB, joint, 3));
+				if (Quaternion::Dot(a, b) < 0.0f) {
+					b = -b;
+				}
+				Quaternion rotation = Quaternion::Slerp(a.Normalised(), b.Normalised(), t);
+				Vector3 translation, scale;
+				for (int i = 0; i < 3; i++) {
+					float fromA = decode(frameA, joint, AnimationKeys::PositionX + i);
+					translation[i] = fromA + (decode(frameB, joint, AnimationKeys::PositionX + i) - fromA) * t;
+					float scaleA = decode(frameA, joint, AnimationKeys::ScaleX + i);
+					scale[i] = scaleA + (decode(frameB, joint, AnimationKeys::ScaleX + i) - scaleA) * t;
+				}
+				Matrix4 matrix = Matrix::Translation(translation) * Quaternion::RotationMatrix<Matrix4>(rotation) * Matrix::Scale(scale);
+				palette[joint] = matrix * inverseBindPose[joint];
+			}
+		}
+
+		float largestDifference(const std::vector<Matrix4>& a, const std::vector<Matrix4>& b) {
+			float largest = 0.0f;
+			for (size_t i = 0; i < a.size(); i++) {
+				for (int col = 0; col < 4; col++) {
+					for (int row = 0; row < 4; row++) {
+						largest = std::max(largest, std::abs(a[i].array[col][row] - b[i].array[col][row]));
+					}
+				}
+			}
+			return largest;
+		}
+	}
+
+	void meshLoading() {
+		// Converted into a scratch directory, so the real assets are left alone
+		std::filesystem::path scratch = std::filesystem::temp_directory_path() / "ncl_mesh_benchmark";
+		std::filesystem::create_directories(scratch);
+
+		std::vector<std::string> files;
+		for (const auto& entry : std::filesystem::directory_iterator(Assets::MESHDIR)) {
+			if (entry.path().extension() == ".msh") {
+				files.push_back(entry.path().filename().string());
+			}
+		}
+		std::sort(files.begin(), files.end());
+
+		std::cout << std::fixed << std::setprecision(3);
+		size_t mismatches = 0;
+		size_t textBytes = 0;
+		size_t binaryBytes = 0;
+		double textSeconds = 0.0;
+		double binarySeconds = 0.0;
+		for (const std::string& file : files) {
+			StubMesh text;
+			MshLoader::LoadTextMesh(file, text);
+			std::string binaryPath = (scratch / std::filesystem::path(file).replace_extension(MeshBinary::Extension)).string();
+			MeshBinary::Save(binaryPath, text);
+
+			StubMesh binary;
+			MeshBinary::Load(binaryPath, binary);
+			bool same = sameMesh(text, binary);
+			mismatches += !same;
+
+			// Each load fills in a fresh mesh, as the game does
+			double textTime = timeRepeated([&]() {
+				StubMesh mesh;
+				MshLoader::LoadTextMesh(file, mesh);
+			}, 0.1);
+			double binaryTime = timeRepeated([&]() {
+				StubMesh mesh;
+				MeshBinary::Load(binaryPath, mesh);
+			}, 0.1);
+			size_t textSize = std::filesystem::file_size(Assets::MESHDIR + file);
+			size_t binarySize = std::filesystem::file_size(binaryPath);
+			std::cout << std::left << std::setw(28) << file << std::right << std::setw(6) << textSize / 1024 << "KB "
+				<< std::setw(8) << textTime * 1000.0 << "ms -> " << std::setw(6) << binarySize / 1024 << "KB "
+				<< std::setw(6) << binaryTime * 1000.0 << "ms" << (same ? "" : "  DIFFERENT") << "\n";
+			textBytes += textSize;
+			binaryBytes += binarySize;
+			textSeconds += textTime;
+			binarySeconds += binaryTime;
+		}
+		std::cout << "Meshes that load differently: " << mismatches << " of " << files.size() << "\n";
+		std::cout << "All " << files.size() << " meshes: " << textBytes / 1024 << "KB text in " << textSeconds * 1000.0 << "ms, "
+			<< binaryBytes / 1024 << "KB binary in " << binarySeconds * 1000.0 << "ms (" << textSeconds / binarySeconds << "x)\n";
+
+		// The game's meshes also need their LODs, which msh2bin builds ahead of time
+		const std::vector<std::string>& gameMeshes = GameMeshes;
+		double parseAndBuild = timeRepeated([&]() {
+			for (const std::string& file : gameMeshes) {
+				StubMesh mesh;
+				MshLoader::LoadTextMesh(file, mesh);
+				LodBuilder::Build(mesh);
+			}
+		}, 0.1);
+		std::vector<std::string> converted;
+		for (const std::string& file : gameMeshes) {
+			StubMesh mesh;
+			MshLoader::LoadTextMesh(file, mesh);
+			LodBuilder::Build(mesh);
+			converted.push_back((scratch / std::filesystem::path(file).replace_extension(MeshBinary::Extension)).string());
+			MeshBinary::Save(converted.back(), mesh);
+		}
+		double loadConverted = timeRepeated([&]() {
+			for (const std::string& path : converted) {
+				StubMesh mesh;
+				MeshBinary::Load(path, mesh);
+			}
+		}, 0.1);
+		std::cout << "Game meshes with LODs: parsed and simplified in " << parseAndBuild * 1000.0 << "ms, converted loaded in "
+			<< loadConverted * 1000.0 << "ms (" << parseAndBuild / loadConverted << "x)\n";
+		std::cout << "Timings are with the files already in the OS cache\n";
+
+		std::filesystem::remove_all(scratch);
+	}
+
+	void asyncLoading() {
+		// A frame of a game running at 60Hz, most of it spent waiting on the GPU
+		const auto frameTime = std::chrono::milliseconds(16);
+		std::cout << std::fixed << std::setprecision(1);
+
+		// Warms the OS file cache, so both runs read from memory
+		for (const std::string& name : GameMeshes) {
+			StubMesh mesh;
+			LoadMeshWithLods(name, mesh);
+		}
+		for (const std::string& name : GameTextures) {
+			if (!loadGameTexture(name)) {
+				std::cout << "Couldn't load " << name << ", nothing to measure\n";
+				return;
+			}
+		}
+
+		// Before: the first frame waits for everything to load
+		GameTimer syncTimer;
+		for (const std::string& name : GameMeshes) {
+			StubMesh mesh;
+			LoadMeshWithLods(name, mesh);
+		}
+		for (const std::string& name : GameTextures) {
+			loadGameTexture(name);
+		}
+		double syncTime = syncTimer.GetTotalTimeMSec();
+		std::cout << "Loading before the first frame: first frame after " << syncTime << "ms\n";
+
+		// After: assets are asked for, and frames run while they load
+		GameTimer asyncTimer;
+		AssetLoader loader;
+		std::vector<std::unique_ptr<StubMesh>> meshes;
+		size_t uploaded = 0;
+		for (const std::string& name : GameMeshes) {
+			StubMesh* mesh = meshes.emplace_back(std::make_unique<StubMesh>()).get();
+			loader.load(name, [name, mesh]() { LoadMeshWithLods(name, *mesh); }, [&uploaded]() { uploaded++; });
+		}
+		for (const std::string& name : GameTextures) {
+			loader.load(name, [name]() {
+				if (!loadGameTexture(name)) {
+					throw std::runtime_error("Couldn't read texture file");
+				}
+			}, [&uploaded]() { uploaded++; });
+		}
+		loader.update();
+		double firstFrame = asyncTimer.GetTotalTimeMSec();
+		size_t frames = 1;
+		double longestUpdate = 0.0;
+		while (loader.getPendingCount() > 0) {
+			std::this_thread::sleep_for(frameTime);
+			GameTimer updateTimer;
+			loader.update();
+			longestUpdate = std::max(longestUpdate, updateTimer.GetTotalTimeMSec());
+			frames++;
+		}
+		double asyncTime = asyncTimer.GetTotalTimeMSec();
+		std::cout << "Loading on " << loader.getThreadCount() << " loader thread(s): first frame after " << firstFrame
+			<< "ms, everything loaded after " << asyncTime << "ms, " << frames << " frames drawn meanwhile\n";
+		std::cout << std::setprecision(3) << "Longest update: " << longestUpdate << "ms, " << uploaded << " of "
+			<< GameMeshes.size() + GameTextures.size() << " assets finished, " << loader.getFailedCount() << " failed\n";
+		std::cout << "Frames are simulated as " << frameTime.count() << "ms sleeps, uploads as no-ops\n";
+	}
+
+	void assetCache() {
+		std::cout << std::fixed << std::setprecision(3);
+
+		// Lookups the way Resources did, by name in a map, and the way it does now, by a precomputed ID
+		std::map<std::string, int> byName;
+		std::unordered_map<AssetId, int> byId;
+		std::vector<AssetId> ids;
+		for (const std::string& name : GameMeshes) {
+			byName[name] = (int)byName.size();
+			byId[AssetId::FromPath(name)] = (int)byId.size();
+			ids.push_back(AssetId::FromPath(name));
+		}
+		const int lookups = 100000;
+		size_t sink = 0;
+		double nameTime = timeRepeated([&]() {
+			for (int i = 0; i < lookups; i++) {
+				sink += byName.find(GameMeshes[i % GameMeshes.size()])->second;
+			}
+		}, 0.1);
+		double idTime = timeRepeated([&]() {
+			for (int i = 0; i < lookups; i++) {
+				sink += byId.find(ids[i % ids.size()])->second;
+			}
+		}, 0.1);
+		std::cout << lookups << " lookups: " << nameTime * 1000.0 << "ms by name, " << idTime * 1000.0 << "ms by ID ("
+			<< nameTime / idTime << "x, " << sink % 2 << ")\n";
+
+		// Files that would load twice by name, but only once by contents
+		std::filesystem::path scratch = std::filesystem::temp_directory_path() / "ncl_cache_benchmark";
+		std::filesystem::remove_all(scratch);
+		std::unordered_set<uint64_t> contents;
+		size_t files = 0;
+		{
+			AssetCache cache(scratch.string() + "/");
+			for (const std::string& dir : { Assets::MESHDIR, Assets::TEXTUREDIR }) {
+				for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+					if (entry.is_regular_file() && (entry.path().extension() == ".msh" || entry.path().extension() == ".png")) {
+						std::optional<uint64_t> hash = cache.hashFile(entry.path().string());
+						files += hash.has_value();
+						if (hash) {
+							contents.insert(*hash);
+						}
+					}
+				}
+			}
+		}
+		std::cout << files << " meshes and textures, " << files - contents.size() << " duplicated by contents\n";
+
+		// A cold cache parses and simplifies, a warm one in a later run just loads its binary
+		GameTimer coldTimer;
+		size_t coldMisses;
+		{
+			AssetCache cache(scratch.string() + "/");
+			for (const std::string& name : GameMeshes) {
+				StubMesh mesh;
+				cache.loadMesh(name, mesh);
+			}
+			coldMisses = cache.getMisses();
+		}
+		double coldTime = coldTimer.GetTotalTimeMSec();
+		GameTimer warmTimer;
+		size_t warmHits;
+		{
+			AssetCache cache(scratch.string() + "/");
+			for (const std::string& name : GameMeshes) {
+				StubMesh mesh;
+				cache.loadMesh(name, mesh);
+			}
+			warmHits = cache.getHits();
+		}
+		double warmTime = warmTimer.GetTotalTimeMSec();
+		std::cout << "Game meshes: cold cache " << coldTime << "ms (" << coldMisses << " misses), warm cache " << warmTime
+			<< "ms (" << warmHits << " hits)\n";
+		std::cout << "The warm run identifies meshes from the index, without reading their text\n";
+
+		std::filesystem::remove_all(scratch);
+	}
+
+	void animationSampling() {
+		const size_t JointCount = 32;
+		const size_t FrameCount = 60;
+		const float FrameRate = 30.0f;
+		const int KittenCount = 1000;
+		std::cout << std::fixed << std::setprecision(3);
+
+		std::unique_ptr<MeshAnimation> animation = makeAnimation(JointCount, FrameCount, FrameRate);
+		// Bound in the first frame's pose
+		std::vector<Matrix4> inverseBindPose;
+		for (size_t joint = 0; joint < JointCount; joint++) {
+			inverseBindPose.push_back(Matrix::Inverse(animation->GetJointData(0)[joint]));
+		}
+
+		// Keys should reproduce the original matrices at each frame
+		std::vector<Matrix4> original(animation->GetJointData(0), animation->GetJointData(0) + JointCount * FrameCount);
+		std::vector<Matrix4> decoded(JointCount * FrameCount);
+		for (size_t frame = 0; frame < FrameCount; frame++) {
+			AnimationSampler::Sample({ animation.get(), frame / FrameRate, &decoded[frame * JointCount] });
+		}
+		std::cout << JointCount << " joints, " << FrameCount << " frames: " << JointCount * FrameCount * sizeof(Matrix4) / 1024
+			<< "KB of matrices, " << JointCount * FrameCount * AnimationKeys::ComponentCount * sizeof(uint16_t) / 1024
+			<< "KB of keys, largest quantisation error " << std::setprecision(6) << largestDifference(original, decoded)
+			<< std::setprecision(3) << "\n";
+
+		// The binary file's keys are used in place, so should match exactly
+		std::filesystem::path scratch = std::filesystem::temp_directory_path() / ("ncl_animation_benchmark" + std::string(AnimationBinary::Extension));
+		AnimationBinary::Save(scratch.string(), *animation);
+		MeshAnimation loaded;
+		double loadTime = timeRepeated([&]() {
+			AnimationBinary::Load(scratch.string(), loaded);
+		}, 0.1);
+		const AnimationKeys& keys = animation->GetKeys();
+		bool same = loaded.GetKeys().ranges == keys.ranges
+			&& memcmp(loaded.GetKeys().data, keys.data, FrameCount * AnimationKeys::ComponentCount * keys.stride * sizeof(uint16_t)) == 0;
+		std::cout << "Binary file: " << std::filesystem::file_size(scratch) / 1024 << "KB, mapped in " << loadTime * 1e6 << "us, "
+			<< (same ? "same keys" : "DIFFERENT keys") << "\n";
+
+		// A crowd of kittens, each at its own point in the animation
+		std::vector<float> times;
+		for (int i = 0; i < KittenCount; i++) {
+			times.push_back(i * 0.0137f);
+		}
+		std::vector<Matrix4> wholeFrames(KittenCount * JointCount);
+		std::vector<Matrix4> scalar(KittenCount * JointCount);
+		std::vector<Matrix4> simd(KittenCount * JointCount);
+		std::vector<AnimationSampler::Instance> instances;
+		for (int i = 0; i < KittenCount; i++) {
+			instances.push_back({ &loaded, times[i], &simd[i * JointCount], inverseBindPose.data() });
+		}
+
+		// Before: the nearest whole frame, with no blending
+		double wholeTime = timeRepeated([&]() {
+			for (int i = 0; i < KittenCount; i++) {
+				size_t frame = (size_t)(times[i] * FrameRate) % FrameCount;
+				const Matrix4* joints = animation->GetJointData(frame);
+				for (size_t joint = 0; joint < JointCount; joint++) {
+					wholeFrames[i * JointCount + joint] = joints[joint] * inverseBindPose[joint];
+				}
+			}
+		}, 0.2);
+		double scalarTime = timeRepeated([&]() {
+			for (int i = 0; i < KittenCount; i++) {
+				sampleScalar(loaded, times[i], &scalar[i * JointCount], inverseBindPose.data());
+			}
+		}, 0.2);
+		double simdTime = timeRepeated([&]() {
+			AnimationSampler::Sample(instances);
+		}, 0.2);
+
+		std::cout << KittenCount << " kittens a frame:\n";
+		std::cout << "  Whole frames, no blending:     " << wholeTime * 1000.0 << "ms\n";
+		std::cout << "  Blended a joint at a time:     " << scalarTime * 1000.0 << "ms\n";
+		std::cout << "  Blended four joints at a time: " << simdTime * 1000.0 << "ms (" << scalarTime / simdTime << "x)\n";
+		std::cout << "Largest difference from slerp: " << std::setprecision(6) << largestDifference(scalar, simd) << "\n";
+#ifndef NCL_FLOAT4_SSE
+		std::cout << "No SSE on this platform, four joints at a time runs as plain code\n";
+#endif
+
+		std::filesystem::remove(scratch);
+	}
+
+	void textures() {
+		std::cout << std::fixed << std::setprecision(3);
+
+		// Before: every image decoded from PNG as it loads, and mipmapped by the driver
+		std::vector<DecodedTexture> decoded;
+		size_t pngBytes		= 0;
+		size_t rgbaBytes	= 0;
+		GameTimer decodeTimer;
+		for (const std::string& name : BakedTextures) {
+			char* data = nullptr;
+			uint32_t width, height, channels;
+			int flags = 0;
+			if (!TextureLoader::LoadTexture(name, data, width, height, channels, flags)) {
+				std::cout << "Couldn't load " << name << ", nothing to measure\n";
+				return;
+			}
+			decoded.push_back({ name, std::vector<uint8_t>((uint8_t*)data, (uint8_t*)data + width * height * 4), width, height });
+			TextureLoader::DeleteTextureData(data, flags);
+		}
+		decodeTimer.Tick();
+		double decodeTime = decodeTimer.GetTimeDeltaSeconds();
+		for (const DecodedTexture& texture : decoded) {
+			pngBytes	+= std::filesystem::file_size(Assets::TEXTUREDIR + texture.name);
+			// A full mip chain adds a third again
+			rgbaBytes	+= texture.width * texture.height * 4 * 4 / 3;
+		}
+		std::cout << decoded.size() << " textures, " << pngBytes / 1024 << "KB of PNG decoded in " << decodeTime * 1000.0
+			<< "ms, " << rgbaBytes / 1024 << "KB as RGBA with mips\n";
+
+		const TextureFormat formats[] = { TextureFormat::RGBA8, TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC7 };
+		const char* formatNames[] = { "RGBA8", "BC1  ", "BC3  ", "BC7  " };
+		std::filesystem::path scratch = std::filesystem::temp_directory_path() / ("ncl_texture_benchmark" + std::string(TextureBinary::Extension));
+
+		size_t sink = 0;
+		for (TextureFormat format : formats) {
+			size_t fileBytes	= 0;
+			double bakeTime		= 0.0;
+			double loadTime		= 0.0;
+			double squaredError	= 0.0;
+			size_t channelCount	= 0;
+			int largestError	= 0;
+			for (const DecodedTexture& texture : decoded) {
+				GameTimer bakeTimer;
+				TextureBinary::Bake(scratch.string(), texture.rgba.data(), texture.width, texture.height, format);
+				bakeTimer.Tick();
+				bakeTime	+= bakeTimer.GetTimeDeltaSeconds();
+				fileBytes	+= std::filesystem::file_size(scratch);
+
+				// Read every level, as an upload would, the mapped file isn't read until then
+				TextureBinary::Image image;
+				loadTime += timeRepeated([&]() {
+					image = TextureBinary::Image();
+					TextureBinary::Load(scratch.string(), image);
+					for (const TextureBinary::Level& level : image.levels) {
+						for (size_t i = 0; i < level.size; i++) sink += (uint8_t)level.data[i];
+					}
+				}, 0.02);
+
+				// What compression lost at the full size level
+				const TextureBinary::Level& top = image.levels[0];
+				std::vector<uint8_t> result = TextureCompressor::Decompress(format, (const uint8_t*)top.data, top.width, top.height);
+				for (size_t i = 0; i < result.size(); i++) {
+					int difference = std::abs((int)result[i] - (int)texture.rgba[i]);
+					squaredError += difference * difference;
+					largestError = std::max(largestError, difference);
+				}
+				channelCount += result.size();
+			}
+			std::cout << formatNames[(int)format] << ": " << std::setw(6) << fileBytes / 1024 << "KB ("
+				<< std::setprecision(1) << std::setw(5) << 100.0 * fileBytes / rgbaBytes << "%), baked in "
+				<< std::setprecision(3) << std::setw(9) << bakeTime * 1000.0 << "ms, mapped and read in " << std::setw(7) << loadTime * 1e6
+				<< "us, RMSE " << std::setw(6) << std::sqrt(squaredError / channelCount) << ", largest error " << largestError << " (" << sink % 2 << ")\n";
+		}
+		std::cout << "Errors are per 8 bit channel against the source, alpha included, so BC1 counts what it drops from translucent images\n";
+		std::cout << "Upload times need a GPU, the compressed formats send a quarter to an eighth of the RGBA bytes\n";
+
+		std::filesystem::remove(scratch);
+	}
+}
@@ -0,0 +1,170 @@
+#include "AssetCache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "AssetId.h"
+#include "Assets.h"
+#include "LodBuilder.h"
+#include "MappedFile.h"
+#include "MeshBinary.h"
+
+using namespace NCL::Rendering;
+
+namespace NCL::CSC8503 {
+	namespace {
+		const char* IndexName = "index.txt";
+
+		// Size and modification time, enough to tell if a file has changed since it was hashed
+		bool statFile(const std::string& path, uint64_t& size, int64_t& modified) {
+			std::error_code error;
+			size = std::filesystem::file_size(path, error);
+			if (error) {
+				return false;
+			}
+			modified = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+			return !error;
+		}
+
+		// A cached mesh depends on how its levels were built as well as its source,
+		// so the settings and LodBuilder's version are hashed in with the contents
+		uint64_t meshKey(uint64_t contentHash, const LodSettings& settings) {
+			uint64_t key = contentHash;
+			auto mix = [&key](const auto& value) {
+				key = HashBytes(std::string_view((const char*)&value, sizeof(value)), key);
+			};
+			mix(LodBuilder::Version);
+			mix(settings.reduction);
+			mix(settings.maxLevels);
+			mix(settings.minReduction);
+			mix(settings.maxError);
+			mix(settings.minTriangles);
+			return key;
+		}
+	}
+
+	AssetCache::AssetCache(const std::string& directory)
+		: directory(directory.empty() ? Assets::ASSETROOT + "Cache/" : directory) {
+		std::error_code error;
+		std::filesystem::create_directories(this->directory, error);
+		loadIndex();
+	}
+
+	AssetCache::~AssetCache() {
+		saveIndex();
+	}
+
+	std::optional<uint64_t> AssetCache::findContentHash(const std::string& path) const {
+		uint64_t size;
+		int64_t modified;
+		if (!statFile(path, size, modified)) {
+			return std::nullopt;
+		}
+		std::lock_guard lock(mutex);
+		auto it = index.find(path);
+		if (it == index.end() || it->second.size != size || it->second.modified != modified) {
+			return std::nullopt;
+		}
+		return it->second.contentHash;
+	}
+
+	std::optional<uint64_t> AssetCache::hashFile(const std::string& path) {
+		uint64_t size;
+		int64_t modified;
+		if (!statFile(path, size, modified)) {
+			return std::nullopt;
+		}
+		MappedFile file(path);
+		if (!file.IsOpen()) {
+			return std::nullopt;
+		}
+		std::span<const char> bytes = file.GetBytes();
+		uint64_t contentHash = HashBytes(std::string_view(bytes.data(), bytes.size()));
+
+		std::lock_guard lock(mutex);
+		index[path] = { size, modified, contentHash };
+		indexChanged = true;
+		return contentHash;
+	}
+
+	void AssetCache::loadMesh(const std::string& name, Mesh& mesh, const LodSettings& settings) {
+		std::string path = Assets::MESHDIR + name;
+		std::optional<uint64_t> contentHash = findContentHash(path);
+		if (!contentHash) {
+			contentHash = hashFile(path);
+		}
+		if (!contentHash) {
+			throw std::runtime_error("Couldn't read mesh " + path);
+		}
+
+		uint64_t sourceSize;
+		{
+			std::lock_guard lock(mutex);
+			sourceSize = index.at(path).size;
+		}
+
+		std::string cached = entryPath(meshKey(*contentHash, settings), sourceSize, MeshBinary::Extension);
+		std::error_code error;
+		if (std::filesystem::exists(cached, error)) {
+			try {
+				MeshBinary::Load(cached, mesh);
+				hits++;
+				return;
+			}
+			catch (const std::exception& e) {
+				// From an older build, rebuilt below
+				std::cout << "Rebuilding cached " << name << ": " << e.what() << "\n";
+			}
+		}
+
+		misses++;
+		LoadMeshWithLods(name, mesh, settings);
+		// Written under its own name first, as another thread could be reading the same entry
+		std::stringstream temp;
+		temp << cached << "." << std::this_thread::get_id() << ".tmp";
+		try {
+			MeshBinary::Save(temp.str(), mesh, LodBuilder::Version);
+			std::filesystem::rename(temp.str(), cached);
+		}
+		catch (const std::exception& e) {
+			// Not fatal, it'll be built again next time
+			std::cout << "Couldn't cache " << name << ": " << e.what() << "\n";
+			std::filesystem::remove(temp.str(), error);
+		}
+	}
+
+	void AssetCache::saveIndex() {
+		std::lock_guard lock(mutex);
+		if (!indexChanged) {
+			return;
+		}
+		std::ofstream file(directory + IndexName, std::ios::trunc);
+		// Paths go last, so they can contain spaces
+		for (const auto& [path, entry] : index) {
+			file << std::hex << entry.contentHash << std::dec << " " << entry.size << " " << entry.modified << " " << path << "\n";
+		}
+		indexChanged = !file;
+	}
+
+	std::string AssetCache::entryPath(uint64_t key, uint64_t sourceSize, const std::string& extension) const {
+		std::stringstream path;
+		path << directory << std::hex << std::setw(16) << std::setfill('0') << key << std::dec << "-" << sourceSize << extension;
+		return path.str();
+	}
+
+	void AssetCache::loadIndex() {
+		std::ifstream file(directory + IndexName);
+		IndexEntry entry;
+		std::string path;
+		while (file >> std::hex >> entry.contentHash >> std::dec >> entry.size >> entry.modified) {
+			file.ignore(1);
+			std::getline(file, path);
+			index[path] = entry;
+		}
+	}
+}
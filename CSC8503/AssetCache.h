@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "LodBuilder.h"
+#include "Mesh.h"
+
+namespace NCL::CSC8503 {
+	// Preprocessed assets on disk, named by a hash of their source file's contents
+	// and its size, so identical files share an entry and a renamed file is still found
+	// The size is there so a hash collision alone can't hand back the wrong asset
+	// An index remembers each source file's hash with its size and modification time,
+	// so a file that hasn't changed can be identified without reading it
+	// Safe to use from loader threads
+	class AssetCache {
+	public:
+		// Defaults to Cache/ in the asset directory
+		explicit AssetCache(const std::string& directory = "");
+		// Saves the index if anything was added to it
+		~AssetCache();
+
+		AssetCache(const AssetCache&) = delete;
+		AssetCache& operator=(const AssetCache&) = delete;
+
+		// The hash of a file's contents, if it hasn't changed since it was last hashed
+		std::optional<uint64_t> findContentHash(const std::string& path) const;
+		// Reads and hashes a file, remembering the result. Empty if it can't be read
+		std::optional<uint64_t> hashFile(const std::string& path);
+
+		// Reads a mesh in the mesh directory from the cache, adding it if it isn't there
+		// Missing meshes are read with LoadMeshWithLods, so come with their LODs
+		// Entries are kept per settings, so changing them builds the levels again
+		// Throws if the mesh can't be read at all
+		void loadMesh(const std::string& name, Rendering::Mesh& mesh, const Rendering::LodSettings& settings = {});
+
+		// Meshes read from the cache, and ones that had to be built
+		size_t getHits() const {
+			return hits;
+		}
+		size_t getMisses() const {
+			return misses;
+		}
+
+		void saveIndex();
+	private:
+		struct IndexEntry {
+			uint64_t	size;
+			int64_t		modified;
+			uint64_t	contentHash;
+		};
+
+		std::string entryPath(uint64_t key, uint64_t sourceSize, const std::string& extension) const;
+		void loadIndex();
+
+		std::string directory;
+
+		mutable std::mutex mutex;
+		// By source path
+		std::unordered_map<std::string, IndexEntry> index;
+		bool indexChanged = false;
+
+		std::atomic<size_t> hits = 0;
+		std::atomic<size_t> misses = 0;
+	};
+}
@@ -0,0 +1,60 @@
+#include "Benchmarks.h"
+
+#include <iostream>
+#include <vector>
+
+namespace NCL::CSC8503::Benchmarks {
+	struct Entry {
+		std::string_view name;
+		std::string_view description;
+		void (*func)();
+	};
+
+	static const std::vector<Entry> entries = {
+		{ "dispatch", "Packets per second through NetworkBase dispatch", packetDispatch },
+		{ "loss", "Events and snapshots over a lossy localhost connection", channelLoss },
+		{ "deltas", "Delta generation for 5k networked objects", deltaGeneration },
+		{ "lookup", "Object lookups while decoding a 10k object snapshot", objectLookup },
+		{ "joinStorm", "Player list bytes while 64 players join and leave", joinStorm },
+		{ "inputs", "Client inputs applied by the server over a lossy, jittery connection", inputBuffering },
+		{ "culling", "Camera and shadow frustum culling of 50k objects, serial and parallel", frustumCulling },
+		{ "queue", "Render queue sorting and state changes for 20k draws", renderQueueSort },
+		{ "instancing", "Instanced draw calls for a level of walls, kittens and bonuses", instanceBatching },
+		{ "streaming", "Stream buffer regions, and debug lines and text written straight to vertices", debugStreaming },
+		{ "lod", "Mesh LOD chains for the game's meshes, and LOD selection for 1000 kittens", meshLods },
+		{ "skinning", "Pose evaluation and CPU skinning of the rigged meshes, checked against a reference", skinning },
+		{ "meshLoad", "Loading every shipped mesh from .msh text and from msh2bin's binary format", meshLoading },
+		{ "assetLoad", "Time to first frame loading the game's assets up front and in the background", asyncLoading },
+		{ "assetCache", "Asset lookups by name and by ID, duplicate files, and cold and warm mesh cache loads", assetCache },
+		{ "animation", "Binary animation keys, and blending joint palettes for 1000 kittens", animationSampling },
+		{ "textures", "Baking textures to BC1, BC3 and BC7 with mips, against decoding PNGs", textures },
+		{ "navGrid", "Loading maze.txt and a generated 4096x4096 maze as text and as mapped binary grids", navigationGrids },
+		{ "hpa", "Path queries per second with A* and hierarchical A* on generated mazes up to 4096x4096", hierarchicalPaths },
+		{ "pathSearch", "A* with reusable scratch arrays against the old map and set search, on maze.txt and generated mazes", pathSearches },
+	};
+
+	int run(std::string_view name) {
+		if (name == "list") {
+			for (auto& entry : entries) {
+				std::cout << "  " << entry.name << " - " << entry.description << "\n";
+			}
+			return 0;
+		}
+
+		bool found = false;
+		for (auto& entry : entries) {
+			if (name != "all" && name != entry.name) {
+				continue;
+			}
+			found = true;
+			std::cout << "== " << entry.name << ": " << entry.description << "\n";
+			entry.func();
+			std::cout << std::endl;
+		}
+		if (!found) {
+			std::cerr << "Unknown benchmark: " << name << " (try --benchmark list)" << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+}
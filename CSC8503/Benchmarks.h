@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace NCL::CSC8503 {
+	// Headless benchmarks, run with --benchmark [name]
+	// Each benchmark prints its own results
+	namespace Benchmarks {
+		// Run the named benchmark, "all" to run everything, or "list" to list them
+		// Returns the process exit code
+		int run(std::string_view name);
+
+		// Call func repeatedly until at least minSeconds have passed
+		// Returns the average seconds per call
+		template <typename F>
+		double timeRepeated(F&& func, double minSeconds = 0.5) {
+			using Clock = std::chrono::steady_clock;
+			// Warm up caches and anything lazily allocated
+			func();
+
+			int runs = 0;
+			auto start = Clock::now();
+			std::chrono::duration<double> elapsed{};
+			do {
+				func();
+				runs++;
+				elapsed = Clock::now() - start;
+			} while (elapsed.count() < minSeconds);
+			return elapsed.count() / runs;
+		}
+
+		// Benchmarks, grouped by the files they live in
+		// NetworkBenchmarks.cpp
+		void packetDispatch();
+		void channelLoss();
+		void deltaGeneration();
+		void objectLookup();
+		void joinStorm();
+		void inputBuffering();
+
+		// RenderBenchmarks.cpp
+		void frustumCulling();
+		void renderQueueSort();
+		void instanceBatching();
+		void debugStreaming();
+		void meshLods();
+		void skinning();
+
+		// AssetBenchmarks.cpp
+		void meshLoading();
+		void asyncLoading();
+		void assetCache();
+		void animationSampling();
+		void textures();
+
+		// NavigationBenchmarks.cpp
+		void navigationGrids();
+		void hierarchicalPaths();
+		void pathSearches();
+	}
+}
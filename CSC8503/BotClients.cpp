@@ -0,0 +1,423 @@
+#include "BotClients.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <thread>
+
+#include "AABBVolume.h"
+#include "ClientPrediction.h"
+#include "GameClient.h"
+#include "GameWorld.h"
+#include "NavigationGrid.h"
+#include "NetworkedGame.h"
+#include "NetworkPlayer.h"
+#include "OBBVolume.h"
+#include "PhysicsObject.h"
+#include "PhysicsSystem.h"
+#include "SphereVolume.h"
+
+namespace NCL::CSC8503 {
+	using Clock = std::chrono::steady_clock;
+
+	namespace {
+		void addStatic(GameWorld& world, CollisionVolume* volume, const Vector3& position, const Vector3& halfSize) {
+			GameObject* object = new GameObject();
+			object->SetBoundingVolume(volume);
+			object->GetTransform()
+				.SetPosition(position)
+				.SetScale(halfSize * 2.0f);
+			object->SetPhysicsObject(new PhysicsObject(&object->GetTransform(), object->GetBoundingVolume()));
+			object->GetPhysicsObject()->SetInverseMass(0);
+			object->GetPhysicsObject()->InitCubeInertia();
+			world.AddGameObject(object);
+		}
+
+		// SimulateObject only collides with statics, so prediction only needs the
+		// floor and maze walls NetworkedGame::StartLevel builds, without rendering
+		void addLevelStatics(GameWorld& world) {
+			addStatic(world, new AABBVolume(TutorialGame::FloorHalfSize), Vector3(0, 0, 0), TutorialGame::FloorHalfSize);
+
+			NavigationGrid maze(NetworkedGame::MazeFile, NetworkedGame::MazeOffset);
+			int nodeSize = maze.getNodeSize();
+			Vector3 wallHalfSize(nodeSize / 2, NetworkedGame::MazeWallHeight / 2, nodeSize / 2);
+			for (int i = 0; i < maze.getNodeCount(); i++) {
+				GridNode node = maze.getNode(i);
+				if (node.type == GridNode::Type::Wall) {
+					addStatic(world, new OBBVolume(wallHalfSize), node.position + Vector3(0, wallHalfSize.y, 0), wallHalfSize);
+				}
+			}
+		}
+
+		// Same body as TutorialGame::AddPlayerToWorld, where the server spawns it
+		NetworkPlayer* addPlayer(GameWorld& world) {
+			NetworkPlayer* player = new NetworkPlayer(-1);
+			player->SetBoundingVolume((CollisionVolume*)new SphereVolume(1.0f));
+			player->GetTransform()
+				.SetScale(Vector3(1, 1, 1))
+				.SetPosition(Vector3(0, 5, 0));
+			player->SetDefaultTransform(player->GetTransform());
+
+			player->SetPhysicsObject(new PhysicsObject(&player->GetTransform(), player->GetBoundingVolume()));
+			player->GetPhysicsObject()->SetElasticity(0.1f);
+			player->GetPhysicsObject()->SetInverseMass(0.5f);
+			player->GetPhysicsObject()->InitSphereInertia();
+			player->GetPhysicsObject()->SetAngularDamping(0.5f);
+			player->GetPhysicsObject()->SetLinearDamping(0.5f);
+
+			world.AddGameObject(player);
+			return player;
+		}
+	}
+
+	class BotClients::Bot : public PacketReceiver {
+	public:
+		struct Stats {
+			uint32_t bytesSent = 0;
+			uint32_t bytesReceived = 0;
+			int inputsSent = 0;
+			int snapshots = 0;
+			int acks = 0;
+			// Ticks we never got an ack for
+			int acksMissed = 0;
+			// Time from sending an input to receiving the ack for it, in milliseconds
+			// This is a round trip plus however long the input waited in the server's buffer
+			std::vector<float> inputRtts;
+			// Time from the server sending a tick's state to the first snapshot of it arriving, in milliseconds
+			std::vector<float> snapshotLatencies;
+			// How far each ack moved the predicted player, after replaying unacknowledged inputs
+			std::vector<float> reconcileErrors;
+		};
+
+		Bot(int number, const NetworkConditioner::Settings& conditioner) : number(number), physics(world) {
+			name = "Bot " + std::to_string(number);
+			if (conditioner.isEnabled()) {
+				client.EnableConditioner(conditioner, number + 1);
+			}
+			// Listen to everything, so nothing gets reported as unhandled
+			for (short type = 0; type < (short)GamePacket::Type::Count; type++) {
+				client.RegisterPacketHandler((GamePacket::Type)type, this);
+			}
+
+			physics.SetGravity(Gravity::Earth);
+			addLevelStatics(world);
+			player = addPlayer(world);
+		}
+
+		~Bot() {
+			world.ClearAndErase();
+		}
+
+		bool connect(uint32_t ip) {
+			client.Connect(ip, NetworkBase::GetDefaultPort());
+			if (!client.isConnected()) {
+				return false;
+			}
+			ClientHelloPacket hello;
+			hello.name.set(name);
+			client.SendPacket(hello);
+			return true;
+		}
+
+		void update(float time) {
+			client.UpdateClient();
+			if (!client.isConnected()) {
+				return;
+			}
+
+			PlayerInput input = scriptedInput(time);
+			input.dt = lastUpdate < 0 ? 0 : time - lastUpdate;
+			lastUpdate = time;
+			inputPacket.pushInput(input);
+			inputPacket.viewTick = stateTick;
+			sendTimes[inputPacket.index % sendTimes.size()] = Clock::now();
+			client.SendPacket(inputPacket);
+			stats.inputsSent++;
+
+			// Predict like a real client, so acks have something to reconcile
+			player->setLastInput(input, inputPacket.index);
+			player->OnUpdate(input.dt);
+			physics.SimulateObject(*player, input.dt);
+			prediction.recordInput(inputPacket.index, input, input.dt);
+		}
+
+		void finish() {
+			stats.bytesSent = client.GetBytesSent();
+			stats.bytesReceived = client.GetBytesReceived();
+		}
+
+		void ReceivePacket(GamePacket::Type type, std::span<enet_uint8> packet, int source) override {
+			switch (type) {
+			case GamePacket::Type::Full_State:
+				if (auto state = GamePacket::View<FullPacket>(packet)) receiveSnapshot(state->serverTick);
+				break;
+			case GamePacket::Type::Delta_State:
+				if (auto state = GamePacket::View<DeltaPacket>(packet)) receiveSnapshot(state->serverTick);
+				break;
+			case GamePacket::Type::InputAck:
+				if (auto ack = GamePacket::View<InputAckPacket>(packet)) receiveAck(*ack);
+				break;
+			case GamePacket::Type::ServerHello:
+				if (auto hello = GamePacket::View<ServerHelloPacket>(packet)) client.SetPeerFeatures(0, hello->features);
+				break;
+			default:
+				break;
+			}
+		}
+
+		const std::string& getName() const {
+			return name;
+		}
+		const Stats& getStats() const {
+			return stats;
+		}
+		bool isConnected() const {
+			return client.isConnected();
+		}
+	private:
+		// Drive around in a loop, each bot slightly out of phase with the others
+		PlayerInput scriptedInput(float time) {
+			PlayerInput input;
+			int phase = (int)(time * 0.5f + number) % 4;
+			input.forward = phase != 2;
+			input.backward = phase == 2;
+			input.left = phase == 1;
+			input.right = phase == 3;
+			// Jump for one frame every few seconds
+			if (time >= nextJump) {
+				input.jump = true;
+				nextJump = time + 3.0f;
+			}
+			return input;
+		}
+
+		// Bots don't share a clock with the server, so when a tick was sent is estimated as
+		// halfway through the round trip of the input acked on it. Snapshots and acks leave
+		// together, so latency comes out as half the input RTT plus however much later the
+		// snapshot arrived than the ack. It includes half the time inputs wait in the server's buffer
+		struct TickTimes {
+			int tick = -1;
+			std::optional<Clock::time_point> snapshotArrived;
+			std::optional<Clock::time_point> estimatedSent;
+		};
+
+		TickTimes& tickTimes(int tick) {
+			TickTimes& times = recentTicks[tick % recentTicks.size()];
+			if (times.tick != tick) {
+				times = TickTimes();
+				times.tick = tick;
+			}
+			return times;
+		}
+
+		void recordSnapshotLatency(const TickTimes& times) {
+			stats.snapshotLatencies.push_back(std::chrono::duration<float, std::milli>(*times.snapshotArrived - *times.estimatedSent).count());
+		}
+
+		void receiveSnapshot(int serverTick) {
+			stats.snapshots++;
+			stateTick = std::max(stateTick, serverTick);
+
+			TickTimes& times = tickTimes(serverTick);
+			if (times.snapshotArrived) {
+				return;
+			}
+			times.snapshotArrived = Clock::now();
+			if (times.estimatedSent) {
+				recordSnapshotLatency(times);
+			}
+		}
+
+		void receiveAck(const InputAckPacket& ack) {
+			auto now = Clock::now();
+			stats.acks++;
+
+			if (lastServerTick >= 0 && ack.serverTick > lastServerTick + 1) {
+				stats.acksMissed += ack.serverTick - lastServerTick - 1;
+			}
+			// Reordered, we've already seen newer
+			if (ack.serverTick <= lastServerTick) {
+				return;
+			}
+
+			if (ack.lastInputIndex > lastAcknowledged && inputPacket.index - ack.lastInputIndex < (int)sendTimes.size()) {
+				auto sentAt = sendTimes[ack.lastInputIndex % sendTimes.size()];
+				stats.inputRtts.push_back(std::chrono::duration<float, std::milli>(now - sentAt).count());
+
+				TickTimes& times = tickTimes(ack.serverTick);
+				times.estimatedSent = sentAt + (now - sentAt) / 2;
+				if (times.snapshotArrived) {
+					recordSnapshotLatency(times);
+				}
+			}
+			lastAcknowledged = std::max(lastAcknowledged, ack.lastInputIndex);
+
+			// The first ack moves us from wherever we spawned, which isn't an error
+			int reconciled = prediction.getReconcileCount();
+			prediction.reconcile(*player, ack, physics);
+			if (prediction.getReconcileCount() > reconciled && reconciled > 0) {
+				stats.reconcileErrors.push_back(prediction.getLastError());
+			}
+
+			lastServerTick = ack.serverTick;
+		}
+
+		int number;
+		std::string name;
+		GameClient client;
+		Stats stats;
+
+		// Kept between frames, so it carries the last few inputs
+		ClientPacket inputPacket;
+		int lastAcknowledged = -1;
+		int lastServerTick = -1;
+		// Server tick of the newest state received, which bots "show" as soon as it arrives
+		int stateTick = -1;
+		float nextJump = 1.0f;
+		// Time of the last input sent, each input is held until the next
+		float lastUpdate = -1;
+
+		std::array<Clock::time_point, 256> sendTimes;
+		std::array<TickTimes, 64> recentTicks;
+
+		// Only holds the statics and our own player, everything else is left to the server
+		GameWorld world;
+		PhysicsSystem physics;
+		NetworkPlayer* player = nullptr;
+		ClientPrediction prediction;
+	};
+
+	BotClients::BotClients(const Cli& cli) : cli(cli) {
+	}
+
+	BotClients::~BotClients() {
+	}
+
+	int BotClients::run() {
+		NetworkBase::Initialise();
+
+		for (int i = 0; i < cli.getBotCount(); i++) {
+			auto bot = std::make_unique<Bot>(i, cli.getConditionerSettings());
+			if (!bot->connect(cli.getIp())) {
+				std::cerr << bot->getName() << " failed to connect, is the server running?" << std::endl;
+				continue;
+			}
+			bots.push_back(std::move(bot));
+		}
+		if (bots.empty()) {
+			NetworkBase::Destroy();
+			return 1;
+		}
+
+		// Play at a steady 60fps, like a real client with vsync
+		const auto frameTime = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(1.0f / 60.0f));
+		auto start = Clock::now();
+		auto nextFrame = start;
+		float time = 0;
+		while (time < cli.getBotDuration()) {
+			for (auto& bot : bots) {
+				bot->update(time);
+			}
+			nextFrame += frameTime;
+			std::this_thread::sleep_until(nextFrame);
+			time = std::chrono::duration<float>(Clock::now() - start).count();
+		}
+
+		for (auto& bot : bots) {
+			bot->finish();
+		}
+		printReport(time);
+
+		bots.clear();
+		NetworkBase::Destroy();
+		return 0;
+	}
+
+	namespace {
+		float average(const std::vector<float>& values) {
+			if (values.empty()) return 0;
+			float total = 0;
+			for (float v : values) total += v;
+			return total / values.size();
+		}
+
+		// Sorts a copy, only called once per bot
+		float percentile(std::vector<float> values, float p) {
+			if (values.empty()) return 0;
+			std::sort(values.begin(), values.end());
+			return values[std::min(values.size() - 1, (size_t)(p * values.size()))];
+		}
+
+		float maximum(const std::vector<float>& values) {
+			return values.empty() ? 0 : *std::max_element(values.begin(), values.end());
+		}
+	}
+
+	void BotClients::printReport(float duration) const {
+		auto& sim = cli.getConditionerSettings();
+		std::cout << "\nBot run: " << bots.size() << " bots for " << std::fixed << std::setprecision(1) << duration << "s\n";
+		if (sim.isEnabled()) {
+			std::cout << "Conditioner: " << sim.latency << "ms latency, " << sim.jitter << "ms jitter, "
+				<< sim.loss * 100 << "% loss, " << sim.duplicate * 100 << "% duplicate, "
+				<< sim.reorder * 100 << "% reorder, "
+				<< (sim.bandwidth ? std::to_string(sim.bandwidth * 8 / 1000) + "kbps" : std::string("unlimited")) << " bandwidth\n";
+		}
+
+		std::cout
+			<< std::left << std::setw(10) << "Name"
+			<< std::right
+			<< std::setw(10) << "Up kbps"
+			<< std::setw(10) << "Down kbps"
+			<< std::setw(12) << "Snapshots/s"
+			<< std::setw(16) << "Input RTT avg"
+			<< std::setw(16) << "Input RTT p95"
+			<< std::setw(16) << "Input RTT max"
+			<< std::setw(16) << "Snapshot avg"
+			<< std::setw(16) << "Snapshot p95"
+			<< std::setw(12) << "Acks lost"
+			<< std::setw(16) << "Reconcile avg"
+			<< std::setw(16) << "Reconcile max"
+			<< "\n";
+
+		Bot::Stats total;
+		for (auto& bot : bots) {
+			auto& stats = bot->getStats();
+			std::cout
+				<< std::left << std::setw(10) << bot->getName()
+				<< std::right << std::setprecision(1)
+				<< std::setw(10) << stats.bytesSent * 8 / 1000.0f / duration
+				<< std::setw(10) << stats.bytesReceived * 8 / 1000.0f / duration
+				<< std::setw(12) << stats.snapshots / duration
+				<< std::setw(16) << average(stats.inputRtts)
+				<< std::setw(16) << percentile(stats.inputRtts, 0.95f)
+				<< std::setw(16) << maximum(stats.inputRtts)
+				<< std::setw(16) << average(stats.snapshotLatencies)
+				<< std::setw(16) << percentile(stats.snapshotLatencies, 0.95f)
+				<< std::setw(12) << stats.acksMissed
+				<< std::setprecision(3)
+				<< std::setw(16) << average(stats.reconcileErrors)
+				<< std::setw(16) << maximum(stats.reconcileErrors)
+				<< (bot->isConnected() ? "" : "  (disconnected)")
+				<< "\n";
+
+			total.bytesSent += stats.bytesSent;
+			total.bytesReceived += stats.bytesReceived;
+			total.acksMissed += stats.acksMissed;
+			total.inputRtts.insert(total.inputRtts.end(), stats.inputRtts.begin(), stats.inputRtts.end());
+			total.snapshotLatencies.insert(total.snapshotLatencies.end(), stats.snapshotLatencies.begin(), stats.snapshotLatencies.end());
+			total.reconcileErrors.insert(total.reconcileErrors.end(), stats.reconcileErrors.begin(), stats.reconcileErrors.end());
+		}
+
+		std::cout << std::setprecision(1)
+			<< "Total: " << total.bytesSent * 8 / 1000.0f / duration << "kbps up, "
+			<< total.bytesReceived * 8 / 1000.0f / duration << "kbps down, "
+			<< "input RTT avg " << average(total.inputRtts) << "ms p95 " << percentile(total.inputRtts, 0.95f) << "ms, "
+			<< "snapshot latency avg " << average(total.snapshotLatencies) << "ms p95 " << percentile(total.snapshotLatencies, 0.95f) << "ms, "
+			<< total.acksMissed << " acks lost, "
+			<< std::setprecision(3) << "reconciliation error avg " << average(total.reconcileErrors) << " max " << maximum(total.reconcileErrors)
+			<< std::endl;
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Cli.h"
+
+namespace NCL::CSC8503 {
+	// Headless clients that connect to a running server and play a scripted
+	// input pattern. Used to test the netcode under load and bad network
+	// conditions, prints stats for the run once finished
+	class BotClients {
+	public:
+		BotClients(const Cli& cli);
+		~BotClients();
+
+		// Returns the process exit code
+		int run();
+	private:
+		class Bot;
+
+		void printReport(float duration) const;
+
+		const Cli& cli;
+		std::vector<std::unique_ptr<Bot>> bots;
+	};
+}
@@ -24,8 +24,16 @@ Cli::Cli(int argc, char** argv) {
 			throw std::runtime_error("Expected argument");
 		}
 	};
-
     std::string arg;
+    // Read a non-negative number for the current flag
+    auto consumeNumber = [&](float& out) {
+        std::string str;
+        consumeRequiredArg(str);
+        if (sscanf_s(str.c_str(), "%f", &out) != 1 || out < 0) {
+            throw std::runtime_error("Invalid value for " + arg + ": " + str);
+        }
+    };
+
     while (consumeArg(arg)) {
         if (arg == "-h" || arg == "--help") {
             // Normally we only want to exit by returning from main
@@ -67,6 +75,51 @@ Cli::Cli(int argc, char** argv) {
 			if (sscanf_s(timeStr.c_str(), "%f", &maxGameLength) != 1) {
 				throw std::runtime_error("Invalid time limit: " + timeStr);
 			}
+        } else if (arg == "-r" || arg == "--tick-rate") {
+            std::string rateStr;
+            consumeRequiredArg(rateStr);
+            if (sscanf_s(rateStr.c_str(), "%f", &tickRate) != 1 || tickRate <= 0) {
+                throw std::runtime_error("Invalid tick rate: " + rateStr);
+            }
+        } else if (arg == "--sim-latency") {
+            consumeNumber(conditioner.latency);
+        } else if (arg == "--sim-jitter") {
+            consumeNumber(conditioner.jitter);
+        } else if (arg == "--sim-loss") {
+            consumeNumber(conditioner.loss);
+            conditioner.loss /= 100.0f;
+        } else if (arg == "--sim-duplicate") {
+            consumeNumber(conditioner.duplicate);
+            conditioner.duplicate /= 100.0f;
+        } else if (arg == "--sim-reorder") {
+            consumeNumber(conditioner.reorder);
+            conditioner.reorder /= 100.0f;
+        } else if (arg == "--sim-bandwidth") {
+            float kbps;
+            consumeNumber(kbps);
+            conditioner.bandwidth = (int)(kbps * 1000.0f / 8.0f);
+        } else if (arg == "--bots") {
+            float count;
+            consumeNumber(count);
+            botCount = (int)count;
+        } else if (arg == "--bot-time") {
+            consumeNumber(botDuration);
+        } else if (arg == "--hpa") {
+            hierarchicalPaths = true;
+        } else if (arg == "--net-profile") {
+            // Optional, defaults to the working directory
+            if (i < argc && argv[i][0] != '-') {
+                consumeArg(netProfilePath);
+            } else {
+                netProfilePath = "net_profile";
+            }
+        } else if (arg == "-b" || arg == "--benchmark") {
+            // Optional, defaults to everything
+            if (i < argc && argv[i][0] != '-') {
+                consumeArg(benchmark);
+            } else {
+                benchmark = "all";
+            }
         } else {
             throw std::runtime_error("Unknown argument: " + arg + " (try -h for help)");
         }
@@ -86,5 +139,21 @@ void Cli::printUsage(char* programName) const {
         "  -f, --fullscreen              Run the program in fullscreen\n"
         "  -w, --window [x=0] [y=0]      Set the window position\n"
         "  -t, --time-limit              Set the maximum game length\n"
-        "  -n, --name [name=User]        Set the user name\n";
+        "  -r, --tick-rate [hz=60]       Set the network tick rate\n"
+        "  -n, --name [name=User]        Set the user name\n"
+        "  -b, --benchmark [name=all]    Run a headless benchmark and exit, \"list\" to list them\n"
+        "  --net-profile [path=net_profile]  Write network traffic stats to path.csv and path.json on exit\n"
+        "  --hpa                         Find paths through the maze with hierarchical A*\n"
+        "\n"
+        "Network simulation, applied to this instance's connection:\n"
+        "  --sim-latency [ms=0]          One way latency\n"
+        "  --sim-jitter [ms=0]           Random extra latency, up to this much\n"
+        "  --sim-loss [percent=0]        Incoming packet loss\n"
+        "  --sim-duplicate [percent=0]   Duplicate outgoing unreliable packets\n"
+        "  --sim-reorder [percent=0]     Hold back outgoing unreliable packets so they arrive out of order\n"
+        "  --sim-bandwidth [kbps=0]      Outgoing bandwidth cap, 0 for unlimited\n"
+        "\n"
+        "Headless bots, connect to a running server and print stats:\n"
+        "  --bots [count]                Run this many bot clients instead of the game\n"
+        "  --bot-time [seconds=30]       How long the bots play for\n";
 }
@@ -43,13 +43,56 @@ public:
 	float getMaxGameLength() const {
 		return maxGameLength;
 	}
+
+	// Network ticks per second
+	float getTickRate() const {
+		return tickRate;
+	}
+
+	const NetworkConditioner::Settings& getConditionerSettings() const {
+		return conditioner;
+	}
+
+	// Number of headless bot clients to run, 0 to run the game normally
+	int getBotCount() const {
+		return botCount;
+	}
+	float getBotDuration() const {
+		return botDuration;
+	}
+
+	// Where to write network profiles on shutdown, without an extension
+	// Empty if they shouldn't be written
+	std::string_view getNetProfilePath() const {
+		return netProfilePath;
+	}
+
+	// Search the maze with hierarchical A* rather than plain A*
+	bool useHierarchicalPaths() const {
+		return hierarchicalPaths;
+	}
+
+	// Name of the benchmark to run instead of the game, empty if none
+	std::string_view getBenchmark() const {
+		return benchmark;
+	}
 private:
 	ClientType clientType = ClientType::Auto;
 	bool captureMouse = true;
 	bool fullscreen = false;
+	bool hierarchicalPaths = false;
 	uint32_t ip = NetworkBase::ipv4(127, 0, 0, 1); // Default to localhost
 
 	float maxGameLength = 300.0f;
+	float tickRate = 60.0f;
+
+	NetworkConditioner::Settings conditioner;
+
+	int botCount = 0;
+	float botDuration = 30.0f;
+
+	std::string benchmark;
+	std::string netProfilePath;
 
 	NCL::Maths::Vector2i windowPos = NCL::Maths::Vector2i(0, 0);
 
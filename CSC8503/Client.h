@@ -11,7 +11,7 @@ namespace NCL::CSC8503 {
             return client;
         }
 
-        void ReceivePacket(GamePacket::Type type, GamePacket* payload, int source = -1) override;
+        void ReceivePacket(GamePacket::Type type, std::span<enet_uint8> packet, int source = -1) override;
     private:
         GameClient* client;
     };
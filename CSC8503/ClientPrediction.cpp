@@ -0,0 +1,47 @@
+#include "ClientPrediction.h"
+
+namespace NCL::CSC8503 {
+	void ClientPrediction::recordInput(int index, const PlayerInput& input, float dt) {
+		InputRecord& record = history[index & (HistorySize - 1)];
+		record.index = index;
+		record.input = input;
+		record.dt = dt;
+		lastRecorded = index;
+	}
+
+	void ClientPrediction::reconcile(NetworkPlayer& player, const InputAckPacket& ack, PhysicsSystem& physics) {
+		// Acks are sent unreliably, ignore any that arrive out of order
+		if (ack.lastInputIndex <= lastAcknowledged) {
+			return;
+		}
+		lastAcknowledged = ack.lastInputIndex;
+
+		Vector3 predicted = player.GetTransform().GetPosition();
+		player.readAck(ack);
+
+		// Anything older than the history has been overwritten, the best we can do
+		// is replay what we still have
+		int first = std::max(lastAcknowledged + 1, lastRecorded - HistorySize + 1);
+		for (int i = first; i <= lastRecorded; i++) {
+			const InputRecord& record = history[i & (HistorySize - 1)];
+			if (record.index != i) {
+				continue;
+			}
+			player.replayInput(record.input, record.dt);
+			physics.SimulateObject(player, record.dt);
+		}
+
+		lastError = Vector::Length(player.GetTransform().GetPosition() - predicted);
+		maxError = std::max(maxError, lastError);
+		reconcileCount++;
+	}
+
+	void ClientPrediction::reset() {
+		history.fill(InputRecord());
+		lastRecorded = -1;
+		lastAcknowledged = -1;
+		lastError = 0;
+		maxError = 0;
+		reconcileCount = 0;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+
+#include "NetworkPlayer.h"
+#include "PhysicsSystem.h"
+
+namespace NCL::CSC8503 {
+	// Client side prediction for the local player
+	// Inputs are applied locally as soon as they're sent, and kept until the
+	// server acknowledges them. When the server's state arrives, we rewind to it
+	// and replay everything it hasn't seen yet
+	class ClientPrediction {
+	public:
+		// Must be a power of 2. 128 inputs is ~2 seconds at 60fps, if we're
+		// further behind than that, prediction is the least of our problems
+		static const constexpr int HistorySize = 128;
+
+		struct InputRecord {
+			int index = -1;
+			PlayerInput input;
+			// Frame time the input was held for
+			float dt = 0;
+		};
+
+		void recordInput(int index, const PlayerInput& input, float dt);
+
+		// Snap the player to the server state and replay unacknowledged inputs
+		void reconcile(NetworkPlayer& player, const InputAckPacket& ack, PhysicsSystem& physics);
+
+		void reset();
+
+		int getLastAcknowledged() const {
+			return lastAcknowledged;
+		}
+		int getPendingInputs() const {
+			return lastRecorded - lastAcknowledged;
+		}
+		// Distance between where we predicted we'd be and where we ended up
+		// after replaying on top of the server state
+		float getLastError() const {
+			return lastError;
+		}
+		float getMaxError() const {
+			return maxError;
+		}
+		int getReconcileCount() const {
+			return reconcileCount;
+		}
+	private:
+		std::array<InputRecord, HistorySize> history;
+		int lastRecorded = -1;
+		int lastAcknowledged = -1;
+
+		float lastError = 0;
+		float maxError = 0;
+		int reconcileCount = 0;
+	};
+}
@@ -3,18 +3,36 @@
 #include "RenderObject.h"
 #include "Camera.h"
 #include "TextureLoader.h"
-#include "MshLoader.h"
+#include "GameTimer.h"
+#include "OGLProgramCache.h"
+#include "Assets.h"
+#include "LodBuilder.h"
+#include "Pose.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
 using namespace NCL;
 using namespace Rendering;
 using namespace CSC8503;
 
 #define SHADOWSIZE 4096
+//Space for one frame's instances and debug vertices, three frames are kept in flight
+#define STREAMREGIONSIZE (2 * 1024 * 1024)
 
 Matrix4 biasMatrix = Matrix::Translation(Vector3(0.5f, 0.5f, 0.5f)) * Matrix::Scale(Vector3(0.5f, 0.5f, 0.5f));
 
-GameTechRenderer::GameTechRenderer(GameWorld& world) : OGLRenderer(*Window::GetWindow()), gameWorld(world)	{
+GameTechRenderer::GameTechRenderer(GameWorld& world) : OGLRenderer(*Window::GetWindow()), gameWorld(world), streamBuffer(STREAMREGIONSIZE)	{
 	glEnable(GL_DEPTH_TEST);
 
+	//Textures baked by msh2bin are used instead of their images, already compressed with their mips
+	TextureLoader::RegisterTextureLoadFunction(TextureBinary::LoadFunction, TextureBinary::Extension);
+	//Linked shader programs from earlier runs are reused instead of compiling them again
+	OGLProgramCache::SetDirectory(Assets::ASSETROOT + "Cache/Programs/");
+
 	debugShader  = new OGLShader("Debug.vert", "Debug.frag");
 	shadowShader = new OGLShader("shadow.vert", "shadow.frag");
 
@@ -54,11 +72,9 @@ GameTechRenderer::GameTechRenderer(GameWorld& world) : OGLRenderer(*Window::GetW
 
 	glGenVertexArrays(1, &lineVAO);
 	glGenVertexArrays(1, &textVAO);
+	SetDebugVertexFormats();
 
-	glGenBuffers(1, &lineVertVBO);
-	glGenBuffers(1, &textVertVBO);
-	glGenBuffers(1, &textColourVBO);
-	glGenBuffers(1, &textTexVBO);
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
 
 	Debug::CreateDebugFont("PressStart2P.fnt", *LoadTexture("PressStart2P.png"));
 
@@ -68,15 +84,13 @@ GameTechRenderer::GameTechRenderer(GameWorld& world) : OGLRenderer(*Window::GetW
 	debugTexMesh->SetVertexTextureCoords({ Vector2(0, 1), Vector2(0,0) , Vector2(1,0) , Vector2(1,1) });
 	debugTexMesh->SetVertexIndices({ 0,1,2,2,3,0 });
 	debugTexMesh->UploadToGPU();
-
-
-	SetDebugStringBufferSizes(10000);
-	SetDebugLineBufferSizes(1000);
 }
 
 GameTechRenderer::~GameTechRenderer()	{
 	glDeleteTextures(1, &shadowTex);
 	glDeleteFramebuffers(1, &shadowFBO);
+	glDeleteVertexArrays(1, &lineVAO);
+	glDeleteVertexArrays(1, &textVAO);
 }
 
 void GameTechRenderer::LoadSkybox() {
@@ -89,27 +103,13 @@ void GameTechRenderer::LoadSkybox() {
 		"Cubemap/skyrender0005.png"
 	};
 
-	uint32_t width[6]	 = { 0 };
-	uint32_t height[6]	 = { 0 };
-	uint32_t channels[6] = { 0 };
-	int flags[6]		 = { 0 };
-
-	vector<char*> texData(6, nullptr);
-
-	for (int i = 0; i < 6; ++i) {
-		TextureLoader::LoadTexture(filenames[i], texData[i], width[i], height[i], channels[i], flags[i]);
-		if (i > 0 && (width[i] != width[0] || height[0] != height[0])) {
-			std::cout << __FUNCTION__ << " cubemap input textures don't match in size?\n";
-			return;
-		}
-	}
 	glGenTextures(1, &skyboxTex);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTex);
 
-	GLenum type = channels[0] == 4 ? GL_RGBA : GL_RGB;
-
-	for (int i = 0; i < 6; ++i) {
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width[i], height[i], 0, type, GL_UNSIGNED_BYTE, texData[i]);
+	bool baked = false;
+	if (!OGLTexture::UploadCubemapFaces(filenames, baked)) {
+		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		return;
 	}
 
 	glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -120,9 +120,12 @@ void GameTechRenderer::LoadSkybox() {
 }
 
 void GameTechRenderer::RenderFrame() {
+	streamBuffer.BeginFrame();
 	glEnable(GL_CULL_FACE);
 	glClearColor(1, 1, 1, 1);
 	BuildObjectList();
+	SkinObjects();
+	SelectLods();
 	SortObjectList();
 	RenderShadowMap();
 	RenderSkybox();
@@ -137,23 +140,119 @@ void GameTechRenderer::RenderFrame() {
 	glDisable(GL_BLEND);
 	glEnable(GL_DEPTH_TEST);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	streamBuffer.EndFrame();
 }
 
 void GameTechRenderer::BuildObjectList() {
-	activeObjects.clear();
+	GameTimer timer;
+
+	Matrix4 viewMatrix = gameWorld.GetMainCamera().BuildViewMatrix();
+	Matrix4 projMatrix = gameWorld.GetMainCamera().BuildProjectionMatrix(hostWindow.GetScreenAspect());
+	views[CameraView].frustum = Frustum::FromViewProjMatrix(projMatrix * viewMatrix);
+
+	Matrix4 shadowViewMatrix = Matrix::View(lightPosition, Vector3(0, 0, 0), Vector3(0, 1, 0));
+	Matrix4 shadowProjMatrix = Matrix::Perspective(100.0f, 500.0f, 1.0f, 45.0f);
+	shadowViewProj	= shadowProjMatrix * shadowViewMatrix;
+	shadowMatrix	= biasMatrix * shadowViewProj; //we'll use this one later on
+	views[ShadowView].frustum = Frustum::FromViewProjMatrix(shadowViewProj);
+
+	culler.cull(gameWorld, views);
+	// A mesh still loading may be half written by a loader thread, so nothing reads it until it's uploaded
+	for (RenderCuller::View& view : views) {
+		std::erase_if(view.visible, [](const RenderObject* object) {
+			return !((const OGLMesh*)object->GetMesh())->IsUploaded();
+		});
+	}
+	cullTime = (float)timer.GetTotalTimeSeconds();
+}
+
+void GameTechRenderer::SkinObjects() {
+	GameTimer timer;
 
-	for (auto o : gameWorld.objects()) {
-		if (o->IsActive()) {
-			const RenderObject* g = o->GetRenderObject();
-			if (g) {
-				activeObjects.emplace_back(g);
+	skinnedObjects.clear();
+	for (const RenderCuller::View& view : views) {
+		for (RenderObject* object : view.visible) {
+			if (object->GetSkin()) {
+				skinnedObjects.push_back(object);
 			}
 		}
 	}
+	// Objects seen by both the camera and the shadow map are only skinned once
+	std::sort(skinnedObjects.begin(), skinnedObjects.end());
+	skinnedObjects.erase(std::unique(skinnedObjects.begin(), skinnedObjects.end()), skinnedObjects.end());
+	if (skinnedObjects.empty()) {
+		skinTime = 0.0f;
+		return;
+	}
+
+	for (RenderObject* object : skinnedObjects) {
+		RenderObject::Skin& skin = *object->GetSkin();
+		if (!skin.mesh) {
+			skin.mesh = CreateSkinnedMesh(*object->GetBindMesh());
+		}
+	}
+
+	WorkerPool::Get().parallelFor(skinnedObjects.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			RenderObject::Skin& skin = *skinnedObjects[i]->GetSkin();
+			CpuSkinner::Skin(*skinnedObjects[i]->GetBindMesh(), skin.pose->GetPalette(), skin.vertices);
+		}
+	});
+
+	// Uploads have to happen on this thread, which owns the GL context
+	for (RenderObject* object : skinnedObjects) {
+		RenderObject::Skin& skin = *object->GetSkin();
+		OGLMesh& mesh = (OGLMesh&)*skin.mesh;
+		mesh.SetVertexPositions(skin.vertices.positions);
+		mesh.SetVertexNormals(skin.vertices.normals);
+		mesh.SetVertexTangents(skin.vertices.tangents);
+		mesh.UpdateGPUBuffers(0, (unsigned int)mesh.GetVertexCount());
+	}
+	skinTime = (float)timer.GetTotalTimeSeconds();
+}
+
+void GameTechRenderer::SelectLods() {
+	const PerspectiveCamera& camera = gameWorld.GetMainCamera();
+	lodSelector.BeginFrame((float)windowSize.y, camera.GetFieldOfVision(), frameTime);
+	Vector3 camPos = camera.GetPosition();
+
+	// Shadows use the level picked for the camera, so objects match their shadows
+	for (const RenderCuller::View& view : views) {
+		for (RenderObject* object : view.visible) {
+			const Transform* transform = object->GetTransform();
+			float distance	= Vector::Length(transform->GetPosition() - camPos);
+			float scale		= Vector::GetAbsMaxElement(transform->GetScale());
+			lodSelector.Select(*object->GetMesh(), distance, scale, object->GetLodState());
+		}
+	}
 }
 
 void GameTechRenderer::SortObjectList() {
+	GameTimer timer;
+
+	const PerspectiveCamera& camera = gameWorld.GetMainCamera();
+	renderQueue.begin(camera.GetPosition(), camera.GetFarPlane());
+	renderQueue.add(RenderQueue::Pass::Shadow, views[ShadowView].visible);
+	for (const RenderObject* object : views[CameraView].visible) {
+		bool transparent = object->GetColour().w < 1.0f;
+		renderQueue.add(transparent ? RenderQueue::Pass::Transparent : RenderQueue::Pass::Opaque, *object);
+	}
+	renderQueue.sort();
+	batcher.build(renderQueue);
+
+	sortTime = (float)timer.GetTotalTimeSeconds();
+
+	UploadInstances();
+}
+
+void GameTechRenderer::UploadInstances() {
+	std::span<const InstanceBatcher::Instance> instances = batcher.getInstances();
+	// Binding an empty range isn't allowed
+	size_t size = std::max<size_t>(instances.size_bytes(), sizeof(InstanceBatcher::Instance));
 
+	OGLStreamBuffer::Allocation space = streamBuffer.Allocate(size, storageAlignment);
+	memcpy(space.data, instances.data(), instances.size_bytes());
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, InstanceBinding, space.buffer, space.offset, size);
 }
 
 void GameTechRenderer::RenderShadowMap() {
@@ -165,24 +264,16 @@ void GameTechRenderer::RenderShadowMap() {
 	glCullFace(GL_FRONT);
 
 	UseShader(*shadowShader);
-	int mvpLocation = glGetUniformLocation(shadowShader->GetProgramID(), "mvpMatrix");
+	glUniformMatrix4fv(shadowShader->GetUniformLocation("viewProjMatrix"), 1, false, (float*)&shadowViewProj);
+	int offsetLocation = shadowShader->GetUniformLocation("instanceOffset");
 
-	Matrix4 shadowViewMatrix = Matrix::View(lightPosition, Vector3(0, 0, 0), Vector3(0,1,0));
-	Matrix4 shadowProjMatrix = Matrix::Perspective(100.0f, 500.0f, 1.0f, 45.0f);
-
-	Matrix4 mvMatrix = shadowProjMatrix * shadowViewMatrix;
-
-	shadowMatrix = biasMatrix * mvMatrix; //we'll use this one later on
-
-	for (const auto&i : activeObjects) {
-		Matrix4 modelMatrix = (*i).GetTransform()->GetMatrix();
-		Matrix4 mvpMatrix	= mvMatrix * modelMatrix;
-		glUniformMatrix4fv(mvpLocation, 1, false, (float*)&mvpMatrix);
-		BindMesh((OGLMesh&)*(*i).GetMesh());
-		size_t layerCount = (*i).GetMesh()->GetSubMeshCount();
-		for (size_t i = 0; i < layerCount; ++i) {
-			DrawBoundMesh((uint32_t)i);
+	for (const InstanceBatcher::Batch& batch : batcher.getBatches(RenderQueue::Pass::Shadow)) {
+		const RenderObject& object = *batch.object;
+		if (batch.change.mesh) {
+			BindMesh((OGLMesh&)*object.GetMesh());
 		}
+		glUniform1i(offsetLocation, batch.firstInstance);
+		DrawSubMeshes(*object.GetMesh(), object.GetLodLevel(), batch.instanceCount);
 	}
 
 	glViewport(0, 0, windowSize.x, windowSize.y);
@@ -202,9 +293,9 @@ void GameTechRenderer::RenderSkybox() {
 
 	UseShader(*skyboxShader);
 
-	int projLocation = glGetUniformLocation(skyboxShader->GetProgramID(), "projMatrix");
-	int viewLocation = glGetUniformLocation(skyboxShader->GetProgramID(), "viewMatrix");
-	int texLocation  = glGetUniformLocation(skyboxShader->GetProgramID(), "cubeTex");
+	int projLocation = skyboxShader->GetUniformLocation("projMatrix");
+	int viewLocation = skyboxShader->GetUniformLocation("viewMatrix");
+	int texLocation  = skyboxShader->GetUniformLocation("cubeTex");
 
 	glUniformMatrix4fv(projLocation, 1, false, (float*)&projMatrix);
 	glUniformMatrix4fv(viewLocation, 1, false, (float*)&viewMatrix);
@@ -224,99 +315,122 @@ void GameTechRenderer::RenderSkybox() {
 void GameTechRenderer::RenderCamera() {
 	Matrix4 viewMatrix = gameWorld.GetMainCamera().BuildViewMatrix();
 	Matrix4 projMatrix = gameWorld.GetMainCamera().BuildProjectionMatrix(hostWindow.GetScreenAspect());
+	Vector3 camPos = gameWorld.GetMainCamera().GetPosition();
 
-	OGLShader* activeShader = nullptr;
-	int projLocation	= 0;
-	int viewLocation	= 0;
-	int modelLocation	= 0;
-	int colourLocation  = 0;
+	OGLShader* shader = nullptr;
+	int offsetLocation	= 0;
 	int hasVColLocation = 0;
 	int hasTexLocation  = 0;
-	int shadowLocation  = 0;
-
-	int lightPosLocation	= 0;
-	int lightColourLocation = 0;
-	int lightRadiusLocation = 0;
-
-	int cameraLocation = 0;
 
 	//TODO - PUT IN FUNCTION
 	glActiveTexture(GL_TEXTURE0 + 1);
 	glBindTexture(GL_TEXTURE_2D, shadowTex);
 
-	for (const auto&i : activeObjects) {
-		OGLShader* shader = (OGLShader*)(*i).GetShader();
-		UseShader(*shader);
+	auto drawBatch = [&](const InstanceBatcher::Batch& batch) {
+		const RenderObject& object = *batch.object;
 
-		if ((*i).GetDefaultTexture()) {
-			BindTextureToShader(*(OGLTexture*)(*i).GetDefaultTexture(), "mainTex", 0);
-		}
+		// Everything that only changes per shader is set once, as the queue keeps shaders together
+		if (batch.change.shader) {
+			shader = (OGLShader*)object.GetShader();
+			UseShader(*shader);
 
-		if (activeShader != shader) {
-			projLocation	= glGetUniformLocation(shader->GetProgramID(), "projMatrix");
-			viewLocation	= glGetUniformLocation(shader->GetProgramID(), "viewMatrix");
-			modelLocation	= glGetUniformLocation(shader->GetProgramID(), "modelMatrix");
-			shadowLocation  = glGetUniformLocation(shader->GetProgramID(), "shadowMatrix");
-			colourLocation  = glGetUniformLocation(shader->GetProgramID(), "objectColour");
-			hasVColLocation = glGetUniformLocation(shader->GetProgramID(), "hasVertexColours");
-			hasTexLocation  = glGetUniformLocation(shader->GetProgramID(), "hasTexture");
+			offsetLocation	= shader->GetUniformLocation("instanceOffset");
+			hasVColLocation = shader->GetUniformLocation("hasVertexColours");
+			hasTexLocation  = shader->GetUniformLocation("hasTexture");
 
-			lightPosLocation	= glGetUniformLocation(shader->GetProgramID(), "lightPos");
-			lightColourLocation = glGetUniformLocation(shader->GetProgramID(), "lightColour");
-			lightRadiusLocation = glGetUniformLocation(shader->GetProgramID(), "lightRadius");
+			glUniform3fv(shader->GetUniformLocation("cameraPos"), 1, &camPos.x);
 
-			cameraLocation = glGetUniformLocation(shader->GetProgramID(), "cameraPos");
+			glUniformMatrix4fv(shader->GetUniformLocation("projMatrix"), 1, false, (float*)&projMatrix);
+			glUniformMatrix4fv(shader->GetUniformLocation("viewMatrix"), 1, false, (float*)&viewMatrix);
+			glUniformMatrix4fv(shader->GetUniformLocation("shadowMatrix"), 1, false, (float*)&shadowMatrix);
 
-			Vector3 camPos = gameWorld.GetMainCamera().GetPosition();
-			glUniform3fv(cameraLocation, 1, &camPos.x);
+			glUniform3fv(shader->GetUniformLocation("lightPos")	, 1, (float*)&lightPosition);
+			glUniform4fv(shader->GetUniformLocation("lightColour"), 1, (float*)&lightColour);
+			glUniform1f(shader->GetUniformLocation("lightRadius") , lightRadius);
 
-			glUniformMatrix4fv(projLocation, 1, false, (float*)&projMatrix);
-			glUniformMatrix4fv(viewLocation, 1, false, (float*)&viewMatrix);
-
-			glUniform3fv(lightPosLocation	, 1, (float*)&lightPosition);
-			glUniform4fv(lightColourLocation, 1, (float*)&lightColour);
-			glUniform1f(lightRadiusLocation , lightRadius);
-
-			int shadowTexLocation = glGetUniformLocation(shader->GetProgramID(), "shadowTex");
-			glUniform1i(shadowTexLocation, 1);
-
-			activeShader = shader;
+			glUniform1i(shader->GetUniformLocation("shadowTex"), 1);
 		}
 
-		Matrix4 modelMatrix = (*i).GetTransform()->GetMatrix();
-		glUniformMatrix4fv(modelLocation, 1, false, (float*)&modelMatrix);
-
-		Matrix4 fullShadowMat = shadowMatrix * modelMatrix;
-		glUniformMatrix4fv(shadowLocation, 1, false, (float*)&fullShadowMat);
+		if (batch.change.texture) {
+			if (object.GetDefaultTexture()) {
+				BindTextureToShader(*(OGLTexture*)object.GetDefaultTexture(), "mainTex", 0);
+			}
+			glUniform1i(hasTexLocation, object.GetDefaultTexture() ? 1:0);
+		}
 
-		Vector4 colour = i->GetColour();
-		glUniform4fv(colourLocation, 1, &colour.x);
+		if (batch.change.mesh) {
+			BindMesh((OGLMesh&)*object.GetMesh());
+		}
+		if (batch.change.mesh || batch.change.shader) {
+			glUniform1i(hasVColLocation, !object.GetMesh()->GetColourData().empty());
+		}
 
-		glUniform1i(hasVColLocation, !(*i).GetMesh()->GetColourData().empty());
+		// Model matrices and colours come from the instance buffer
+		glUniform1i(offsetLocation, batch.firstInstance);
+		DrawSubMeshes(*object.GetMesh(), object.GetLodLevel(), batch.instanceCount);
+	};
 
-		glUniform1i(hasTexLocation, (OGLTexture*)(*i).GetDefaultTexture() ? 1:0);
+	for (const InstanceBatcher::Batch& batch : batcher.getBatches(RenderQueue::Pass::Opaque)) {
+		drawBatch(batch);
+	}
+	for (const InstanceBatcher::Batch& batch : batcher.getBatches(RenderQueue::Pass::Transparent)) {
+		drawBatch(batch);
+	}
+}
 
-		BindMesh((OGLMesh&)*(*i).GetMesh());
-		size_t layerCount = (*i).GetMesh()->GetSubMeshCount();
-		for (size_t i = 0; i < layerCount; ++i) {
-			DrawBoundMesh((uint32_t)i);
+void GameTechRenderer::DrawSubMeshes(const Mesh& mesh, uint32_t lod, uint32_t instanceCount) {
+	if (lod > 0) {
+		for (const SubMesh& range : mesh.GetLods()[lod - 1].subMeshes) {
+			DrawBoundSubMesh(range, instanceCount);
 		}
+		return;
+	}
+	size_t layerCount = mesh.GetSubMeshCount();
+	for (size_t i = 0; i < layerCount; ++i) {
+		DrawBoundMesh((uint32_t)i, instanceCount);
 	}
 }
 
 Mesh* GameTechRenderer::LoadMesh(const std::string& name) {
 	OGLMesh* mesh = new OGLMesh();
-	MshLoader::LoadMesh(name, *mesh);
-	mesh->SetPrimitiveType(GeometryPrimitive::Triangles);
+	LoadMeshWithLods(name, *mesh);
 	mesh->UploadToGPU();
 	return mesh;
 }
 
+Mesh* GameTechRenderer::LoadMeshAsync(const std::string& name, AssetLoader& loader, MeshReader read) {
+	OGLMesh* mesh = new OGLMesh();
+	if (!read) {
+		read = [](const std::string& name, Mesh& mesh) { LoadMeshWithLods(name, mesh); };
+	}
+	loader.load(name,
+		[name, mesh, read]() { read(name, *mesh); },
+		[mesh]() { mesh->UploadToGPU(); }
+	);
+	return mesh;
+}
+
+UniqueMesh GameTechRenderer::CreateSkinnedMesh(const Mesh& bindMesh) {
+	auto mesh = std::make_unique<OGLMesh>();
+	mesh->SetPrimitiveType(bindMesh.GetPrimitiveType());
+	mesh->SetVertexPositions(bindMesh.GetPositionData());
+	mesh->SetVertexTextureCoords(bindMesh.GetTextureCoordData());
+	mesh->SetVertexColours(bindMesh.GetColourData());
+	mesh->SetVertexNormals(bindMesh.GetNormalData());
+	mesh->SetVertexTangents(bindMesh.GetTangentData());
+	mesh->SetVertexIndices(bindMesh.GetIndexData());
+	mesh->SetSubMeshes(bindMesh.GetSubMeshes());
+	mesh->SetSubMeshNames(bindMesh.GetSubMeshNames());
+	mesh->SetLods(bindMesh.GetLods());
+	mesh->UploadToGPU(this);
+	return mesh;
+}
+
 void GameTechRenderer::NewRenderLines() {
 	if (!Debug::getLinesEnabled()) {
 		return;
 	}
-	const std::vector<Debug::DebugLineEntry>& lines = Debug::GetDebugLines();
+	std::span<const Debug::DebugLineEntry> lines = Debug::GetDebugLines();
 	if (lines.empty()) {
 		return;
 	}
@@ -327,30 +441,24 @@ void GameTechRenderer::NewRenderLines() {
 	Matrix4 viewProj  = projMatrix * viewMatrix;
 
 	UseShader(*debugShader);
-	int matSlot = glGetUniformLocation(debugShader->GetProgramID(), "viewProjMatrix");
-	GLuint texSlot = glGetUniformLocation(debugShader->GetProgramID(), "useTexture");
+	int matSlot = debugShader->GetUniformLocation("viewProjMatrix");
+	GLuint texSlot = debugShader->GetUniformLocation("useTexture");
 	glUniform1i(texSlot, 0);
 
 	glUniformMatrix4fv(matSlot, 1, false, (float*)viewProj.array);
 
-	debugLineData.clear();
-
-	size_t frameLineCount = lines.size() * 2;
-
-	SetDebugLineBufferSizes(frameLineCount);
-
-	glBindBuffer(GL_ARRAY_BUFFER, lineVertVBO);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, lines.size() * sizeof(Debug::DebugLineEntry), lines.data());
-
+	OGLStreamBuffer::Allocation space = streamBuffer.Allocate(lines.size_bytes());
+	memcpy(space.data, lines.data(), lines.size_bytes());
 
 	glBindVertexArray(lineVAO);
-	glDrawArrays(GL_LINES, 0, (GLsizei)frameLineCount);
+	glBindVertexBuffer(0, space.buffer, space.offset, sizeof(Debug::DebugLineEntry) / 2);
+	glDrawArrays(GL_LINES, 0, (GLsizei)lines.size() * 2);
 	glBindVertexArray(0);
 }
 
 void GameTechRenderer::NewRenderText() {
-	const std::vector<Debug::DebugStringEntry>& strings = Debug::GetDebugStrings();
-	if (strings.empty()) {
+	std::span<const SimpleFont::InterleavedTextVertex> vertices = Debug::GetDebugTextVertices();
+	if (vertices.empty()) {
 		return;
 	}
 
@@ -369,36 +477,19 @@ void GameTechRenderer::NewRenderText() {
 
 	Matrix4 proj = Matrix::Orthographic(0.0f, 100.0f, 100.0f, 0.0f, -1.0f, 1.0f);
 
-	int matSlot = glGetUniformLocation(debugShader->GetProgramID(), "viewProjMatrix");
+	int matSlot = debugShader->GetUniformLocation("viewProjMatrix");
 	glUniformMatrix4fv(matSlot, 1, false, (float*)proj.array);
 
-	GLuint texSlot = glGetUniformLocation(debugShader->GetProgramID(), "useTexture");
+	GLuint texSlot = debugShader->GetUniformLocation("useTexture");
 	glUniform1i(texSlot, 1);
 
-	debugTextPos.clear();
-	debugTextColours.clear();
-	debugTextUVs.clear();
-
-	int frameVertCount = 0;
-	for (const auto& s : strings) {
-		frameVertCount += Debug::GetDebugFont()->GetVertexCountForString(s.data);
-	}
-	SetDebugStringBufferSizes(frameVertCount);
-
-	for (const auto& s : strings) {
-		float size = 20.0f;
-		Debug::GetDebugFont()->BuildVerticesForString(s.data, s.position, s.colour, size, debugTextPos, debugTextUVs, debugTextColours);
-	}
-
-	glBindBuffer(GL_ARRAY_BUFFER, textVertVBO);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, frameVertCount * sizeof(Vector3), debugTextPos.data());
-	glBindBuffer(GL_ARRAY_BUFFER, textColourVBO);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, frameVertCount * sizeof(Vector4), debugTextColours.data());
-	glBindBuffer(GL_ARRAY_BUFFER, textTexVBO);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, frameVertCount * sizeof(Vector2), debugTextUVs.data());
+	//Debug::Print has already built the vertices, so they only need copying over
+	OGLStreamBuffer::Allocation space = streamBuffer.Allocate(vertices.size_bytes());
+	memcpy(space.data, vertices.data(), vertices.size_bytes());
 
 	glBindVertexArray(textVAO);
-	glDrawArrays(GL_TRIANGLES, 0, frameVertCount);
+	glBindVertexBuffer(0, space.buffer, space.offset, sizeof(SimpleFont::InterleavedTextVertex));
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
 	glBindVertexArray(0);
 }
 
@@ -411,16 +502,16 @@ void GameTechRenderer::NewRenderTextures() {
 
 	Matrix4 proj = Matrix::Orthographic(0.0f, 100.0f, 100.0f, 0.0f, -1.0f, 1.0f);
 
-	int matSlot = glGetUniformLocation(debugShader->GetProgramID(), "viewProjMatrix");
+	int matSlot = debugShader->GetUniformLocation("viewProjMatrix");
 	glUniformMatrix4fv(matSlot, 1, false, (float*)proj.array);
 
-	GLuint texSlot = glGetUniformLocation(debugShader->GetProgramID(), "useTexture");
+	GLuint texSlot = debugShader->GetUniformLocation("useTexture");
 	glUniform1i(texSlot, 2);
 
-	GLuint useColourSlot = glGetUniformLocation(debugShader->GetProgramID(), "useColour");
+	GLuint useColourSlot = debugShader->GetUniformLocation("useColour");
 	glUniform1i(useColourSlot, 1);
 
-	GLuint colourSlot = glGetUniformLocation(debugShader->GetProgramID(), "texColour");
+	GLuint colourSlot = debugShader->GetUniformLocation("texColour");
 
 	BindMesh(*debugTexMesh);
 
@@ -453,73 +544,64 @@ Texture* GameTechRenderer::LoadTexture(const std::string& name) {
 	return OGLTexture::TextureFromFile(name).release();
 }
 
+Texture* GameTechRenderer::LoadTextureAsync(const std::string& name, AssetLoader& loader) {
+	char white[4] = { (char)255, (char)255, (char)255, (char)255 };
+	OGLTexture* texture = OGLTexture::TextureFromData(white, 1, 1, 4).release();
+
+	// Shared between the two halves, and freed with them even if the load is cancelled
+	struct Image {
+		char*		data		= nullptr;
+		uint32_t	width		= 0;
+		uint32_t	height		= 0;
+		uint32_t	channels	= 0;
+		int			flags		= 0;
+		~Image() {
+			TextureLoader::DeleteTextureData(data, flags);
+		}
+	};
+	auto image = std::make_shared<Image>();
+	loader.load(name,
+		[name, image]() {
+			if (!TextureLoader::LoadTexture(name, image->data, image->width, image->height, image->channels, image->flags)) {
+				throw std::runtime_error("Couldn't read texture file");
+			}
+		},
+		[texture, image]() { texture->SetLoadedData(image->data, image->width, image->height, image->channels, image->flags); }
+	);
+	return texture;
+}
+
 Shader* GameTechRenderer::LoadShader(const std::string& vertex, const std::string& fragment) {
 	return new OGLShader(vertex, fragment);
 }
 
-void GameTechRenderer::SetDebugStringBufferSizes(size_t newVertCount) {
-	if (newVertCount > textCount) {
-		textCount = newVertCount;
-
-		glBindBuffer(GL_ARRAY_BUFFER, textVertVBO);
-		glBufferData(GL_ARRAY_BUFFER, textCount * sizeof(Vector3), nullptr, GL_DYNAMIC_DRAW);
-
-		glBindBuffer(GL_ARRAY_BUFFER, textColourVBO);
-		glBufferData(GL_ARRAY_BUFFER, textCount * sizeof(Vector4), nullptr, GL_DYNAMIC_DRAW);
-
-		glBindBuffer(GL_ARRAY_BUFFER, textTexVBO);
-		glBufferData(GL_ARRAY_BUFFER, textCount * sizeof(Vector2), nullptr, GL_DYNAMIC_DRAW);
-
-		debugTextPos.reserve(textCount);
-		debugTextColours.reserve(textCount);
-		debugTextUVs.reserve(textCount);
-
-		glBindVertexArray(textVAO);
-
-		glVertexAttribFormat(0, 3, GL_FLOAT, false, 0);
-		glVertexAttribBinding(0, 0);
-		glBindVertexBuffer(0, textVertVBO, 0, sizeof(Vector3));
-
-		glVertexAttribFormat(1, 4, GL_FLOAT, false, 0);
-		glVertexAttribBinding(1, 1);
-		glBindVertexBuffer(1, textColourVBO, 0, sizeof(Vector4));
-
-		glVertexAttribFormat(2, 2, GL_FLOAT, false, 0);
-		glVertexAttribBinding(2, 2);
-		glBindVertexBuffer(2, textTexVBO, 0, sizeof(Vector2));
-
-		glEnableVertexAttribArray(0);
-		glEnableVertexAttribArray(1);
-		glEnableVertexAttribArray(2);
-
-		glBindVertexArray(0);
-	}
-}
+void GameTechRenderer::SetDebugVertexFormats() {
+	//Both read from one buffer binding, which is pointed at each frame's vertices as they're drawn
+	glBindVertexArray(lineVAO);
 
-void GameTechRenderer::SetDebugLineBufferSizes(size_t newVertCount) {
-	if (newVertCount > lineCount) {
-		lineCount = newVertCount;
+	glVertexAttribFormat(0, 3, GL_FLOAT, false, offsetof(Debug::DebugLineEntry, start));
+	glVertexAttribBinding(0, 0);
 
-		glBindBuffer(GL_ARRAY_BUFFER, lineVertVBO);
-		glBufferData(GL_ARRAY_BUFFER, lineCount * sizeof(Debug::DebugLineEntry), nullptr, GL_DYNAMIC_DRAW);
+	glVertexAttribFormat(1, 4, GL_FLOAT, false, offsetof(Debug::DebugLineEntry, colourA));
+	glVertexAttribBinding(1, 0);
 
-		debugLineData.reserve(lineCount);
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
 
-		glBindVertexArray(lineVAO);
+	glBindVertexArray(textVAO);
 
-		int realStride = sizeof(Debug::DebugLineEntry) / 2;
+	glVertexAttribFormat(0, 2, GL_FLOAT, false, offsetof(SimpleFont::InterleavedTextVertex, pos));
+	glVertexAttribBinding(0, 0);
 
-		glVertexAttribFormat(0, 3, GL_FLOAT, false, offsetof(Debug::DebugLineEntry, start));
-		glVertexAttribBinding(0, 0);
-		glBindVertexBuffer(0, lineVertVBO, 0, realStride);
+	glVertexAttribFormat(1, 4, GL_FLOAT, false, offsetof(SimpleFont::InterleavedTextVertex, colour));
+	glVertexAttribBinding(1, 0);
 
-		glVertexAttribFormat(1, 4, GL_FLOAT, false, offsetof(Debug::DebugLineEntry, colourA));
-		glVertexAttribBinding(1, 0);
-		glBindVertexBuffer(1, lineVertVBO, sizeof(Vector4), realStride);
+	glVertexAttribFormat(2, 2, GL_FLOAT, false, offsetof(SimpleFont::InterleavedTextVertex, texCoord));
+	glVertexAttribBinding(2, 0);
 
-		glEnableVertexAttribArray(0);
-		glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
 
-		glBindVertexArray(0);
-	}
+	glBindVertexArray(0);
 }
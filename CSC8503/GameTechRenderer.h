@@ -3,8 +3,14 @@
 #include "OGLShader.h"
 #include "OGLTexture.h"
 #include "OGLMesh.h"
+#include "OGLStreamBuffer.h"
 
 #include "GameWorld.h"
+#include "RenderCulling.h"
+#include "RenderQueue.h"
+#include "InstanceBatcher.h"
+#include "LodSelector.h"
+#include "AssetLoader.h"
 
 namespace NCL {
 	namespace CSC8503 {
@@ -19,6 +25,58 @@ namespace NCL {
 			Texture*	LoadTexture(const std::string& name);
 			Shader*		LoadShader(const std::string& vertex, const std::string& fragment);
 
+			// Fills a mesh from a file on a loader thread
+			using MeshReader = std::function<void(const std::string& name, Mesh& mesh)>;
+
+			// Return straight away, with the file read on one of loader's threads
+			// The mesh isn't drawn until it's uploaded, and the texture is plain white until then
+			// Meshes are read with LoadMeshWithLods unless given a reader
+			Mesh*		LoadMeshAsync(const std::string& name, AssetLoader& loader, MeshReader read = {});
+			Texture*	LoadTextureAsync(const std::string& name, AssetLoader& loader);
+			// A copy of a loaded rigged mesh for one skinned object to draw, without its skinning data
+			UniqueMesh	CreateSkinnedMesh(const Mesh& bindMesh);
+
+			void Update(float dt) override {
+				frameTime = dt;
+			}
+
+			const RenderCuller::View& GetCameraView() const {
+				return views[CameraView];
+			}
+			const RenderCuller::View& GetShadowView() const {
+				return views[ShadowView];
+			}
+			const RenderCuller& GetCuller() const {
+				return culler;
+			}
+			// How long the last frame's culling took
+			float GetCullTime() const {
+				return cullTime;
+			}
+			// How long the last frame took to build, sort and batch its render queue
+			float GetSortTime() const {
+				return sortTime;
+			}
+			// Batches and binds from the last frame
+			const InstanceBatcher& GetBatcher() const {
+				return batcher;
+			}
+			// Objects skinned on the CPU in the last frame, and how long it took
+			size_t GetSkinnedCount() const {
+				return skinnedObjects.size();
+			}
+			float GetSkinTime() const {
+				return skinTime;
+			}
+			// Levels picked and triangles drawn in the last frame
+			const LodSelector& GetLodSelector() const {
+				return lodSelector;
+			}
+			// Holds every frame's instances, debug lines and text
+			const OGLStreamBuffer& GetStreamBuffer() const {
+				return streamBuffer;
+			}
+
 		protected:
 			void NewRenderLines();
 			void NewRenderText();
@@ -30,18 +88,45 @@ namespace NCL {
 
 			GameWorld&	gameWorld;
 
+			OGLStreamBuffer	streamBuffer;
+
 			void BuildObjectList();
+			void SkinObjects();
+			void SelectLods();
 			void SortObjectList();
 			void RenderShadowMap();
 			void RenderCamera(); 
 			void RenderSkybox();
+			// Draws every submesh of the bound mesh, at the given LOD
+			void DrawSubMeshes(const Mesh& mesh, uint32_t lod, uint32_t instanceCount = 1);
+			void UploadInstances();
 
 			void LoadSkybox();
 
-			void SetDebugStringBufferSizes(size_t newVertCount);
-			void SetDebugLineBufferSizes(size_t newVertCount);
+			void SetDebugVertexFormats();
+
+			enum ViewIndex {
+				CameraView,
+				ShadowView,
+				ViewCount
+			};
+			RenderCuller		culler;
+			RenderCuller::View	views[ViewCount];
+			float				cullTime = 0.0f;
+
+			std::vector<RenderObject*>	skinnedObjects;
+			float				skinTime = 0.0f;
+
+			LodSelector			lodSelector;
+			float				frameTime = 0.0f;
 
-			vector<const RenderObject*> activeObjects;
+			RenderQueue			renderQueue;
+			InstanceBatcher		batcher;
+			float				sortTime = 0.0f;
+
+			// Storage buffer binding of instances.glslh
+			static const constexpr GLuint InstanceBinding = 0;
+			GLint				storageAlignment;
 
 			OGLShader*  debugShader;
 			OGLShader*  skyboxShader;
@@ -53,28 +138,16 @@ namespace NCL {
 			OGLShader*	shadowShader;
 			GLuint		shadowTex;
 			GLuint		shadowFBO;
+			Matrix4     shadowViewProj;
 			Matrix4     shadowMatrix;
 
 			Vector4		lightColour;
 			float		lightRadius;
 			Vector3		lightPosition;
 
-			//Debug data storage things
-			vector<Vector3> debugLineData;
-
-			vector<Vector3> debugTextPos;
-			vector<Vector4> debugTextColours;
-			vector<Vector2> debugTextUVs;
-
+			//Debug vertices are streamed in from the stream buffer each frame
 			GLuint lineVAO;
-			GLuint lineVertVBO;
-			size_t lineCount;
-
 			GLuint textVAO;
-			GLuint textVertVBO;
-			GLuint textColourVBO;
-			GLuint textTexVBO;
-			size_t textCount;
 		};
 	}
 }
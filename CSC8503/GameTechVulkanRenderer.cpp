@@ -5,6 +5,7 @@
 #include "Camera.h"
 #include "VulkanUtils.h"
 #include "MshLoader.h"
+#include "Assets.h"
 
 using namespace NCL;
 using namespace Rendering;
@@ -27,6 +28,7 @@ GameTechVulkanRenderer::GameTechVulkanRenderer(GameWorld& world) :/* VulkanRende
 	vkInit.majorVersion = 1;
 	vkInit.minorVersion = 3;
 	vkInit.autoBeginDynamicRendering = false;
+	vkInit.pipelineCacheFile = Assets::ASSETROOT + "Cache/pipelines.vkcache";
 
 	/*
 	
@@ -45,7 +47,10 @@ GameTechVulkanRenderer::GameTechVulkanRenderer(GameWorld& world) :/* VulkanRende
 }
 
 GameTechVulkanRenderer::~GameTechVulkanRenderer() {
-
+	// renderer is never deleted, as this class's own Vulkan objects need its device until after
+	// this body has run, so the pipeline cache is saved here rather than by its destructor
+	renderer->GetDevice().waitIdle();
+	renderer->SavePipelineCache();
 }
 
 void	GameTechVulkanRenderer::InitStructures() {
@@ -120,7 +125,7 @@ void	GameTechVulkanRenderer::InitStructures() {
 			.WithColourAttachment(frameState.colourFormat)
 			.WithDepthAttachment(frameState.depthFormat, vk::CompareOp::eAlways, true, false)
 			.WithDescriptorSetLayout(0, *globalDataLayout) //Set 0
-			.Build("CubeMapRenderer Skybox Pipeline");
+			.Build("CubeMapRenderer Skybox Pipeline", renderer->GetPipelineCache());
 	}
 
 	{//Setting up all the data we need for shadow maps!
@@ -200,7 +205,7 @@ void GameTechVulkanRenderer::BuildScenePipelines(VulkanMesh* m) {
 		.WithDescriptorSetLayout(0, *globalDataLayout)
 		.WithDescriptorSetLayout(1, *objectTextxureLayout) //Set 1
 		//.WithPushConstant(vk::ShaderStageFlagBits::eVertex, 0, sizeof(Matrix4))
-		.Build("Main Scene Pipeline");
+		.Build("Main Scene Pipeline", renderer->GetPipelineCache());
 
 	shadowPipeline = PipelineBuilder(renderer->GetDevice())
 		.WithVertexInputState(m->GetVertexInputState())
@@ -211,7 +216,7 @@ void GameTechVulkanRenderer::BuildScenePipelines(VulkanMesh* m) {
 		.WithDescriptorSetLayout(1, *objectTextxureLayout) //Set 1
 		.WithDepthAttachment(shadowMap->GetFormat(), vk::CompareOp::eLessOrEqual, true, true)
 		.WithRaster(vk::CullModeFlagBits::eFront)
-		.Build("Shadow Map Pipeline");
+		.Build("Shadow Map Pipeline", renderer->GetPipelineCache());
 }
 
 void GameTechVulkanRenderer::BuildDebugPipelines() {
@@ -264,7 +269,7 @@ void GameTechVulkanRenderer::BuildDebugPipelines() {
 		.WithDepthAttachment(frameState.depthFormat)
 		.WithDescriptorSetLayout(0, *globalDataLayout)		//Set 0
 		.WithDescriptorSetLayout(1, *objectTextxureLayout) //Set 1
-		.Build("Debug Line Pipeline");
+		.Build("Debug Line Pipeline", renderer->GetPipelineCache());
 
 	debugTextPipeline = PipelineBuilder(renderer->GetDevice())
 		.WithVertexInputState(textVertexState)
@@ -275,7 +280,7 @@ void GameTechVulkanRenderer::BuildDebugPipelines() {
 		.WithDescriptorSetLayout(0, *globalDataLayout)		//Set 0
 		.WithDescriptorSetLayout(1, *objectTextxureLayout) //Set 1
 		//.WithPushConstant(vk::ShaderStageFlagBits::eFragment, 0, sizeof(int)) //TexID to use
-		.Build("Debug Text Pipeline");
+		.Build("Debug Text Pipeline", renderer->GetPipelineCache());
 }
 
 void GameTechVulkanRenderer::RenderFrame() {
@@ -406,15 +411,10 @@ void GameTechVulkanRenderer::UpdateObjectList() {
 }
 
 void GameTechVulkanRenderer::UpdateDebugData() {
-	const std::vector<Debug::DebugStringEntry>& strings = Debug::GetDebugStrings();
-	const std::vector<Debug::DebugLineEntry>& lines		= Debug::GetDebugLines();
-
-	currentFrame->textVertCount = 0;
-	currentFrame->lineVertCount = 0;
+	std::span<const SimpleFont::InterleavedTextVertex> textVerts	= Debug::GetDebugTextVertices();
+	std::span<const Debug::DebugLineEntry> lines					= Debug::GetDebugLines();
 
-	for (const auto& s : strings) {
-		currentFrame->textVertCount += Debug::GetDebugFont()->GetVertexCountForString(s.data);
-	}
+	currentFrame->textVertCount = (int)textVerts.size();
 	currentFrame->lineVertCount = (int)lines.size() * 2;
 
 	currentFrame->lineVertSize = currentFrame->lineVertCount * lineStride;
@@ -425,18 +425,9 @@ void GameTechVulkanRenderer::UpdateDebugData() {
 	currentFrame->WriteData((void*)lines.data(), (size_t)currentFrame->lineVertCount * lineStride);
 
 	currentFrame->debugTextOffset = currentFrame->bytesWritten;
-	std::vector< NCL::Rendering::SimpleFont::InterleavedTextVertex> verts;
-
-	for (const auto& s : strings) {
-		float size = 20.0f;
-		Debug::GetDebugFont()->BuildInterleavedVerticesForString(s.data, s.position, s.colour, size, verts);
-		//can now copy to GPU visible mem
-		size_t count = verts.size() * textStride;
-		memcpy(currentFrame->data, verts.data(), count);
-		currentFrame->data += count;
-		currentFrame->bytesWritten += count;
-		verts.clear();
-	}
+
+	//Debug::Print has already built the vertices, can now copy to GPU visible mem
+	currentFrame->WriteData((void*)textVerts.data(), (size_t)currentFrame->textVertCount * textStride);
 }
 
 void GameTechVulkanRenderer::RenderSceneObjects(VulkanPipeline& pipe, vk::CommandBuffer cmds) {
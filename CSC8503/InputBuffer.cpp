@@ -0,0 +1,156 @@
+#include "InputBuffer.h"
+
+namespace NCL::CSC8503 {
+	using InputEvent = NetworkProfiler::InputEvent;
+
+	InputBuffer::InputBuffer(NetworkProfiler* profiler, int peer) : profiler(profiler), peer(peer) {
+	}
+
+	void InputBuffer::insert(const ClientPacket& packet) {
+		if (packet.index < 0 || packet.index > MaxIndex) {
+			return;
+		}
+		Entry& newest = entries[packet.index & (Capacity - 1)];
+		if (newest.index == packet.index && newest.packetArrived) {
+			record(InputEvent::Duplicate);
+			return;
+		}
+		// Oldest first, so the first packet received starts playback from its oldest input
+		for (int i = ClientPacket::RedundantInputs - 1; i >= 0; i--) {
+			int index = packet.index - i;
+			if (index >= 0) {
+				insert(index, packet.inputs[i]);
+			}
+		}
+		if (newest.index == packet.index) {
+			newest.packetArrived = true;
+		}
+		float bufferedTime = getBufferedTime();
+		if (bufferedTime > MaxTime) {
+			skipTime(bufferedTime - TargetTime);
+		}
+	}
+
+	void InputBuffer::insert(int index, const PlayerInput& input) {
+		if (nextIndex < 0) {
+			nextIndex = index;
+		}
+		Entry& entry = entries[index & (Capacity - 1)];
+		if (entry.index == index) {
+			// Whole duplicate packets are caught before here, so this is a repeat from a later packet
+			// Or the packet's own newest input, when reordering let a later packet's repeat arrive first
+			record(InputEvent::Redundant);
+			return;
+		}
+		if (index < nextIndex) {
+			record(InputEvent::Late);
+			return;
+		}
+		// Too far ahead to fit, the client must have raced ahead
+		if (index - nextIndex >= Capacity) {
+			skipTo(index - Capacity + 1);
+		}
+		entry.index = index;
+		entry.input = input;
+		entry.input.dt = std::clamp(input.dt, MinInputTime, MaxInputTime);
+		entry.packetArrived = false;
+		newestIndex = std::max(newestIndex, index);
+		record(InputEvent::Received);
+	}
+
+	void InputBuffer::skipTo(int index) {
+		// Nothing past newestIndex has arrived, so a long jump counts those lost all at once
+		int stored = std::min(index, newestIndex + 1);
+		for (; nextIndex < stored; nextIndex++) {
+			const Entry& entry = entries[nextIndex & (Capacity - 1)];
+			if (entry.index == nextIndex) {
+				pendingJump |= entry.input.jump;
+				lastInput = entry.input;
+				record(InputEvent::Skipped);
+			} else {
+				record(InputEvent::Lost);
+			}
+		}
+		if (nextIndex < index) {
+			record(InputEvent::Lost, (uint64_t)(index - nextIndex));
+			nextIndex = index;
+		}
+	}
+
+	void InputBuffer::skipTime(float time) {
+		while (time > 0 && nextIndex <= newestIndex) {
+			time -= getInputTime(nextIndex);
+			skipTo(nextIndex + 1);
+		}
+	}
+
+	float InputBuffer::getInputTime(int index) const {
+		const Entry& entry = entries[index & (Capacity - 1)];
+		return std::max(entry.index == index ? entry.input.dt : lastInput.dt, MinInputTime);
+	}
+
+	float InputBuffer::getBufferedTime() const {
+		float time = 0;
+		for (int i = std::max(nextIndex, 0); i <= newestIndex; i++) {
+			time += getInputTime(i);
+		}
+		return time;
+	}
+
+	bool InputBuffer::consume(float dt, PlayerInput& input, int& index) {
+		float bufferedTime = getBufferedTime();
+		if (!started) {
+			if (bufferedTime < TargetTime) {
+				return false;
+			}
+			started = true;
+		}
+
+		minTime = std::min(minTime, bufferedTime);
+		if (++framesSinceShrink == ShrinkInterval) {
+			if (minTime > TargetTime) {
+				skipTo(nextIndex + 1);
+			}
+			minTime = MaxTime;
+			framesSinceShrink = 0;
+		}
+
+		// Play inputs until they cover the time that's passed, the last one carries on into the next frame
+		unplayedTime += dt;
+		bool played = false;
+		while (unplayedTime > 0) {
+			if (getDepth() == 0) {
+				record(InputEvent::Starved);
+				minTime = 0;
+				// The player carried on with its last input, so this time has been played already
+				unplayedTime = 0;
+				break;
+			}
+			const Entry& entry = entries[nextIndex & (Capacity - 1)];
+			if (entry.index == nextIndex) {
+				lastInput = entry.input;
+			} else {
+				// Something newer has arrived, so this one had its chance
+				record(InputEvent::Lost);
+				lastInput.jump = false;
+			}
+			pendingJump |= lastInput.jump;
+			unplayedTime -= getInputTime(nextIndex);
+			index = nextIndex++;
+			played = true;
+		}
+		if (!played) {
+			return false;
+		}
+		input = lastInput;
+		input.jump = pendingJump;
+		pendingJump = false;
+		return true;
+	}
+
+	void InputBuffer::record(InputEvent event, uint64_t count) {
+		if (profiler) {
+			profiler->recordInput(peer, event, count);
+		}
+	}
+}
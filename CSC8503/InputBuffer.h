@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <climits>
+
+#include "NetworkPlayer.h"
+#include "NetworkProfiler.h"
+
+namespace NCL::CSC8503 {
+	// Server side jitter buffer for one client's inputs
+	// Inputs arrive in bursts and out of order, but are played back in the order
+	// they were sent, each for as long as the client held it. Client and server
+	// frame rates differ, so a server frame can play several inputs or none.
+	// A couple are held back before playing, so a late packet has time to
+	// arrive before it's needed
+	class InputBuffer {
+	public:
+		// Must be a power of 2, and much bigger than MaxTime's worth of inputs at
+		// the usual frame rates so old entries stay around to recognise duplicates
+		static const constexpr int Capacity = 64;
+		// Input time buffered before playback starts, all of it latency
+		// Depths are in time rather than inputs, as a client at 144fps sends
+		// more than twice as many inputs to cover the same time as one at 60
+		static const constexpr float TargetTime = 2.0f / 60.0f;
+		// More than this buffered means the client is running ahead of us,
+		// so inputs are skipped to get back to TargetTime
+		static const constexpr float MaxTime = 8.0f / 60.0f;
+		// A late packet makes the buffer wait, adding latency for good
+		// If it's stayed deeper than it needs to for this many frames, an input is skipped to win it back
+		static const constexpr int ShrinkInterval = 60;
+		// Bounds on how long a client can say it held an input for. The client caps
+		// its frame time at 0.1s, and a tiny time would play the whole buffer at once
+		static const constexpr float MinInputTime = 0.001f;
+		static const constexpr float MaxInputTime = 0.1f;
+		// Packets indexed past this are dropped, as counting on from them would overflow
+		// A client sending an input every frame at 144fps takes months to get here
+		static const constexpr int MaxIndex = INT_MAX - Capacity;
+
+		// Events are recorded against peer if there's a profiler
+		InputBuffer(NetworkProfiler* profiler = nullptr, int peer = -1);
+
+		void insert(const ClientPacket& packet);
+
+		// The input to apply for a server frame of dt, and its index to acknowledge
+		// Returns false if there's nothing new to apply, and the player should carry on with its last input
+		// If an input never arrived, the previous one is repeated in its place
+		bool consume(float dt, PlayerInput& input, int& index);
+
+		// Inputs received but not yet played
+		int getDepth() const {
+			return nextIndex < 0 ? 0 : std::max(newestIndex - nextIndex + 1, 0);
+		}
+		// Client time covered by the inputs not yet played
+		float getBufferedTime() const;
+		// -1 if nothing has arrived yet
+		int getNewestIndex() const {
+			return newestIndex;
+		}
+	private:
+		struct Entry {
+			int index = -1;
+			PlayerInput input;
+			// The packet this was the newest input of has arrived
+			bool packetArrived = false;
+		};
+
+		void insert(int index, const PlayerInput& input);
+		// Drop everything before index unplayed
+		void skipTo(int index);
+		// Drop the oldest inputs unplayed until time's worth are gone
+		void skipTime(float time);
+		// Time an input will be played for, a lost one repeats the last input's
+		float getInputTime(int index) const;
+		void record(NetworkProfiler::InputEvent event, uint64_t count = 1);
+
+		std::array<Entry, Capacity> entries;
+		// Next input to play, -1 until the first arrives
+		int nextIndex = -1;
+		int newestIndex = -1;
+		// Playback waits for TargetDepth inputs before starting
+		bool started = false;
+		// Server time not yet covered by played inputs
+		// Goes negative while an input is held for longer than a server frame
+		float unplayedTime = 0;
+		// Shallowest the buffer has been over the last ShrinkInterval frames
+		float minTime = MaxTime;
+		int framesSinceShrink = 0;
+
+		// Repeated when an input doesn't arrive in time
+		PlayerInput lastInput;
+		// Jumps only last a frame, so one in a skipped input is kept for the next played
+		bool pendingJump = false;
+
+		NetworkProfiler* profiler;
+		int peer;
+	};
+}
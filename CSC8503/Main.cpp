@@ -16,6 +16,8 @@
 
 #include "TutorialGame.h"
 #include "NetworkedGame.h"
+#include "Benchmarks.h"
+#include "BotClients.h"
 #include "Cli.h"
 
 #include "PushdownMachine.h"
@@ -293,13 +295,16 @@ public:
 		this->name = name;
 	}
 
-	void ReceivePacket(GamePacket::Type type, GamePacket* payload, int source) {
+	void ReceivePacket(GamePacket::Type type, std::span<enet_uint8> packet, int source) {
 		if (type != GamePacket::Type::String_Message) {
 			return;
 		}
 
-		StringPacket* realPacket = (StringPacket*)payload;
-		std::cout << name << " received a message: " << realPacket->toString() << std::endl;
+		StringPacket* realPacket = GamePacket::View<StringPacket>(packet, sizeof(GamePacket) + 1);
+		if (!realPacket) {
+			return;
+		}
+		std::cout << name << " received a message: " << realPacket->toString(packet.size()) << std::endl;
 	}
 protected:
 	std::string name;
@@ -397,6 +402,16 @@ int main(int argc, char** argv) {
 		return 1;
 	}
 
+	if (!cli->getBenchmark().empty()) {
+		return Benchmarks::run(cli->getBenchmark());
+	}
+
+	// Bots are headless, so don't need a window
+	if (cli->getBotCount() > 0) {
+		BotClients bots(*cli);
+		return bots.run();
+	}
+
 	//testStateMachine();
 	//testBehaviourTree();
 	WindowInitialisation initInfo;
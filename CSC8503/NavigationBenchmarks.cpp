@@ -0,0 +1,399 @@
+#include "Benchmarks.h"
+
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "Assets.h"
+#include "Debug.h"
+#include "GameTimer.h"
+#include "HierarchicalNavigationGrid.h"
+#include "MazeGenerator.h"
+#include "NavigationGrid.h"
+#include "NavigationGridBinary.h"
+
+namespace NCL::CSC8503::Benchmarks {
+	namespace {
+		// How NavigationGrid used to store each cell
+		struct OldGridNode {
+			OldGridNode*	connected[4] = {};
+			int				costs[4] = {};
+			Vector3			position;
+			GridNode::Type	type = GridNode::Type::None;
+		};
+
+		// How NavigationGrid used to load, reading a char at a time and linking every cell to its neighbours
+		std::vector<OldGridNode> loadOldGrid(const std::string& path) {
+			std::ifstream infile(path);
+			int nodeSize, gridWidth, gridHeight;
+			infile >> nodeSize;
+			infile >> gridWidth;
+			infile >> gridHeight;
+			std::vector<OldGridNode> nodes((size_t)gridWidth * gridHeight);
+			for (int y = 0; y < gridHeight; ++y) {
+				for (int x = 0; x < gridWidth; ++x) {
+					OldGridNode& n = nodes[(gridWidth * y) + x];
+					char type = 0;
+					infile >> type;
+					n.type = (GridNode::Type)type;
+					n.position = Vector3((float)(x * nodeSize), 0, (float)(y * nodeSize));
+				}
+			}
+			for (int y = 0; y < gridHeight; ++y) {
+				for (int x = 0; x < gridWidth; ++x) {
+					OldGridNode& n = nodes[(gridWidth * y) + x];
+					if (y > 0) {
+						n.connected[0] = &nodes[(gridWidth * (y - 1)) + x];
+					}
+					if (y < gridHeight - 1) {
+						n.connected[1] = &nodes[(gridWidth * (y + 1)) + x];
+					}
+					if (x > 0) {
+						n.connected[2] = &nodes[(gridWidth * (y)) + (x - 1)];
+					}
+					if (x < gridWidth - 1) {
+						n.connected[3] = &nodes[(gridWidth * (y)) + (x + 1)];
+					}
+					for (int i = 0; i < 4; ++i) {
+						if (n.connected[i]) {
+							if (n.connected[i]->type == GridNode::Type::Wall) {
+								n.connected[i] = nullptr;
+							} else {
+								n.costs[i] = 1;
+							}
+						}
+					}
+				}
+			}
+			return nodes;
+		}
+
+		void writeTextGrid(const std::string& path, const NavigationGrid& grid) {
+			std::string text = std::to_string(grid.getNodeSize()) + "\n" + std::to_string(grid.getWidth()) + "\n"
+				+ std::to_string(grid.getHeight()) + "\n";
+			text.reserve(text.size() + (size_t)(grid.getWidth() + 1) * grid.getHeight());
+			for (int i = 0; i < grid.getNodeCount(); i++) {
+				text += (char)grid.getNode(i).type;
+				if (i % grid.getWidth() == grid.getWidth() - 1) {
+					text += '\n';
+				}
+			}
+			std::ofstream out(path, std::ios::binary);
+			out.write(text.data(), text.size());
+		}
+
+		template <typename T>
+		bool sameSpan(std::span<const T> a, std::span<const T> b) {
+			return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size_bytes()) == 0);
+		}
+
+		bool sameGrid(const NavigationGrid& a, const NavigationGrid& b) {
+			bool same = a.getWidth() == b.getWidth() && a.getHeight() == b.getHeight() && a.getNodeSize() == b.getNodeSize();
+			same &= sameSpan(a.getWalls(), b.getWalls());
+			same &= sameSpan(a.getCosts(), b.getCosts());
+			same &= sameSpan(a.getRegions(), b.getRegions());
+			same &= a.getMarkers().size() == b.getMarkers().size();
+			for (size_t i = 0; same && i < a.getMarkers().size(); i++) {
+				same &= a.getMarkers()[i].cell == b.getMarkers()[i].cell && a.getMarkers()[i].type == b.getMarkers()[i].type;
+			}
+			return same;
+		}
+
+		// Bytes a grid takes in memory, regions included
+		size_t gridBytes(const NavigationGrid& grid) {
+			return grid.getWalls().size_bytes() + grid.getCosts().size_bytes() + grid.getRegions().size_bytes()
+				+ grid.getMarkers().size_bytes();
+		}
+
+		// Reads every wall word, cost and region, so mapped grids pay for the pages they use
+		uint64_t touchGrid(const NavigationGrid& grid) {
+			uint64_t sum = 0;
+			for (uint64_t word : grid.getWalls()) sum += std::popcount(word);
+			for (uint8_t cost : grid.getCosts()) sum += cost;
+			for (uint32_t region : grid.getRegions()) sum += region;
+			return sum;
+		}
+
+		// Loads are in Assets::DATADIR, so point back out to the temp directory from there
+		std::string fromDataDir(const std::filesystem::path& path) {
+			return std::filesystem::relative(path, Assets::DATADIR).generic_string();
+		}
+
+		// Floor cells in the same region, so there's always a path between them
+		std::vector<std::pair<int, int>> pickQueries(const NavigationGrid& grid, int count, uint32_t seed) {
+			std::mt19937 random(seed);
+			std::uniform_int_distribution<int> cell(0, grid.getNodeCount() - 1);
+			auto floorCell = [&]() {
+				int i = cell(random);
+				while (grid.isWall(i)) {
+					i = cell(random);
+				}
+				return i;
+			};
+			std::vector<std::pair<int, int>> queries;
+			while ((int)queries.size() < count) {
+				int from = floorCell();
+				int to = floorCell();
+				if (grid.getRegion(from) == grid.getRegion(to)) {
+					queries.push_back({ from, to });
+				}
+			}
+			return queries;
+		}
+
+		// How NavigationGrid::FindPath used to search, with a map of seen cells, a set of closed ones
+		// and a priority queue that may hold stale entries, all allocated for each search
+		bool oldFindPath(const NavigationGrid& grid, int startNode, int endNode, NavigationPath& outPath) {
+			struct SearchNode {
+				int		parent;
+				int		node;
+				float	currentCost;
+				float	currentPlusHeuristic;
+
+				bool operator>(const SearchNode& other) const {
+					return currentPlusHeuristic > other.currentPlusHeuristic;
+				}
+			};
+			auto heuristic = [&](int node) {
+				return Vector::Length(grid.getPosition(node) - grid.getPosition(endNode));
+			};
+
+			std::map<int, SearchNode> seenNodes;
+			std::set<int> closedNodes;
+			std::priority_queue<SearchNode, std::vector<SearchNode>, std::greater<SearchNode>> openList;
+			auto pushIfBetter = [&](const SearchNode& node) {
+				auto existing = seenNodes.find(node.node);
+				if (existing != seenNodes.end() && existing->second.currentPlusHeuristic > node.currentPlusHeuristic) {
+					return;
+				}
+				openList.push(node);
+				seenNodes[node.node] = node;
+			};
+
+			pushIfBetter(SearchNode{ -1, startNode, 0, 0 });
+			while (!openList.empty()) {
+				SearchNode current = openList.top();
+				openList.pop();
+				if (closedNodes.find(current.node) != closedNodes.end()) {
+					continue;
+				}
+				if (current.node == endNode) {
+					outPath.PushWaypoint(grid.getPosition(endNode));
+					for (SearchNode node = current; node.parent >= 0; node = seenNodes.find(node.parent)->second) {
+						outPath.PushWaypoint(grid.getPosition(node.node));
+					}
+					outPath.PushWaypoint(grid.getPosition(startNode));
+					return true;
+				}
+				int neighbours[4];
+				grid.getNeighbours(current.node, neighbours);
+				for (int neighbour : neighbours) {
+					if (neighbour < 0 || closedNodes.find(neighbour) != closedNodes.end()) {
+						continue;
+					}
+					float g = current.currentCost + grid.getCost(neighbour);
+					pushIfBetter(SearchNode{ current.node, neighbour, g, g + heuristic(neighbour) });
+				}
+				closedNodes.insert(current.node);
+				seenNodes[current.node] = current;
+			}
+			return false;
+		}
+
+		// Sum of the costs of every cell a path steps onto, emptying it
+		uint64_t pathCost(const NavigationGrid& grid, NavigationPath& path) {
+			std::vector<Vector3> waypoints;
+			Vector3 waypoint;
+			while (path.PopWaypoint(waypoint)) {
+				waypoints.push_back(waypoint);
+			}
+			uint64_t cost = 0;
+			// Skipping the start, and the end position as it's in the same cell as the last waypoint
+			for (size_t i = 1; i + 1 < waypoints.size(); i++) {
+				cost += grid.getCost(grid.getCellAt(waypoints[i]));
+			}
+			return cost;
+		}
+	}
+
+	void navigationGrids() {
+		std::cout << std::fixed << std::setprecision(3);
+		std::filesystem::path scratch = std::filesystem::temp_directory_path() / "ncl_navigation_benchmark";
+		std::filesystem::path textPath		= scratch.string() + ".txt";
+		std::filesystem::path binaryPath	= scratch.string() + NavigationGridBinary::Extension;
+		std::filesystem::path noRegionsPath	= scratch.string() + "_noregions" + NavigationGridBinary::Extension;
+
+		auto compare = [&](const std::string& name, const std::string& textFile, double minSeconds) {
+			NavigationGrid text(textFile);
+			NavigationGridBinary::Save(binaryPath.string(), text);
+			NavigationGridBinary::Save(noRegionsPath.string(), text, false);
+
+			// Each load reads its grid back, a mapped grid hasn't touched its file until then
+			uint64_t sink = 0;
+			double oldTime = timeRepeated([&]() {
+				std::vector<OldGridNode> nodes = loadOldGrid(Assets::DATADIR + textFile);
+				for (const OldGridNode& node : nodes) sink += (int)node.type;
+			}, minSeconds);
+			double textTime = timeRepeated([&]() {
+				NavigationGrid grid(textFile);
+				sink += touchGrid(grid);
+			}, minSeconds);
+			double binaryTime = timeRepeated([&]() {
+				NavigationGrid grid(fromDataDir(binaryPath));
+				sink += touchGrid(grid);
+			}, minSeconds);
+			double noRegionsTime = timeRepeated([&]() {
+				NavigationGrid grid(fromDataDir(noRegionsPath));
+				sink += touchGrid(grid);
+			}, minSeconds);
+
+			NavigationGrid binary(fromDataDir(binaryPath));
+			NavigationGrid noRegions(fromDataDir(noRegionsPath));
+			bool same = sameGrid(text, binary) && sameGrid(text, noRegions);
+
+			size_t cells = (size_t)text.getNodeCount();
+			std::cout << name << ", " << text.getWidth() << "x" << text.getHeight() << ", " << text.getRegionCount() - 1 << " regions:\n";
+			std::cout << "  Old loader, char by char:  " << std::setw(10) << oldTime * 1000.0 << "ms, "
+				<< cells * sizeof(OldGridNode) / 1024 << "KB of nodes\n";
+			std::cout << "  Text, bitset and costs:    " << std::setw(10) << textTime * 1000.0 << "ms, "
+				<< gridBytes(text) / 1024 << "KB, " << (gridBytes(text) - text.getRegions().size_bytes()) / 1024 << "KB without regions\n";
+			std::cout << "  Binary, mapped:            " << std::setw(10) << binaryTime * 1000.0 << "ms, "
+				<< std::filesystem::file_size(binaryPath) / 1024 << "KB file\n";
+			std::cout << "  Binary, regions worked out:" << std::setw(10) << noRegionsTime * 1000.0 << "ms, "
+				<< std::filesystem::file_size(noRegionsPath) / 1024 << "KB file\n";
+			std::cout << "  " << (same ? "Same" : "DIFFERENT") << " grids from text and binary (" << sink % 2 << ")\n";
+		};
+
+		compare("maze.txt", "maze.txt", 0.1);
+
+		MazeGenerator::Settings settings;
+		GameTimer generateTimer;
+		NavigationGrid generated(MazeGenerator::Generate(settings));
+		generateTimer.Tick();
+		std::cout << "Generated a " << settings.width << "x" << settings.height << " maze in "
+			<< generateTimer.GetTimeDeltaSeconds() * 1000.0 << "ms\n";
+		// Text has no costs, so check the binary file keeps them
+		NavigationGridBinary::Save(binaryPath.string(), generated);
+		bool sameCosts = sameGrid(generated, NavigationGrid(fromDataDir(binaryPath)));
+		std::cout << "  " << generated.getRegionCount() - 1 << " regions, " << (sameCosts ? "same" : "DIFFERENT")
+			<< " costs and regions after saving as binary\n";
+		writeTextGrid(textPath.string(), generated);
+		compare("Generated maze", fromDataDir(textPath), 0.5);
+
+		std::filesystem::remove(textPath);
+		std::filesystem::remove(binaryPath);
+		std::filesystem::remove(noRegionsPath);
+	}
+
+	void hierarchicalPaths() {
+		std::cout << std::fixed << std::setprecision(3);
+		for (int size : { 512, 1024, 2048, 4096 }) {
+			MazeGenerator::Settings settings;
+			settings.width	= size;
+			settings.height	= size;
+			NavigationGrid flat(MazeGenerator::Generate(settings));
+
+			GridLayout layout = MazeGenerator::Generate(settings);
+			GameTimer buildTimer;
+			HierarchicalNavigationGrid hierarchical(std::move(layout));
+			buildTimer.Tick();
+
+			std::vector<std::pair<int, int>> queries = pickQueries(flat, 200, 1);
+			auto run = [&](const NavigationGrid& grid, uint64_t& totalCost, size_t& found) {
+				totalCost	= 0;
+				found		= 0;
+				// The first search on a thread sizes A*'s scratch arrays, which later searches reuse
+				NavigationPath warmUp;
+				grid.FindPath(grid.getPosition(queries[0].first), grid.getPosition(queries[0].second), warmUp);
+				GameTimer timer;
+				for (auto& [from, to] : queries) {
+					NavigationPath path;
+					if (grid.FindPath(grid.getPosition(from), grid.getPosition(to), path)) {
+						totalCost += pathCost(grid, path);
+						found++;
+					}
+					// FindPath draws a debug line each time, so age them out as a frame would
+					Debug::UpdateRenderables(1.0f);
+				}
+				timer.Tick();
+				return timer.GetTimeDeltaSeconds();
+			};
+			uint64_t flatCost, hierarchicalCost;
+			size_t flatFound, hierarchicalFound;
+			double flatTime			= run(flat, flatCost, flatFound);
+			double hierarchicalTime	= run(hierarchical, hierarchicalCost, hierarchicalFound);
+
+			std::cout << size << "x" << size << " maze, " << queries.size() << " random paths:\n";
+			std::cout << "  HPA* graph, " << hierarchical.getClusterSize() << "x" << hierarchical.getClusterSize() << " clusters: "
+				<< hierarchical.getEntranceCount() << " nodes, " << hierarchical.getEdgeCount() << " edges, "
+				<< hierarchical.getGraphBytes() / (1024 * 1024) << "MB, built in " << buildTimer.GetTimeDeltaSeconds() * 1000.0 << "ms\n";
+			std::cout << "  A*:   " << std::setw(12) << queries.size() / flatTime << " paths/s, "
+				<< flatFound << " found, average cost " << (double)flatCost / std::max<size_t>(flatFound, 1) << "\n";
+			std::cout << "  HPA*: " << std::setw(12) << queries.size() / hierarchicalTime << " paths/s, "
+				<< hierarchicalFound << " found, average cost " << (double)hierarchicalCost / std::max<size_t>(hierarchicalFound, 1)
+				<< ", " << std::showpos << ((double)hierarchicalCost / std::max<uint64_t>(flatCost, 1) - 1.0) * 100.0
+				<< std::noshowpos << "% against A*\n";
+		}
+	}
+
+	void pathSearches() {
+		std::cout << std::fixed << std::setprecision(3);
+
+		auto compare = [&](const std::string& name, const NavigationGrid& grid, int queryCount) {
+			std::vector<std::pair<int, int>> queries = pickQueries(grid, queryCount, 1);
+			uint64_t oldCost = 0;
+			uint64_t newCost = 0;
+			size_t oldFound = 0;
+			size_t newFound = 0;
+			// Long searches take a while with the old search, so time one pass rather than repeating
+			GameTimer oldTimer;
+			for (auto& [from, to] : queries) {
+				NavigationPath path;
+				if (oldFindPath(grid, from, to, path)) {
+					oldCost += pathCost(grid, path);
+					oldFound++;
+				}
+			}
+			oldTimer.Tick();
+			// The first search on a thread sizes its scratch arrays, which later searches reuse
+			NavigationPath warmUp;
+			grid.FindPath(grid.getPosition(queries[0].first), grid.getPosition(queries[0].second), warmUp);
+			GameTimer newTimer;
+			for (auto& [from, to] : queries) {
+				NavigationPath path;
+				if (grid.FindPath(grid.getPosition(from), grid.getPosition(to), path)) {
+					newCost += pathCost(grid, path);
+					newFound++;
+				}
+				// FindPath draws a debug line each time, so age them out as a frame would
+				Debug::UpdateRenderables(1.0f);
+			}
+			newTimer.Tick();
+
+			double oldTime = oldTimer.GetTimeDeltaSeconds();
+			double newTime = newTimer.GetTimeDeltaSeconds();
+			std::cout << name << ", " << grid.getWidth() << "x" << grid.getHeight() << ", " << queries.size() << " random paths:\n";
+			std::cout << "  Map, set and queue:  " << std::setw(12) << queries.size() / oldTime << " paths/s, "
+				<< oldFound << " found, average cost " << (double)oldCost / std::max<size_t>(oldFound, 1) << "\n";
+			std::cout << "  Scratch arrays:      " << std::setw(12) << queries.size() / newTime << " paths/s, "
+				<< newFound << " found, average cost " << (double)newCost / std::max<size_t>(newFound, 1)
+				<< ", " << oldTime / newTime << "x faster\n";
+		};
+
+		compare("maze.txt", NavigationGrid("maze.txt"), 2000);
+		for (int size : { 512, 2048 }) {
+			MazeGenerator::Settings settings;
+			settings.width	= size;
+			settings.height	= size;
+			compare("Generated maze", NavigationGrid(MazeGenerator::Generate(settings)), size >= 2048 ? 20 : 100);
+		}
+	}
+}
@@ -0,0 +1,700 @@
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "GameClient.h"
+#include "GameServer.h"
+#include "GameWorld.h"
+#include "InputBuffer.h"
+#include "NetworkBase.h"
+#include "NetworkObject.h"
+#include "NetworkProfiler.h"
+#include "NetworkedGame.h"
+#include "NetworkWorld.h"
+
+namespace NCL::CSC8503::Benchmarks {
+	namespace {
+		// Exposes dispatch without needing a real ENet host
+		class DispatchHarness : public NetworkBase {
+		public:
+			using NetworkBase::ProcessPackedPackets;
+		};
+
+		class CountingReceiver : public PacketReceiver {
+		public:
+			void ReceivePacket(GamePacket::Type type, std::span<enet_uint8> packet, int source) override {
+				count++;
+				bytes += packet.size();
+			}
+			size_t count = 0;
+			size_t bytes = 0;
+		};
+
+		// Tracks the newest snapshot and every event a client has seen, and whether the server has seen the client
+		class LossReceiver : public PacketReceiver {
+		public:
+			void ReceivePacket(GamePacket::Type type, std::span<enet_uint8> packet, int source) override {
+				switch (type) {
+				case GamePacket::Type::Full_State:
+					if (auto full = GamePacket::View<FullPacket>(packet)) {
+						newestSnapshot = std::max(newestSnapshot, full->fullState.stateID);
+					}
+					break;
+				case GamePacket::Type::Server_ClientConnect:
+					clientJoined = true;
+					break;
+				case GamePacket::Type::ObjectDestroy:
+					if (auto destroy = GamePacket::View<DestroyPacket>(packet)) {
+						events.push_back(destroy->id);
+					}
+					break;
+				default:
+					break;
+				}
+			}
+			bool clientJoined = false;
+			int newestSnapshot = -1;
+			std::vector<unsigned int> events;
+		};
+
+		// Exposes compression and dispatch without needing a real ENet host
+		class CompressionHarness : public NetworkBase {
+		public:
+			using NetworkBase::CompressPacket;
+			using NetworkBase::ProcessPacket;
+		};
+
+		// Decodes every player list it's given
+		class PlayerListReceiver : public PacketReceiver {
+		public:
+			void ReceivePacket(GamePacket::Type type, std::span<enet_uint8> packet, int source) override {
+				auto list = GamePacket::View<PlayerListPacket>(packet, PlayerListPacket::MinSize);
+				valid = list && list->read(states);
+			}
+			bool valid = false;
+			std::vector<PlayerState> states;
+		};
+
+		// PlayerListPacket as it was, a fixed size array sent whole
+		struct LegacyPlayerListPacket : public GamePacket {
+			char count;
+			PlayerState playerStates[MaxPlayers];
+		};
+
+		template <typename T>
+		void appendPacket(std::vector<enet_uint8>& buffer, const T& packet) {
+			auto start = buffer.size();
+			buffer.resize(start + packet.GetTotalSize());
+			memcpy(buffer.data() + start, &packet, packet.GetTotalSize());
+		}
+	}
+
+	void packetDispatch() {
+		DispatchHarness harness;
+		CountingReceiver world;
+		CountingReceiver game;
+		// Register a spread of types, so lookups aren't all hitting the same entry
+		harness.RegisterPacketHandler(GamePacket::Type::Delta_State, &world);
+		harness.RegisterPacketHandler(GamePacket::Type::Full_State, &world);
+		for (auto type : { GamePacket::Type::ObjectDestroy, GamePacket::Type::PlayerList, GamePacket::Type::ServerHello,
+				GamePacket::Type::Reset, GamePacket::Type::GameEnd, GamePacket::Type::Full_State }) {
+			harness.RegisterPacketHandler(type, &game);
+		}
+
+		// The old multimap, for comparison
+		std::multimap<GamePacket::Type, PacketReceiver*> legacyHandlers = {
+			{ GamePacket::Type::Delta_State, &world },
+			{ GamePacket::Type::Full_State, &world },
+			{ GamePacket::Type::ObjectDestroy, &game },
+			{ GamePacket::Type::PlayerList, &game },
+			{ GamePacket::Type::ServerHello, &game },
+			{ GamePacket::Type::Reset, &game },
+			{ GamePacket::Type::GameEnd, &game },
+			{ GamePacket::Type::Full_State, &game },
+		};
+
+		// A typical tick: mostly deltas, some fulls, the odd event
+		const int PacketCount = 4096;
+		std::vector<enet_uint8> buffer;
+		std::mt19937 rng(1234);
+		for (int i = 0; i < PacketCount; i++) {
+			int roll = rng() % 100;
+			if (roll < 75) {
+				DeltaPacket packet;
+				packet.objectID = i;
+				appendPacket(buffer, packet);
+			} else if (roll < 95) {
+				FullPacket packet;
+				packet.objectID = i;
+				appendPacket(buffer, packet);
+			} else {
+				appendPacket(buffer, GamePacket(GamePacket::Type::Reset));
+			}
+		}
+
+		double tableTime = timeRepeated([&]() {
+			harness.ProcessPackedPackets(std::span(buffer));
+		});
+
+		double legacyTime = timeRepeated([&]() {
+			std::span<enet_uint8> remaining(buffer);
+			while (!remaining.empty()) {
+				GamePacket* packet = reinterpret_cast<GamePacket*>(remaining.data());
+				auto size = packet->GetTotalSize();
+				auto range = legacyHandlers.equal_range(packet->type);
+				for (auto i = range.first; i != range.second; i++) {
+					i->second->ReceivePacket(packet->type, remaining.first(size), -1);
+				}
+				remaining = remaining.subspan(size);
+			}
+		});
+
+		std::cout << PacketCount << " packets, " << buffer.size() << " bytes per buffer\n";
+		std::cout << "Flat table: " << (PacketCount / tableTime) / 1e6 << "M packets/s\n";
+		std::cout << "Multimap:   " << (PacketCount / legacyTime) / 1e6 << "M packets/s\n";
+		// Stops the handlers being optimised away
+		std::cout << "(" << world.count + game.count << " handler calls, " << world.bytes + game.bytes << " bytes)\n";
+	}
+
+	void channelLoss() {
+		NetworkBase::Initialise();
+		// Off the default port, so this can run next to a game
+		const int port = NetworkBase::GetDefaultPort() + 1;
+		const int TickCount = 600;
+		const int EventInterval = 10;
+		const float TickRate = 60.0f;
+		const int DrainTicks = 300;
+
+		NetworkConditioner::Settings conditions;
+		conditions.latency = 50;
+		conditions.jitter = 10;
+		conditions.loss = 0.2f;
+
+		GameServer server(port, 1);
+		GameClient client;
+		server.EnableConditioner(conditions, 1);
+		client.EnableConditioner(conditions, 2);
+
+		LossReceiver receiver;
+		client.RegisterPacketHandler(GamePacket::Type::Full_State, &receiver);
+		client.RegisterPacketHandler(GamePacket::Type::ObjectDestroy, &receiver);
+		client.RegisterPacketHandler(GamePacket::Type::Client_ClientConnect, &receiver);
+		client.RegisterPacketHandler(GamePacket::Type::Client_ClientDisconnect, &receiver);
+		server.RegisterPacketHandler(GamePacket::Type::Server_ClientConnect, &receiver);
+		server.RegisterPacketHandler(GamePacket::Type::Server_ClientDisconnect, &receiver);
+
+		// Connect blocks, so the server needs servicing on another thread meanwhile
+		std::atomic<bool> connecting = true;
+		std::thread serverThread([&]() {
+			while (connecting) {
+				server.UpdateServer();
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		});
+		client.Connect(127, 0, 0, 1, port);
+		connecting = false;
+		serverThread.join();
+		// The client can think it's connected before the server has heard the handshake ack,
+		// and anything broadcast before then never reaches it
+		using Clock = std::chrono::steady_clock;
+		auto joinDeadline = Clock::now() + std::chrono::seconds(10);
+		while (client.isConnected() && !receiver.clientJoined && Clock::now() < joinDeadline) {
+			server.UpdateServer();
+			client.UpdateClient();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		if (!client.isConnected() || !receiver.clientJoined) {
+			std::cout << "Couldn't connect to the loopback server\n";
+			NetworkBase::Destroy();
+			return;
+		}
+
+		const auto tickTime = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(1.0f / TickRate));
+		// How many ticks behind the server the client's newest snapshot is, sampled every tick
+		std::vector<int> snapshotAges;
+		unsigned int eventsSent = 0;
+
+		auto nextTick = Clock::now();
+		// Run a bit past the last tick, to let resends finish
+		for (int tick = 0; tick < TickCount + DrainTicks; ) {
+			if (Clock::now() >= nextTick && tick < TickCount + DrainTicks) {
+				if (tick < TickCount) {
+					FullPacket snapshot;
+					snapshot.fullState.stateID = tick;
+					server.SendGlobalPacket(snapshot);
+					if (tick % EventInterval == 0) {
+						DestroyPacket event(eventsSent++);
+						server.SendGlobalPacket(event);
+					}
+				}
+				server.UpdateServer();
+				nextTick += tickTime;
+				tick++;
+				if (tick < TickCount && receiver.newestSnapshot >= 0) {
+					snapshotAges.push_back(tick - 1 - receiver.newestSnapshot);
+				}
+			}
+			client.UpdateClient();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		bool inOrder = std::is_sorted(receiver.events.begin(), receiver.events.end());
+		std::sort(snapshotAges.begin(), snapshotAges.end());
+		auto ageAt = [&](float p) {
+			return snapshotAges.empty() ? -1 : snapshotAges[std::min(snapshotAges.size() - 1, (size_t)(p * snapshotAges.size()))];
+		};
+		float tickMs = 1000.0f / TickRate;
+
+		std::cout << conditions.latency << "ms latency, " << conditions.jitter << "ms jitter, "
+			<< conditions.loss * 100 << "% loss each way, " << TickCount << " ticks\n";
+		std::cout << "Events: " << receiver.events.size() << "/" << eventsSent << " received, "
+			<< (inOrder ? "in order" : "OUT OF ORDER") << "\n";
+		std::cout << "Snapshot age: median " << ageAt(0.5f) * tickMs << "ms, p95 " << ageAt(0.95f) * tickMs
+			<< "ms, max " << ageAt(1.0f) * tickMs << "ms\n";
+		std::cout << "Packets dropped: " << server.GetConditioner()->getDroppedCount() << " by server, "
+			<< client.GetConditioner()->getDroppedCount() << " by client\n";
+
+		bool eventsOk = receiver.events.size() == eventsSent && inOrder;
+		// Fresh means a few lost snapshots in a row at worst, on top of the latency and the tick the age is sampled at
+		bool snapshotsOk = ageAt(0.95f) * tickMs <= conditions.latency + conditions.jitter + 4 * tickMs;
+		std::cout << (eventsOk && snapshotsOk ? "PASS" : "FAIL") << std::endl;
+
+		NetworkBase::Destroy();
+	}
+
+	void deltaGeneration() {
+		const int ObjectCount = 5000;
+		// A minute of play at 60Hz
+		const int TickCount = 3600;
+		const int FullInterval = 10;
+
+		NetworkWorld network(nullptr, nullptr);
+		std::vector<std::unique_ptr<GameObject>> objects;
+		std::vector<NetworkObject*> networkObjects;
+		for (int i = 0; i < ObjectCount; i++) {
+			auto& object = objects.emplace_back(std::make_unique<GameObject>());
+			object->GetTransform().SetPosition(Vector3((float)(i % 100), 0, (float)(i / 100)));
+			networkObjects.push_back(network.trackObject(object.get()));
+		}
+
+		// The per object vector this replaced, with states pushed on each full
+		// and found by linear search for each delta
+		std::vector<std::vector<NetworkState>> legacyHistory(ObjectCount);
+		double ringLookupTime = 0;
+		double legacyLookupTime = 0;
+
+		using Clock = std::chrono::steady_clock;
+		auto seconds = [](Clock::time_point since) {
+			return std::chrono::duration<double>(Clock::now() - since).count();
+		};
+
+		size_t packetBytes = 0;
+		int deltaFallbacks = 0;
+		NetworkState state;
+		auto start = Clock::now();
+		double writeTime = 0;
+		for (int tick = 0; tick < TickCount; tick++) {
+			for (int i = 0; i < ObjectCount; i++) {
+				Transform& transform = objects[i]->GetTransform();
+				transform.SetPosition(transform.GetPosition() + Vector3(0.01f, 0, 0));
+			}
+
+			auto writeStart = Clock::now();
+			for (int i = 0; i < ObjectCount; i++) {
+				NetworkObject* o = networkObjects[i];
+				// Staggered, so every tick has the same mix of fulls and deltas
+				bool deltaFrame = (tick + i) % FullInterval != 0;
+				GamePacket* packet = nullptr;
+				if (o->WritePacket(&packet, deltaFrame, o->GetLastFullState().stateID)) {
+					deltaFallbacks += deltaFrame && packet->type == GamePacket::Type::Full_State;
+					packetBytes += packet->GetTotalSize();
+					delete packet;
+				}
+			}
+			writeTime += seconds(writeStart);
+
+			// Just the history operations, old and new, for the same sequence of states
+			auto ringStart = Clock::now();
+			SnapshotHistory& snapshots = network.getSnapshots();
+			for (int i = 0; i < ObjectCount; i++) {
+				NetworkObject* o = networkObjects[i];
+				int stateID = o->GetLastFullState().stateID;
+				snapshots.get(o->getHistorySlot(), stateID, state);
+			}
+			ringLookupTime += seconds(ringStart);
+
+			auto legacyStart = Clock::now();
+			for (int i = 0; i < ObjectCount; i++) {
+				const NetworkState& latest = networkObjects[i]->GetLastFullState();
+				auto& history = legacyHistory[i];
+				if (history.empty() || history.back().stateID != latest.stateID) {
+					history.push_back(latest);
+				}
+				auto it = std::find_if(history.begin(), history.end(), [&](NetworkState& s) {
+					return s.stateID == latest.stateID;
+				});
+				if (it != history.end()) {
+					state = *it;
+				}
+			}
+			legacyLookupTime += seconds(legacyStart);
+		}
+		double totalTime = seconds(start);
+
+		size_t legacyBytes = 0;
+		for (auto& history : legacyHistory) {
+			legacyBytes += history.capacity() * sizeof(NetworkState);
+		}
+
+		std::cout << ObjectCount << " objects, " << TickCount << " ticks, full state every " << FullInterval << " ticks\n";
+		std::cout << "Packet writing: " << writeTime / TickCount * 1000 << "ms per tick, "
+			<< packetBytes / TickCount / 1024 << "KB per tick, " << deltaFallbacks << " deltas fell back to full\n";
+		std::cout << "History lookups, ring buffer:   " << ringLookupTime / TickCount * 1000 << "ms per tick, "
+			<< (size_t)ObjectCount * SnapshotHistory::MaxStates * (sizeof(int) + sizeof(Vector3) + sizeof(Quaternion)) / 1024 << "KB\n";
+		std::cout << "History lookups, linear search: " << legacyLookupTime / TickCount * 1000 << "ms per tick, "
+			<< legacyBytes / 1024 << "KB after " << TickCount << " ticks, still growing\n";
+		std::cout << "(" << totalTime << "s total)\n";
+	}
+
+	void objectLookup() {
+		const int ObjectCount = 10000;
+
+		GameWorld world;
+		NetworkWorld network(nullptr, nullptr);
+		std::vector<GameObject*> objects;
+		// What NetworkWorld used before
+		std::map<NetworkObject::Id, GameObject*> legacyMap;
+		for (int i = 0; i < ObjectCount; i++) {
+			GameObject* object = new GameObject();
+			world.AddGameObject(object);
+			// A mix of automatic and manual IDs, like a level with players in it
+			NetworkObject* netObj = i % 100 == 0
+				? network.trackObjectManual(object, NetworkWorld::ManualIdStart + i / 100)
+				: network.trackObject(object);
+			legacyMap.emplace(netObj->getId(), object);
+			objects.push_back(object);
+		}
+
+		// A full snapshot of every object, in a random order
+		std::vector<enet_uint8> buffer;
+		std::vector<GameObject*> shuffled = objects;
+		std::mt19937 rng(1);
+		std::shuffle(shuffled.begin(), shuffled.end(), rng);
+		for (GameObject* object : shuffled) {
+			FullPacket packet;
+			packet.objectID = object->GetNetworkObject()->getId();
+			packet.fullState.stateID = 1;
+			packet.fullState.position = Vector3(1, 2, 3);
+			appendPacket(buffer, packet);
+		}
+
+		auto decode = [&](auto&& lookup) {
+			std::span<enet_uint8> remaining(buffer);
+			while (!remaining.empty()) {
+				auto packet = GamePacket::View<FullPacket>(remaining);
+				if (GameObject* object = lookup(packet->objectID)) {
+					object->GetNetworkObject()->ReadPacket(*packet);
+				}
+				remaining = remaining.subspan(packet->GetTotalSize());
+			}
+		};
+
+		double slotMapTime = timeRepeated([&]() {
+			decode([&](NetworkObject::Id id) { return network.getTrackedObject(id); });
+		});
+		double mapTime = timeRepeated([&]() {
+			decode([&](NetworkObject::Id id) {
+				auto i = legacyMap.find(id);
+				return i == legacyMap.end() ? nullptr : i->second;
+			});
+		});
+
+		// Just the lookups, without applying the state
+		std::vector<NetworkObject::Id> netIds;
+		for (GameObject* object : shuffled) {
+			netIds.push_back(object->GetNetworkObject()->getId());
+		}
+		size_t found = 0;
+		double slotMapLookupTime = timeRepeated([&]() {
+			for (auto id : netIds) {
+				found += network.getTrackedObject(id) != nullptr;
+			}
+		});
+		double mapLookupTime = timeRepeated([&]() {
+			for (auto id : netIds) {
+				found += legacyMap.find(id) != legacyMap.end();
+			}
+		});
+
+		// World IDs, looked up in the same random order
+		std::vector<int> worldIds;
+		for (GameObject* object : shuffled) {
+			worldIds.push_back(object->GetWorldID());
+		}
+		double worldTime = timeRepeated([&]() {
+			for (int id : worldIds) {
+				found += world.getObject(id) != nullptr;
+			}
+		});
+		// The linear scan getObject used to do
+		double scanTime = timeRepeated([&]() {
+			for (int id : worldIds) {
+				auto i = std::find_if(world.objects().begin(), world.objects().end(), [&](GameObject* o) {
+					return o->GetWorldID() == id;
+				});
+				found += i != world.objects().end();
+			}
+		});
+
+		// Removed objects must not be found, even once their slots are reused
+		GameObject* removed = objects[ObjectCount / 2];
+		int removedWorldId = removed->GetWorldID();
+		NetworkObject::Id removedNetId = removed->GetNetworkObject()->getId();
+		network.removeObject(removed);
+		world.RemoveGameObject(removed, true);
+		GameObject* replacement = new GameObject();
+		world.AddGameObject(replacement);
+		network.trackObject(replacement);
+		bool staleRejected = world.getObject(removedWorldId) == nullptr && network.getTrackedObject(removedNetId) == nullptr;
+
+		std::cout << ObjectCount << " objects, full snapshot of " << buffer.size() / 1024 << "KB\n";
+		std::cout << "Snapshot decode, slot map: " << slotMapTime * 1000 << "ms, "
+			<< ObjectCount / slotMapTime / 1e6 << "M objects/s\n";
+		std::cout << "Snapshot decode, std::map: " << mapTime * 1000 << "ms, "
+			<< ObjectCount / mapTime / 1e6 << "M objects/s\n";
+		std::cout << "NetworkWorld::getTrackedObject x" << ObjectCount << ", slot map: " << slotMapLookupTime * 1000 << "ms\n";
+		std::cout << "NetworkWorld::getTrackedObject x" << ObjectCount << ", std::map: " << mapLookupTime * 1000 << "ms\n";
+		std::cout << "GameWorld::getObject x" << ObjectCount << ", slot map: " << worldTime * 1000 << "ms\n";
+		std::cout << "GameWorld::getObject x" << ObjectCount << ", linear scan: " << scanTime * 1000 << "ms\n";
+		std::cout << "Stale handles rejected: " << (staleRejected ? "yes" : "NO") << " (" << found << " found)\n";
+
+		world.ClearAndErase();
+	}
+
+	void joinStorm() {
+		CompressionHarness harness;
+		PlayerListReceiver receiver;
+		harness.RegisterPacketHandler(GamePacket::Type::PlayerList, &receiver);
+
+		std::mt19937 rng(64);
+		std::uniform_real_distribution<float> colourDist(0.0f, 1.0f);
+		const char* names[] = { "Bot", "Player", "Kitten Rescuer", "xX_Trapper_Xx", "Guest" };
+		auto makeState = [&](int id) {
+			PlayerState state;
+			state.id = id;
+			state.score = (int)(rng() % 10) * 300;
+			state.netObjectID = id + 1000;
+			state.colour = Vector4(colourDist(rng), colourDist(rng), colourDist(rng), 1.0f);
+			state.name.set(std::string(names[rng() % std::size(names)]) + " " + std::to_string(id));
+			return state;
+		};
+
+		// The host is always in the list
+		std::map<int, LocalPlayerState> players;
+		players.emplace(-1, LocalPlayerState(makeState(-1)));
+
+		size_t legacyBytes = 0;
+		size_t variableBytes = 0;
+		size_t compressedBytes = 0;
+		size_t listsSent = 0;
+		bool roundtripOk = true;
+
+		// Every join or leave sends the new list to every connected client
+		auto broadcastList = [&](size_t recipients) {
+			PlayerListPacket list(players);
+			GamePacket& compressed = harness.CompressPacket(list);
+			legacyBytes += sizeof(LegacyPlayerListPacket) * recipients;
+			variableBytes += list.GetTotalSize() * recipients;
+			compressedBytes += compressed.GetTotalSize() * recipients;
+			listsSent += recipients;
+
+			// What a client would get
+			std::vector<enet_uint8> received((enet_uint8*)&compressed, (enet_uint8*)&compressed + compressed.GetTotalSize());
+			receiver.valid = false;
+			harness.ProcessPacket(std::span(received));
+			bool matches = receiver.valid && receiver.states.size() == players.size();
+			auto it = players.begin();
+			for (size_t i = 0; matches && i < receiver.states.size(); i++, it++) {
+				matches = receiver.states[i].id == it->second.netState.id
+					&& receiver.states[i].name.get() == it->second.netState.name.get();
+			}
+			roundtripOk = roundtripOk && matches;
+		};
+		// Packets that don't change with the list encoding, counted the same in every total
+		auto addFixed = [&](size_t bytes) {
+			legacyBytes += bytes;
+			variableBytes += bytes;
+			compressedBytes += bytes;
+		};
+
+		for (int id = 0; id < MaxPlayers; id++) {
+			players.emplace(id, LocalPlayerState(makeState(id)));
+			broadcastList(players.size() - 1);
+			addFixed(sizeof(ServerHelloPacket));
+		}
+		PlayerListPacket fullList(players);
+		size_t fullListSize = fullList.GetTotalSize();
+		size_t fullCompressedSize = harness.CompressPacket(fullList).GetTotalSize();
+		for (int id = 0; id < MaxPlayers; id++) {
+			players.erase(id);
+			addFixed(sizeof(PlayerDisconnectedPacket) * (players.size() - 1));
+			broadcastList(players.size() - 1);
+		}
+
+		// Encoding and compressing a full list
+		std::map<int, LocalPlayerState> fullPlayers;
+		for (int id = -1; id < MaxPlayers; id++) {
+			fullPlayers.emplace(id, LocalPlayerState(makeState(id)));
+		}
+		size_t sink = 0;
+		double encodeTime = timeRepeated([&]() {
+			PlayerListPacket list(fullPlayers);
+			sink += list.GetTotalSize();
+		});
+		double compressTime = timeRepeated([&]() {
+			PlayerListPacket list(fullPlayers);
+			sink += harness.CompressPacket(list).GetTotalSize();
+		});
+
+		auto kb = [](size_t bytes) { return bytes / 1024.0; };
+		std::cout << MaxPlayers << " players join then leave, " << listsSent << " player lists delivered\n";
+		std::cout << "Full list: fixed " << sizeof(LegacyPlayerListPacket) << " bytes, variable " << fullListSize
+			<< " bytes, compressed " << fullCompressedSize << " bytes\n";
+		std::cout << "Storm total, fixed size:            " << kb(legacyBytes) << "KB\n";
+		std::cout << "Storm total, variable length:       " << kb(variableBytes) << "KB ("
+			<< 100.0 * variableBytes / legacyBytes << "%)\n";
+		std::cout << "Storm total, variable + compressed: " << kb(compressedBytes) << "KB ("
+			<< 100.0 * compressedBytes / legacyBytes << "%)\n";
+		std::cout << "Full list encode: " << encodeTime * 1e6 << "us, encode + compress: " << compressTime * 1e6 << "us ("
+			<< sink % 2 << ")\n";
+		std::cout << "Roundtrip: " << (roundtripOk ? "PASS" : "FAIL") << std::endl;
+	}
+
+	void inputBuffering() {
+		const int FrameCount = 6000;
+		const float FrameMs = 1000.0f / 60.0f;
+		const int JumpInterval = 30;
+
+		struct Conditions {
+			float latency;
+			float jitter;
+			float loss;
+		};
+		for (Conditions conditions : { Conditions{ 50, 10, 0.02f }, Conditions{ 100, 30, 0.1f } }) {
+			// Client sends an input every frame, each arriving after latency plus or minus jitter, or not at all
+			std::mt19937 rng(35);
+			std::uniform_real_distribution<float> jitterDist(-conditions.jitter, conditions.jitter);
+			std::bernoulli_distribution lossDist(conditions.loss);
+			struct Arrival {
+				float time;
+				ClientPacket packet;
+			};
+			std::vector<Arrival> arrivals;
+			ClientPacket packet;
+			int jumpsSent = 0;
+			for (int frame = 0; frame < FrameCount; frame++) {
+				PlayerInput input;
+				input.forward = (frame / 90) % 2 == 0;
+				input.jump = frame % JumpInterval == 0;
+				input.dt = FrameMs / 1000.0f;
+				jumpsSent += input.jump;
+				packet.pushInput(input);
+				if (!lossDist(rng)) {
+					arrivals.push_back({ frame * FrameMs + conditions.latency + jitterDist(rng), packet });
+				}
+			}
+			std::sort(arrivals.begin(), arrivals.end(), [](const Arrival& a, const Arrival& b) { return a.time < b.time; });
+
+			struct Result {
+				std::vector<bool> applied = std::vector<bool>(FrameCount, false);
+				int jumps = 0;
+				int repeats = 0;
+				bool inOrder = true;
+				float totalDelay = 0;
+				int appliedCount = 0;
+				int lastIndex = -1;
+
+				void apply(int frame, int index, const PlayerInput& input) {
+					inOrder = inOrder && index > lastIndex;
+					lastIndex = index;
+					if (!applied[index]) {
+						applied[index] = true;
+						appliedCount++;
+						totalDelay += (frame - index) * 1000.0f / 60.0f;
+					}
+					jumps += input.jump;
+				}
+			};
+
+			// Server frames, delivering everything that's arrived before each one
+			// Runs until everything has arrived, and then while pending() says there's more to apply
+			auto simulate = [&](auto&& receive, auto&& applyFrame, auto&& pending) {
+				size_t next = 0;
+				for (int frame = 0; next < arrivals.size() || pending(); frame++) {
+					for (; next < arrivals.size() && arrivals[next].time <= frame * FrameMs; next++) {
+						receive(arrivals[next].packet);
+					}
+					applyFrame(frame);
+				}
+			};
+
+			// The old behaviour, each packet overwriting the last input
+			Result legacy;
+			ClientPacket newest;
+			bool newSinceLastFrame = false;
+			simulate([&](const ClientPacket& received) {
+				if (received.index > newest.index) {
+					newest = received;
+					newSinceLastFrame = true;
+				}
+			}, [&](int frame) {
+				if (newSinceLastFrame) {
+					legacy.apply(frame, newest.index, newest.newestInput());
+				} else {
+					legacy.repeats++;
+				}
+				newSinceLastFrame = false;
+			}, [&]() { return false; });
+
+			NetworkProfiler profiler;
+			InputBuffer buffer(&profiler, 0);
+			Result buffered;
+			simulate([&](const ClientPacket& received) {
+				buffer.insert(received);
+			}, [&](int frame) {
+				PlayerInput input;
+				int index;
+				if (buffer.consume(FrameMs / 1000.0f, input, index)) {
+					buffered.apply(frame, index, input);
+				} else {
+					buffered.repeats++;
+				}
+			}, [&]() { return buffer.getDepth() > 0; });
+
+			auto report = [&](const char* name, const Result& result) {
+				std::cout << name << result.appliedCount * 100.0f / FrameCount << "% of inputs applied, "
+					<< result.jumps << "/" << jumpsSent << " jumps, "
+					<< result.totalDelay / std::max(result.appliedCount, 1) << "ms mean delay, "
+					<< result.repeats << " frames without a new input, "
+					<< (result.inOrder ? "in order" : "OUT OF ORDER") << "\n";
+			};
+			std::cout << conditions.latency << "ms latency, " << conditions.jitter << "ms jitter, "
+				<< conditions.loss * 100 << "% loss, " << FrameCount << " frames\n";
+			report("  Overwrite:     ", legacy);
+			report("  Jitter buffer: ", buffered);
+			std::cout << "  Buffer events:";
+			for (size_t i = 0; i < NetworkProfiler::InputEventCount; i++) {
+				std::cout << " " << NetworkProfiler::GetInputEventName((NetworkProfiler::InputEvent)i) << " "
+					<< profiler.getPeerStats()[0].inputs[i];
+			}
+			std::cout << "\n";
+		}
+	}
+}
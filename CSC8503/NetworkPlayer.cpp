@@ -25,7 +25,7 @@ namespace NCL::CSC8503 {
 		return input;
 	}
 
-	void NetworkPlayer::handleJumpInput(float dt) {
+	void NetworkPlayer::handleJumpInput(float dt, bool affectOthers) {
 		auto [canJump, collision] = this->canJump();
 		if (!canJump) {
 			return;
@@ -39,6 +39,9 @@ namespace NCL::CSC8503 {
 		float force = impulseToForce(JumpImpulse, dt);
 		
 		GetPhysicsObject()->AddForce({ 0, force, 0 });
+		if (!affectOthers) {
+			return;
+		}
 		// Newton's third law: for every action there is an equal and opposite reaction
 		// Apply an impulse to the object we jumped off of
 		GameObject* other = (GameObject*)collision.node;
@@ -48,22 +51,53 @@ namespace NCL::CSC8503 {
 		}
 	}
 
-	void NetworkPlayer::OnUpdate(float dt) {
+	void NetworkPlayer::applyMovement(const PlayerInput& input, float dt) {
 		float force = 1000 * dt;
 		Vector3 forwardsForce = GetTransform().GetOrientation() * Vector3(0, 0, force);
 		forwardsForce = forwardsForce * 3;
 
-		if (lastInput.forward) {
+		if (input.forward) {
 			GetPhysicsObject()->AddForce(forwardsForce);
-		} else if (lastInput.backward) {
+		} else if (input.backward) {
 			GetPhysicsObject()->AddForce(-forwardsForce);
 		}
 
-		if (lastInput.left) {
+		if (input.left) {
 			GetPhysicsObject()->AddTorque({ 0, force, 0 });
-		} else if (lastInput.right) {
+		} else if (input.right) {
 			GetPhysicsObject()->AddTorque({ 0, -force, 0 });
 		}
+	}
+
+	void NetworkPlayer::replayInput(const PlayerInput& input, float dt) {
+		applyMovement(input, dt);
+		if (input.jump) {
+			handleJumpInput(dt, false);
+		}
+		jumpCooldown -= dt;
+	}
+
+	void NetworkPlayer::writeAck(InputAckPacket& packet) const {
+		packet.lastInputIndex = lastInputIndex;
+		packet.position = transform.GetPosition();
+		packet.orientation = transform.GetOrientation();
+		packet.linearVelocity = physicsObject->GetLinearVelocity();
+		packet.angularVelocity = physicsObject->GetAngularVelocity();
+		packet.jumpCooldown = jumpCooldown;
+	}
+
+	void NetworkPlayer::readAck(const InputAckPacket& packet) {
+		GetTransform()
+			.SetPosition(packet.position)
+			.SetOrientation(packet.orientation);
+		GetPhysicsObject()->SetLinearVelocity(packet.linearVelocity);
+		GetPhysicsObject()->SetAngularVelocity(packet.angularVelocity);
+		GetPhysicsObject()->ClearForces();
+		jumpCooldown = packet.jumpCooldown;
+	}
+
+	void NetworkPlayer::OnUpdate(float dt) {
+		applyMovement(lastInput, dt);
 
 		if (lastInput.jump) {
 			handleJumpInput(dt);
@@ -91,7 +125,10 @@ namespace NCL::CSC8503 {
 		auto world = GetWorld();
 		Ray ray(GetTransform().GetPosition(), Vector3(0, -1, 0));
 		RayCollision closestCollision;
-		bool hit = world->Raycast(ray, closestCollision, true, this);
+		// Check against what the client saw, otherwise laggy players miss the ground under moving objects
+		bool hit = viewTick >= 0
+			? world->RaycastAtTime(ray, viewTick, closestCollision, true, this)
+			: world->Raycast(ray, closestCollision, true, this);
 
 		bool closeEnough = hit && closestCollision.rayDistance < JumpRayLength;
 		Debug::DrawLine(
@@ -13,15 +13,55 @@ namespace NCL::CSC8503 {
 		bool right = false;
 		bool jump = false;
 		bool action = false;
+		// Client frame time the input was held for
+		// The server plays inputs back by time, so it keeps pace with a client at any frame rate
+		float dt = 0;
 	};
 
 	struct ClientPacket : public GamePacket {
-		// How many packets have been sent
-		int		index;
-		PlayerInput input;
+		// Input is sent unreliably, so each packet repeats the last few inputs
+		// An input in a lost packet still arrives with the next, without waiting for a resend
+		static const constexpr int RedundantInputs = 3;
+
+		// Index of the newest input, one per client frame
+		int		index = -1;
+		// Server tick of the state the client was showing when it sampled this input
+		// The server rewinds to it for lag compensation
+		int		viewTick = -1;
+		// inputs[i] is the input for index - i
+		PlayerInput inputs[RedundantInputs];
 
 		ClientPacket() : GamePacket(Type::ClientState) {
-			size = sizeof(ClientPacket);
+			size = sizeof(ClientPacket) - sizeof(GamePacket);
+		}
+
+		// Keep the packet between frames, and push each new input into it
+		void pushInput(const PlayerInput& input) {
+			for (int i = RedundantInputs - 1; i > 0; i--) {
+				inputs[i] = inputs[i - 1];
+			}
+			inputs[0] = input;
+			index++;
+		}
+		const PlayerInput& newestInput() const {
+			return inputs[0];
+		}
+	};
+
+	// Sent by the server to each client every tick
+	// Authoritative state of the client's own player after applying lastInputIndex,
+	// the client rewinds to this and replays any inputs the server hasn't seen yet
+	struct InputAckPacket : public GamePacket {
+		int lastInputIndex = -1;
+		int serverTick = -1;
+		Vector3 position;
+		Quaternion orientation;
+		Vector3 linearVelocity;
+		Vector3 angularVelocity;
+		float jumpCooldown = 0;
+
+		InputAckPacket() : GamePacket(Type::InputAck) {
+			size = sizeof(InputAckPacket) - sizeof(GamePacket);
 		}
 	};
 
@@ -34,6 +74,28 @@ namespace NCL::CSC8503 {
 		void setLastInput(const PlayerInput& input) {
 			lastInput = input;
 		}
+		// Index is the ClientPacket index, used to acknowledge inputs
+		void setLastInput(const PlayerInput& input, int index) {
+			lastInput = input;
+			lastInputIndex = index;
+		}
+		int getLastInputIndex() const {
+			return lastInputIndex;
+		}
+
+		// The server tick this player's client is looking at
+		// -1 if we're looking at the present, i.e. the host
+		void setViewTick(int tick) {
+			viewTick = tick;
+		}
+
+		// Apply an input that has already been simulated once, for reconciliation
+		// Only affects this player, so it's safe to call repeatedly
+		void replayInput(const PlayerInput& input, float dt);
+
+		void writeAck(InputAckPacket& packet) const;
+		// Rewind to the server's state, ready to replay inputs on top of it
+		void readAck(const InputAckPacket& packet);
 
 		void OnUpdate(float dt) override;
 		void OnCollisionBegin(GameObject* other) override;
@@ -53,10 +115,14 @@ namespace NCL::CSC8503 {
 			inHome = value;
 		}
 	private:
-		void handleJumpInput(float dt);
+		void applyMovement(const PlayerInput& input, float dt);
+		// affectOthers pushes the object we jumped off, which must only happen once per jump
+		void handleJumpInput(float dt, bool affectOthers = true);
 
 		int clientId;
 		PlayerInput lastInput;
+		int lastInputIndex = -1;
+		int viewTick = -1;
 
 		bool inHome = false;
 
@@ -1,5 +1,8 @@
 #include "NetworkWorld.h"
 
+#include <algorithm>
+#include <utility>
+
 namespace NCL::CSC8503 {
     NetworkWorld::NetworkWorld(GameClient* client, GameServer* server)
         : client(client), server(server) {
@@ -11,8 +14,12 @@ namespace NCL::CSC8503 {
     }
 
     void NetworkWorld::reset() {
-        networkObjects.clear();
+        objects.clear();
+        autoHandles.clear();
+        manualHandles.clear();
+        snapshots.clear();
         nextId = 0;
+        stateTick = -1;
     }
 
     NetworkObject* NetworkWorld::trackObject(GameObject* obj) {
@@ -22,9 +29,9 @@ namespace NCL::CSC8503 {
             throw std::runtime_error("Too many network objects. You're doing it wrong.");
 		}
 
-        NetworkObject* netObj = new NetworkObject(*obj, nextId);
+        NetworkObject* netObj = new NetworkObject(*obj, nextId, snapshots);
         obj->SetNetworkObject(netObj);
-        networkObjects.emplace(nextId, obj);
+        autoHandles.push_back(objects.insert(obj));
         nextId++;
         return netObj;
     }
@@ -34,45 +41,76 @@ namespace NCL::CSC8503 {
         if (id < ManualIdStart) {
 			throw std::runtime_error("Manual ID must be greater than " + std::to_string(ManualIdStart));
 		}
-        if (networkObjects.find(id) != networkObjects.end()) {
+        if (id - ManualIdStart >= MaxManualIds) {
+            throw std::runtime_error("Manual ID must be less than " + std::to_string(ManualIdStart + MaxManualIds));
+        }
+        if (getTrackedObject(id) != nullptr) {
             throw std::runtime_error("Network object with ID " + std::to_string(id) + " already exists");
         }
 
-        NetworkObject* netObj = new NetworkObject(*obj, id);
+        NetworkObject* netObj = new NetworkObject(*obj, id, snapshots);
 		obj->SetNetworkObject(netObj);
-		networkObjects.emplace(id, obj);
+        size_t index = id - ManualIdStart;
+        if (index >= manualHandles.size()) {
+            manualHandles.resize(index + 1, ObjectMap::InvalidHandle);
+        }
+        manualHandles[index] = objects.insert(obj);
 		return netObj;
     }
 
-    GameObject* NetworkWorld::getTrackedObject(NetworkObject::Id id) {
-        auto i = networkObjects.find(id);
-        // TODO: Possible use-after-free if the GameObject is deleted
-        if (i == networkObjects.end()) {
+    void NetworkWorld::removeObject(GameObject* obj) {
+        NetworkObject* netObj = obj->GetNetworkObject();
+        snapshots.removeObject(netObj->getHistorySlot());
+        if (auto handle = findHandle(netObj->getId())) {
+            objects.erase(*handle);
+            *handle = ObjectMap::InvalidHandle;
+        }
+    }
+
+    GameObject* NetworkWorld::getTrackedObject(NetworkObject::Id id) const {
+        auto handle = findHandle(id);
+        if (handle == nullptr) {
             return nullptr;
         }
-        return i->second;
+        // TODO: Possible use-after-free if the GameObject is deleted without being removed
+        auto obj = objects.get(*handle);
+        return obj ? *obj : nullptr;
+    }
+
+    NetworkWorld::ObjectMap::Handle* NetworkWorld::findHandle(NetworkObject::Id id) {
+        return const_cast<ObjectMap::Handle*>(std::as_const(*this).findHandle(id));
+    }
+
+    const NetworkWorld::ObjectMap::Handle* NetworkWorld::findHandle(NetworkObject::Id id) const {
+        if (id < ManualIdStart) {
+            return id < autoHandles.size() ? &autoHandles[id] : nullptr;
+        }
+        size_t index = id - ManualIdStart;
+        return index < manualHandles.size() ? &manualHandles[index] : nullptr;
     }
 
     void NetworkWorld::ProcessPacket(DeltaPacket* payload, int source) {
         GameObject* obj = getTrackedObject(payload->objectID);
-        if (obj) {
-            obj->GetNetworkObject()->ReadPacket(*payload);
+        if (obj && obj->GetNetworkObject()->ReadPacket(*payload)) {
+            stateTick = std::max(stateTick, payload->serverTick);
         }
     }
 
     void NetworkWorld::ProcessPacket(FullPacket* payload, int source) {
         GameObject* obj = getTrackedObject(payload->objectID);
-        if (obj) {
-            obj->GetNetworkObject()->ReadPacket(*payload);
+        if (obj && obj->GetNetworkObject()->ReadPacket(*payload)) {
+            stateTick = std::max(stateTick, payload->serverTick);
         }
     }
 
-    void NetworkWorld::ReceivePacket(GamePacket::Type type, GamePacket* payload, int source) {
+    void NetworkWorld::ReceivePacket(GamePacket::Type type, std::span<enet_uint8> packet, int source) {
         switch (type) {
         case GamePacket::Type::Delta_State:
-            return ProcessPacket((DeltaPacket*)payload, source);
+            if (auto payload = GamePacket::View<DeltaPacket>(packet)) ProcessPacket(payload, source);
+            break;
         case GamePacket::Type::Full_State:
-            return ProcessPacket((FullPacket*)payload, source);
+            if (auto payload = GamePacket::View<FullPacket>(packet)) ProcessPacket(payload, source);
+            break;
         default:
             break;
         }
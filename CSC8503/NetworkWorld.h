@@ -1,11 +1,12 @@
 #pragma once
 
-#include <map>
+#include <vector>
 
 #include "GameObject.h"
 #include "NetworkObject.h"
 #include "GameClient.h"
 #include "GameServer.h"
+#include "SlotMap.h"
 
 namespace NCL::CSC8503 {
     // The state of the game over the network, synchronises held objects
@@ -14,6 +15,8 @@ namespace NCL::CSC8503 {
         // Reserve IDs below this for level loading
         // IDs above this can be assigned manually
         static const constexpr NetworkObject::Id ManualIdStart = NetworkObject::MaxId >> 1;
+        // Manual IDs are looked up in a table, so must be within this of ManualIdStart
+        static const constexpr NetworkObject::Id MaxManualIds = 1 << 16;
 
         NetworkWorld(GameClient* client, GameServer* server);
 
@@ -30,19 +33,44 @@ namespace NCL::CSC8503 {
         NetworkObject* trackObjectManual(GameObject* obj, NetworkObject::Id id);
 
         // Get the GameObject associated with a network ID
-        GameObject* getTrackedObject(NetworkObject::Id id);
+        // nullptr if it was never tracked, or has been removed
+        GameObject* getTrackedObject(NetworkObject::Id id) const;
 
-        void ReceivePacket(GamePacket::Type type, GamePacket* payload, int source) override;
+        // Every tracked object, in no particular order
+        const std::vector<GameObject*>& trackedObjects() const {
+            return objects.dense();
+        }
 
-        void removeObject(GameObject* obj) {
-			networkObjects.erase(obj->GetNetworkObject()->getId());
-		}
+        void ReceivePacket(GamePacket::Type type, std::span<enet_uint8> packet, int source) override;
+
+        void removeObject(GameObject* obj);
+
+        // Full states sent by every tracked object
+        SnapshotHistory& getSnapshots() {
+            return snapshots;
+        }
+
+        // Server tick of the newest state applied to any object, -1 before the first
+        // Objects only get state when they change, so this is the tick the world as shown is from
+        int getStateTick() const {
+            return stateTick;
+        }
     private:
         void ProcessPacket(DeltaPacket* payload, int source);
         void ProcessPacket(FullPacket* payload, int source);
 
+        using ObjectMap = SlotMap<GameObject*>;
+        // Handle into objects for each network ID, so stale IDs are caught
+        // Automatic IDs are dense from 0, manual ones from ManualIdStart
+        ObjectMap::Handle* findHandle(NetworkObject::Id id);
+        const ObjectMap::Handle* findHandle(NetworkObject::Id id) const;
+
         NetworkObject::Id nextId = 0;
-        std::map<NetworkObject::Id, GameObject*> networkObjects;
+        int stateTick = -1;
+        ObjectMap objects;
+        std::vector<ObjectMap::Handle> autoHandles;
+        std::vector<ObjectMap::Handle> manualHandles;
+        SnapshotHistory snapshots;
 
         GameClient* client;
         GameServer* server;
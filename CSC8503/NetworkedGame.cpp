@@ -11,10 +11,12 @@
 #include "NetworkObject.h"
 #include "GameServer.h"
 #include "GameClient.h"
+#include "NetworkProfiler.h"
 #include "RenderObject.h"
 #include "Trapper.h"
 #include "Kitten.h"
 #include "Bonus.h"
+#include "HierarchicalNavigationGrid.h"
 #include "Trigger.h"
 
 #define COLLISION_MSG 30
@@ -39,6 +41,7 @@ NetworkedGame::NetworkedGame(const Cli& cli)
 
 	NetworkBase::Initialise();
 	timeToNextPacket  = 0.0f;
+	inverseTickRate = 1.0f / cli.getTickRate();
 
 	auto type = cli.getClientType();
 	switch (type) {
@@ -56,12 +59,38 @@ NetworkedGame::NetworkedGame(const Cli& cli)
 }
 
 NetworkedGame::~NetworkedGame()	{
+	if (thisClient && prediction.getReconcileCount() > 0) {
+		std::cout << "Prediction: " << prediction.getReconcileCount() << " reconciliations, "
+			<< "last error " << prediction.getLastError() << ", max error " << prediction.getMaxError() << "\n";
+	}
+	writeNetworkProfile();
 	ClearWorld();
 	delete server;
 	delete client;
 	delete thisClient;
 }
 
+NetworkBase* NetworkedGame::getNetworkBase() const {
+	if (server) {
+		return server->getServer();
+	}
+	return thisClient;
+}
+
+void NetworkedGame::writeNetworkProfile() const {
+	NetworkBase* network = getNetworkBase();
+	if (cli.getNetProfilePath().empty() || network == nullptr) {
+		return;
+	}
+	std::string path(cli.getNetProfilePath());
+	const NetworkProfiler* profiler = network->GetProfiler();
+	if (profiler->writeCsv(path + ".csv") && profiler->writeJson(path + ".json")) {
+		std::cout << "Network profile written to " << path << ".csv and " << path << ".json\n";
+	} else {
+		std::cerr << "Couldn't write network profile to " << path << "\n";
+	}
+}
+
 void NCL::CSC8503::NetworkedGame::decrementRemainingKittens(Kitten* kitten, NetworkPlayer* player)
 {
 	kittensSaved++;
@@ -75,6 +104,13 @@ void NCL::CSC8503::NetworkedGame::decrementRemainingKittens(Kitten* kitten, Netw
 
 void NetworkedGame::StartAsServer() {
 	server = new Server(this, MaxPlayers);
+	server->getServer()->EnableProfiler();
+	if (!cli.getNetProfilePath().empty()) {
+		server->getServer()->GetProfiler()->setKeepTickHistory(true);
+	}
+	if (cli.getConditionerSettings().isEnabled()) {
+		server->getServer()->EnableConditioner(cli.getConditionerSettings());
+	}
 	delete networkWorld;
 	networkWorld = new NetworkWorld(thisClient, server->getServer());
 
@@ -90,6 +126,13 @@ void NetworkedGame::StartAsClient(uint32_t addr, std::string_view name) {
 	connectionFailed = false;
 	connectionLength = 0.0f;
 	thisClient = new GameClient();
+	thisClient->EnableProfiler();
+	if (!cli.getNetProfilePath().empty()) {
+		thisClient->GetProfiler()->setKeepTickHistory(true);
+	}
+	if (cli.getConditionerSettings().isEnabled()) {
+		thisClient->EnableConditioner(cli.getConditionerSettings());
+	}
 	thisClient->Connect(addr, NetworkBase::GetDefaultPort());
 
 	if (!thisClient->isConnected()) {
@@ -112,6 +155,10 @@ void NetworkedGame::StartAsClient(uint32_t addr, std::string_view name) {
 	thisClient->RegisterPacketHandler(GamePacket::Type::PlayerList, this);
 	thisClient->RegisterPacketHandler(GamePacket::Type::ServerHello, this);
 	thisClient->RegisterPacketHandler(GamePacket::Type::ObjectDestroy, this);
+	thisClient->RegisterPacketHandler(GamePacket::Type::InputAck, this);
+	prediction.reset();
+	inputPacket = ClientPacket();
+	renderedTick = -1;
 
 	StartLevel();
 }
@@ -211,6 +258,13 @@ void NetworkedGame::UpdateGame(float dt) {
 	if (Window::GetKeyboard()->KeyDown(KeyCodes::TAB))
 		drawScoreboard();
 
+	if (Window::GetKeyboard()->KeyPressed(KeyCodes::F7)) {
+		showNetworkStats = !showNetworkStats;
+	}
+	if (showNetworkStats && getNetworkBase()) {
+		getNetworkBase()->GetProfiler()->drawOverlay(55, 10);
+	}
+
 	if (timeToNextPacket < 0) {
 		if (server) {
 			server->update(dt);
@@ -221,8 +275,14 @@ void NetworkedGame::UpdateGame(float dt) {
 	}
 
 	ProcessInput(dt);
+	if (server) {
+		server->applyInputs(dt);
+	}
 
 	TutorialGame::UpdateGame(dt);
+	if (thisClient && networkWorld) {
+		renderedTick = networkWorld->getStateTick();
+	}
 
 	clearGraveyard();
 }
@@ -280,12 +340,17 @@ void NetworkedGame::ProcessInput(float dt) {
 
 	if (server) {
 		playerObject->setLastInput(input);
-	} else {
-		ClientPacket newPacket;
-		newPacket.input = input;
-		// TODO: Should this sync with the state ID?
-		newPacket.index = inputIndex++;
-		thisClient->SendPacket(newPacket);
+	} else if (thisClient) {
+		NetworkProfiler::ScopedTimer timer(thisClient->GetProfiler(), GamePacket::Type::ClientState);
+		input.dt = dt;
+		inputPacket.pushInput(input);
+		inputPacket.viewTick = renderedTick;
+		timer.stop();
+		thisClient->SendPacket(inputPacket);
+
+		// Predict the result locally rather than waiting a round trip for the server
+		playerObject->setLastInput(input, inputPacket.index);
+		prediction.recordInput(inputPacket.index, input, dt);
 	}
 }
 
@@ -323,13 +388,7 @@ void NetworkedGame::UpdateMinimumState() {
 	}
 	//every client has acknowledged reaching at least state minID
 	//so we can get rid of any old states!
-	for (auto i : world->objects()) {
-		NetworkObject* o = i->GetNetworkObject();
-		if (!o) {
-			continue;
-		}
-		o->UpdateStateHistory(minID); //clear out old states so they arent taking up memory...
-	}
+	networkWorld->getSnapshots().expire(minID);
 }
 
 NetworkPlayer* NetworkedGame::SpawnPlayer(PlayerState state) {
@@ -495,28 +554,32 @@ void NetworkedGame::StartLevel() {
 	bridgeBonus->setValue(300); // Quite difficult to get to
 	networkWorld->trackObject(bridgeBonus);
 
-	maze = new NavigationGrid("maze.txt", Vector3(32, 0, 32));
+	if (cli.useHierarchicalPaths()) {
+		maze = new HierarchicalNavigationGrid(MazeFile, MazeOffset);
+	} else {
+		maze = new NavigationGrid(MazeFile, MazeOffset);
+	}
 	int nodeSize = maze->getNodeSize();
 	for (int i = 0; i < maze->getNodeCount(); i++) {
-		GridNode* node = maze->getNode(i);
-		switch (node->type) {
+		GridNode node = maze->getNode(i);
+		switch (node.type) {
 		case GridNode::Type::Wall:
-			AddCubeToWorld(node->position + Vector3(0, 10, 0), Vector3(nodeSize / 2, 10, nodeSize / 2), 0.0f, true);
+			AddCubeToWorld(node.position + Vector3(0, MazeWallHeight / 2, 0), Vector3(nodeSize / 2, MazeWallHeight / 2, nodeSize / 2), 0.0f, true);
 			break;
 		case GridNode::Type::Bonus: {
-			auto bonus = AddBonusToWorld(node->position + Vector3(0, 2.5, 0));
+			auto bonus = AddBonusToWorld(node.position + Vector3(0, 2.5, 0));
 			networkWorld->trackObject(bonus);
 			// TODO: Reward for collecting
 			break;
 		} case GridNode::Type::Enemy: {
 			auto enemy = new Trapper(rng, enemyMesh, basicShader, maze, world);
-			enemy->GetTransform().SetPosition(node->position);
+			enemy->GetTransform().SetPosition(node.position);
 			enemy->SetDefaultTransform(enemy->GetTransform());
 			world->AddGameObject(enemy);
 			networkWorld->trackObject(enemy);
 			break;
 		} case GridNode::Type::Kitten: {
-			AddKittenToWorld(node->position + Vector3(0, 5, 0));
+			AddKittenToWorld(node.position + Vector3(0, 5, 0));
 			break;
 		} default:
 			break;
@@ -532,9 +595,13 @@ void NetworkedGame::ProcessPacket(PlayerDisconnectedPacket* payload) {
 }
 
 void NetworkedGame::ProcessPacket(PlayerListPacket* payload) {
-	std::cout << "Received list of " << (int)payload->count << " players\n";
-	for (int i = 0; i < payload->count; i++) {
-		auto state = payload->playerStates[i];
+	std::vector<PlayerState> states;
+	if (!payload->read(states)) {
+		std::cerr << "Received a malformed player list\n";
+		return;
+	}
+	std::cout << "Received list of " << states.size() << " players\n";
+	for (auto& state : states) {
 		std::cout << "Player " << state.id << " has object ID " << state.netObjectID << "\n";
 		auto it = allPlayers.find(state.id);
 		if (it == allPlayers.end()) {
@@ -557,6 +624,7 @@ void NetworkedGame::ProcessPacket(ServerHelloPacket* payload) {
 	gameEnded = payload->gameEnded;
 	timeElapsed = payload->timeElapsed;
 	timeLimit = payload->timeLimit;
+	thisClient->SetPeerFeatures(0, payload->features);
 	allPlayers.emplace(localPlayerId, LocalPlayerState(payload->whoAmI));
 }
 
@@ -565,17 +633,36 @@ void NCL::CSC8503::NetworkedGame::ProcessPacket(DestroyPacket* payload)
 	removeObject(networkWorld->getTrackedObject(payload->id));
 }
 
-void NetworkedGame::ReceivePacket(GamePacket::Type type, GamePacket* payload, int source) {
+void NetworkedGame::ProcessPacket(InputAckPacket* payload) {
+	auto it = allPlayers.find(localPlayerId);
+	if (it == allPlayers.end() || it->second.player == nullptr) {
+		return;
+	}
+	NetworkPlayer* player = it->second.player;
+	// Stop snapshots fighting with prediction
+	player->GetNetworkObject()->setPredicted(true);
+	prediction.reconcile(*player, *payload, *physics);
+}
+
+void NetworkedGame::ReceivePacket(GamePacket::Type type, std::span<enet_uint8> packet, int source) {
+	// Packets too small for their type are dropped
 	switch (type)
 	{
 	case GamePacket::Type::PlayerDisconnected:
-		return ProcessPacket((PlayerDisconnectedPacket*)payload);
+		if (auto payload = GamePacket::View<PlayerDisconnectedPacket>(packet)) ProcessPacket(payload);
+		break;
 	case GamePacket::Type::PlayerList:
-		return ProcessPacket((PlayerListPacket*)payload);
+		if (auto payload = GamePacket::View<PlayerListPacket>(packet, PlayerListPacket::MinSize)) ProcessPacket(payload);
+		break;
 	case GamePacket::Type::ServerHello:
-		return ProcessPacket((ServerHelloPacket*)payload);
+		if (auto payload = GamePacket::View<ServerHelloPacket>(packet)) ProcessPacket(payload);
+		break;
 	case GamePacket::Type::ObjectDestroy:
-		return ProcessPacket((DestroyPacket*)payload);
+		if (auto payload = GamePacket::View<DestroyPacket>(packet)) ProcessPacket(payload);
+		break;
+	case GamePacket::Type::InputAck:
+		if (auto payload = GamePacket::View<InputAckPacket>(packet)) ProcessPacket(payload);
+		break;
 	case GamePacket::Type::Reset:
 		StartLevel();
 		break;
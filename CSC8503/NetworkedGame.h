@@ -3,6 +3,7 @@
 #include <map>
 
 #include "Client.h"
+#include "ClientPrediction.h"
 #include "Server.h"
 
 #include "Cli.h"
@@ -50,6 +51,49 @@ namespace NCL {
 			NetworkObject::Id netObjectID;
 			Vector4 colour;
 			SizedString<MaxNameLength> name;
+
+			// On the wire, only as much of the name as is used is sent
+			static const constexpr size_t FixedEncodedSize = sizeof(id) + sizeof(score) + sizeof(netObjectID) + sizeof(colour) + sizeof(name.length);
+			static const constexpr size_t MaxEncodedSize = FixedEncodedSize + MaxNameLength;
+
+			// out must have room for MaxEncodedSize bytes. Returns the number written
+			size_t encode(char* out) const {
+				char* start = out;
+				auto write = [&](const auto& value) {
+					memcpy(out, &value, sizeof(value));
+					out += sizeof(value);
+				};
+				write(id);
+				write(score);
+				write(netObjectID);
+				write(colour);
+				write(name.length);
+				memcpy(out, name.data, name.length);
+				return out + name.length - start;
+			}
+
+			// Returns the number of bytes read, or 0 if data doesn't hold a valid state
+			static size_t decode(std::span<const char> data, PlayerState& state) {
+				if (data.size() < FixedEncodedSize) {
+					return 0;
+				}
+				const char* in = data.data();
+				auto read = [&](auto& value) {
+					memcpy(&value, in, sizeof(value));
+					in += sizeof(value);
+				};
+				read(state.id);
+				read(state.score);
+				read(state.netObjectID);
+				read(state.colour);
+				read(state.name.length);
+				if (state.name.length > MaxNameLength || data.size() < FixedEncodedSize + state.name.length) {
+					return 0;
+				}
+				memset(state.name.data, 0, MaxNameLength);
+				memcpy(state.name.data, in, state.name.length);
+				return FixedEncodedSize + state.name.length;
+			}
 		};
 		struct LocalPlayerState {
 			PlayerState netState;
@@ -58,19 +102,47 @@ namespace NCL {
 			LocalPlayerState(PlayerState netState) : netState(netState), player(nullptr) {}
 		};
 
+		// Variable length, only the encoded states are sent
 		struct PlayerListPacket : public GamePacket {
-			char count;
-			PlayerState playerStates[MaxPlayers];
+			// Every client, plus the host
+			static const constexpr int MaxListed = MaxPlayers + 1;
+			// An empty list
+			static const constexpr size_t MinSize = sizeof(GamePacket) + sizeof(unsigned char);
+
+			unsigned char count;
+			char data[MaxListed * PlayerState::MaxEncodedSize];
 
 			PlayerListPacket(const std::map<int, LocalPlayerState>& players) : GamePacket(Type::PlayerList) {
-				size = sizeof(PlayerListPacket) - sizeof(GamePacket);
-				count = (char)players.size();
+				if (players.size() > MaxListed) {
+					throw std::runtime_error("Too many players for a player list packet!");
+				}
+				count = (unsigned char)players.size();
 
-				int i = 0;
+				size_t used = 0;
 				for (auto& player : players) {
-					playerStates[i] = player.second.netState;
-					i++;
+					used += player.second.netState.encode(data + used);
 				}
+				size = (short)(sizeof(count) + used);
+			}
+
+			// Only reads within GetTotalSize(), so is safe on a received packet
+			// Returns false if the list is malformed
+			bool read(std::vector<PlayerState>& states) const {
+				if (size < (short)sizeof(count) || (size_t)size - sizeof(count) > sizeof(data)) {
+					return false;
+				}
+				std::span<const char> remaining(data, size - sizeof(count));
+				states.clear();
+				for (int i = 0; i < count; i++) {
+					PlayerState state;
+					size_t used = PlayerState::decode(remaining, state);
+					if (used == 0) {
+						return false;
+					}
+					states.push_back(state);
+					remaining = remaining.subspan(used);
+				}
+				return remaining.empty();
 			}
 		};
 
@@ -93,9 +165,12 @@ namespace NCL {
 			bool gameEnded;
 			float timeElapsed;
 			float timeLimit;
-			ServerHelloPacket(PlayerState state, bool gameEnded, float timeElapsed, float timeLimit) : GamePacket(Type::ServerHello) {
+			// NetworkBase::Feature flags the server has agreed to use
+			unsigned char features;
+			ServerHelloPacket(PlayerState state, bool gameEnded, float timeElapsed, float timeLimit, unsigned char features) : GamePacket(Type::ServerHello) {
 				size = sizeof(ServerHelloPacket) - sizeof(GamePacket);
 				whoAmI = state;
+				this->features = features;
 				this->gameEnded = gameEnded;
 				this->timeElapsed = timeElapsed;
 				this->timeLimit = timeLimit;
@@ -104,8 +179,11 @@ namespace NCL {
 
 		struct ClientHelloPacket : public GamePacket {
 			SizedString<MaxNameLength> name;
+			// NetworkBase::Feature flags the client supports
+			unsigned char features;
 			ClientHelloPacket() : GamePacket(Type::ClientHello) {
 				size = sizeof(ClientHelloPacket) - sizeof(GamePacket);
+				features = NetworkBase::SupportedFeatures;
 			}
 		};
 
@@ -145,6 +223,11 @@ namespace NCL {
 
 			const static constexpr int PlayerIdStart = NetworkWorld::ManualIdStart + 1000;
 
+			// Where StartLevel builds the maze, bots build the same walls to predict against
+			const static constexpr char MazeFile[] = "maze.txt";
+			const static constexpr Vector3 MazeOffset = Vector3(32, 0, 32);
+			const static constexpr float MazeWallHeight = 20;
+
 			NetworkPlayer* SpawnPlayer(PlayerState state);
 			// Spawn player objects for all clients that don't have one
 			void SpawnMissingPlayers();
@@ -170,7 +253,7 @@ namespace NCL {
 
 			void StartLevel();
 
-			void ReceivePacket(GamePacket::Type type, GamePacket* payload, int source) override;
+			void ReceivePacket(GamePacket::Type type, std::span<enet_uint8> packet, int source) override;
 
 			void OnPlayerCollision(NetworkPlayer* a, NetworkPlayer* b);
 
@@ -217,9 +300,14 @@ namespace NCL {
 			void ProcessPacket(PlayerListPacket* payload);
 			void ProcessPacket(ServerHelloPacket* payload);
 			void ProcessPacket(DestroyPacket* payload);
+			void ProcessPacket(InputAckPacket* payload);
 
 			void UpdateAsClient(float dt);
 
+			// The server or client, whichever is running
+			NetworkBase* getNetworkBase() const;
+			void writeNetworkProfile() const;
+
 			void UpdateMinimumState();
 			std::map<int, int> stateIDs;
 
@@ -231,7 +319,7 @@ namespace NCL {
 
 			// TODO: Make this a Server class
 			// Tick every n seconds
-			float inverseTickRate = 1.0f / 60.0f;
+			float inverseTickRate;
 
 
 			// TODO: Make this a Client class
@@ -245,7 +333,13 @@ namespace NCL {
 
 			float timeToNextPacket;
 
-			int inputIndex = 0;
+			// Kept between frames, so it carries the last few inputs
+			ClientPacket inputPacket;
+			// Inputs we've applied locally but the server hasn't acknowledged
+			ClientPrediction prediction;
+			// Server tick of the state shown in the last frame drawn, sent back with inputs for lag compensation
+			// Inputs are sampled before this frame's draw, so they react to the previous one
+			int renderedTick = -1;
 
 			std::map<int, LocalPlayerState> allPlayers;
 			const static constexpr int InvalidPlayerId = -2;
@@ -253,6 +347,7 @@ namespace NCL {
 			int localPlayerId = InvalidPlayerId;
 
 			bool freeCam = false;
+			bool showNetworkStats = false;
 
 			int totalBonusCount = 0;
 			int kittensSaved = 0;
@@ -0,0 +1,893 @@
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "AABBVolume.h"
+#include "Assets.h"
+#include "Camera.h"
+#include "CpuSkinner.h"
+#include "Debug.h"
+#include "Float4.h"
+#include "GameObject.h"
+#include "GameWorld.h"
+#include "InstanceBatcher.h"
+#include "LodBuilder.h"
+#include "LodSelector.h"
+#include "Mesh.h"
+#include "MeshSimplifier.h"
+#include "MshLoader.h"
+#include "OBBVolume.h"
+#include "Pose.h"
+#include "RenderCulling.h"
+#include "RenderObject.h"
+#include "RenderQueue.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "Transform.h"
+#include "SphereVolume.h"
+#include "StreamRing.h"
+#include "WorkerPool.h"
+
+namespace NCL::CSC8503::Benchmarks {
+	namespace {
+		// Culled in clip space instead of against frustum planes: a box is only
+		// outside if all 8 corners are past the same clip plane. In doubles, as
+		// the far plane test cancels out most of a float's precision
+		bool referenceVisible(const Matrix4& viewProj, const Vector3& position, const Vector3& halfSize) {
+			double corners[8][4];
+			for (int i = 0; i < 8; i++) {
+				double corner[4] = {
+					position.x + (double)(i & 1 ? halfSize.x : -halfSize.x),
+					position.y + (double)(i & 2 ? halfSize.y : -halfSize.y),
+					position.z + (double)(i & 4 ? halfSize.z : -halfSize.z),
+					1.0
+				};
+				for (int row = 0; row < 4; row++) {
+					corners[i][row] = 0.0;
+					for (int col = 0; col < 4; col++) {
+						corners[i][row] += (double)viewProj.array[col][row] * corner[col];
+					}
+				}
+			}
+			for (int axis = 0; axis < 3; axis++) {
+				for (double side : { -1.0, 1.0 }) {
+					bool allOutside = true;
+					for (const auto& c : corners) {
+						if (side * c[axis] < c[3]) {
+							allOutside = false;
+							break;
+						}
+					}
+					if (allOutside) {
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		// Stand ins for GPU resources, the queue only ever compares their addresses
+		class StubMesh : public Mesh {
+		public:
+			void UploadToGPU(Rendering::RendererBase* renderer) override {}
+		};
+		class StubTexture : public Texture {
+		};
+		class StubShader : public Shader {
+		public:
+			void ReloadShader() override {}
+		};
+
+		// The obvious way to pose a joint, walking up to the root every time
+		Matrix4 referenceModel(const Mesh& mesh, const std::vector<Matrix4>& local, int joint) {
+			const std::vector<int>& parents = mesh.GetJointParents();
+			int parent = joint < (int)parents.size() ? parents[joint] : -1;
+			return parent < 0 ? local[joint] : referenceModel(mesh, local, parent) * local[joint];
+		}
+
+		// Skinning a vertex at a time with whole matrices
+		void referenceSkin(const Mesh& mesh, const std::vector<Matrix4>& palette, SkinnedVertices& out) {
+			const std::vector<Vector3>& positions	= mesh.GetPositionData();
+			const std::vector<Vector3>& normals		= mesh.GetNormalData();
+			out.positions.resize(positions.size());
+			out.normals.resize(normals.size());
+			for (size_t v = 0; v < positions.size(); v++) {
+				Matrix4 blended;
+				for (int col = 0; col < 4; col++) {
+					for (int row = 0; row < 4; row++) {
+						blended.array[col][row] = 0.0f;
+						for (int i = 0; i < 4; i++) {
+							blended.array[col][row] += mesh.GetSkinWeightData()[v][i] * palette[mesh.GetSkinIndexData()[v][i]].array[col][row];
+						}
+					}
+				}
+				Vector4 p = blended * Vector4(positions[v].x, positions[v].y, positions[v].z, 1.0f);
+				out.positions[v] = Vector3(p.x, p.y, p.z);
+				if (!normals.empty()) {
+					Vector4 n = blended * Vector4(normals[v].x, normals[v].y, normals[v].z, 0.0f);
+					out.normals[v] = Vector::Normalise(Vector3(n.x, n.y, n.z));
+				}
+			}
+		}
+
+		// Each joint swinging back and forth around its own axis
+		void wavePose(const Skeleton& skeleton, float time, std::vector<Matrix4>& local) {
+			for (size_t joint = 0; joint < skeleton.GetJointCount(); joint++) {
+				Vector3 axis = Vector::Normalise(Vector3(1.0f, (float)(joint % 3), (float)(joint % 5) - 2.0f));
+				local[joint] = skeleton.GetLocalBindPose()[joint] * Matrix::Rotation(25.0f * std::sin(time * 3.0f + joint), axis);
+			}
+		}
+
+		float largestDifference(const std::vector<Vector3>& a, const std::vector<Vector3>& b) {
+			float largest = 0.0f;
+			for (size_t i = 0; i < a.size(); i++) {
+				largest = std::max(largest, Vector::Length(a[i] - b[i]));
+			}
+			return largest;
+		}
+
+		float largestDifference(const std::vector<Matrix4>& a, const std::vector<Matrix4>& b) {
+			float largest = 0.0f;
+			for (size_t i = 0; i < a.size(); i++) {
+				for (int col = 0; col < 4; col++) {
+					for (int row = 0; row < 4; row++) {
+						largest = std::max(largest, std::abs(a[i].array[col][row] - b[i].array[col][row]));
+					}
+				}
+			}
+			return largest;
+		}
+	}
+
+	void frustumCulling() {
+		const int GridSize = 224;
+		const float Spacing = 8.0f;
+		const float AspectRatio = 16.0f / 9.0f;
+
+		// A big flat level of mixed shapes, with a few objects that have nothing to cull by
+		GameWorld world;
+		std::mt19937 rng(1);
+		std::uniform_real_distribution<float> height(0.0f, 20.0f);
+		std::uniform_real_distribution<float> size(0.5f, 3.0f);
+		std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+		for (int x = 0; x < GridSize; x++) {
+			for (int z = 0; z < GridSize; z++) {
+				GameObject* object = new GameObject();
+				Vector3 position((x - GridSize / 2) * Spacing, height(rng), (z - GridSize / 2) * Spacing);
+				object->GetTransform().SetPosition(position);
+				switch ((x + z) % 4) {
+				case 0:
+					object->SetBoundingVolume((CollisionVolume*)new AABBVolume(Vector3(size(rng), size(rng), size(rng))));
+					break;
+				case 1:
+					object->SetBoundingVolume((CollisionVolume*)new SphereVolume(size(rng)));
+					break;
+				case 2:
+					object->GetTransform().SetOrientation(Quaternion::EulerAnglesToQuaternion(0, angle(rng), 0));
+					object->SetBoundingVolume((CollisionVolume*)new OBBVolume(Vector3(size(rng), size(rng), size(rng))));
+					break;
+				default:
+					if (z % 64 != 3) {
+						object->SetBoundingVolume((CollisionVolume*)new SphereVolume(size(rng)));
+					}
+					break;
+				}
+				object->SetRenderObject(new RenderObject(&object->GetTransform(), nullptr, nullptr, nullptr));
+				world.AddGameObject(object);
+			}
+		}
+
+		// Scripted camera poses: ground level looking across, high up looking down, and facing out of the level
+		struct Pose {
+			Vector3 position;
+			float pitch;
+			float yaw;
+		};
+		const std::vector<Pose> poses = {
+			{ Vector3(0, 5, 0), 0, 0 },
+			{ Vector3(0, 5, 0), -10, 90 },
+			{ Vector3(400, 30, 400), -20, 45 },
+			{ Vector3(-800, 10, -800), 0, 225 },
+			{ Vector3(0, 300, 0), -89, 0 },
+			{ Vector3(100, 60, -300), -35, 160 },
+		};
+		PerspectiveCamera camera;
+		camera.SetNearPlane(0.1f);
+		camera.SetFarPlane(500.0f);
+
+		// Same light as GameTechRenderer
+		Matrix4 shadowViewProj = Matrix::Perspective(100.0f, 500.0f, 1.0f, 45.0f)
+			* Matrix::View(Vector3(-200.0f, 60.0f, -200.0f), Vector3(0, 0, 0), Vector3(0, 1, 0));
+
+		std::vector<std::vector<RenderCuller::View>> poseViews(poses.size(), std::vector<RenderCuller::View>(2));
+		std::vector<Matrix4> viewProjs;
+		for (size_t p = 0; p < poses.size(); p++) {
+			camera.SetPosition(poses[p].position).SetPitch(poses[p].pitch).SetYaw(poses[p].yaw);
+			Matrix4 viewProj = camera.BuildProjectionMatrix(AspectRatio) * camera.BuildViewMatrix();
+			viewProjs.push_back(viewProj);
+			poseViews[p][0].frustum = Frustum::FromViewProjMatrix(viewProj);
+			poseViews[p][1].frustum = Frustum::FromViewProjMatrix(shadowViewProj);
+		}
+
+		RenderCuller serial(nullptr);
+		// Checked with a few threads even on a single core machine, where the shared pool has none
+		WorkerPool checkPool(std::max<size_t>(WorkerPool::DefaultThreadCount(), 3));
+		RenderCuller parallel(&checkPool);
+
+		// The parallel lists must match the serial ones exactly
+		// Against the reference, a visible object being culled is a bug. Keeping one that
+		// could have been culled only costs a draw, and happens within float error of a plane
+		size_t orderMismatches = 0;
+		size_t wronglyCulled = 0;
+		size_t wronglyKept = 0;
+		GameObjectIterator first;
+		GameObjectIterator last;
+		world.GetObjectIterators(first, last);
+		for (size_t p = 0; p < poses.size(); p++) {
+			std::vector<RenderCuller::View> serialViews = poseViews[p];
+			serial.cull(world, serialViews);
+			parallel.cull(world, poseViews[p]);
+
+			const Matrix4 matrices[2] = { viewProjs[p], shadowViewProj };
+			for (size_t v = 0; v < 2; v++) {
+				if (serialViews[v].visible != poseViews[p][v].visible) {
+					orderMismatches++;
+				}
+				// Both lists are in world order
+				const std::vector<RenderObject*>& visible = poseViews[p][v].visible;
+				auto next = visible.begin();
+				for (auto i = first; i != last; ++i) {
+					bool culled = next == visible.end() || *next != (*i)->GetRenderObject();
+					if (!culled) {
+						++next;
+					}
+					Vector3 halfSize;
+					bool expected = !(*i)->GetBroadphaseAABB(halfSize) || referenceVisible(matrices[v], (*i)->GetTransform().GetPosition(), halfSize);
+					wronglyCulled += expected && culled;
+					wronglyKept += !expected && !culled;
+				}
+			}
+
+			const RenderCuller::View& view = poseViews[p][0];
+			std::cout << "Pose " << p << ": camera drew " << view.visible.size() << "/" << parallel.getTotalCount()
+				<< ", shadow drew " << poseViews[p][1].visible.size() << "\n";
+		}
+		std::cout << "Objects without bounds: " << parallel.getUnboundedCount() << "\n";
+		std::cout << "Views where parallel differs from serial: " << orderMismatches << "\n";
+		std::cout << "Against the clip space reference: " << wronglyCulled << " visible objects culled, "
+			<< wronglyKept << " hidden objects kept\n";
+
+		auto cullAllPoses = [&](RenderCuller& culler) {
+			for (auto& views : poseViews) {
+				culler.cull(world, views);
+			}
+		};
+		parallel.setPool(&WorkerPool::Get());
+		double serialSeconds = timeRepeated([&]() { cullAllPoses(serial); }) / poses.size();
+		double parallelSeconds = timeRepeated([&]() { cullAllPoses(parallel); }) / poses.size();
+
+		std::cout << std::fixed << std::setprecision(3);
+		std::cout << "Serial: " << serialSeconds * 1000.0 << "ms per frame (camera and shadow)\n";
+		std::cout << "Parallel: " << parallelSeconds * 1000.0 << "ms per frame on "
+			<< WorkerPool::Get().getThreadCount() + 1 << " threads ("
+			<< std::setprecision(2) << serialSeconds / parallelSeconds << "x)\n";
+
+		world.ClearAndErase();
+	}
+
+	void renderQueueSort() {
+		const int DrawCount = 20000;
+		const int ShaderCount = 6;
+		const int TextureCount = 40;
+		const int MeshCount = 30;
+
+		std::vector<StubShader> shaders(ShaderCount);
+		std::vector<StubTexture> textures(TextureCount);
+		std::vector<StubMesh> meshes(MeshCount);
+
+		// Objects in the order they were added to the world, with resources picked at random
+		std::mt19937 rng(1);
+		std::uniform_real_distribution<float> coord(-200.0f, 200.0f);
+		std::vector<Transform> transforms(DrawCount);
+		std::vector<RenderObject> objects;
+		objects.reserve(DrawCount);
+		for (int i = 0; i < DrawCount; i++) {
+			transforms[i].SetPosition(Vector3(coord(rng), coord(rng) * 0.1f, coord(rng)));
+			int texture = (int)(rng() % (TextureCount + TextureCount / 3));
+			objects.emplace_back(&transforms[i], &meshes[rng() % MeshCount],
+				texture < TextureCount ? &textures[texture] : nullptr, &shaders[rng() % ShaderCount]);
+			if (i % 50 == 0) {
+				objects.back().SetColour(Vector4(1, 1, 1, 0.5f));
+			}
+		}
+		std::vector<const RenderObject*> visible;
+		for (const RenderObject& object : objects) {
+			visible.push_back(&object);
+		}
+
+		auto fillQueue = [&](RenderQueue& queue) {
+			queue.begin(Vector3(0, 10, 0), 500.0f);
+			queue.add(RenderQueue::Pass::Shadow, visible);
+			for (const RenderObject* object : visible) {
+				queue.add(object->GetColour().w < 1.0f ? RenderQueue::Pass::Transparent : RenderQueue::Pass::Opaque, *object);
+			}
+		};
+
+		RenderQueue queue;
+		fillQueue(queue);
+		queue.sort();
+
+		// Keys must come out in order, every draw exactly once
+		std::vector<RenderQueue::Item> sorted;
+		for (size_t pass = 0; pass < (size_t)RenderQueue::Pass::Count; pass++) {
+			for (const RenderQueue::Item& item : queue.getItems((RenderQueue::Pass)pass)) {
+				sorted.push_back(item);
+			}
+		}
+		size_t outOfOrder = 0;
+		for (size_t i = 1; i < sorted.size(); i++) {
+			outOfOrder += sorted[i - 1].key > sorted[i].key;
+		}
+		std::cout << "Queued " << sorted.size() << "/" << DrawCount * 2 << " draws, " << outOfOrder << " out of order\n";
+
+		// What the old loop bound: a shader, texture and mesh for every object
+		size_t textured = 0;
+		size_t worldShaderChanges = 0;
+		for (size_t i = 0; i < visible.size(); i++) {
+			textured += visible[i]->GetDefaultTexture() != nullptr;
+			worldShaderChanges += i == 0 || visible[i]->GetShader() != visible[i - 1]->GetShader();
+		}
+		RenderQueue::Stats opaque = queue.forEachDraw(RenderQueue::Pass::Opaque, [](auto&, auto) {});
+		RenderQueue::Stats transparent = queue.forEachDraw(RenderQueue::Pass::Transparent, [](auto&, auto) {});
+		RenderQueue::Stats shadow = queue.forEachDraw(RenderQueue::Pass::Shadow, [](auto&, auto) {});
+
+		std::cout << "Camera draws: " << visible.size() << " (" << ShaderCount << " shaders, "
+			<< TextureCount << " textures, " << MeshCount << " meshes)\n";
+		std::cout << "World order: " << visible.size() << " shader, " << textured << " texture, " << visible.size()
+			<< " mesh binds, uniforms looked up on " << worldShaderChanges << " shader changes\n";
+		std::cout << "Sorted opaque: " << opaque.shaderChanges << " shader, " << opaque.textureChanges << " texture, "
+			<< opaque.meshChanges << " mesh binds for " << opaque.draws << " draws\n";
+		std::cout << "Sorted transparent, back to front: " << transparent.shaderChanges << " shader, " << transparent.textureChanges
+			<< " texture, " << transparent.meshChanges << " mesh binds for " << transparent.draws << " draws\n";
+		std::cout << "Shadow pass: " << shadow.meshChanges << " mesh binds for " << shadow.draws << " draws\n";
+
+		// Sorting alone, radix against a comparison sort of the same items
+		// Radix sorting is stable, so both must give exactly the same order
+		std::vector<RenderQueue::Item> keys(sorted);
+		std::shuffle(keys.begin(), keys.end(), rng);
+		auto byKey = [](const RenderQueue::Item& a, const RenderQueue::Item& b) {
+			return a.key < b.key;
+		};
+		std::vector<RenderQueue::Item> radixSorted(keys);
+		std::vector<RenderQueue::Item> stdSorted(keys);
+		std::vector<RenderQueue::Item> scratch;
+		RenderQueue::RadixSort(radixSorted, scratch);
+		std::stable_sort(stdSorted.begin(), stdSorted.end(), byKey);
+		size_t orderMismatches = 0;
+		for (size_t i = 0; i < keys.size(); i++) {
+			orderMismatches += radixSorted[i].key != stdSorted[i].key || radixSorted[i].object != stdSorted[i].object;
+		}
+		std::cout << "Radix sort differs from std::stable_sort at " << orderMismatches << " places\n";
+
+		std::vector<RenderQueue::Item> work;
+		double radixSeconds = timeRepeated([&]() {
+			work = keys;
+			RenderQueue::RadixSort(work, scratch);
+		});
+		double stdSeconds = timeRepeated([&]() {
+			work = keys;
+			std::stable_sort(work.begin(), work.end(), byKey);
+		});
+		double fillSeconds = timeRepeated([&]() {
+			fillQueue(queue);
+			queue.sort();
+		});
+		std::cout << std::fixed << std::setprecision(3);
+		std::cout << "Radix sort: " << radixSeconds * 1000.0 << "ms, std::stable_sort: " << stdSeconds * 1000.0
+			<< "ms for " << keys.size() << " keys\n";
+		std::cout << "Build and sort both passes: " << fillSeconds * 1000.0 << "ms\n";
+	}
+
+	void instanceBatching() {
+		// Roughly a level of the game: lots of the same few things, in random colours
+		struct Group {
+			const char* name;
+			int count;
+			int mesh;
+			int texture;
+		};
+		const std::vector<Group> groups = {
+			{ "walls", 2000, 0, 0 },
+			{ "kittens", 500, 1, 1 },
+			{ "bonuses", 100, 2, 1 },
+			{ "players", 4, 3, 1 },
+			{ "floor", 1, 0, 2 },
+		};
+		std::vector<StubMesh> meshes(4);
+		std::vector<StubTexture> textures(3);
+		StubShader shader;
+
+		std::mt19937 rng(1);
+		std::uniform_real_distribution<float> coord(-200.0f, 200.0f);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::vector<Transform> transforms;
+		for (const Group& group : groups) {
+			for (int i = 0; i < group.count; i++) {
+				transforms.emplace_back().SetPosition(Vector3(coord(rng), 0, coord(rng)));
+			}
+		}
+		std::vector<RenderObject> objects;
+		objects.reserve(transforms.size());
+		size_t t = 0;
+		for (const Group& group : groups) {
+			for (int i = 0; i < group.count; i++, t++) {
+				objects.emplace_back(&transforms[t], &meshes[group.mesh], &textures[group.texture], &shader);
+				objects.back().SetColour(Vector4(unit(rng), unit(rng), unit(rng), 1.0f));
+			}
+		}
+		// Interleaved, as objects are added to the world as the level is built
+		std::vector<const RenderObject*> visible;
+		for (const RenderObject& object : objects) {
+			visible.push_back(&object);
+		}
+		std::shuffle(visible.begin(), visible.end(), rng);
+
+		RenderQueue queue;
+		InstanceBatcher batcher;
+		auto build = [&]() {
+			queue.begin(Vector3(0, 10, 0), 500.0f);
+			queue.add(RenderQueue::Pass::Shadow, visible);
+			queue.add(RenderQueue::Pass::Opaque, visible);
+			queue.sort();
+			batcher.build(queue);
+		};
+		build();
+
+		// Every object must be packed once, into a batch that shares its state
+		size_t packingErrors = 0;
+		size_t nextInstance = 0;
+		std::span<const InstanceBatcher::Instance> instances = batcher.getInstances();
+		for (RenderQueue::Pass pass : { RenderQueue::Pass::Shadow, RenderQueue::Pass::Opaque }) {
+			std::span<const RenderQueue::Item> items = queue.getItems(pass);
+			size_t item = 0;
+			for (const InstanceBatcher::Batch& batch : batcher.getBatches(pass)) {
+				packingErrors += batch.firstInstance != nextInstance;
+				for (uint32_t i = 0; i < batch.instanceCount; i++, item++) {
+					const RenderObject& object = *items[item].object;
+					const InstanceBatcher::Instance& instance = instances[batch.firstInstance + i];
+					packingErrors += object.GetMesh() != batch.object->GetMesh();
+					if (pass != RenderQueue::Pass::Shadow) {
+						packingErrors += object.GetShader() != batch.object->GetShader() || object.GetDefaultTexture() != batch.object->GetDefaultTexture();
+					}
+					Matrix4 model = object.GetTransform()->GetMatrix();
+					Vector4 colour = object.GetColour();
+					packingErrors += memcmp(&instance.modelMatrix, &model, sizeof(Matrix4)) != 0;
+					packingErrors += memcmp(&instance.colour, &colour, sizeof(Vector4)) != 0;
+				}
+				nextInstance += batch.instanceCount;
+			}
+			packingErrors += item != items.size();
+		}
+		std::cout << "Packing errors: " << packingErrors << "\n";
+
+		size_t cameraBatches = batcher.getBatches(RenderQueue::Pass::Opaque).size();
+		size_t shadowBatches = batcher.getBatches(RenderQueue::Pass::Shadow).size();
+		std::cout << "Camera: " << visible.size() << " objects in " << cameraBatches << " draw calls\n";
+		std::cout << "Shadow: " << visible.size() << " objects in " << shadowBatches << " draw calls\n";
+		// Before, each camera draw set the model, shadow and colour uniforms, and each shadow draw its MVP
+		std::cout << "Per object uniform uploads: " << visible.size() * 4 << " before, "
+			<< cameraBatches + shadowBatches << " instance offsets now, plus "
+			<< instances.size_bytes() / 1024 << "KB of instance data in one upload\n";
+
+		double buildSeconds = timeRepeated(build);
+		std::cout << std::fixed << std::setprecision(3);
+		std::cout << "Queue, sort and batch both passes: " << buildSeconds * 1000.0 << "ms\n";
+	}
+
+	void debugStreaming() {
+		// The ring has to keep each frame's writes inside its own region, clear of
+		// the regions the GPU may still be reading from the frames before it
+		const size_t RegionSize = 64 * 1024;
+		StreamRing ring(RegionSize);
+		std::mt19937 rng(1);
+		std::uniform_int_distribution<size_t> allocSize(1, 4096);
+		std::uniform_int_distribution<size_t> alignPower(2, 8);
+
+		size_t ringErrors = 0;
+		size_t allocations = 0;
+		size_t wasted = 0;
+		std::vector<size_t> recentRegions;
+		for (int frame = 0; frame < 1000; frame++) {
+			size_t region = ring.BeginFrame();
+			ringErrors += std::find(recentRegions.begin(), recentRegions.end(), region) != recentRegions.end();
+			recentRegions.insert(recentRegions.begin(), region);
+			recentRegions.resize(std::min(recentRegions.size(), ring.GetRegionCount() - 1));
+
+			size_t regionStart = region * ring.GetRegionSize();
+			size_t regionEnd = regionStart + ring.GetRegionSize();
+			size_t previousEnd = regionStart;
+			while (true) {
+				size_t size = allocSize(rng);
+				size_t alignment = size_t(1) << alignPower(rng);
+				size_t offset = ring.Allocate(size, alignment);
+				if (offset == StreamRing::NoSpace) {
+					// Only allowed to fail if the allocation really wouldn't fit
+					ringErrors += previousEnd + size + alignment <= regionEnd;
+					wasted += regionEnd - previousEnd;
+					break;
+				}
+				ringErrors += offset % alignment != 0;
+				ringErrors += offset < previousEnd || offset + size > regionEnd;
+				previousEnd = offset + size;
+				allocations++;
+			}
+			ringErrors += ring.EndFrame() != region;
+		}
+		std::cout << "Ring errors: " << ringErrors << " over " << allocations << " allocations, "
+			<< std::fixed << std::setprecision(1) << 100.0 * wasted / (1000.0 * RegionSize) << "% of each region left at the end\n";
+
+		// A busy debug frame: the stats overlay, plus the bounding boxes of a few hundred objects
+		const int StringCount = 60;
+		const int BoxCount = 400;
+		StubTexture fontTexture;
+		if (!Debug::GetDebugFont()) {
+			Debug::CreateDebugFont("PressStart2P.fnt", fontTexture);
+		}
+		SimpleFont& font = *Debug::GetDebugFont();
+
+		std::vector<std::string> strings;
+		for (int i = 0; i < StringCount; i++) {
+			strings.push_back("Object " + std::to_string(i * 37) + " at (" + std::to_string(i) + ", " + std::to_string(i * 2) + ")");
+		}
+		std::uniform_real_distribution<float> coord(-200.0f, 200.0f);
+		std::vector<Vector3> boxes;
+		for (int i = 0; i < BoxCount; i++) {
+			boxes.emplace_back(coord(rng), coord(rng), coord(rng));
+		}
+		auto textPosition = [](int i) {
+			return Vector2(5.0f, 5.0f + (i % 30) * 3.0f);
+		};
+
+		// Stand in for the GPU buffers, so both paths pay for getting vertices there
+		std::vector<char> gpu(4 * 1024 * 1024);
+
+		// Before: Print kept each string, and the renderer built three vertex arrays from them
+		// Lines were already kept in vertex layout, so both paths draw them the same way
+		struct StringEntry {
+			std::string	data;
+			Vector2 position;
+			Vector4 colour;
+		};
+		std::vector<StringEntry> oldStrings;
+		std::vector<Vector3> oldPositions;
+		std::vector<Vector4> oldColours;
+		std::vector<Vector2> oldTexCoords;
+		auto oldFrame = [&]() {
+			for (int i = 0; i < StringCount; i++) {
+				oldStrings.push_back({ strings[i], textPosition(i), Debug::WHITE });
+			}
+			for (const Vector3& box : boxes) {
+				Debug::DrawAABB(box, Vector3(1, 1, 1), Debug::GREEN);
+			}
+			oldPositions.clear();
+			oldColours.clear();
+			oldTexCoords.clear();
+			for (const StringEntry& entry : oldStrings) {
+				font.BuildVerticesForString(entry.data, entry.position, entry.colour, Debug::TEXTSIZE, oldPositions, oldTexCoords, oldColours);
+			}
+			std::span<const Debug::DebugLineEntry> lines = Debug::GetDebugLines();
+			char* out = gpu.data();
+			memcpy(out, lines.data(), lines.size_bytes());
+			out += lines.size_bytes();
+			memcpy(out, oldPositions.data(), oldPositions.size() * sizeof(Vector3));
+			out += oldPositions.size() * sizeof(Vector3);
+			memcpy(out, oldColours.data(), oldColours.size() * sizeof(Vector4));
+			out += oldColours.size() * sizeof(Vector4);
+			memcpy(out, oldTexCoords.data(), oldTexCoords.size() * sizeof(Vector2));
+			oldStrings.clear();
+			Debug::UpdateRenderables(1.0f);
+		};
+
+		// Now: Print and DrawLine write vertices into place, which are copied over in one go
+		size_t framePeak = 0;
+		auto newFrame = [&]() {
+			for (int i = 0; i < StringCount; i++) {
+				Debug::Print(strings[i], textPosition(i), Debug::WHITE);
+			}
+			for (const Vector3& box : boxes) {
+				Debug::DrawAABB(box, Vector3(1, 1, 1), Debug::GREEN);
+			}
+			std::span<const Debug::DebugLineEntry> lines = Debug::GetDebugLines();
+			std::span<const SimpleFont::InterleavedTextVertex> text = Debug::GetDebugTextVertices();
+			memcpy(gpu.data(), lines.data(), lines.size_bytes());
+			memcpy(gpu.data() + lines.size_bytes(), text.data(), text.size_bytes());
+			framePeak = lines.size_bytes() + text.size_bytes();
+		};
+
+		// Both paths must give the GPU the same text
+		Debug::UpdateRenderables(1.0f);
+		for (int i = 0; i < StringCount; i++) {
+			oldStrings.push_back({ strings[i], textPosition(i), Debug::WHITE });
+			Debug::Print(strings[i], textPosition(i), Debug::WHITE);
+		}
+		oldPositions.clear();
+		oldColours.clear();
+		oldTexCoords.clear();
+		for (const StringEntry& entry : oldStrings) {
+			font.BuildVerticesForString(entry.data, entry.position, entry.colour, Debug::TEXTSIZE, oldPositions, oldTexCoords, oldColours);
+		}
+		oldStrings.clear();
+		std::span<const SimpleFont::InterleavedTextVertex> text = Debug::GetDebugTextVertices();
+		size_t textErrors = text.size() != oldPositions.size();
+		for (size_t i = 0; i < std::min(text.size(), oldPositions.size()); i++) {
+			textErrors += text[i].pos.x != oldPositions[i].x || text[i].pos.y != oldPositions[i].y;
+			textErrors += text[i].texCoord != oldTexCoords[i];
+			textErrors += text[i].colour != oldColours[i];
+		}
+		std::cout << "Text vertex mismatches: " << textErrors << " of " << text.size() << "\n";
+		Debug::UpdateRenderables(1.0f);
+
+		double oldSeconds = timeRepeated(oldFrame);
+		double newSeconds = timeRepeated([&]() {
+			newFrame();
+			Debug::UpdateRenderables(1.0f);
+		});
+		std::cout << std::setprecision(3);
+		std::cout << StringCount << " strings and " << BoxCount * 12 << " lines, building and copying to the GPU per frame:\n";
+		std::cout << "  Strings kept, then converted: " << oldSeconds * 1000.0 << "ms\n";
+		std::cout << "  Vertices written in place:    " << newSeconds * 1000.0 << "ms (" << oldSeconds / newSeconds << "x)\n";
+		std::cout << "  " << framePeak / 1024 << "KB of debug vertices a frame\n";
+	}
+
+	void meshLods() {
+		// Every mesh the game loads, plus a couple with heavier UV seams
+		const std::vector<std::string> assets = {
+			"Kitten.msh", "ORIGAMI_Chat.msh", "cat.msh", "Keeper.msh", "Goat.msh", "Sphere.msh", "19463_Kitten_Head_v1.msh"
+		};
+		// MeasureError is brute force, so only checks meshes up to this size
+		const size_t MeasuredTriangles = 5000;
+
+		std::cout << std::fixed << std::setprecision(3);
+		size_t levelErrors = 0;
+		StubMesh kitten;
+		for (const std::string& name : assets) {
+			StubMesh mesh;
+			MshLoader::LoadMesh(name, mesh);
+			mesh.SetPrimitiveType(GeometryPrimitive::Triangles);
+			size_t fullIndices = mesh.GetIndexCount();
+
+			auto start = std::chrono::steady_clock::now();
+			LodBuilder::Build(mesh);
+			std::chrono::duration<double> buildTime = std::chrono::steady_clock::now() - start;
+
+			std::cout << name << ": " << buildTime.count() * 1000.0 << "ms, triangles";
+			for (uint32_t level = 0; level < mesh.GetLodCount(); level++) {
+				std::cout << " " << LodSelector::TriangleCount(mesh, level);
+			}
+			std::cout << "\n";
+
+			const std::vector<unsigned int>& indices = mesh.GetIndexData();
+			const std::vector<Vector3>& positions = mesh.GetPositionData();
+			size_t previous = LodSelector::TriangleCount(mesh, 0);
+			for (uint32_t level = 1; level < mesh.GetLodCount(); level++) {
+				const MeshLod& lod = mesh.GetLods()[level - 1];
+				// Levels must be coarser than the last, and their indices after the full mesh's
+				size_t triangles = LodSelector::TriangleCount(mesh, level);
+				levelErrors += triangles >= previous;
+				levelErrors += lod.subMeshes.size() != std::max<size_t>(mesh.GetSubMeshCount(), 1);
+				previous = triangles;
+
+				MeshSimplifier::Level check;
+				for (const SubMesh& sm : lod.subMeshes) {
+					levelErrors += (size_t)sm.start < fullIndices || (size_t)(sm.start + sm.count) > indices.size();
+					for (int i = sm.start; i + 2 < sm.start + sm.count; i += 3) {
+						unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+						if (a >= positions.size() || b >= positions.size() || c >= positions.size()) {
+							levelErrors++;
+							continue;
+						}
+						levelErrors += positions[a] == positions[b] || positions[b] == positions[c] || positions[c] == positions[a];
+						check.indices.insert(check.indices.end(), { a, b, c });
+					}
+				}
+				std::cout << "  Level " << level << ": error " << lod.error;
+				if (LodSelector::TriangleCount(mesh, 0) <= MeasuredTriangles) {
+					// LodSelector takes the error as a distance, so it mustn't claim the level is closer than it is
+					float measured = MeshSimplifier::MeasureError(mesh, check);
+					levelErrors += lod.error < measured;
+					std::cout << ", furthest original vertex " << measured;
+				}
+				std::cout << "\n";
+			}
+			if (name == "Kitten.msh") {
+				MshLoader::LoadMesh(name, kitten);
+				kitten.SetPrimitiveType(GeometryPrimitive::Triangles);
+				LodBuilder::Build(kitten);
+			}
+		}
+		std::cout << "Level errors: " << levelErrors << "\n";
+
+		// A crowd of kittens spread out in front of the camera
+		const int KittenCount = 1000;
+		const float ScreenHeight = 1080.0f;
+		const float FieldOfView = 45.0f;
+		std::mt19937 rng(1);
+		std::uniform_real_distribution<float> across(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> ahead(2.0f, 300.0f);
+		std::vector<Vector3> positions;
+		std::vector<LodState> states(KittenCount);
+		for (int i = 0; i < KittenCount; i++) {
+			positions.emplace_back(across(rng), 0.0f, -ahead(rng));
+		}
+		LodSelector selector;
+		auto selectAll = [&]() {
+			selector.BeginFrame(ScreenHeight, FieldOfView, 1.0f / 60.0f);
+			for (int i = 0; i < KittenCount; i++) {
+				selector.Select(kitten, Vector::Length(positions[i]), 1.0f, states[i]);
+			}
+		};
+		const int Frames = 8;
+		size_t animated = 0;
+		for (int frame = 0; frame < Frames; frame++) {
+			selectAll();
+			animated += selector.GetAnimatedCount();
+		}
+		std::cout << KittenCount << " kittens, levels";
+		for (size_t count : selector.GetLevelCounts()) {
+			std::cout << " " << count;
+		}
+		std::cout << "\n  Triangles: " << selector.GetTriangleCount() << " of " << selector.GetFullTriangleCount() << " ("
+			<< 100.0 * selector.GetTriangleCount() / selector.GetFullTriangleCount() << "%)\n";
+		std::cout << "  Animation updates: " << animated / Frames << " a frame, of " << KittenCount << "\n";
+
+		// Each kitten's animation must still advance by the whole time passed
+		double lostTime = 0.0;
+		double totalTime = 0.0;
+		for (int i = 0; i < KittenCount; i++) {
+			LodState state;
+			for (int frame = 0; frame < 64; frame++) {
+				selector.BeginFrame(ScreenHeight, FieldOfView, 1.0f / 60.0f);
+				selector.Select(kitten, Vector::Length(positions[i]), 1.0f, state);
+				totalTime += state.animationDelta;
+			}
+			lostTime += state.bankedTime;
+		}
+		std::cout << "  Animation time played " << totalTime << "s, banked " << lostTime << "s, of " << KittenCount * 64 / 60.0f << "s passed\n";
+
+		// A kitten wobbling around the distance where it switches to level 1
+		// shouldn't flicker between levels every frame
+		float pixelScale = ScreenHeight / (2.0f * std::tan(FieldOfView * 0.5f * 3.14159265f / 180.0f));
+		float switchDistance = kitten.GetLodError(1) * pixelScale / selector.GetPixelTolerance();
+		for (float hysteresis : { 0.0f, 0.25f }) {
+			LodSelector wobbly(1.0f, hysteresis);
+			LodState state;
+			int changes = 0;
+			uint32_t last = 0;
+			for (int frame = 0; frame < 1000; frame++) {
+				float distance = switchDistance * (1.0f + 0.05f * std::sin(frame * 0.7f));
+				wobbly.BeginFrame(ScreenHeight, FieldOfView, 1.0f / 60.0f);
+				uint32_t level = wobbly.Select(kitten, distance, 1.0f, state);
+				changes += level != last;
+				last = level;
+			}
+			std::cout << "Level changes wobbling 5% around " << switchDistance << " units, hysteresis " << hysteresis << ": " << changes << " in 1000 frames\n";
+		}
+
+		double selectSeconds = timeRepeated(selectAll);
+		std::cout << "Selecting " << KittenCount << " kittens: " << selectSeconds * 1000.0 << "ms\n";
+	}
+
+	void skinning() {
+		const int CatCount = 200;
+		std::cout << std::fixed << std::setprecision(3);
+
+		// Checked against the reference on every rigged mesh we ship
+		std::vector<std::string> rigged;
+		for (const auto& entry : std::filesystem::directory_iterator(Assets::MESHDIR)) {
+			if (entry.path().extension() != ".msh") {
+				continue;
+			}
+			StubMesh mesh;
+			MshLoader::LoadMesh(entry.path().filename().string(), mesh);
+			if (mesh.GetBindPose().empty()) {
+				continue;
+			}
+			rigged.push_back(entry.path().filename().string());
+
+			Skeleton skeleton(mesh);
+			Pose pose(skeleton);
+			SkinnedVertices skinned;
+			CpuSkinner::Skin(mesh, pose.GetPalette(), skinned);
+			float bindError = largestDifference(mesh.GetPositionData(), skinned.positions);
+
+			std::vector<Matrix4> local(skeleton.GetJointCount());
+			std::vector<Matrix4> referencePalette(skeleton.GetJointCount());
+			SkinnedVertices reference;
+			float largestMove = 0.0f;
+			float paletteError = 0.0f;
+			float positionError = 0.0f;
+			float normalError = 0.0f;
+			for (float time = 0.0f; time < 2.0f; time += 0.1f) {
+				wavePose(skeleton, time, local);
+				pose.GetLocalTransforms() = local;
+				pose.Evaluate();
+				CpuSkinner::Skin(mesh, pose.GetPalette(), skinned);
+
+				for (size_t joint = 0; joint < skeleton.GetJointCount(); joint++) {
+					referencePalette[joint] = referenceModel(mesh, local, (int)joint) * mesh.GetInverseBindPose()[joint];
+				}
+				referenceSkin(mesh, referencePalette, reference);
+				largestMove		= std::max(largestMove, largestDifference(mesh.GetPositionData(), reference.positions));
+				paletteError	= std::max(paletteError, largestDifference(referencePalette, pose.GetPalette()));
+				positionError	= std::max(positionError, largestDifference(reference.positions, skinned.positions));
+				normalError		= std::max(normalError, largestDifference(reference.normals, skinned.normals));
+			}
+			std::cout << rigged.back() << ": " << skeleton.GetJointCount() << " joints, " << mesh.GetVertexCount() << " vertices\n"
+				<< std::defaultfloat << "  Bind pose moves vertices by " << bindError << ", posing by up to " << largestMove << "\n"
+				<< "  Largest difference from reference: palette " << paletteError << ", positions " << positionError
+				<< ", normals " << normalError << std::fixed << "\n";
+		}
+		if (rigged.empty()) {
+			std::cout << "No rigged meshes found in " << Assets::MESHDIR << "\n";
+			return;
+		}
+
+		// A crowd of the first rigged mesh, each at its own point in the wave
+		StubMesh mesh;
+		MshLoader::LoadMesh(rigged[0], mesh);
+		Skeleton skeleton(mesh);
+		std::vector<Pose> poses(CatCount, Pose(skeleton));
+		std::vector<SkinnedVertices> skinned(CatCount);
+		std::vector<std::vector<Matrix4>> locals(CatCount, std::vector<Matrix4>(skeleton.GetJointCount()));
+		for (int i = 0; i < CatCount; i++) {
+			wavePose(skeleton, i * 0.037f, locals[i]);
+		}
+
+		std::vector<Matrix4> referencePalette(skeleton.GetJointCount());
+		double referenceTime = timeRepeated([&]() {
+			for (int i = 0; i < CatCount; i++) {
+				for (size_t joint = 0; joint < skeleton.GetJointCount(); joint++) {
+					referencePalette[joint] = referenceModel(mesh, locals[i], (int)joint) * mesh.GetInverseBindPose()[joint];
+				}
+				referenceSkin(mesh, referencePalette, skinned[i]);
+			}
+		}, 0.2);
+		auto poseAndSkin = [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				poses[i].GetLocalTransforms() = locals[i];
+				poses[i].Evaluate();
+				CpuSkinner::Skin(mesh, poses[i].GetPalette(), skinned[i]);
+			}
+		};
+		double evaluateTime = timeRepeated([&]() {
+			for (int i = 0; i < CatCount; i++) {
+				poses[i].GetLocalTransforms() = locals[i];
+				poses[i].Evaluate();
+			}
+		}, 0.2);
+		double serialTime = timeRepeated([&]() {
+			poseAndSkin(0, CatCount);
+		}, 0.2);
+		WorkerPool& pool = WorkerPool::Get();
+		double parallelTime = timeRepeated([&]() {
+			pool.parallelFor(CatCount, 8, poseAndSkin);
+		}, 0.2);
+
+		std::cout << CatCount << " " << rigged[0] << " a frame, " << CatCount * mesh.GetVertexCount() << " vertices:\n";
+		std::cout << "  Reference, whole matrices:   " << referenceTime * 1000.0 << "ms\n";
+		std::cout << "  Poses only:                  " << evaluateTime * 1000.0 << "ms\n";
+		std::cout << "  Poses and skinning:          " << serialTime * 1000.0 << "ms (" << referenceTime / serialTime << "x)\n";
+		std::cout << "  Split across " << pool.getThreadCount() + 1 << " threads:      " << parallelTime * 1000.0 << "ms ("
+			<< referenceTime / parallelTime << "x)\n";
+#ifndef NCL_FLOAT4_SSE
+		std::cout << "No SSE on this platform, skinning runs as plain code\n";
+#endif
+	}
+}
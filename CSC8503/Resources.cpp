@@ -1,59 +1,118 @@
 #include "Resources.h"
 
 #include <stdexcept>
+#include <unordered_set>
+
+#include "Assets.h"
 
 namespace NCL::CSC8503 {
     Resources::~Resources() {
-        for (auto& [name, mesh] : meshes) {
+        // Loader threads may still be writing into meshes and textures
+        loader.cancel();
+        // Duplicates share a pointer, so each is only deleted once
+        std::unordered_set<Mesh*> uniqueMeshes;
+        for (auto& [id, mesh] : meshes) {
+            uniqueMeshes.insert(mesh);
+        }
+        for (Mesh* mesh : uniqueMeshes) {
             delete mesh;
         }
-        for (auto& [name, texture] : textures) {
+        std::unordered_set<Texture*> uniqueTextures;
+        for (auto& [id, texture] : textures) {
+            uniqueTextures.insert(texture);
+        }
+        for (Texture* texture : uniqueTextures) {
             delete texture;
         }
-        for (auto& [name, shader] : shaders) {
+        for (auto& [id, shader] : shaders) {
             delete shader;
         }
     }
 
-    Mesh* Resources::getMesh(const std::string& name) {
-        checkLength(name);
+    Mesh* Resources::getMesh(AssetPath name) {
+        checkLength(name.GetPath());
 
-        auto it = meshes.find(name);
+        auto it = meshes.find(name.GetId());
         if (it != meshes.end()) {
+            stats.hits++;
             return it->second;
         }
-        Mesh* mesh = renderer->LoadMesh(name);
-        meshes[name] = mesh;
+
+        std::string path(name.GetPath());
+        // Only known without reading the file if the cache has seen it before,
+        // otherwise it's hashed on a loader thread, ready for next time
+        std::optional<uint64_t> contentHash = cache.findContentHash(Assets::MESHDIR + path);
+        if (contentHash) {
+            auto same = meshesByContent.find(*contentHash);
+            if (same != meshesByContent.end()) {
+                stats.duplicates++;
+                meshes[name.GetId()] = same->second;
+                return same->second;
+            }
+        }
+
+        stats.misses++;
+        Mesh* mesh = renderer->LoadMeshAsync(path, loader, [this](const std::string& name, Mesh& mesh) {
+            cache.loadMesh(name, mesh);
+        });
+        meshes[name.GetId()] = mesh;
+        if (contentHash) {
+            meshesByContent[*contentHash] = mesh;
+        }
         return mesh;
     }
 
-    Texture* Resources::getTexture(const std::string& name) {
-        checkLength(name);
+    Texture* Resources::getTexture(AssetPath name) {
+        checkLength(name.GetPath());
 
-        auto it = textures.find(name);
+        auto it = textures.find(name.GetId());
         if (it != textures.end()) {
+            stats.hits++;
             return it->second;
         }
-        Texture* texture = renderer->LoadTexture(name);
-        textures[name] = texture;
+
+        std::string path(name.GetPath());
+        // Textures are small enough to hash up front the first time they're seen
+        std::string fullPath = Assets::TEXTUREDIR + path;
+        std::optional<uint64_t> contentHash = cache.findContentHash(fullPath);
+        if (!contentHash) {
+            contentHash = cache.hashFile(fullPath);
+        }
+        if (contentHash) {
+            auto same = texturesByContent.find(*contentHash);
+            if (same != texturesByContent.end()) {
+                stats.duplicates++;
+                textures[name.GetId()] = same->second;
+                return same->second;
+            }
+        }
+
+        stats.misses++;
+        Texture* texture = renderer->LoadTextureAsync(path, loader);
+        textures[name.GetId()] = texture;
+        if (contentHash) {
+            texturesByContent[*contentHash] = texture;
+        }
         return texture;
     }
 
-    Shader* Resources::getShader(const std::string& vertex, const std::string& fragment) {
-        checkLength(vertex);
-        checkLength(fragment);
+    Shader* Resources::getShader(AssetPath vertex, AssetPath fragment) {
+        checkLength(vertex.GetPath());
+        checkLength(fragment.GetPath());
 
-        auto key = std::make_pair(vertex, fragment);
+        AssetId key = AssetId::Combine(vertex.GetId(), fragment.GetId());
         auto it = shaders.find(key);
         if (it != shaders.end()) {
+            stats.hits++;
             return it->second;
         }
-        Shader* shader = renderer->LoadShader(vertex, fragment);
+        stats.misses++;
+        Shader* shader = renderer->LoadShader(std::string(vertex.GetPath()), std::string(fragment.GetPath()));
         shaders[key] = shader;
         return shader;
     }
 
-    void Resources::checkLength(const std::string& name) const {
+    void Resources::checkLength(std::string_view name) const {
         if ((name.length() + 1) > MaxPathLength) { // +1 for null terminator
             throw std::runtime_error("Path too long");
         }
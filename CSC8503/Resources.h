@@ -2,8 +2,10 @@
 
 #include <string>
 #include <cstring>
-#include <map>
+#include <unordered_map>
 
+#include "AssetCache.h"
+#include "AssetId.h"
 #include "GameTechRenderer.h"
 #include "Mesh.h"
 #include "TextureLoader.h"
@@ -17,6 +19,10 @@
 namespace NCL::CSC8503 {
     // Basic resource manager
     // Everything will be lazy-loaded from disk
+    // Meshes and textures load in the background: they're returned straight away,
+    // and become usable once update has uploaded them. Shaders load straight away
+    // Assets are looked up by a hash of their path, and files with the same contents
+    // share one asset once the cache has seen them
     class Resources {
     public:
         // Maximum length of a path string
@@ -43,26 +49,67 @@ namespace NCL::CSC8503 {
             Shader* shader;
 
             ResourceSet(Resources* resources, const NetworkChunk& chunk) {
-                mesh = resources->getMesh(chunk.meshName);
-                texture = resources->getTexture(chunk.textureName);
-                shader = resources->getShader(chunk.vertexName, chunk.fragmentName);
+                // Arrays would be taken as literals and hashed at compile time
+                mesh = resources->getMesh(std::string(chunk.meshName));
+                texture = resources->getTexture(std::string(chunk.textureName));
+                shader = resources->getShader(std::string(chunk.vertexName), std::string(chunk.fragmentName));
             }
         };
 
+        struct Stats {
+            // Asked for by a path that was already loaded
+            size_t hits = 0;
+            // Loaded from a new path
+            size_t misses = 0;
+            // New paths whose contents matched something already loaded
+            size_t duplicates = 0;
+        };
+
         Resources(GameTechRenderer* renderer) : renderer(renderer) {}
         ~Resources();
 
 
-        Mesh* getMesh(const std::string& name);
-        Texture* getTexture(const std::string& name);
-        Shader* getShader(const std::string& vertex, const std::string& fragment);
+        Mesh* getMesh(AssetPath name);
+        Texture* getTexture(AssetPath name);
+        Shader* getShader(AssetPath vertex, AssetPath fragment);
+
+        // Uploads meshes and textures that have finished loading, call once a frame
+        void update(float budgetSeconds = AssetLoader::DefaultBudget) {
+            loader.update(budgetSeconds);
+        }
+        // Blocks until everything asked for so far is usable
+        void finishLoading() {
+            loader.finishAll();
+        }
+        // Meshes and textures still loading
+        size_t getLoadingCount() const {
+            return loader.getPendingCount();
+        }
+
+        const Stats& getStats() const {
+            return stats;
+        }
+        const AssetCache& getCache() const {
+            return cache;
+        }
     private:
-        void checkLength(const std::string& name) const;
+        void checkLength(std::string_view name) const;
 
         GameTechRenderer* renderer;
 
-        std::map<std::string, Mesh*> meshes;
-        std::map<std::string, Texture*> textures;
-        std::map<std::pair<std::string, std::string>, Shader*> shaders;
+        // By path, with duplicates sharing a pointer
+        std::unordered_map<AssetId, Mesh*> meshes;
+        std::unordered_map<AssetId, Texture*> textures;
+        // By both stages' paths combined
+        std::unordered_map<AssetId, Shader*> shaders;
+
+        // By the hash of their file's contents, for those whose hash is known
+        std::unordered_map<uint64_t, Mesh*> meshesByContent;
+        std::unordered_map<uint64_t, Texture*> texturesByContent;
+
+        Stats stats;
+        // Declared before the loader, so loads are stopped before the cache goes away
+        AssetCache cache;
+        AssetLoader loader;
     };
 }
@@ -1,6 +1,7 @@
 #include "Server.h"
 
 #include "NetworkedGame.h"
+#include "NetworkProfiler.h"
 
 namespace NCL::CSC8503 {
     Server::Server(NetworkedGame *game, int maxPlayers)
@@ -23,29 +24,38 @@ namespace NCL::CSC8503 {
         }
 
         broadcastDeltas();
+        sendInputAcks();
+        // Remember what clients were just sent, for lag compensation
+        game->getWorld()->RecordHistory(tick);
+        tick++;
 
         // Process any packets received and flush the send buffer
 		server->UpdateServer();
     }
 
-    void Server::ReceivePacket(GamePacket::Type type, GamePacket *payload, int source)
+    void Server::ReceivePacket(GamePacket::Type type, std::span<enet_uint8> packet, int source)
     {
+        // Clients can send anything, so packets too small for their type are dropped
         switch (type) {
             case GamePacket::Type::Server_ClientConnect:
                 std::cout << "Client connected. Waiting for hello packet" << std::endl;
                 return;
             case GamePacket::Type::ClientHello:
-                return processPacket((ClientHelloPacket*)payload, source);
+                if (auto payload = GamePacket::View<ClientHelloPacket>(packet)) processPacket(payload, source);
+                return;
             case GamePacket::Type::Server_ClientDisconnect:
                 return processPlayerDisconnect(source);
             case GamePacket::Type::ClientState:
-                return processPacket((ClientPacket*)payload, source);
+                if (auto payload = GamePacket::View<ClientPacket>(packet)) processPacket(payload, source);
+                return;
         }
     }
 
     void Server::sendPlayerList()
     {
+        NetworkProfiler::ScopedTimer timer(server->GetProfiler(), GamePacket::Type::PlayerList);
         PlayerListPacket listPacket(game->GetAllPlayers());
+        timer.stop();
         server->SendGlobalPacket(listPacket);
     }
 
@@ -59,6 +69,9 @@ namespace NCL::CSC8503 {
     {
         std::cout << packet->name.get() << " says hello" << std::endl;
         auto netState = game->generateNetworkState(source, packet->name.get());
+        // Use whatever both sides support
+        unsigned char features = packet->features & NetworkBase::SupportedFeatures;
+        server->SetPeerFeatures(source, features);
 
         sendPlayerList();
 
@@ -66,11 +79,13 @@ namespace NCL::CSC8503 {
             netState,
             game->hasGameEnded(),
             game->getTimeElapsed(),
-            game->getTimeLimit()
+            game->getTimeLimit(),
+            features
         };
         server->SendClientPacket(source, helloPacket);
 
         game->GetAllPlayers().emplace(source, LocalPlayerState{netState});
+        inputBuffers.insert_or_assign(source, InputBuffer(server->GetProfiler(), source));
         game->SpawnMissingPlayers();
         forceFullSync();
     }
@@ -78,15 +93,53 @@ namespace NCL::CSC8503 {
     void Server::processPlayerDisconnect(int source)
     {
         std::cout << "Player " << source << " has disconnected!" << std::endl;
+        inputBuffers.erase(source);
         // TODO: Implement
     }
 
     void Server::processPacket(ClientPacket *packet, int source)
     {
         auto it = game->GetAllPlayers().find(source);
-        if (it != game->GetAllPlayers().end()) {
-			it->second.player->setLastInput(packet->input);
-		}
+        auto buffer = inputBuffers.find(source);
+        if (it == game->GetAllPlayers().end() || it->second.player == nullptr || buffer == inputBuffers.end()) {
+            return;
+        }
+        // Input packets are unreliable, so may arrive out of order
+        if (packet->index > buffer->second.getNewestIndex()) {
+            it->second.player->setViewTick(packet->viewTick);
+        }
+        buffer->second.insert(*packet);
+    }
+
+    void Server::applyInputs(float dt)
+    {
+        for (auto& [id, buffer] : inputBuffers) {
+            auto it = game->GetAllPlayers().find(id);
+            if (it == game->GetAllPlayers().end() || it->second.player == nullptr) {
+                continue;
+            }
+            PlayerInput input;
+            int index;
+            if (buffer.consume(dt, input, index)) {
+                it->second.player->setLastInput(input, index);
+            }
+        }
+    }
+
+    void Server::sendInputAcks()
+    {
+        for (auto& [id, state] : game->GetAllPlayers()) {
+            // The host plays locally, and clients that haven't sent input have nothing to reconcile
+            if (id < 0 || state.player == nullptr || state.player->getLastInputIndex() < 0) {
+                continue;
+            }
+            NetworkProfiler::ScopedTimer timer(server->GetProfiler(), GamePacket::Type::InputAck);
+            InputAckPacket ack;
+            state.player->writeAck(ack);
+            ack.serverTick = tick;
+            timer.stop();
+            server->SendClientPacket(id, ack);
+        }
     }
     void Server::broadcastDeltas()
     {
@@ -121,7 +174,17 @@ namespace NCL::CSC8503 {
 
             if (wantFull || wantDelta) {
                 GamePacket* newPacket = nullptr;
+                NetworkProfiler::ScopedTimer timer(server->GetProfiler(), GamePacket::Type::Full_State);
                 if (o->WritePacket(&newPacket, !wantFull, playerState)) {
+                    // Deltas can fall back to full states, so the type isn't known until now
+                    timer.setType(newPacket->type);
+                    // Clients send back the tick of the state they're showing, for lag compensation
+                    if (newPacket->type == GamePacket::Type::Full_State) {
+                        ((FullPacket*)newPacket)->serverTick = tick;
+                    } else {
+                        ((DeltaPacket*)newPacket)->serverTick = tick;
+                    }
+                    timer.stop();
                     server->SendGlobalPacket(*newPacket);
                     delete newPacket;
                 }
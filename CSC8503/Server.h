@@ -1,7 +1,10 @@
 #pragma once
 
+#include <map>
+
 #include "GameServer.h"
 
+#include "InputBuffer.h"
 #include "NetworkPlayer.h"
 #include "NetworkObject.h"
 
@@ -18,8 +21,15 @@ namespace NCL::CSC8503 {
         }
 
         void update(float dt);
+        // Apply the next buffered input for each client's player, once per frame
+        void applyInputs(float dt);
+
+        // Number of network ticks since the server started
+        int getTick() const {
+            return tick;
+        }
 
-        void ReceivePacket(GamePacket::Type type, GamePacket* payload, int source = -1) override;
+        void ReceivePacket(GamePacket::Type type, std::span<enet_uint8> packet, int source = -1) override;
 
         void sendPlayerList();
 
@@ -32,13 +42,18 @@ namespace NCL::CSC8503 {
 		}
     private:
         bool forceFullBroadcast = false;
+        int tick = 0;
         NetworkedGame* game;
         GameServer* server;
+        // Keyed by client ID
+        std::map<int, InputBuffer> inputBuffers;
 
         void processPlayerDisconnect(int source);
         void processPacket(ClientPacket* packet, int source);
         void processPacket(ClientHelloPacket* packet, int source);
 
         void broadcastDeltas();
+        // Tell each client where the server thinks their player is
+        void sendInputAcks();
     };
 }
@@ -125,12 +125,12 @@ namespace NCL::CSC8503 {
     }
 
     Vector3 RandomMoveState::pickTarget() {
-        std::uniform_int_distribution<int> dist(0, navMap->getNodeCount());
-        GridNode* node;
+        std::uniform_int_distribution<int> dist(0, navMap->getNodeCount() - 1);
+        GridNode node;
         do {
             node = navMap->getNode(dist(rng));
-        } while (node->isWall());
-        return node->position;
+        } while (node.isWall());
+        return node.position;
     }
 
     bool ChaseState::shouldRepickTarget() {
@@ -1,11 +1,16 @@
 #include "TutorialGame.h"
 
 #include <array>
+#include <iomanip>
+#include <sstream>
 
 #include "GameWorld.h"
 #include "PhysicsObject.h"
 #include "RenderObject.h"
 #include "TextureLoader.h"
+#ifndef USEVULKAN
+#include "OGLProgramCache.h"
+#endif
 
 #include "PositionConstraint.h"
 #include "OrientationConstraint.h"
@@ -168,8 +173,30 @@ void TutorialGame::UpdateGame(float dt) {
 	renderer->Update(dt);
 	physics->Update(dt);
 
+#ifndef USEVULKAN
+	if (showRenderStats) {
+		drawRenderStats(55, 65);
+	}
+#endif
+	resources->update();
 	renderer->Render();
 	Debug::UpdateRenderables(dt);
+	RecordStartup();
+}
+
+void TutorialGame::RecordStartup() {
+	if (firstFrameTime == 0.0) {
+		firstFrameTime = startupTimer.GetTotalTimeMSec();
+		std::cout << "Startup: first frame after " << firstFrameTime << "ms";
+#ifndef USEVULKAN
+		const OGLProgramCache::Stats& programs = OGLProgramCache::GetStats();
+		std::cout << ", " << programs.seconds * 1000.0 << "ms of it on shaders";
+#endif
+		std::cout << "\n";
+	}
+	if (loadedTime == 0.0 && resources->getLoadingCount() == 0) {
+		loadedTime = startupTimer.GetTotalTimeMSec();
+	}
 }
 
 void TutorialGame::UpdateKeys() {
@@ -190,6 +217,9 @@ void TutorialGame::UpdateKeys() {
 	if (Window::GetKeyboard()->KeyPressed(KeyCodes::F8)) {
 		world->ShuffleObjects(false);
 	}
+	if (Window::GetKeyboard()->KeyPressed(KeyCodes::F6)) {
+		showRenderStats = !showRenderStats;
+	}
 
 	if (lockedObject) {
 		LockedObjectMovement();
@@ -199,6 +229,95 @@ void TutorialGame::UpdateKeys() {
 	}
 }
 
+#ifndef USEVULKAN
+// Stats are from the last frame rendered
+void TutorialGame::drawRenderStats(float x, float y) const {
+	const float lineHeight = 3.0f;
+	const RenderCuller& culler = renderer->GetCuller();
+	auto viewLine = [&](const std::string& name, const RenderCuller::View& view) {
+		return name + ": drew " + std::to_string(view.visible.size()) + "/" + std::to_string(culler.getTotalCount())
+			+ ", culled " + std::to_string(view.culled);
+	};
+
+	Debug::Print("Rendering", Vector2(x, y), Debug::YELLOW);
+	y += lineHeight;
+	Debug::Print(viewLine("Camera", renderer->GetCameraView()), Vector2(x, y));
+	y += lineHeight;
+	Debug::Print(viewLine("Shadow", renderer->GetShadowView()), Vector2(x, y));
+	y += lineHeight;
+	Debug::Print("No bounds: " + std::to_string(culler.getUnboundedCount()), Vector2(x, y));
+	y += lineHeight;
+	std::stringstream ss;
+	ss << "Cull time: " << std::fixed << std::setprecision(3) << renderer->GetCullTime() * 1000.0f << "ms";
+	Debug::Print(ss.str(), Vector2(x, y));
+	y += lineHeight;
+	ss.str("");
+	ss << "Sort and batch time: " << renderer->GetSortTime() * 1000.0f << "ms";
+	Debug::Print(ss.str(), Vector2(x, y));
+	y += lineHeight;
+	ss.str("");
+	ss << "Skinned: " << renderer->GetSkinnedCount() << " in " << renderer->GetSkinTime() * 1000.0f << "ms";
+	Debug::Print(ss.str(), Vector2(x, y));
+	y += lineHeight;
+
+	// Draw calls and binds per pass, which sorting and instancing keep low
+	const InstanceBatcher& batcher = renderer->GetBatcher();
+	auto statsLine = [&](const std::string& name, std::initializer_list<RenderQueue::Pass> passes) {
+		RenderQueue::Stats total;
+		size_t drawCalls = 0;
+		for (RenderQueue::Pass pass : passes) {
+			const RenderQueue::Stats& stats = batcher.getStats(pass);
+			total.shaderChanges += stats.shaderChanges;
+			total.textureChanges += stats.textureChanges;
+			total.meshChanges += stats.meshChanges;
+			drawCalls += batcher.getBatches(pass).size();
+		}
+		return name + ": " + std::to_string(drawCalls) + " draw calls, binds " + std::to_string(total.shaderChanges) + " shader, "
+			+ std::to_string(total.textureChanges) + " texture, " + std::to_string(total.meshChanges) + " mesh";
+	};
+	Debug::Print(statsLine("Camera", { RenderQueue::Pass::Opaque, RenderQueue::Pass::Transparent }), Vector2(x, y));
+	y += lineHeight;
+	Debug::Print(statsLine("Shadow", { RenderQueue::Pass::Shadow }), Vector2(x, y));
+	y += lineHeight;
+
+	// Objects at each LOD, with the triangles they save
+	const LodSelector& lods = renderer->GetLodSelector();
+	std::string levels;
+	for (size_t count : lods.GetLevelCounts()) {
+		levels += (levels.empty() ? "" : "/") + std::to_string(count);
+	}
+	Debug::Print("LOD: " + std::to_string(lods.GetTriangleCount()) + "/" + std::to_string(lods.GetFullTriangleCount())
+		+ " triangles, levels " + levels, Vector2(x, y));
+	y += lineHeight;
+
+	// Meshes and textures load in the background, so the first frame doesn't wait for them
+	ss.str("");
+	ss << std::setprecision(1) << "Startup: first frame " << firstFrameTime << "ms, ";
+	if (loadedTime > 0.0) {
+		ss << "loaded " << loadedTime << "ms";
+	}
+	else {
+		ss << resources->getLoadingCount() << " assets loading";
+	}
+	Debug::Print(ss.str(), Vector2(x, y));
+	y += lineHeight;
+
+	const Resources::Stats& assets = resources->getStats();
+	const AssetCache& cache = resources->getCache();
+	Debug::Print("Assets: " + std::to_string(assets.hits) + " hits, " + std::to_string(assets.misses) + " misses, "
+		+ std::to_string(assets.duplicates) + " duplicates, cache " + std::to_string(cache.getHits()) + " hits, "
+		+ std::to_string(cache.getMisses()) + " misses", Vector2(x, y));
+	y += lineHeight;
+
+	// Programs loaded from binaries saved by earlier runs skip compiling
+	const OGLProgramCache::Stats& programs = OGLProgramCache::GetStats();
+	ss.str("");
+	ss << "Shaders: " << programs.seconds * 1000.0 << "ms, " << programs.hits << " cached, " << programs.misses
+		<< " compiled, " << programs.rejected << " rejected";
+	Debug::Print(ss.str(), Vector2(x, y));
+}
+#endif
+
 void TutorialGame::LockedObjectMovement() {
 	Matrix4 view		= world->GetMainCamera().BuildViewMatrix();
 	Matrix4 camWorld	= Matrix::Inverse(view);
@@ -316,11 +435,10 @@ A single function to add a large immoveable cube to the bottom of our world
 GameObject* TutorialGame::AddFloorToWorld(const Vector3& position) {
 	GameObject* floor = new GameObject();
 
-	Vector3 floorSize = Vector3(200, 2, 200);
-	AABBVolume* volume = new AABBVolume(floorSize);
+	AABBVolume* volume = new AABBVolume(FloorHalfSize);
 	floor->SetBoundingVolume((CollisionVolume*)volume);
 	floor->GetTransform()
-		.SetScale(floorSize * 2.0f)
+		.SetScale(FloorHalfSize * 2.0f)
 		.SetPosition(position);
 
 	floor->SetRenderObject(new RenderObject(&floor->GetTransform(), cubeMesh, basicTex, basicShader));
@@ -9,6 +9,7 @@
 
 #include "StateGameObject.h"
 #include "Resources.h"
+#include "GameTimer.h"
 #include "NetworkPlayer.h"
 
 namespace NCL {
@@ -24,8 +25,13 @@ namespace NCL {
 			GameWorld* getWorld() {
 				return world;
 			}
+
+			// Half size of the floor AddFloorToWorld builds
+			const static constexpr Vector3 FloorHalfSize = Vector3(200, 2, 200);
 		protected:
 			void InitialiseAssets();
+			// Notes when the first frame is drawn and when loading finishes, for the F6 stats
+			void RecordStartup();
 
 			void InitCamera();
 			void UpdateKeys();
@@ -50,6 +56,11 @@ namespace NCL {
 			void MoveSelectedObject(float dt);
 			void DebugObjectMovement();
 			void LockedObjectMovement();
+#ifndef USEVULKAN
+			// Culling stats, toggled with F6
+			void drawRenderStats(float x, float y) const;
+			bool showRenderStats = false;
+#endif
 
 			GameObject* AddFloorToWorld(const Vector3& position);
 			GameObject* AddSphereToWorld(const Vector3& position, float radius, float inverseMass = 10.0f);
@@ -77,6 +88,12 @@ namespace NCL {
 
 			Resources* resources = nullptr;
 
+			// Started with the game, for timing how long until there's something on screen
+			GameTimer	startupTimer;
+			// In milliseconds since the game started, 0 until they happen
+			double		firstFrameTime	= 0.0;
+			double		loadedTime		= 0.0;
+
 			GameObject* selectionObject = nullptr;
 			GameObject* selectionVisibleObject = nullptr;
 
@@ -0,0 +1,66 @@
+#include "AssetLoader.h"
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+
+#include "GameTimer.h"
+
+using namespace NCL;
+using namespace NCL::CSC8503;
+
+AssetLoader::AssetLoader(size_t threadCount) : jobs(threadCount) {
+}
+
+AssetLoader::~AssetLoader() {
+	cancel();
+}
+
+void AssetLoader::load(const std::string& name, std::function<void()> load, std::function<void()> finish) {
+	pending.push_back({ name, jobs.submit(std::move(load)), std::move(finish) });
+}
+
+size_t AssetLoader::update(float budgetSeconds) {
+	GameTimer timer;
+	size_t finished = 0;
+	auto it = pending.begin();
+	// Stops at the first load that isn't ready, so they finish in order
+	while (it != pending.end() && it->loaded.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		if (finished > 0 && timer.GetTotalTimeSeconds() > budgetSeconds) {
+			break;
+		}
+		finishLoad(*it);
+		++it;
+		finished++;
+	}
+	pending.erase(pending.begin(), it);
+	return finished;
+}
+
+void AssetLoader::finishAll() {
+	for (Pending& load : pending) {
+		finishLoad(load);
+	}
+	pending.clear();
+}
+
+void AssetLoader::cancel() {
+	jobs.clear();
+	for (Pending& load : pending) {
+		load.loaded.wait();
+	}
+	pending.clear();
+}
+
+void AssetLoader::finishLoad(Pending& load) {
+	try {
+		load.loaded.get();
+	}
+	catch (const std::exception& e) {
+		std::cout << "Failed to load " << load.name << ": " << e.what() << "\n";
+		failedCount++;
+		return;
+	}
+	load.finish();
+	finishedCount++;
+}
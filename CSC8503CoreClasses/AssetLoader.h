@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "JobQueue.h"
+
+namespace NCL::CSC8503 {
+	// Loads assets in two halves: reading and parsing on a JobQueue thread,
+	// then anything that needs the graphics context, like creating buffers,
+	// back on the render thread in update, a few per frame so frames don't hitch
+	class AssetLoader {
+	public:
+		// Long enough to upload a mesh or two each frame
+		static constexpr float DefaultBudget = 0.002f;
+
+		explicit AssetLoader(size_t threadCount = JobQueue::DefaultThreadCount());
+		// Waits for loads in progress, but doesn't finish them
+		~AssetLoader();
+
+		// Runs load on a worker thread, then finish on the next update after it's done
+		// If load throws, the error is printed and finish is never called
+		void load(const std::string& name, std::function<void()> load, std::function<void()> finish);
+
+		// Finishes loads that are ready, in the order they were asked for, until
+		// budgetSeconds is spent. At least one is finished if any are ready
+		// Returns how many were finished
+		size_t update(float budgetSeconds = DefaultBudget);
+		// Blocks until every load so far is finished
+		void finishAll();
+		// Drops loads that haven't started and waits for the rest, without finishing any
+		void cancel();
+
+		// Asked for but not finished yet
+		size_t getPendingCount() const {
+			return pending.size();
+		}
+		size_t getFinishedCount() const {
+			return finishedCount;
+		}
+		size_t getFailedCount() const {
+			return failedCount;
+		}
+		size_t getThreadCount() const {
+			return jobs.getThreadCount();
+		}
+	private:
+		struct Pending {
+			std::string				name;
+			std::future<void>		loaded;
+			std::function<void()>	finish;
+		};
+		// Waits for the load, then finishes it unless it failed
+		void finishLoad(Pending& load);
+
+		JobQueue				jobs;
+		std::vector<Pending>	pending;
+		size_t					finishedCount = 0;
+		size_t					failedCount = 0;
+	};
+}
@@ -0,0 +1,183 @@
+#include "Compression.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+	// Format constants from the LZ4 block spec
+	const size_t MinMatch = 4;
+	// The last 5 bytes are always literals, and the last match must start
+	// at least 12 bytes before the end
+	const size_t LastLiterals = 5;
+	const size_t MatchFindLimit = 12;
+	const size_t MaxOffset = 65535;
+
+	const int HashBits = 12;
+
+	uint32_t read32(const uint8_t* p) {
+		uint32_t value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	uint32_t hash(uint32_t sequence) {
+		return (sequence * 2654435761u) >> (32 - HashBits);
+	}
+
+	// Bounds checked writer, remembers if it ever ran out of space
+	struct Writer {
+		std::span<uint8_t> output;
+		size_t pos = 0;
+		bool overflow = false;
+
+		void byte(uint8_t value) {
+			if (pos >= output.size()) {
+				overflow = true;
+				return;
+			}
+			output[pos++] = value;
+		}
+		void bytes(const uint8_t* data, size_t count) {
+			if (count == 0) {
+				return;
+			}
+			if (output.size() - pos < count) {
+				overflow = true;
+				return;
+			}
+			memcpy(output.data() + pos, data, count);
+			pos += count;
+		}
+		// Lengths over 15 continue in bytes of 255 after the token
+		void length(size_t remaining) {
+			for (; remaining >= 255; remaining -= 255) {
+				byte(255);
+			}
+			byte((uint8_t)remaining);
+		}
+	};
+
+	void writeSequence(Writer& out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) {
+		size_t matchCode = matchLength - MinMatch;
+		uint8_t token = (uint8_t)((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15));
+		out.byte(token);
+		if (literalCount >= 15) {
+			out.length(literalCount - 15);
+		}
+		out.bytes(literals, literalCount);
+		out.byte((uint8_t)(offset & 0xff));
+		out.byte((uint8_t)(offset >> 8));
+		if (matchCode >= 15) {
+			out.length(matchCode - 15);
+		}
+	}
+
+	void writeLastLiterals(Writer& out, const uint8_t* literals, size_t literalCount) {
+		out.byte((uint8_t)(std::min<size_t>(literalCount, 15) << 4));
+		if (literalCount >= 15) {
+			out.length(literalCount - 15);
+		}
+		out.bytes(literals, literalCount);
+	}
+
+	// Reads a length continuation, returns false if it runs off the end of the input
+	bool readLength(std::span<const uint8_t> input, size_t& pos, size_t& length) {
+		uint8_t next;
+		do {
+			if (pos >= input.size()) {
+				return false;
+			}
+			next = input[pos++];
+			length += next;
+		} while (next == 255);
+		return true;
+	}
+}
+
+size_t Compression::Compress(std::span<const uint8_t> input, std::span<uint8_t> output) {
+	Writer out{ output };
+	const uint8_t* in = input.data();
+	size_t size = input.size();
+	size_t anchor = 0;
+
+	if (size > MatchFindLimit) {
+		// Most recent position each hash was seen at
+		std::array<int32_t, 1 << HashBits> table;
+		table.fill(-1);
+
+		size_t pos = 0;
+		size_t limit = size - MatchFindLimit;
+		while (pos < limit) {
+			uint32_t sequence = read32(in + pos);
+			uint32_t h = hash(sequence);
+			int32_t candidate = table[h];
+			table[h] = (int32_t)pos;
+
+			if (candidate < 0 || pos - candidate > MaxOffset || read32(in + candidate) != sequence) {
+				pos++;
+				continue;
+			}
+
+			size_t matchLength = MinMatch;
+			size_t maxLength = size - LastLiterals - pos;
+			while (matchLength < maxLength && in[candidate + matchLength] == in[pos + matchLength]) {
+				matchLength++;
+			}
+			writeSequence(out, in + anchor, pos - anchor, pos - candidate, matchLength);
+			pos += matchLength;
+			anchor = pos;
+		}
+	}
+	writeLastLiterals(out, in + anchor, size - anchor);
+	return out.overflow ? 0 : out.pos;
+}
+
+bool Compression::Decompress(std::span<const uint8_t> input, std::span<uint8_t> output) {
+	size_t in = 0;
+	size_t out = 0;
+	while (in < input.size()) {
+		uint8_t token = input[in++];
+
+		size_t literalCount = token >> 4;
+		if (literalCount == 15 && !readLength(input, in, literalCount)) {
+			return false;
+		}
+		if (input.size() - in < literalCount || output.size() - out < literalCount) {
+			return false;
+		}
+		if (literalCount > 0) {
+			memcpy(output.data() + out, input.data() + in, literalCount);
+		}
+		in += literalCount;
+		out += literalCount;
+
+		// The last sequence has no match
+		if (in == input.size()) {
+			break;
+		}
+
+		if (input.size() - in < 2) {
+			return false;
+		}
+		size_t offset = input[in] | (input[in + 1] << 8);
+		in += 2;
+		if (offset == 0 || offset > out) {
+			return false;
+		}
+
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !readLength(input, in, matchLength)) {
+			return false;
+		}
+		matchLength += MinMatch;
+		if (output.size() - out < matchLength) {
+			return false;
+		}
+		// Byte by byte, as the match can overlap what it's writing
+		for (size_t i = 0; i < matchLength; i++, out++) {
+			output[out] = output[out - offset];
+		}
+	}
+	return out == output.size();
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Small LZ77 compressor using the LZ4 block format
+// Fast enough to run on packets as they're sent, and the output can be
+// decoded by any LZ4 block decoder. Not as tight as the reference encoder,
+// as it only tries the most recent match for each hash
+namespace Compression {
+	// Largest possible output for an input of this size, when it doesn't compress
+	constexpr size_t CompressBound(size_t inputSize) {
+		return inputSize + inputSize / 255 + 16;
+	}
+
+	// Returns the compressed size, or 0 if output is too small
+	size_t Compress(std::span<const uint8_t> input, std::span<uint8_t> output);
+
+	// Input comes off the network, so is treated as untrusted
+	// Returns false unless input decodes to exactly output.size() bytes
+	bool Decompress(std::span<const uint8_t> input, std::span<uint8_t> output);
+}
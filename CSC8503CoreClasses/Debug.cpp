@@ -1,8 +1,8 @@
 #include "Debug.h"
 using namespace NCL;
 
-std::vector<Debug::DebugStringEntry>	Debug::stringEntries;
-std::vector<Debug::DebugLineEntry>		Debug::lineEntries;
+CSC8503::VertexArena<SimpleFont::InterleavedTextVertex>	Debug::textVertices(10000);
+CSC8503::VertexArena<Debug::DebugLineEntry>				Debug::lineEntries(1000);
 std::vector<Debug::DebugTexEntry>		Debug::texEntries;
 
 SimpleFont* Debug::debugFont = nullptr;
@@ -20,25 +20,21 @@ const Vector4 Debug::MAGENTA	= Vector4(1, 0, 1, 1);
 const Vector4 Debug::CYAN		= Vector4(0, 1, 1, 1);
 
 void Debug::Print(const std::string& text, const Vector2& pos, const Vector4& colour) {
-	DebugStringEntry newEntry;
-
-	newEntry.data = text;
-	newEntry.position = pos;
-	newEntry.colour = colour;
-
-	stringEntries.emplace_back(newEntry);
+	if (!debugFont) {
+		return;
+	}
+	std::span<SimpleFont::InterleavedTextVertex> vertices = textVertices.allocate(debugFont->GetVertexCountForString(text));
+	debugFont->WriteInterleavedVerticesForString(text, pos, colour, TEXTSIZE, vertices);
 }
 
 void Debug::DrawLine(const Vector3& startpoint, const Vector3& endpoint, const Vector4& colour, float time) {
-	DebugLineEntry newEntry;
+	DebugLineEntry& newEntry = lineEntries.allocate(1)[0];
 
 	newEntry.start = startpoint;
 	newEntry.end = endpoint;
 	newEntry.colourA = colour;
 	newEntry.colourB = colour;
 	newEntry.time = time;
-
-	lineEntries.emplace_back(newEntry);
 }
 
 void Debug::DrawAABB(const Vector3& position, const Vector3& halfSize, const Vector4& colour, float time) {
@@ -91,23 +87,16 @@ void Debug::DrawAxisLines(const Matrix4& modelMatrix, float scaleBoost, float ti
 }
 
 void Debug::UpdateRenderables(float dt) {
-	int trim = 0;
-	for (int i = 0; i < lineEntries.size(); ) {
-		DebugLineEntry* e = &lineEntries[i];
-		e->time -= dt;
-		if (e->time < 0) {
-			trim++;
-			lineEntries[i] = lineEntries[lineEntries.size() - trim];
-		}
-		else {
-			++i;
-		}
-		if (i + trim >= lineEntries.size()) {
-			break;
+	std::span<DebugLineEntry> lines = lineEntries.getVertices();
+	size_t kept = 0;
+	for (DebugLineEntry& e : lines) {
+		e.time -= dt;
+		if (e.time >= 0) {
+			lines[kept++] = e;
 		}
 	}
-	lineEntries.resize(lineEntries.size() - trim);
-	stringEntries.clear();
+	lineEntries.truncate(kept);
+	textVertices.clear();
 	texEntries.clear();
 }
 
@@ -119,12 +108,12 @@ void Debug::CreateDebugFont(const std::string& dataFile, Texture& tex) {
 	debugFont = new SimpleFont(dataFile, tex);
 }
 
-const std::vector<Debug::DebugStringEntry>& Debug::GetDebugStrings() {
-	return stringEntries;
+std::span<const SimpleFont::InterleavedTextVertex> Debug::GetDebugTextVertices() {
+	return textVertices.getVertices();
 }
 
-const std::vector<Debug::DebugLineEntry>& Debug::GetDebugLines() {
-	return lineEntries;
+std::span<const Debug::DebugLineEntry> Debug::GetDebugLines() {
+	return lineEntries.getVertices();
 }
 
 const std::vector<Debug::DebugTexEntry>& Debug::GetDebugTex() {
@@ -1,5 +1,6 @@
 #pragma once
 #include "SimpleFont.h"
+#include "VertexArena.h"
 
 namespace NCL {
 	using namespace NCL::Maths;
@@ -7,12 +8,6 @@ namespace NCL {
 	class Debug
 	{
 	public:
-		struct DebugStringEntry {
-			std::string	data;
-			Vector2 position;
-			Vector4 colour;
-		};
-
 		struct DebugTexEntry {
 			const Texture* t;
 			Vector2 position;
@@ -20,6 +15,7 @@ namespace NCL {
 			Vector4 colour;
 		};
 
+		// Laid out as the line's two vertices, so can be drawn straight from memory
 		struct DebugLineEntry {
 			Vector3 start;
 			float	padding;
@@ -43,8 +39,9 @@ namespace NCL {
 
 		static void CreateDebugFont(const std::string& dataFile, Texture& tex);
 
-		static const std::vector<Debug::DebugStringEntry>& GetDebugStrings();
-		static const std::vector<Debug::DebugLineEntry>& GetDebugLines();
+		// Vertices for this frame's printed text, with 6 to a character
+		static std::span<const SimpleFont::InterleavedTextVertex> GetDebugTextVertices();
+		static std::span<const Debug::DebugLineEntry> GetDebugLines();
 		static const std::vector<Debug::DebugTexEntry>& GetDebugTex();
 
 
@@ -59,6 +56,8 @@ namespace NCL {
 		static const Vector4 MAGENTA;
 		static const Vector4 CYAN;
 
+		static const constexpr float TEXTSIZE = 20.0f;
+
 		static void setLinesEnabled(bool enabled) {
 			linesEnabled = enabled;
 		}
@@ -71,8 +70,9 @@ namespace NCL {
 		~Debug() {}
 
 		static bool linesEnabled;
-		static std::vector<DebugStringEntry>	stringEntries;
-		static std::vector<DebugLineEntry>		lineEntries;
+		// Print and DrawLine write vertices straight into these
+		static CSC8503::VertexArena<SimpleFont::InterleavedTextVertex>	textVertices;
+		static CSC8503::VertexArena<DebugLineEntry>						lineEntries;
 		static std::vector<DebugTexEntry>		texEntries;
 
 		static SimpleFont* debugFont;
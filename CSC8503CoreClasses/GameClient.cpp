@@ -1,10 +1,13 @@
 #include "GameClient.h"
+#include "NetworkProfiler.h"
 #include "./enet/enet.h"
 using namespace NCL;
 using namespace CSC8503;
 
 GameClient::GameClient()	{
-	netHandle = enet_host_create(nullptr, 1, 1, 0, 0);
+	netHandle = enet_host_create(nullptr, 1, ChannelCount, 0, 0);
+	netPeer = nullptr;
+	connected = false;
 }
 
 GameClient::~GameClient()	{
@@ -18,7 +21,7 @@ bool GameClient::Connect(uint32_t addr, int portNum) {
 
 	std::cout << "Connecting to server on " << (int)(address.host & 0xff) << "." << (int)((address.host >> 8) & 0xff) << "." << (int)((address.host >> 16) & 0xff) << "." << (int)((address.host >> 24) & 0xff) << ":" << address.port << std::endl;
 
-	netPeer = enet_host_connect(netHandle, &address, 2, 0);
+	netPeer = enet_host_connect(netHandle, &address, ChannelCount, 0);
 
 	if (netPeer == nullptr) {
 		std::cerr << "Connection to server failed!" << std::endl;
@@ -31,8 +34,9 @@ bool GameClient::Connect(uint32_t addr, int portNum) {
 		if (event.type == ENET_EVENT_TYPE_CONNECT) {
 			std::cout << "Server connection succeeded!" << std::endl;
 			connected = true;
+			ConfigurePeer(netPeer);
 			GamePacket p(GamePacket::Type::Client_ClientConnect);
-			ProcessPacket(&p);
+			ProcessPacket(p);
 			return true;
 		}
 		else {
@@ -49,6 +53,8 @@ void GameClient::UpdateClient() {
 		return;
 	}
 
+	UpdateConditioner();
+
 	// Loop while we have work to do
 	ENetEvent event;
 	while (enet_host_service(netHandle, &event, 0) > 0) {
@@ -57,10 +63,14 @@ void GameClient::UpdateClient() {
 		case ENET_EVENT_TYPE_DISCONNECT: {
 			std::cout << "Server disconnected!" << std::endl;
 			connected = false;
+			SetPeerFeatures(GetPeerID(netPeer), 0);
 			GamePacket p(GamePacket::Type::Client_ClientDisconnect);
-			ProcessPacket(&p);
+			ProcessPacket(p);
 			break;
 		} case ENET_EVENT_TYPE_RECEIVE: {
+			if (profiler) {
+				profiler->recordPeerReceived(GetPeerID(event.peer), event.packet->dataLength);
+			}
 			ProcessPackedPackets(std::span(event.packet->data, event.packet->dataLength));
 			break;
 		} default:
@@ -70,9 +80,18 @@ void GameClient::UpdateClient() {
 		// Free the packet now that we've processed it
 		enet_packet_destroy(event.packet);
 	}
+
+	if (profiler) {
+		profiler->endTick();
+	}
 }
 
 void GameClient::SendPacket(GamePacket&  payload) {
-	ENetPacket* packet = enet_packet_create(&payload, payload.GetTotalSize(), 0);
-	enet_peer_send(netPeer, 0, packet);
+	if (profiler) {
+		profiler->recordSent(payload.type, payload.GetTotalSize());
+	}
+	Channel channel = GetChannel(payload.type);
+	GamePacket& toSend = (GetPeerFeatures(GetPeerID(netPeer)) & CompressionFeature) ? CompressPacket(payload) : payload;
+	ENetPacket* packet = enet_packet_create(&toSend, toSend.GetTotalSize(), GetPacketFlags(channel));
+	SendToPeer(netPeer, channel, packet);
 }
@@ -48,4 +48,10 @@ void GameObject::UpdateBroadphaseAABB() {
 		Vector3 halfSizes = ((OBBVolume&)*boundingVolume).GetHalfDimensions();
 		broadphaseAABB = mat * halfSizes;
 	}
+	else if (boundingVolume->type == VolumeType::Capsule) {
+		Matrix3 mat = Quaternion::RotationMatrix<Matrix3>(transform.GetOrientation());
+		mat = Matrix::Absolute(mat);
+		const CapsuleVolume& capsule = (CapsuleVolume&)*boundingVolume;
+		broadphaseAABB = mat * Vector3(capsule.GetRadius(), capsule.GetHalfHeight(), capsule.GetRadius());
+	}
 }
\ No newline at end of file
@@ -35,6 +35,7 @@ namespace NCL::CSC8503 {
 
 		void SetBoundingVolume(CollisionVolume* vol) {
 			boundingVolume = vol;
+			UpdateBroadphaseAABB();
 		}
 
 		const CollisionVolume* GetBoundingVolume() const {
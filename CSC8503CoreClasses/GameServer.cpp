@@ -1,5 +1,6 @@
 #include "GameServer.h"
 #include "GameWorld.h"
+#include "NetworkProfiler.h"
 #include "./enet/enet.h"
 using namespace NCL;
 using namespace CSC8503;
@@ -18,6 +19,8 @@ GameServer::~GameServer()	{
 
 void GameServer::Shutdown() {
 	SendGlobalPacket(GamePacket::Type::Shutdown);
+	// Packets still waiting in the conditioner are lost with the host
+	conditioner.reset();
 	enet_host_destroy(netHandle);
 	netHandle = nullptr;
 }
@@ -27,7 +30,7 @@ bool GameServer::Initialise() {
 	// Create a host that listens to any address on the specified port
 	address.host = ENET_HOST_ANY;
 	address.port = port;
-	netHandle = enet_host_create(&address, clientMax, 1, 0, 0);
+	netHandle = enet_host_create(&address, clientMax, ChannelCount, 0, 0);
 
 	if (!netHandle) {
 		std::cerr << __FUNCTION__ << " failed to create network handle!" << std::endl;
@@ -44,33 +47,85 @@ bool GameServer::SendGlobalPacket(GamePacket::Type msgID) {
 
 // Send a packet with a payload to all clients
 bool GameServer::SendGlobalPacket(GamePacket& packet) {
+	if (profiler) {
+		profiler->recordSent(packet.type, packet.GetTotalSize());
+	}
+	// Everyone gets the same bytes, so only compress if everyone can decompress
+	GamePacket& toSend = allPeersHaveFeature(CompressionFeature) ? CompressPacket(packet) : packet;
+
 	// Add the packet to the global send queue
-	globalSendQueue.resize(globalSendQueue.size() + packet.GetTotalSize());
-	auto next = globalSendQueue.end() - packet.GetTotalSize();
-	memcpy(&(*next), &packet, packet.GetTotalSize());
+	auto& queue = globalSendQueues[GetChannel(packet.type)];
+	queue.resize(queue.size() + toSend.GetTotalSize());
+	auto next = queue.end() - toSend.GetTotalSize();
+	memcpy(&(*next), &toSend, toSend.GetTotalSize());
 	return true;
 }
 
 bool GameServer::SendClientPacket(int clientID, GamePacket& packet) {
-	ENetPacket* enetPacket = enet_packet_create(&packet, packet.GetTotalSize(), 0);
+	if (profiler) {
+		profiler->recordSent(packet.type, packet.GetTotalSize());
+	}
+	Channel channel = GetChannel(packet.type);
+	GamePacket& toSend = (GetPeerFeatures(clientID) & CompressionFeature) ? CompressPacket(packet) : packet;
+	ENetPacket* enetPacket = enet_packet_create(&toSend, toSend.GetTotalSize(), GetPacketFlags(channel));
 	ENetPeer* peer = netHandle->peers + clientID;
-	enet_peer_send(peer, 0, enetPacket);
+	SendToPeer(peer, channel, enetPacket);
 	return true;
 }
 
+bool GameServer::allPeersHaveFeature(Feature feature) const {
+	bool anyConnected = false;
+	for (size_t i = 0; i < netHandle->peerCount; i++) {
+		if (netHandle->peers[i].state != ENET_PEER_STATE_CONNECTED) {
+			continue;
+		}
+		if (!(GetPeerFeatures((int)i) & feature)) {
+			return false;
+		}
+		anyConnected = true;
+	}
+	return anyConnected;
+}
+
+void GameServer::flushGlobalQueue(Channel channel) {
+	auto& queue = globalSendQueues[channel];
+	uint32_t flags = GetPacketFlags(channel);
+	// Reliable channels can be sent in one go, ENet will fragment them
+	size_t maxSize = channel == StateChannel ? MaxUnreliableSize : queue.size();
+
+	// Split at packet boundaries, so each ENet packet can be processed by itself
+	size_t start = 0;
+	while (start < queue.size()) {
+		size_t end = start;
+		while (end < queue.size()) {
+			auto packet = reinterpret_cast<GamePacket*>(queue.data() + end);
+			size_t packetSize = packet->GetTotalSize();
+			// Always take at least one packet, even if it's oversized
+			if (end != start && end - start + packetSize > maxSize) {
+				break;
+			}
+			end += packetSize;
+		}
+		Broadcast(channel, enet_packet_create(queue.data() + start, end - start, flags));
+		start = end;
+	}
+	queue.clear();
+}
+
 // Process incoming packets from clients
 void GameServer::UpdateServer() {
 	if (!netHandle) {
 		return;
 	}
 
-	// Send any global packets waiting in the queue,
-	// bundled into one to reduce network overhead
-	if (!globalSendQueue.empty()) {
-		ENetPacket* packet = enet_packet_create(globalSendQueue.data(), globalSendQueue.size(), 0);
-		enet_host_broadcast(netHandle, 0, packet);
-		globalSendQueue.clear();
+	// Send any global packets waiting in the queues,
+	// bundled together to reduce network overhead
+	for (int channel = 0; channel < ChannelCount; channel++) {
+		if (!globalSendQueues[channel].empty()) {
+			flushGlobalQueue((Channel)channel);
+		}
 	}
+	UpdateConditioner();
 
 	// Receive incoming packets
 	ENetEvent event;
@@ -83,24 +138,32 @@ void GameServer::UpdateServer() {
 		case ENET_EVENT_TYPE_CONNECT: {
 			std::cout << "Server: New client connected" << std::endl;
 			clientCount++;
+			ConfigurePeer(event.peer);
 			GamePacket p(GamePacket::Type::Server_ClientConnect);
-			ProcessPacket(&p, peer);
+			ProcessPacket(p, peer);
 			break;
 		} case ENET_EVENT_TYPE_DISCONNECT: {
 			std::cout << "Server: Client disconnected" << std::endl;
 			clientCount--;
+			SetPeerFeatures(peer, 0);
 			GamePacket p(GamePacket::Type::Server_ClientDisconnect);
-			ProcessPacket(&p, peer);
+			ProcessPacket(p, peer);
 			break;
 		} case ENET_EVENT_TYPE_RECEIVE: {
-			GamePacket* packet = (GamePacket*)event.packet->data;
-			ProcessPacket(packet, peer);
+			if (profiler) {
+				profiler->recordPeerReceived(peer, event.packet->dataLength);
+			}
+			ProcessPackedPackets(std::span(event.packet->data, event.packet->dataLength), peer);
 			break;
 		} default:
 			std::cerr << "Server: Unhandled network event type: " << type << std::endl;
 		}
 		enet_packet_destroy(event.packet);
 	}
+
+	if (profiler) {
+		profiler->endTick();
+	}
 }
 
 void GameServer::SetGameWorld(GameWorld &g) {
@@ -35,10 +35,13 @@ namespace NCL {
 			int incomingDataRate;
 			int outgoingDataRate;
 
-			// Packet payloads waiting to be sent to all clients
+			// Packet payloads waiting to be sent to all clients, one queue per channel
 			// To decode, cast to GamePacket and read type. Once
 			// processed, seek forward by GetTotalSize() bytes
-			std::vector<char> globalSendQueue;
+			std::array<std::vector<char>, ChannelCount> globalSendQueues;
+
+			void flushGlobalQueue(Channel channel);
+			bool allPeersHaveFeature(Feature feature) const;
 		};
 	}
 }
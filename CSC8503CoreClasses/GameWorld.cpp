@@ -11,7 +11,6 @@ using namespace NCL::CSC8503;
 GameWorld::GameWorld()	{
 	shuffleConstraints	= false;
 	shuffleObjects		= false;
-	worldIDCounter		= 0;
 	worldStateCounter	= 0;
 }
 
@@ -21,9 +20,9 @@ GameWorld::~GameWorld()	{
 void GameWorld::Clear() {
 	gameObjects.clear();
 	constraints.clear();
-	worldIDCounter		= 0;
 	worldStateCounter	= 0;
 	taggedObjects.clear();
+	history.clear();
 }
 
 void GameWorld::ClearAndErase() {
@@ -37,15 +36,18 @@ void GameWorld::ClearAndErase() {
 }
 
 void GameWorld::AddGameObject(GameObject* o) {
-	gameObjects.emplace_back(o);
+	auto id = gameObjects.insert(o);
+	if (id == ObjectMap::InvalidHandle) {
+		throw std::runtime_error("Too many objects in the world");
+	}
 	taggedObjects.insert(std::make_pair(o->getTag(), o));
 	o->SetWorld(this);
-	o->SetWorldID(worldIDCounter++);
+	o->SetWorldID((int)id);
 	worldStateCounter++;
 }
 
 void GameWorld::RemoveGameObject(GameObject* o, bool andDelete) {
-	gameObjects.erase(std::find(gameObjects.begin(), gameObjects.end(), o));
+	gameObjects.erase((ObjectMap::Handle)o->GetWorldID());
 	auto range = taggedObjects.equal_range(o->getTag());
 	for (auto i = range.first; i != range.second; ++i) {
 		if (i->second == o) {
@@ -53,6 +55,7 @@ void GameWorld::RemoveGameObject(GameObject* o, bool andDelete) {
 			break;
 		}
 	}
+	history.removeObject(o);
 	o->SetWorld(nullptr);
 	if (andDelete) {
 		delete o;
@@ -75,7 +78,7 @@ void GameWorld::UpdateWorld(float dt) {
 	std::default_random_engine e(seed);
 
 	if (shuffleObjects) {
-		std::shuffle(gameObjects.begin(), gameObjects.end(), e);
+		gameObjects.shuffle(e);
 	}
 
 	if (shuffleConstraints) {
@@ -107,7 +110,7 @@ bool GameWorld::Raycast(Ray& r, RayCollision& closestCollision, bool closestObje
 		if (CollisionDetection::RayIntersection(r, *i, thisCollision)) {
 
 			if (!closestObject) {
-				closestCollision		= collision;
+				closestCollision		= thisCollision;
 				closestCollision.node = i;
 				return true;
 			}
@@ -127,6 +130,72 @@ bool GameWorld::Raycast(Ray& r, RayCollision& closestCollision, bool closestObje
 	return false;
 }
 
+void GameWorld::RecordHistory(int tick) {
+	history.record(tick, gameObjects.dense());
+}
+
+bool GameWorld::RaycastAtTime(Ray& r, int tick, RayCollision& closestCollision, bool closestObject, GameObject* ignoreThis) {
+	const WorldHistory::Frame* frame = history.getFrame(tick);
+	if (frame == nullptr) {
+		return Raycast(r, closestCollision, closestObject, ignoreThis);
+	}
+
+	// Cheap pass over the recorded bounds to find what the ray could hit
+	// RayBoxIntersection misses boxes that contain the ray origin, so check for those too
+	rewindCandidates.clear();
+	Vector3 origin = r.GetPosition();
+	for (int i = 0; i < (int)frame->size(); i++) {
+		Vector3 offset = origin - frame->positions[i];
+		const Vector3& halfSize = frame->halfSizes[i];
+		bool inside = std::abs(offset.x) <= halfSize.x && std::abs(offset.y) <= halfSize.y && std::abs(offset.z) <= halfSize.z;
+		RayCollision boundsCollision;
+		if (inside || CollisionDetection::RayBoxIntersection(r, frame->positions[i], halfSize, boundsCollision)) {
+			rewindCandidates.push_back(i);
+		}
+	}
+
+	RayCollision collision;
+	for (int i : rewindCandidates) {
+		GameObject* object = frame->objects[i];
+		// Deleted since the frame was recorded, or otherwise not hittable
+		if (object == nullptr || object == ignoreThis || !object->GetBoundingVolume()) {
+			continue;
+		}
+		if (!r.getMask().matches(object->getLayer())) {
+			continue;
+		}
+
+		// Rewind just this object, test against it, then put it back
+		Transform& transform = object->GetTransform();
+		Vector3 position = transform.GetPosition();
+		Quaternion orientation = transform.GetOrientation();
+		transform.SetPosition(frame->positions[i]).SetOrientation(frame->orientations[i]);
+
+		RayCollision thisCollision;
+		bool hit = CollisionDetection::RayIntersection(r, *object, thisCollision);
+
+		transform.SetPosition(position).SetOrientation(orientation);
+
+		if (!hit) {
+			continue;
+		}
+		if (!closestObject) {
+			closestCollision = thisCollision;
+			closestCollision.node = object;
+			return true;
+		}
+		if (thisCollision.rayDistance < collision.rayDistance) {
+			thisCollision.node = object;
+			collision = thisCollision;
+		}
+	}
+	if (collision.node) {
+		closestCollision = collision;
+		return true;
+	}
+	return false;
+}
+
 bool GameWorld::hasLineOfSight(GameObject* from, GameObject* to, float maxDistance) const
 {
 	// Ray casts are fairly expensive. If we're too far then it's impossible
@@ -10,6 +10,8 @@
 #include "CollisionDetection.h"
 #include "QuadTree.h"
 #include "GameObject.h"
+#include "SlotMap.h"
+#include "WorldHistory.h"
 
 namespace NCL {
 		// Declare RNG here as an alias, so that changing it would be easy
@@ -61,18 +63,23 @@ namespace NCL {
 
 			bool Raycast(Ray& r, RayCollision& closestCollision, bool closestObject = false, GameObject* ignore = nullptr) const;
 
+			// Snapshot object bounds and transforms for lag compensation
+			// Call once per network tick, after the state for that tick is sent
+			void RecordHistory(int tick);
+			// Raycast against the world as it was on a recorded tick, only objects
+			// the ray could hit are rewound. Falls back to Raycast if the tick wasn't recorded
+			// Objects that didn't exist on that tick can't be hit
+			bool RaycastAtTime(Ray& r, int tick, RayCollision& closestCollision, bool closestObject = false, GameObject* ignore = nullptr);
+
 			// Is there an unobstructed line of sight between two objects?
 			bool hasLineOfSight(GameObject* from, GameObject* to, float maxDistance = std::numeric_limits<float>::infinity()) const;
 
 			virtual void UpdateWorld(float dt);
 
+			// nullptr if the object has been removed, even if its ID has since been reused
 			GameObject* getObject(int id) const {
-				for (auto& i : gameObjects) {
-					if (i->GetWorldID() == id) {
-						return i;
-					}
-				}
-				return nullptr;
+				auto object = gameObjects.get((ObjectMap::Handle)id);
+				return object ? *object : nullptr;
 			}
 
 			void GetObjectIterators(
@@ -93,16 +100,21 @@ namespace NCL {
 				outEnd = range.second;
 			}
 		protected:
-			std::vector<GameObject*> gameObjects;
+			// World IDs are handles into this
+			using ObjectMap = SlotMap<GameObject*>;
+			ObjectMap gameObjects;
 			std::vector<Constraint*> constraints;
 
 			TaggedObjects taggedObjects;
 
+			WorldHistory history;
+			// Scratch space for RaycastAtTime, indices into a history frame
+			std::vector<int> rewindCandidates;
+
 			PerspectiveCamera mainCamera;
 
 			bool shuffleConstraints;
 			bool shuffleObjects;
-			int		worldIDCounter;
 			int		worldStateCounter;
 		};
 	}
@@ -0,0 +1,498 @@
+#include "HierarchicalNavigationGrid.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_map>
+
+#include "Debug.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	// Entrances at least this wide get a crossing at each end instead of one in the middle,
+	// so paths running along the border don't detour through its middle
+	const int LongEntrance = 6;
+
+	// A cluster's cells, which may be cut short at the right and bottom edges of the grid
+	struct ClusterBounds {
+		int x;
+		int y;
+		int width;
+		int height;
+
+		bool contains(int cellX, int cellY) const {
+			return cellX >= x && cellX < x + width && cellY >= y && cellY < y + height;
+		}
+		// Index of a cell within the cluster, from its grid coordinates
+		int local(int cellX, int cellY) const {
+			return (cellY - y) * width + cellX - x;
+		}
+	};
+
+	// A floor cell next to one being searched, inside the same cluster
+	struct ClusterStep {
+		int cell;
+		int x;
+		int y;
+	};
+
+	// The floor cells above, below, left and right of cell that don't leave bounds, in
+	// NavigationGrid::getNeighbours' order. Working from the cell's coordinates saves the
+	// divisions that finding each neighbour's from its index would cost
+	int getClusterSteps(const NavigationGrid& grid, int gridWidth, const ClusterBounds& bounds, int cell, int x, int y, ClusterStep stepsOut[4]) {
+		const ClusterStep candidates[4] = {
+			{ cell - gridWidth, x, y - 1 },
+			{ cell + gridWidth, x, y + 1 },
+			{ cell - 1, x - 1, y },
+			{ cell + 1, x + 1, y },
+		};
+		int count = 0;
+		for (const ClusterStep& step : candidates) {
+			if (bounds.contains(step.x, step.y) && !grid.isWall(step.cell)) {
+				stepsOut[count++] = step;
+			}
+		}
+		return count;
+	}
+
+	ClusterBounds getBounds(int cluster, int clustersX, int clusterSize, int gridWidth, int gridHeight) {
+		ClusterBounds bounds;
+		bounds.x		= (cluster % clustersX) * clusterSize;
+		bounds.y		= (cluster / clustersX) * clusterSize;
+		bounds.width	= std::min(clusterSize, gridWidth - bounds.x);
+		bounds.height	= std::min(clusterSize, gridHeight - bounds.y);
+		return bounds;
+	}
+
+	// Cost and cell, in a min heap ordered lowest cost first
+	using Queued = std::pair<uint32_t, int>;
+
+	void pushQueued(std::vector<Queued>& open, Queued entry) {
+		open.push_back(entry);
+		std::push_heap(open.begin(), open.end(), std::greater<>());
+	}
+
+	Queued popQueued(std::vector<Queued>& open) {
+		std::pop_heap(open.begin(), open.end(), std::greater<>());
+		Queued top = open.back();
+		open.pop_back();
+		return top;
+	}
+
+	// The searches bounded to one cluster, and what a query builds from them
+	// Kept between queries so that once they've grown, queries don't allocate
+	struct ClusterScratch {
+		std::vector<uint32_t>	fromStart;
+		std::vector<uint32_t>	toGoal;
+		std::vector<int>		fromStartParents;
+		std::vector<int>		toGoalParents;
+		std::vector<uint32_t>	pathCosts;
+		std::vector<int>		parents;
+		std::vector<Queued>		open;
+		std::vector<uint32_t>	route;
+		std::vector<int>		cells;
+	};
+
+	thread_local ClusterScratch clusterScratch;
+
+	// The abstract search's state for each node, kept between searches like NavigationGrid's
+	// Nodes are only valid for the search whose generation they were stamped with
+	struct AbstractScratch {
+		std::vector<uint32_t>	reached;
+		std::vector<uint32_t>	cost;
+		std::vector<uint32_t>	parent;
+		// The edge taken from parent, or NoEdge to and from the start and goal
+		std::vector<uint32_t>	parentEdge;
+		// The open list, a min heap of cost and node that may hold stale entries
+		std::vector<std::pair<uint32_t, uint32_t>>	open;
+		uint32_t				generation = 0;
+
+		void begin(size_t nodeCount) {
+			if (reached.size() < nodeCount) {
+				reached.resize(nodeCount, 0);
+				cost.resize(nodeCount);
+				parent.resize(nodeCount);
+				parentEdge.resize(nodeCount);
+			}
+			if (++generation == 0) {
+				std::fill(reached.begin(), reached.end(), 0);
+				generation = 1;
+			}
+			open.clear();
+		}
+	};
+
+	thread_local AbstractScratch abstractScratch;
+}
+
+HierarchicalNavigationGrid::HierarchicalNavigationGrid(const std::string& filename, Vector3 offset, int clusterSize)
+	: NavigationGrid(filename, offset), clusterSize(clusterSize) {
+	buildAbstractGraph();
+}
+
+HierarchicalNavigationGrid::HierarchicalNavigationGrid(GridLayout&& layout, Vector3 offset, int clusterSize)
+	: NavigationGrid(std::move(layout), offset), clusterSize(clusterSize) {
+	buildAbstractGraph();
+}
+
+void HierarchicalNavigationGrid::buildAbstractGraph() {
+	clustersX = (gridWidth + clusterSize - 1) / clusterSize;
+	clustersY = (gridHeight + clusterSize - 1) / clusterSize;
+	int clusterCount = clustersX * clustersY;
+
+	// Pairs of floor cells facing each other across a cluster border
+	std::vector<std::pair<int, int>> crossings;
+	auto addEntrances = [&](int firstA, int firstB, int step, int length) {
+		int runStart = -1;
+		for (int i = 0; i <= length; i++) {
+			bool open = i < length && !isWall(firstA + i * step) && !isWall(firstB + i * step);
+			if (open && runStart < 0) {
+				runStart = i;
+			}
+			if (!open && runStart >= 0) {
+				int runLength = i - runStart;
+				if (runLength < LongEntrance) {
+					int middle = runStart + runLength / 2;
+					crossings.push_back({ firstA + middle * step, firstB + middle * step });
+				} else {
+					crossings.push_back({ firstA + runStart * step, firstB + runStart * step });
+					crossings.push_back({ firstA + (i - 1) * step, firstB + (i - 1) * step });
+				}
+				runStart = -1;
+			}
+		}
+	};
+	for (int cluster = 0; cluster < clusterCount; cluster++) {
+		ClusterBounds bounds = getBounds(cluster, clustersX, clusterSize, gridWidth, gridHeight);
+		if (bounds.x + bounds.width < gridWidth) {
+			int right = bounds.x + bounds.width - 1;
+			addEntrances(bounds.y * gridWidth + right, bounds.y * gridWidth + right + 1, gridWidth, bounds.height);
+		}
+		if (bounds.y + bounds.height < gridHeight) {
+			int bottom = bounds.y + bounds.height - 1;
+			addEntrances(bottom * gridWidth + bounds.x, (bottom + 1) * gridWidth + bounds.x, 1, bounds.width);
+		}
+	}
+
+	// Number the crossing cells cluster by cluster, once each even if they're on two borders
+	std::vector<std::vector<int>> clusterCells(clusterCount);
+	std::unordered_map<int, uint32_t> nodeOf;
+	for (auto& [a, b] : crossings) {
+		for (int cell : { a, b }) {
+			if (nodeOf.emplace(cell, 0).second) {
+				clusterCells[getCluster(cell)].push_back(cell);
+			}
+		}
+	}
+	nodeCells.clear();
+	nodePositions.clear();
+	clusterNodeStart.assign(clusterCount + 1, 0);
+	for (int cluster = 0; cluster < clusterCount; cluster++) {
+		clusterNodeStart[cluster] = (uint32_t)nodeCells.size();
+		for (int cell : clusterCells[cluster]) {
+			nodeOf[cell] = (uint32_t)nodeCells.size();
+			nodeCells.push_back(cell);
+			nodePositions.push_back({ cell % gridWidth, cell / gridWidth });
+		}
+	}
+	clusterNodeStart[clusterCount] = (uint32_t)nodeCells.size();
+
+	// Stepping across each entrance costs whatever the cell stepped onto costs
+	std::vector<std::vector<Edge>> crossingEdges(nodeCells.size());
+	for (auto& [a, b] : crossings) {
+		crossingEdges[nodeOf[a]].push_back({ nodeOf[b], costs[b] });
+		crossingEdges[nodeOf[b]].push_back({ nodeOf[a], costs[a] });
+	}
+
+	edgeStart.assign(nodeCells.size() + 1, 0);
+	edges.clear();
+	edgePathStart.clear();
+	pathSteps.clear();
+	uint32_t stepCount = 0;
+	auto pushStep = [&](int delta) {
+		uint8_t direction = delta == -gridWidth ? 0 : delta == gridWidth ? 1 : delta == -1 ? 2 : 3;
+		if (stepCount % 4 == 0) {
+			pathSteps.push_back(0);
+		}
+		pathSteps.back() |= direction << (stepCount % 4 * 2);
+		stepCount++;
+	};
+
+	// And between each pair of nodes in a cluster, the best path that stays inside it, stored
+	// so queries can walk it. Nodes are numbered cluster by cluster, so this visits them in order
+	std::vector<uint32_t>	pathCosts;
+	std::vector<int>		parents;
+	std::vector<int>		backwards;
+	for (int cluster = 0; cluster < clusterCount; cluster++) {
+		ClusterBounds bounds = getBounds(cluster, clustersX, clusterSize, gridWidth, gridHeight);
+		for (uint32_t from = clusterNodeStart[cluster]; from < clusterNodeStart[cluster + 1]; from++) {
+			edgeStart[from] = (uint32_t)edges.size();
+			for (const Edge& edge : crossingEdges[from]) {
+				edges.push_back(edge);
+				edgePathStart.push_back(stepCount);
+			}
+			clusterCosts(nodeCells[from], false, pathCosts, parents);
+			for (uint32_t to = clusterNodeStart[cluster]; to < clusterNodeStart[cluster + 1]; to++) {
+				int cell = nodeCells[to];
+				uint32_t cost = pathCosts[bounds.local(cell % gridWidth, cell / gridWidth)];
+				if (to == from || cost == Unreachable) {
+					continue;
+				}
+				edges.push_back({ to, cost });
+				edgePathStart.push_back(stepCount);
+				backwards.clear();
+				for (int c = cell; c != nodeCells[from]; c = parents[bounds.local(c % gridWidth, c / gridWidth)]) {
+					backwards.push_back(c);
+				}
+				int previous = nodeCells[from];
+				for (auto i = backwards.rbegin(); i != backwards.rend(); ++i) {
+					pushStep(*i - previous);
+					previous = *i;
+				}
+			}
+		}
+	}
+	edgeStart[nodeCells.size()] = (uint32_t)edges.size();
+	edgePathStart.push_back(stepCount);
+}
+
+void HierarchicalNavigationGrid::clusterCosts(int cell, bool reverse, std::vector<uint32_t>& costsOut, std::vector<int>& parentsOut) const {
+	ClusterBounds bounds = getBounds(getCluster(cell), clustersX, clusterSize, gridWidth, gridHeight);
+	costsOut.assign(bounds.width * bounds.height, Unreachable);
+	// Only read for cells with a cost, so they needn't be cleared
+	parentsOut.resize(bounds.width * bounds.height);
+	costsOut[bounds.local(cell % gridWidth, cell / gridWidth)] = 0;
+
+	std::vector<Queued>& open = clusterScratch.open;
+	open.clear();
+	pushQueued(open, { 0, cell });
+	while (!open.empty()) {
+		auto [cost, current] = popQueued(open);
+		int x = current % gridWidth;
+		int y = current / gridWidth;
+		if (cost > costsOut[bounds.local(x, y)]) {
+			continue; // Already reached more cheaply
+		}
+		ClusterStep steps[4];
+		int stepCount = getClusterSteps(*this, gridWidth, bounds, current, x, y, steps);
+		for (int i = 0; i < stepCount; i++) {
+			const ClusterStep& step = steps[i];
+			// Backwards, each step costs what the cell we came from does
+			uint32_t next = cost + (reverse ? costs[current] : costs[step.cell]);
+			int local = bounds.local(step.x, step.y);
+			if (next < costsOut[local]) {
+				costsOut[local]		= next;
+				parentsOut[local]	= current;
+				pushQueued(open, { next, step.cell });
+			}
+		}
+	}
+}
+
+bool HierarchicalNavigationGrid::clusterPath(int cluster, int start, int goal, std::vector<int>& cellsOut) const {
+	ClusterBounds bounds = getBounds(cluster, clustersX, clusterSize, gridWidth, gridHeight);
+	int goalX = goal % gridWidth;
+	int goalY = goal / gridWidth;
+	// Every cell costs at least 1, so the step count never overestimates
+	auto heuristic = [&](int x, int y) {
+		return (uint32_t)(std::abs(x - goalX) + std::abs(y - goalY));
+	};
+
+	// Parents are only read for cells with a cost, so they needn't be cleared
+	std::vector<uint32_t>&	pathCosts	= clusterScratch.pathCosts;
+	std::vector<int>&		parents		= clusterScratch.parents;
+	pathCosts.assign(bounds.width * bounds.height, Unreachable);
+	parents.resize(bounds.width * bounds.height);
+	int startX = start % gridWidth;
+	int startY = start / gridWidth;
+	pathCosts[bounds.local(startX, startY)] = 0;
+
+	std::vector<Queued>& open = clusterScratch.open;
+	open.clear();
+	pushQueued(open, { heuristic(startX, startY), start });
+	while (!open.empty()) {
+		auto [estimate, current] = popQueued(open);
+		int x = current % gridWidth;
+		int y = current / gridWidth;
+		uint32_t cost = pathCosts[bounds.local(x, y)];
+		if (estimate > cost + heuristic(x, y)) {
+			continue; // Already reached more cheaply
+		}
+		if (current == goal) {
+			size_t first = cellsOut.size();
+			for (int c = goal; c != start; c = parents[bounds.local(c % gridWidth, c / gridWidth)]) {
+				cellsOut.push_back(c);
+			}
+			std::reverse(cellsOut.begin() + first, cellsOut.end());
+			return true;
+		}
+		ClusterStep steps[4];
+		int stepCount = getClusterSteps(*this, gridWidth, bounds, current, x, y, steps);
+		for (int i = 0; i < stepCount; i++) {
+			const ClusterStep& step = steps[i];
+			uint32_t next = cost + costs[step.cell];
+			int local = bounds.local(step.x, step.y);
+			if (next < pathCosts[local]) {
+				pathCosts[local]	= next;
+				parents[local]		= current;
+				pushQueued(open, { next + heuristic(step.x, step.y), step.cell });
+			}
+		}
+	}
+	return false;
+}
+
+void HierarchicalNavigationGrid::walkEdge(uint32_t edge, int cell, std::vector<int>& cellsOut) const {
+	// An edge across an entrance is a single step, straight onto the node it leads to
+	if (edgePathStart[edge] == edgePathStart[edge + 1]) {
+		cellsOut.push_back(nodeCells[edges[edge].to]);
+		return;
+	}
+	const int deltas[4] = { -gridWidth, gridWidth, -1, 1 };
+	for (uint32_t step = edgePathStart[edge]; step < edgePathStart[edge + 1]; step++) {
+		cell += deltas[(pathSteps[step / 4] >> (step % 4 * 2)) & 3];
+		cellsOut.push_back(cell);
+	}
+}
+
+bool HierarchicalNavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) const {
+	int startCell	= getCellAt(from);
+	int goalCell	= getCellAt(to);
+	if (startCell < 0 || goalCell < 0) {
+		return false; //outside of map region!
+	}
+	// Walls aren't part of the abstract graph, so leave starting or ending in one to the plain search
+	if (isWall(startCell) || isWall(goalCell)) {
+		return NavigationGrid::FindPath(from, to, outPath);
+	}
+	if (regions[startCell] != regions[goalCell]) {
+		return false;
+	}
+
+	Debug::DrawLine(getPosition(startCell), getPosition(goalCell), Debug::GREEN);
+
+	int startCluster	= getCluster(startCell);
+	int goalCluster		= getCluster(goalCell);
+	// Every cell after the start, up to and including the goal
+	std::vector<int>& cells = clusterScratch.cells;
+	cells.clear();
+
+	if (startCluster != goalCluster || !clusterPath(startCluster, startCell, goalCell, cells)) {
+		// The start and goal join the abstract graph for this search, through what they can reach in their clusters
+		std::vector<uint32_t>& fromStart	= clusterScratch.fromStart;
+		std::vector<uint32_t>& toGoal		= clusterScratch.toGoal;
+		// Their parents lead back to the start, and on towards the goal, for filling in the path later
+		std::vector<int>& fromStartParents	= clusterScratch.fromStartParents;
+		std::vector<int>& toGoalParents		= clusterScratch.toGoalParents;
+		clusterCosts(startCell, false, fromStart, fromStartParents);
+		clusterCosts(goalCell, true, toGoal, toGoalParents);
+		ClusterBounds startBounds	= getBounds(startCluster, clustersX, clusterSize, gridWidth, gridHeight);
+		ClusterBounds goalBounds	= getBounds(goalCluster, clustersX, clusterSize, gridWidth, gridHeight);
+		auto local = [&](const ClusterBounds& bounds, int c) {
+			return bounds.local(c % gridWidth, c / gridWidth);
+		};
+
+		const uint32_t startNode	= (uint32_t)nodeCells.size();
+		const uint32_t goalNode		= startNode + 1;
+		int goalX = goalCell % gridWidth;
+		int goalY = goalCell / gridWidth;
+		auto heuristic = [&](uint32_t node) {
+			auto [x, y] = node < startNode ? nodePositions[node]
+				: (node == startNode ? std::pair(startCell % gridWidth, startCell / gridWidth) : std::pair(goalX, goalY));
+			return (uint32_t)(std::abs(x - goalX) + std::abs(y - goalY)) * HeuristicWeight;
+		};
+
+		AbstractScratch& scratch = abstractScratch;
+		scratch.begin(goalNode + 1);
+		auto& open = scratch.open;
+		auto cost = [&](uint32_t node) {
+			return scratch.reached[node] == scratch.generation ? scratch.cost[node] : Unreachable;
+		};
+		auto relax = [&](uint32_t node, uint32_t parent, uint32_t newCost, uint32_t edge) {
+			if (cost(node) <= newCost) {
+				return;
+			}
+			scratch.reached[node]		= scratch.generation;
+			scratch.cost[node]			= newCost;
+			scratch.parent[node]		= parent;
+			scratch.parentEdge[node]	= edge;
+			open.push_back({ newCost + heuristic(node), node });
+			std::push_heap(open.begin(), open.end(), std::greater<>());
+		};
+
+		relax(startNode, startNode, 0, NoEdge);
+		bool found = false;
+		while (!open.empty()) {
+			std::pop_heap(open.begin(), open.end(), std::greater<>());
+			auto [estimate, node] = open.back();
+			open.pop_back();
+			uint32_t nodeCost = scratch.cost[node];
+			if (estimate > nodeCost + heuristic(node)) {
+				continue; // Already reached more cheaply
+			}
+			if (node == goalNode) {
+				found = true;
+				break;
+			}
+			if (node == startNode) {
+				for (uint32_t n = clusterNodeStart[startCluster]; n < clusterNodeStart[startCluster + 1]; n++) {
+					uint32_t toNode = fromStart[local(startBounds, nodeCells[n])];
+					if (toNode != Unreachable) {
+						relax(n, node, toNode, NoEdge);
+					}
+				}
+				continue;
+			}
+			for (uint32_t e = edgeStart[node]; e < edgeStart[node + 1]; e++) {
+				relax(edges[e].to, node, nodeCost + edges[e].cost, e);
+			}
+			if (node >= clusterNodeStart[goalCluster] && node < clusterNodeStart[goalCluster + 1]) {
+				uint32_t toEnd = toGoal[local(goalBounds, nodeCells[node])];
+				if (toEnd != Unreachable) {
+					relax(goalNode, node, nodeCost + toEnd, NoEdge);
+				}
+			}
+		}
+		if (!found) {
+			return false;
+		}
+
+		std::vector<uint32_t>& route = clusterScratch.route;
+		route.clear();
+		for (uint32_t node = goalNode; node != startNode; node = scratch.parent[node]) {
+			route.push_back(node);
+		}
+		std::reverse(route.begin(), route.end());
+
+		// Fill in the cells between each pair of nodes, from the paths stored with their edges,
+		// and the start and goal searches' parents at either end
+		cells.clear();
+		for (uint32_t node : route) {
+			uint32_t parent = scratch.parent[node];
+			if (parent == startNode) {
+				size_t first = cells.size();
+				for (int c = nodeCells[node]; c != startCell; c = fromStartParents[local(startBounds, c)]) {
+					cells.push_back(c);
+				}
+				std::reverse(cells.begin() + first, cells.end());
+			} else if (node == goalNode) {
+				for (int c = nodeCells[parent]; c != goalCell; ) {
+					c = toGoalParents[local(goalBounds, c)];
+					cells.push_back(c);
+				}
+			} else {
+				walkEdge(scratch.parentEdge[node], nodeCells[parent], cells);
+			}
+		}
+	}
+
+	// Add the end position
+	outPath.PushWaypoint(to);
+	for (auto i = cells.rbegin(); i != cells.rend(); ++i) {
+		outPath.PushWaypoint(getPosition(*i));
+	}
+	// Add the start position
+	outPath.PushWaypoint(from);
+	return true;
+}
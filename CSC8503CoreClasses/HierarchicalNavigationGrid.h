@@ -0,0 +1,87 @@
+#pragma once
+#include "NavigationGrid.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace NCL {
+	namespace CSC8503 {
+		// A NavigationGrid searched hierarchically (HPA*), for large maps
+		// The grid is split into square clusters. Where floor crosses from one cluster to the
+		// next, entrance cells either side become nodes of a much smaller graph, joined to
+		// each other node in their cluster by the cost of the best path inside the cluster.
+		// Queries search that graph, then fill in the cells between each pair of nodes from
+		// the path stored with the edge joining them. Paths are close to, but not always, the shortest
+		class HierarchicalNavigationGrid : public NavigationGrid {
+		public:
+			static const constexpr int DefaultClusterSize = 16;
+
+			HierarchicalNavigationGrid(const std::string& filename, Vector3 offset = Vector3(), int clusterSize = DefaultClusterSize);
+			HierarchicalNavigationGrid(GridLayout&& layout, Vector3 offset = Vector3(), int clusterSize = DefaultClusterSize);
+
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) const override;
+
+			int getClusterSize() const {
+				return clusterSize;
+			}
+			size_t getEntranceCount() const {
+				return nodeCells.size();
+			}
+			size_t getEdgeCount() const {
+				return edges.size();
+			}
+			// Memory taken by the abstract graph and the paths stored with it
+			size_t getGraphBytes() const {
+				return nodeCells.size() * sizeof(int) + nodePositions.size() * sizeof(std::pair<int, int>)
+					+ clusterNodeStart.size() * sizeof(uint32_t)
+					+ edgeStart.size() * sizeof(uint32_t) + edges.size() * sizeof(Edge)
+					+ edgePathStart.size() * sizeof(uint32_t) + pathSteps.size();
+			}
+
+		protected:
+			static const constexpr uint32_t Unreachable = UINT32_MAX;
+			static const constexpr uint32_t NoEdge = UINT32_MAX;
+			// The abstract search overestimates the distance left by this much, expanding far fewer
+			// nodes for paths a little longer than the best, much as NavigationGrid's does
+			static const constexpr uint32_t HeuristicWeight = 4;
+
+			struct Edge {
+				uint32_t	to;
+				uint32_t	cost;
+			};
+
+			void buildAbstractGraph();
+
+			int getCluster(int cell) const {
+				return ((cell / gridWidth) / clusterSize) * clustersX + (cell % gridWidth) / clusterSize;
+			}
+			// Cost from cell to every cell of its cluster without leaving it, indexed within the
+			// cluster. Reversed, it's the cost from every cell to this one instead
+			// Each reached cell's parent is the cell before it on the way from cell, or reversed,
+			// the next one on the way to it
+			void clusterCosts(int cell, bool reverse, std::vector<uint32_t>& costsOut, std::vector<int>& parentsOut) const;
+			// Appends the cells after start up to goal, staying inside cluster
+			bool clusterPath(int cluster, int start, int goal, std::vector<int>& cellsOut) const;
+			// Appends the cells after cell, the node edge leaves from, up to the node it leads to
+			void walkEdge(uint32_t edge, int cell, std::vector<int>& cellsOut) const;
+
+			int clusterSize;
+			int clustersX;
+			int clustersY;
+
+			// Nodes are numbered cluster by cluster, so a cluster's nodes are a run of them
+			std::vector<int>		nodeCells;
+			// Each node's cell as x and y, so the search's heuristic needn't divide to find them
+			std::vector<std::pair<int, int>>	nodePositions;
+			std::vector<uint32_t>	clusterNodeStart;
+			// Each node's edges, to nodes in its own cluster and across entrances to the next
+			std::vector<uint32_t>	edgeStart;
+			std::vector<Edge>		edges;
+			// The steps along each edge inside a cluster, found when its cost was. Edge e's are
+			// steps edgePathStart[e] up to edgePathStart[e + 1], each 2 bits of pathSteps for the
+			// direction moved. Edges across an entrance are a single step and store none
+			std::vector<uint32_t>	edgePathStart;
+			std::vector<uint8_t>	pathSteps;
+		};
+	}
+}
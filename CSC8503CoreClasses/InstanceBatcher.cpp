@@ -0,0 +1,31 @@
+#include "InstanceBatcher.h"
+
+#include "RenderObject.h"
+#include "Transform.h"
+
+using namespace NCL::CSC8503;
+
+void InstanceBatcher::build(const RenderQueue& queue) {
+	batches.clear();
+	instances.clear();
+
+	for (size_t pass = 0; pass < (size_t)RenderQueue::Pass::Count; pass++) {
+		passStarts[pass] = batches.size();
+		stats[pass] = queue.forEachDraw((RenderQueue::Pass)pass, [&](const RenderQueue::Item& item, RenderQueue::StateChange change) {
+			// Nothing to bind means it can join the previous draw
+			bool sameState = !change.shader && !change.texture && !change.mesh && !change.lod;
+			if (!sameState || batches.size() == passStarts[pass]) {
+				batches.push_back({ item.object, change, (uint32_t)instances.size(), 0 });
+			}
+			batches.back().instanceCount++;
+			instances.push_back({ item.object->GetTransform()->GetMatrix(), item.object->GetColour() });
+		});
+	}
+	passStarts[(size_t)RenderQueue::Pass::Count] = batches.size();
+}
+
+std::span<const InstanceBatcher::Batch> InstanceBatcher::getBatches(RenderQueue::Pass pass) const {
+	size_t begin = passStarts[(size_t)pass];
+	size_t end = passStarts[(size_t)pass + 1];
+	return std::span<const Batch>(batches).subspan(begin, end - begin);
+}
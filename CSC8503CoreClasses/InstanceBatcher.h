@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Matrix.h"
+#include "RenderQueue.h"
+#include "Vector.h"
+
+namespace NCL::CSC8503 {
+	// Turns a sorted RenderQueue into instanced draws
+	// The queue puts draws with the same shader, texture, mesh and LOD next to each other,
+	// so each run of them becomes one batch, drawn with a single instanced call.
+	// Per object data for every batch is packed into one array, ready to upload
+	// Knows nothing about the graphics API, so can be run headless
+	class InstanceBatcher {
+	public:
+		// Matches Instance in instances.glslh, laid out for a std430 buffer
+		struct Instance {
+			Maths::Matrix4 modelMatrix;
+			Maths::Vector4 colour;
+		};
+		static_assert(sizeof(Instance) == 80, "Instance must match the shader's layout");
+
+		struct Batch {
+			// Supplies the shader, texture and mesh for the whole batch
+			const RenderObject* object;
+			// What needs binding before the batch is drawn
+			RenderQueue::StateChange change;
+			uint32_t firstInstance;
+			uint32_t instanceCount;
+		};
+
+		// Rebuilds every pass's batches and instances from queue, which must be sorted
+		void build(const RenderQueue& queue);
+
+		std::span<const Batch> getBatches(RenderQueue::Pass pass) const;
+		// All passes' instances, each batch indexes into this
+		std::span<const Instance> getInstances() const {
+			return instances;
+		}
+		// Binds needed by the pass's batches, draws are objects rather than batches
+		const RenderQueue::Stats& getStats(RenderQueue::Pass pass) const {
+			return stats[(size_t)pass];
+		}
+	private:
+		std::vector<Batch> batches;
+		std::vector<Instance> instances;
+		// Start of each pass in batches, with one past the end
+		size_t passStarts[(size_t)RenderQueue::Pass::Count + 1] = {};
+		RenderQueue::Stats stats[(size_t)RenderQueue::Pass::Count];
+	};
+}
@@ -0,0 +1,68 @@
+#include "JobQueue.h"
+
+using namespace NCL::CSC8503;
+
+JobQueue::JobQueue(size_t threadCount) {
+	for (size_t i = 0; i < threadCount; i++) {
+		threads.emplace_back([this]() { workerLoop(); });
+	}
+}
+
+JobQueue::~JobQueue() {
+	clear();
+	{
+		std::lock_guard lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+size_t JobQueue::DefaultThreadCount() {
+	unsigned int cores = std::thread::hardware_concurrency();
+	return cores > 2 ? cores - 1 : 1;
+}
+
+size_t JobQueue::clear() {
+	// Destroyed outside the lock, as that's what breaks their futures
+	std::deque<std::function<void()>> dropped;
+	{
+		std::lock_guard lock(mutex);
+		dropped.swap(jobs);
+	}
+	return dropped.size();
+}
+
+size_t JobQueue::getQueuedCount() const {
+	std::lock_guard lock(mutex);
+	return jobs.size();
+}
+
+void JobQueue::push(std::function<void()> job) {
+	{
+		std::lock_guard lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	wake.notify_one();
+}
+
+void JobQueue::workerLoop() {
+	std::unique_lock lock(mutex);
+	while (true) {
+		wake.wait(lock, [&]() { return stopping || !jobs.empty(); });
+		if (stopping) {
+			return;
+		}
+		std::function<void()> job = std::move(jobs.front());
+		jobs.pop_front();
+		lock.unlock();
+
+		job();
+		// Anything the job captured goes before the lock is taken again
+		job = nullptr;
+
+		lock.lock();
+	}
+}
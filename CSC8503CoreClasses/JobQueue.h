@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace NCL::CSC8503 {
+	// Threads that run jobs in the background, in the order they were submitted
+	// Unlike WorkerPool the caller doesn't wait, it gets a future to check on later,
+	// so jobs can be long, like loading files
+	class JobQueue {
+	public:
+		// Defaults to a thread per core less one for the caller, but always at least one
+		explicit JobQueue(size_t threadCount = DefaultThreadCount());
+		// Waits for running jobs, jobs that haven't started are dropped
+		~JobQueue();
+
+		JobQueue(const JobQueue&) = delete;
+		JobQueue& operator=(const JobQueue&) = delete;
+
+		// Runs func() on a worker thread. Its result, or anything it throws, comes back through the future
+		template <typename F>
+		auto submit(F&& func) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+			using Result = std::invoke_result_t<std::decay_t<F>>;
+			// packaged_task can't be copied, and std::function needs to be
+			auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+			std::future<Result> future = task->get_future();
+			push([task]() { (*task)(); });
+			return future;
+		}
+
+		// Drops jobs that haven't started, their futures throw std::future_error
+		// Returns how many were dropped
+		size_t clear();
+
+		// Jobs waiting for a thread, not counting ones already running
+		size_t getQueuedCount() const;
+		size_t getThreadCount() const {
+			return threads.size();
+		}
+
+		static size_t DefaultThreadCount();
+	private:
+		void push(std::function<void()> job);
+		void workerLoop();
+
+		std::vector<std::thread> threads;
+
+		mutable std::mutex mutex;
+		std::condition_variable wake;
+		std::deque<std::function<void()>> jobs;
+		bool stopping = false;
+	};
+}
@@ -0,0 +1,73 @@
+#include "MazeGenerator.h"
+
+#include <random>
+
+using namespace NCL;
+using namespace CSC8503;
+
+GridLayout MazeGenerator::Generate(const Settings& settings) {
+	GridLayout layout(settings.nodeSize, settings.width, settings.height);
+	int width	= settings.width;
+	int height	= settings.height;
+	std::mt19937 rng(settings.seed);
+	if (width < 3 || height < 3) {
+		return layout;
+	}
+
+	// Walked with our own stack, as a recursive walk would go millions of calls deep
+	const int stepX[4] = { 0, 0, -2, 2 };
+	const int stepY[4] = { -2, 2, 0, 0 };
+	std::vector<int> stack;
+	stack.push_back(width + 1);
+	layout.setWall(width + 1, false);
+	while (!stack.empty()) {
+		int cell = stack.back();
+		int x = cell % width;
+		int y = cell / width;
+
+		// Pick one of the neighbouring cells still walled in, from a random starting direction
+		int start = rng() % 4;
+		int next = -1;
+		for (int i = 0; i < 4; i++) {
+			int direction = (start + i) % 4;
+			int nx = x + stepX[direction];
+			int ny = y + stepY[direction];
+			if (nx <= 0 || ny <= 0 || nx >= width - 1 || ny >= height - 1) {
+				continue;
+			}
+			int neighbour = ny * width + nx;
+			if (layout.isWall(neighbour)) {
+				next = neighbour;
+				break;
+			}
+		}
+		if (next < 0) {
+			stack.pop_back();
+			continue;
+		}
+		// Knock through the wall between us
+		layout.setWall((cell + next) / 2, false);
+		layout.setWall(next, false);
+		stack.push_back(next);
+	}
+
+	std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+	for (int y = 1; y < height - 1; y++) {
+		for (int x = 1; x < width - 1; x++) {
+			int cell = y * width + x;
+			if (layout.isWall(cell)) {
+				// Only walls separating two corridors in a line, so the maze keeps its shape
+				bool betweenRows	= !layout.isWall(cell - width) && !layout.isWall(cell + width)
+					&& layout.isWall(cell - 1) && layout.isWall(cell + 1);
+				bool betweenColumns	= !layout.isWall(cell - 1) && !layout.isWall(cell + 1)
+					&& layout.isWall(cell - width) && layout.isWall(cell + width);
+				if ((betweenRows || betweenColumns) && chance(rng) < settings.loopChance) {
+					layout.setWall(cell, false);
+				}
+			} else if (chance(rng) < settings.roughChance) {
+				layout.costs[cell] = (uint8_t)(2 + rng() % 3);
+			}
+		}
+	}
+	return layout;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "NavigationGrid.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		// Builds large random mazes, for stress testing pathfinding
+		// Corridors are carved by a depth first walk between cells on odd coordinates,
+		// giving a single route between any two points, then some walls between
+		// corridors are knocked out so searches have loops to choose between
+		class MazeGenerator {
+		public:
+			struct Settings {
+				int			width		= 4096;
+				int			height		= 4096;
+				int			nodeSize	= 10;
+				uint32_t	seed		= 1;
+				// Chance of opening each remaining wall between two corridors
+				float		loopChance	= 0.05f;
+				// Chance of a corridor cell being rough ground, costing 2 to 4 to cross
+				float		roughChance	= 0.1f;
+			};
+
+			static GridLayout Generate(const Settings& settings);
+		};
+	}
+}
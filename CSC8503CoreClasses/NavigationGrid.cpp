@@ -1,83 +1,264 @@
 #include "NavigationGrid.h"
 
+#include <algorithm>
 #include <cassert>
-#include <queue>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
+#include <iostream>
 
 #include "Assets.h"
 #include "Debug.h"
+#include "NavigationGridBinary.h"
 
 using namespace NCL;
 using namespace CSC8503;
 
-const int LEFT_NODE		= 0;
-const int RIGHT_NODE	= 1;
-const int TOP_NODE		= 2;
-const int BOTTOM_NODE	= 3;
+const int TOP_NODE		= 0;
+const int BOTTOM_NODE	= 1;
+const int LEFT_NODE		= 2;
+const int RIGHT_NODE	= 3;
+
+namespace {
+	// Everything a search needs to know about each cell, kept between searches so they don't allocate
+	// Cells are only valid for the search whose generation they were stamped with, so nothing needs
+	// clearing between searches, or between grids sharing a thread
+	struct SearchScratch {
+		// Marks a cell as closed in heapIndex
+		static const constexpr int Closed = -1;
+
+		// Generation of the search that last reached each cell
+		std::vector<uint32_t>	reached;
+		// g(n), cost from start to n
+		std::vector<float>		currentCost;
+		// g(n) + h(n), cost from start to n + heuristic cost from n to goal
+		std::vector<float>		currentPlusHeuristic;
+		std::vector<int>		parent;
+		// Where each open cell is in the heap
+		std::vector<int>		heapIndex;
+		// The open list, a binary min heap of cells by currentPlusHeuristic
+		std::vector<int>		heap;
+		uint32_t				generation = 0;
+
+		void begin(size_t cellCount) {
+			if (reached.size() < cellCount) {
+				reached.resize(cellCount, 0);
+				currentCost.resize(cellCount);
+				currentPlusHeuristic.resize(cellCount);
+				parent.resize(cellCount);
+				heapIndex.resize(cellCount);
+			}
+			if (++generation == 0) {
+				// Wrapped around, so old stamps could match again
+				std::fill(reached.begin(), reached.end(), 0);
+				generation = 1;
+			}
+			heap.clear();
+		}
+
+		bool isReached(int cell) const {
+			return reached[cell] == generation;
+		}
+		bool isClosed(int cell) const {
+			return isReached(cell) && heapIndex[cell] == Closed;
+		}
+
+		// Opens a cell, or moves it up the heap if it's already open and its cost went down
+		void open(int cell, int from, float g, float f) {
+			if (!isReached(cell)) {
+				reached[cell] = generation;
+				heapIndex[cell] = (int)heap.size();
+				heap.push_back(cell);
+			}
+			parent[cell]				= from;
+			currentCost[cell]			= g;
+			currentPlusHeuristic[cell]	= f;
+			siftUp(heapIndex[cell]);
+		}
+
+		// Removes and closes the open cell with the lowest f
+		int close() {
+			int best = heap[0];
+			heap[0] = heap.back();
+			heapIndex[heap[0]] = 0;
+			heap.pop_back();
+			if (!heap.empty()) {
+				siftDown(0);
+			}
+			heapIndex[best] = Closed;
+			return best;
+		}
+
+		void place(int i, int cell) {
+			heap[i] = cell;
+			heapIndex[cell] = i;
+		}
+		void siftUp(int i) {
+			int cell = heap[i];
+			while (i > 0) {
+				int up = (i - 1) / 2;
+				if (currentPlusHeuristic[heap[up]] <= currentPlusHeuristic[cell]) {
+					break;
+				}
+				place(i, heap[up]);
+				i = up;
+			}
+			place(i, cell);
+		}
+		void siftDown(int i) {
+			int cell = heap[i];
+			int count = (int)heap.size();
+			while (true) {
+				int down = i * 2 + 1;
+				if (down >= count) {
+					break;
+				}
+				if (down + 1 < count && currentPlusHeuristic[heap[down + 1]] < currentPlusHeuristic[heap[down]]) {
+					down++;
+				}
+				if (currentPlusHeuristic[cell] <= currentPlusHeuristic[heap[down]]) {
+					break;
+				}
+				place(i, heap[down]);
+				i = down;
+			}
+			place(i, cell);
+		}
+	};
+
+	// One per thread, so agents can search in parallel
+	thread_local SearchScratch searchScratch;
+}
+
+GridLayout::GridLayout(int nodeSize, int width, int height)
+	: nodeSize(nodeSize), width(width), height(height)
+	, walls(((size_t)width * height + 63) / 64, ~0ull)
+	, costs((size_t)width * height, 1) {
+}
 
 NavigationGrid::NavigationGrid()	{
 	nodeSize	= 0;
 	gridWidth	= 0;
 	gridHeight	= 0;
-	allNodes	= nullptr;
+	regionCount	= 0;
 }
 
 NavigationGrid::NavigationGrid(const std::string&filename, Vector3 offset) : NavigationGrid() {
-	std::ifstream infile(Assets::DATADIR + filename);
+	this->offset = offset;
+	if (std::filesystem::path(filename).extension() == NavigationGridBinary::Extension) {
+		try {
+			NavigationGridBinary::Load(Assets::DATADIR + filename, *this);
+			return;
+		}
+		catch (const std::exception& e) {
+			std::cout << __FUNCTION__ << " " << e.what() << "\n";
+			*this = NavigationGrid();
+			this->offset = offset;
+			return;
+		}
+	}
+	readText(Assets::DATADIR + filename);
+}
 
+NavigationGrid::NavigationGrid(GridLayout&& layout, Vector3 offset) : NavigationGrid() {
 	this->offset = offset;
-	infile >> nodeSize;
-	infile >> gridWidth;
-	infile >> gridHeight;
+	this->layout = std::move(layout);
+	useLayout();
+}
 
-	allNodes = new GridNode[gridWidth * gridHeight];
+NavigationGrid::~NavigationGrid()	{
+}
+
+void NavigationGrid::readText(const std::string& path) {
+	// Read in one go and walk through it, rather than a char at a time from the stream
+	std::ifstream infile(path, std::ios::binary);
+	std::string text((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+	const char* c	= text.c_str();
+	const char* end	= c + text.size();
+
+	auto readInt = [&]() {
+		while (c < end && isspace((unsigned char)*c)) {
+			c++;
+		}
+		return (int)strtol(c, (char**)&c, 10);
+	};
+	int size	= readInt();
+	int width	= readInt();
+	int height	= readInt();
+	if (size <= 0 || width <= 0 || height <= 0) {
+		std::cout << __FUNCTION__ << " " << path << " is not a navigation grid!\n";
+		return;
+	}
 
-	for (int y = 0; y < gridHeight; ++y) {
-		for (int x = 0; x < gridWidth; ++x) {
-			GridNode&n = allNodes[(gridWidth * y) + x];
-			char type = 0;
-			infile >> type;
-			n.type = (GridNode::Type)type;
-			n.position = Vector3((float)(x * nodeSize), 0, (float)(y * nodeSize)) + offset;
+	layout = GridLayout(size, width, height);
+	for (int cell = 0; cell < width * height; ++cell) {
+		while (c < end && isspace((unsigned char)*c)) {
+			c++;
+		}
+		GridNode::Type type = c < end ? (GridNode::Type)*c++ : GridNode::Type::None;
+		layout.setWall(cell, type == GridNode::Type::Wall);
+		if (GridNode::isMarker(type)) {
+			layout.markers.push_back({ (uint32_t)cell, type });
 		}
 	}
+	useLayout();
+}
 
-	//now to build the connectivity between the nodes
-	for (int y = 0; y < gridHeight; ++y) {
-		for (int x = 0; x < gridWidth; ++x) {
-			GridNode&n = allNodes[(gridWidth * y) + x];
+void NavigationGrid::useLayout() {
+	nodeSize	= layout.nodeSize;
+	gridWidth	= layout.width;
+	gridHeight	= layout.height;
+	walls		= layout.walls;
+	costs		= layout.costs;
+	markers		= layout.markers;
+	if (layout.regions.empty()) {
+		computeRegions();
+	} else {
+		regionCount = *std::max_element(layout.regions.begin(), layout.regions.end()) + 1;
+	}
+	regions		= layout.regions;
+}
 
-			if (y > 0) { //get the above node
-				n.connected[0] = &allNodes[(gridWidth * (y - 1)) + x];
-			}
-			if (y < gridHeight - 1) { //get the below node
-				n.connected[1] = &allNodes[(gridWidth * (y + 1)) + x];
-			}
-			if (x > 0) { //get left node
-				n.connected[2] = &allNodes[(gridWidth * (y)) + (x - 1)];
-			}
-			if (x < gridWidth - 1) { //get right node
-				n.connected[3] = &allNodes[(gridWidth * (y)) + (x + 1)];
-			}
-			for (int i = 0; i < 4; ++i) {
-				if (n.connected[i]) {
-					if (n.connected[i]->isWall()) {
-						n.connected[i] = nullptr; //actually a wall, disconnect!
-					} else {
-						n.costs[i] = 1;
-					}
+void NavigationGrid::computeRegions() {
+	// Flood fill each area of floor not yet reached
+	layout.regions.assign((size_t)gridWidth * gridHeight, 0);
+	regionCount = 1;
+	std::vector<int> toVisit;
+	for (int cell = 0; cell < gridWidth * gridHeight; ++cell) {
+		if (layout.regions[cell] || isWall(cell)) {
+			continue;
+		}
+		uint32_t region = regionCount++;
+		layout.regions[cell] = region;
+		toVisit.push_back(cell);
+		while (!toVisit.empty()) {
+			int neighbours[4];
+			getNeighbours(toVisit.back(), neighbours);
+			toVisit.pop_back();
+			for (int neighbour : neighbours) {
+				if (neighbour >= 0 && !layout.regions[neighbour]) {
+					layout.regions[neighbour] = region;
+					toVisit.push_back(neighbour);
 				}
 			}
 		}
 	}
 }
 
-NavigationGrid::~NavigationGrid()	{
-	delete[] allNodes;
+GridNode NavigationGrid::getNode(int idx) const {
+	GridNode node;
+	node.position = getPosition(idx);
+	if (isWall(idx)) {
+		node.type = GridNode::Type::Wall;
+		return node;
+	}
+	auto marker = std::lower_bound(markers.begin(), markers.end(), (uint32_t)idx,
+		[](const GridMarker& m, uint32_t cell) { return m.cell < cell; });
+	node.type = (marker != markers.end() && marker->cell == (uint32_t)idx) ? marker->type : GridNode::Type::Floor;
+	return node;
 }
 
-bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) const {
-	//need to work out which node 'from' sits in, and 'to' sits in
+int NavigationGrid::getCellAt(const Vector3& position) const {
 	// The position of a node refers to its centre,
 	// so we need to transform from/to by the offset minus half the node size
 	// to get a grid aligned with the top-left of each node
@@ -89,144 +270,88 @@ bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, Navigation
 
 	// Fun fact: ASCII art line drawings in comments are less cursed than
 	// UML diagrams in comments
-
-
 	Vector2 offsetPlusHalfSize =
 		Vector2(offset.x, offset.z)
 		- Vector2(nodeSize / 2, nodeSize / 2);
 
-	int fromX = ((int)(from.x - offsetPlusHalfSize.x) / nodeSize);
-	int fromZ = ((int)(from.z - offsetPlusHalfSize.y) / nodeSize);
-
-	int toX = ((int)(to.x - offsetPlusHalfSize.x) / nodeSize);
-	int toZ = ((int)(to.z - offsetPlusHalfSize.y) / nodeSize);
+	int x = ((int)(position.x - offsetPlusHalfSize.x) / nodeSize);
+	int z = ((int)(position.z - offsetPlusHalfSize.y) / nodeSize);
 
-	if (fromX < 0 || fromX > gridWidth - 1 ||
-		fromZ < 0 || fromZ > gridHeight - 1) {
-		return false; //outside of map region!
+	if (x < 0 || x > gridWidth - 1 ||
+		z < 0 || z > gridHeight - 1) {
+		return -1; //outside of map region!
 	}
+	return (z * gridWidth) + x;
+}
 
-	if (toX < 0 || toX > gridWidth - 1 ||
-		toZ < 0 || toZ > gridHeight - 1) {
+bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) const {
+	//need to work out which node 'from' sits in, and 'to' sits in
+	int startNode	= getCellAt(from);
+	int endNode		= getCellAt(to);
+	if (startNode < 0 || endNode < 0) {
 		return false; //outside of map region!
 	}
 
-	GridNode* startNode = &allNodes[(fromZ * gridWidth) + fromX];
-	GridNode* endNode	= &allNodes[(toZ * gridWidth) + toX];
-
-	Debug::DrawLine(startNode->position, endNode->position, Debug::GREEN);
-
-	// All nodes we've seen, with their best parent and cost
-	// See `closedNodes` for nodes we've already expanded
-	std::map<const GridNode*, SearchNode> seenNodes;
-	std::set<const GridNode*> closedNodes;
-	// The open list of nodes to expand. This may contain nodes that we found a better route to, so check the seenNodes map
-	// This is faster than a vector in this case as finding the best node is O(log n) instead of O(n)
-	// The priority queue is a max heap by default, so explicitly create it as a min heap
-	std::priority_queue<SearchNode, std::vector<SearchNode>, std::greater<SearchNode>> openList;
-
-	// Push a node onto the open list, if we haven't already seen a better route
-	auto pushIfBetter = [&](const SearchNode& node) {
-		auto existing = seenNodes.find(node.node);
-		if (existing != seenNodes.end() && existing->second.currentPlusHeuristic > node.currentPlusHeuristic) {
-			// The current route is better
-			return;
-		}
-		openList.push(node);
-		seenNodes[node.node] = node;
-	};
+	// Floor in different regions can never be joined up, so don't search the whole region to find that out
+	if (!isWall(startNode) && !isWall(endNode) && regions[startNode] != regions[endNode]) {
+		return false;
+	}
 
-	// Pop the best node from the open list, skipping nodes that have already been closed
-	// Returns SearchNode::empty() if the open list is empty
-	auto popNode = [&]() {
-		while (!openList.empty()) {
-			auto node = openList.top();
-			openList.pop();
-			// We can't remove arbitrary nodes from the priority queue,
-			// so check that the GridNode hasn't been closed
-			bool closed = closedNodes.find(node.node) != closedNodes.end();
-			if (!closed) {
-				return node;
-			}
-		}
-		return SearchNode::empty();
-	};
+	Debug::DrawLine(getPosition(startNode), getPosition(endNode), Debug::GREEN);
 
-	pushIfBetter(SearchNode{
-		nullptr, // parent
-		startNode, // node
-		0, // currentCost
-		0, // costPlusHeuristic
-	});
+	SearchScratch& scratch = searchScratch;
+	scratch.begin((size_t)getNodeCount());
+	scratch.open(startNode, -1, 0.0f, 0.0f);
 
-	while (!openList.empty()) {
-		auto currentBestNode = popNode();
-		if (currentBestNode.isEmpty()) {
-			break; // Couldn't find a path
-		}
+	while (!scratch.heap.empty()) {
+		int currentBestNode = scratch.close();
 
-		if (currentBestNode.node == endNode) {			//we've found the path!
-			SearchNode node = currentBestNode;
+		if (currentBestNode == endNode) {			//we've found the path!
 			// Add the end position
 			outPath.PushWaypoint(to);
-			while (node.parent != nullptr) {
-				outPath.PushWaypoint(node.node->position);
-				node = seenNodes.find(node.parent)->second;
+			for (int node = endNode; scratch.parent[node] >= 0; node = scratch.parent[node]) {
+				outPath.PushWaypoint(getPosition(node));
 			}
 			// Add the start position
 			outPath.PushWaypoint(from);
 			return true;
 		}
-		else {
-			for (int i = 0; i < 4; ++i) {
-				GridNode* neighbour = currentBestNode.node->connected[i];
-				if (!neighbour) { //might not be connected...
-					continue;
-				}
-
-				if (closedNodes.find(neighbour) != closedNodes.end()) {
-					continue; //already discarded this neighbour...
-				}
 
-				float h = Heuristic(neighbour, endNode);
-				float g = currentBestNode.currentCost + currentBestNode.node->costs[i];
-				float f = h + g;
+		int neighbours[4];
+		getNeighbours(currentBestNode, neighbours);
+		for (int i = 0; i < 4; ++i) {
+			int neighbour = neighbours[i];
+			if (neighbour < 0) { //might not be connected...
+				continue;
+			}
+			if (scratch.isClosed(neighbour)) {
+				continue; //already discarded this neighbour...
+			}
 
-				pushIfBetter(SearchNode{
-					currentBestNode.node, // parent
-					neighbour, // node
-					g, // currentCost
-					f, // costPlusHeuristic
-				});
+			float g = scratch.currentCost[currentBestNode] + costs[neighbour];
+			if (scratch.isReached(neighbour) && scratch.currentCost[neighbour] <= g) {
+				continue; // Already have a route here at least as good
 			}
-			// Mark this node as closed
-			closedNodes.insert(currentBestNode.node);
-			// Track the best route to this node
-			seenNodes[currentBestNode.node] = currentBestNode;
+			float h = Heuristic(neighbour, endNode);
+			scratch.open(neighbour, currentBestNode, g, g + h);
 		}
 	}
 	return false; //open list emptied out with no path!
 }
 
-float NavigationGrid::Heuristic(GridNode* hNode, GridNode* endNode) const {
-	return Vector::Length(hNode->position - endNode->position);
+float NavigationGrid::Heuristic(int hNode, int endNode) const {
+	return Vector::Length(getPosition(hNode) - getPosition(endNode));
 }
 
 void NavigationGrid::debugDraw()
 {
-	auto drawConnection = [&](GridNode* a, GridNode* b) {
-		if (a && b) {
-			Debug::DrawLine(a->position, b->position, Debug::WHITE);
-		}
-	};
-
 	int numNodes = gridWidth * gridHeight;
 	for (int i = 0; i < numNodes; i++) {
-		GridNode& node = allNodes[i];
-		if (node.isWall()) {
+		Vector3 position = getPosition(i);
+		if (isWall(i)) {
 			Vector3 halfSize(nodeSize / 2, 0, nodeSize / 2);
-			Vector3 topLeft = node.position - halfSize;
-			Vector3 bottomRight = node.position + halfSize;
+			Vector3 topLeft = position - halfSize;
+			Vector3 bottomRight = position + halfSize;
 			Vector3 topRight(topLeft.x, 0, bottomRight.z);
 			Vector3 bottomLeft(bottomRight.x, 0, topLeft.z);
 
@@ -235,9 +360,14 @@ void NavigationGrid::debugDraw()
 			Debug::DrawLine(bottomRight, bottomLeft, Debug::RED);
 			Debug::DrawLine(bottomLeft, topLeft, Debug::RED);
 		} else {
-			drawConnection(&node, node.connected[TOP_NODE]);
-			drawConnection(&node, node.connected[RIGHT_NODE]);
-			// The neighbour will draw the connection to the bottom and left as we are its top or right neighbour
+			int neighbours[4];
+			getNeighbours(i, neighbours);
+			// The neighbour will draw the connection to the top and left as we are its bottom or right neighbour
+			for (int neighbour : { neighbours[BOTTOM_NODE], neighbours[RIGHT_NODE] }) {
+				if (neighbour >= 0) {
+					Debug::DrawLine(position, getPosition(neighbour), Debug::WHITE);
+				}
+			}
 		}
 	}
 }
@@ -1,8 +1,15 @@
 #pragma once
 #include "NavigationMap.h"
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <span>
 #include <string>
+#include <vector>
+
 namespace NCL {
 	namespace CSC8503 {
+		// One cell of the grid, worked out on demand from the grid's compact arrays
 		struct GridNode {
 			// Either a wall, floor, or something special
 			enum class Type : char {
@@ -14,65 +21,128 @@ namespace NCL {
 				Floor = '.',
 			};
 
-			GridNode* connected[4];
-			int		  costs[4];
+			Vector3	position;
+			Type	type = Type::None;
 
-			Vector3		position;
-
-			Type type;
 			bool isWall() const {
 				return type == Type::Wall;
 			}
 			bool isFloor() const {
 				return type != Type::Wall;
 			}
-
-			GridNode() {
-				for (int i = 0; i < 4; ++i) {
-					connected[i] = nullptr;
-					costs[i] = 0;
-				}
-				type = Type::None;
+			// The types a GridMarker can hold, anything else in a grid is floor
+			static bool isMarker(Type type) {
+				return type == Type::Bonus || type == Type::Kitten || type == Type::Enemy;
 			}
-			~GridNode() {	}
 		};
 
-		struct SearchNode {
-			static SearchNode empty() {
-				return SearchNode(nullptr, nullptr, 0, 0);
-			}
-			bool isEmpty() const {
-				return node == nullptr;
-			}
+		// A cell holding something other than wall or floor
+		struct GridMarker {
+			uint32_t		cell;
+			GridNode::Type	type;
+		};
 
-			GridNode* parent;
-			GridNode* node;
+		// Everything a grid is made of, for building one in memory
+		struct GridLayout {
+			int nodeSize	= 0;
+			int width		= 0;
+			int height		= 0;
+			// One bit a cell, row by row, set for walls
+			std::vector<uint64_t>	walls;
+			// Cost of stepping onto each cell
+			std::vector<uint8_t>	costs;
+			// Connected areas of floor, numbered from 1, with walls in region 0
+			// Left empty to have the grid work them out
+			std::vector<uint32_t>	regions;
+			// Sorted by cell
+			std::vector<GridMarker>	markers;
 
-			// g(n), cost from start to n
-			float currentCost;
-			// g(n) + h(n), cost from start to n + heuristic cost from n to goal
-			float currentPlusHeuristic;
+			// All wall, costing 1 to cross once opened up
+			GridLayout(int nodeSize, int width, int height);
+			GridLayout() = default;
 
-			// Comparator used in priority_queue<T>
-			float operator>(const SearchNode& other) const {
-				return currentPlusHeuristic > other.currentPlusHeuristic;
+			void setWall(int cell, bool wall) {
+				if (wall) {
+					walls[cell / 64] |= 1ull << (cell % 64);
+				} else {
+					walls[cell / 64] &= ~(1ull << (cell % 64));
+				}
+			}
+			bool isWall(int cell) const {
+				return (walls[cell / 64] >> (cell % 64)) & 1;
 			}
 		};
 
+		// A grid of square cells, each a wall or floor with a cost to cross, stored as
+		// a bitset of walls and a byte of cost a cell. Loaded from a text grid, or a
+		// .navbin from NavigationGridBinary read in place from the memory mapped file
 		class NavigationGrid : public NavigationMap	{
 		public:
 			NavigationGrid();
+			// A .navbin is mapped, anything else is read as a text grid
 			NavigationGrid(const std::string&filename, Vector3 offset = Vector3());
+			NavigationGrid(GridLayout&& layout, Vector3 offset = Vector3());
 			~NavigationGrid();
 
+			// The arrays may point into our own storage, which moves with us
+			NavigationGrid(NavigationGrid&&) = default;
+			NavigationGrid& operator=(NavigationGrid&&) = default;
+			NavigationGrid(const NavigationGrid&) = delete;
+			NavigationGrid& operator=(const NavigationGrid&) = delete;
+
 			int getNodeCount() const {
 				return gridWidth * gridHeight;
 			}
 			int getNodeSize() const {
 				return nodeSize;
 			}
-			GridNode* getNode(int idx) const {
-				return &allNodes[idx];
+			int getWidth() const {
+				return gridWidth;
+			}
+			int getHeight() const {
+				return gridHeight;
+			}
+			GridNode getNode(int idx) const;
+
+			bool isWall(int idx) const {
+				return (walls[idx / 64] >> (idx % 64)) & 1;
+			}
+			uint8_t getCost(int idx) const {
+				return costs[idx];
+			}
+			uint32_t getRegion(int idx) const {
+				return regions[idx];
+			}
+			// Including region 0, the walls
+			uint32_t getRegionCount() const {
+				return regionCount;
+			}
+			Vector3 getPosition(int idx) const {
+				return Vector3((float)((idx % gridWidth) * nodeSize), 0, (float)((idx / gridWidth) * nodeSize)) + offset;
+			}
+			// The cell a position falls in, or -1 if it's off the grid
+			int getCellAt(const Vector3& position) const;
+			// The cells above, below, left and right of idx, or -1 for walls and the edge of the grid
+			void getNeighbours(int idx, int out[4]) const {
+				int x = idx % gridWidth;
+				int y = idx / gridWidth;
+				out[0] = (y > 0 && !isWall(idx - gridWidth)) ? idx - gridWidth : -1;
+				out[1] = (y < gridHeight - 1 && !isWall(idx + gridWidth)) ? idx + gridWidth : -1;
+				out[2] = (x > 0 && !isWall(idx - 1)) ? idx - 1 : -1;
+				out[3] = (x < gridWidth - 1 && !isWall(idx + 1)) ? idx + 1 : -1;
+			}
+
+			std::span<const uint64_t> getWalls() const {
+				return walls;
+			}
+			std::span<const uint8_t> getCosts() const {
+				return costs;
+			}
+			std::span<const uint32_t> getRegions() const {
+				return regions;
+			}
+			std::span<const GridMarker> getMarkers() const {
+				return markers;
 			}
 
 			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) const override;
@@ -82,13 +152,29 @@ namespace NCL {
 			// Red: Wall
 			void debugDraw();
 		protected:
-			float		Heuristic(GridNode* hNode, GridNode* endNode) const;
+			friend class NavigationGridBinary;
+
+			void		readText(const std::string& path);
+			// Points the arrays at layout, working out regions if it has none
+			void		useLayout();
+			// Into layout's regions, from the walls wherever they live
+			void		computeRegions();
+			float		Heuristic(int hNode, int endNode) const;
+
 			Vector3 offset;
 			int nodeSize;
 			int gridWidth;
 			int gridHeight;
+			uint32_t regionCount;
+
+			std::span<const uint64_t>	walls;
+			std::span<const uint8_t>	costs;
+			std::span<const uint32_t>	regions;
+			std::span<const GridMarker>	markers;
 
-			GridNode* allNodes;
+			// Where the arrays live, built in memory or mapped from a .navbin
+			GridLayout	layout;
+			MappedFile	file;
 		};
 	}
 }
@@ -0,0 +1,139 @@
+#include "NavigationGridBinary.h"
+#include "BinaryFile.h"
+#include "NavigationGrid.h"
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	const BinaryFile::Format Format = {
+		{ 'N', 'C', 'L', 'N', 'A', 'V', '\0', '\0' }, NavigationGridBinary::Version, "navigation grid", "save it again"
+	};
+
+	enum Flags : uint32_t {
+		HasRegions = 1 << 0
+	};
+
+	struct Header {
+		char		magic[8];
+		uint32_t	version;
+		uint32_t	flags;
+		int32_t		nodeSize;
+		int32_t		width;
+		int32_t		height;
+		uint32_t	regionCount;
+		uint32_t	markerCount;
+		uint32_t	padding;
+	};
+	static_assert(sizeof(Header) == 40);
+	static_assert(sizeof(GridMarker) == 8);
+
+	size_t Align(size_t offset) {
+		return BinaryFile::Align(offset, NavigationGridBinary::ArrayAlignment);
+	}
+
+	// Where each array starts, worked out the same way for saving and loading
+	struct Layout {
+		size_t walls;
+		size_t costs;
+		size_t regions;
+		size_t markers;
+		size_t end;
+
+		explicit Layout(const Header& header) {
+			size_t cells = (size_t)header.width * header.height;
+			walls	= Align(sizeof(Header));
+			costs	= Align(walls + (cells + 63) / 64 * sizeof(uint64_t));
+			regions	= Align(costs + cells);
+			markers	= Align(regions + ((header.flags & HasRegions) ? cells * sizeof(uint32_t) : 0));
+			end		= markers + header.markerCount * sizeof(GridMarker);
+		}
+	};
+
+	// Grids look markers up by binary search and index arrays by region, so a damaged
+	// file can't be allowed to get that far
+	bool ValidMarkers(std::span<const GridMarker> markers, size_t cells) {
+		for (size_t i = 0; i < markers.size(); i++) {
+			if (markers[i].cell >= cells || (i > 0 && markers[i].cell <= markers[i - 1].cell)
+				|| !GridNode::isMarker(markers[i].type)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool ValidRegions(std::span<const uint32_t> regions, uint32_t regionCount) {
+		for (uint32_t region : regions) {
+			if (region >= regionCount) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+void NavigationGridBinary::Save(const std::string& path, const NavigationGrid& grid, bool saveRegions) {
+	Header header = BinaryFile::NewHeader<Header>(Format);
+	header.flags		= saveRegions ? HasRegions : 0;
+	header.nodeSize		= grid.getNodeSize();
+	header.width		= grid.getWidth();
+	header.height		= grid.getHeight();
+	header.regionCount	= grid.getRegionCount();
+	header.markerCount	= (uint32_t)grid.getMarkers().size();
+	Layout layout(header);
+
+	std::vector<char> file(layout.end, 0);
+	memcpy(file.data(), &header, sizeof(Header));
+	memcpy(file.data() + layout.walls, grid.getWalls().data(), grid.getWalls().size_bytes());
+	memcpy(file.data() + layout.costs, grid.getCosts().data(), grid.getCosts().size_bytes());
+	if (saveRegions) {
+		memcpy(file.data() + layout.regions, grid.getRegions().data(), grid.getRegions().size_bytes());
+	}
+	// Field by field, so the padding after each type is zeroed
+	for (size_t i = 0; i < grid.getMarkers().size(); i++) {
+		GridMarker marker = {};
+		marker.cell = grid.getMarkers()[i].cell;
+		marker.type = grid.getMarkers()[i].type;
+		memcpy(file.data() + layout.markers + i * sizeof(GridMarker), &marker, sizeof(GridMarker));
+	}
+	BinaryFile::Write(Format, path, file);
+}
+
+void NavigationGridBinary::Load(const std::string& path, NavigationGrid& grid) {
+	Header header;
+	MappedFile file = BinaryFile::Open(Format, path, header);
+	std::span<const char> bytes = file.GetBytes();
+	if (header.nodeSize <= 0 || header.width <= 0 || header.height <= 0 || Layout(header).end > bytes.size()) {
+		BinaryFile::Damaged(Format, path);
+	}
+
+	// The arrays are aligned in the file, and the mapping is page aligned, so they're used in place
+	Layout layout(header);
+	size_t cells = (size_t)header.width * header.height;
+	auto markers = std::span<const GridMarker>((const GridMarker*)(bytes.data() + layout.markers), header.markerCount);
+	std::span<const uint32_t> regions;
+	if (header.flags & HasRegions) {
+		regions = std::span<const uint32_t>((const uint32_t*)(bytes.data() + layout.regions), cells);
+	}
+	if (!ValidMarkers(markers, cells) || !ValidRegions(regions, header.regionCount)) {
+		BinaryFile::Damaged(Format, path);
+	}
+
+	grid.nodeSize	= header.nodeSize;
+	grid.gridWidth	= header.width;
+	grid.gridHeight	= header.height;
+	grid.walls		= std::span<const uint64_t>((const uint64_t*)(bytes.data() + layout.walls), (cells + 63) / 64);
+	grid.costs		= std::span<const uint8_t>((const uint8_t*)(bytes.data() + layout.costs), cells);
+	grid.markers	= markers;
+	if (header.flags & HasRegions) {
+		grid.regions		= regions;
+		grid.regionCount	= header.regionCount;
+	} else {
+		grid.computeRegions();
+		grid.regions = grid.layout.regions;
+	}
+	grid.file = std::move(file);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace NCL {
+	namespace CSC8503 {
+		class NavigationGrid;
+
+		// Navigation grids saved ready to use, see BinaryFile
+		// A header is followed by the wall bitset, a cost byte a cell, the region of
+		// each cell if saved, and the markers, each aligned so it's used in place
+		class NavigationGridBinary	{
+		public:
+			static const constexpr uint32_t Version = 1;
+			static constexpr const char* Extension = ".navbin";
+			// Every array starts on this boundary
+			static const constexpr size_t ArrayAlignment = 8;
+
+			// Regions take 4 bytes a cell, so can be left out to be worked out at load time instead
+			// Throws if the file can't be written
+			static void Save(const std::string& path, const NavigationGrid& grid, bool saveRegions = true);
+			// Throws if the file is missing, from another version, or damaged
+			static void Load(const std::string& path, NavigationGrid& grid);
+		};
+	}
+}
@@ -7,7 +7,7 @@ namespace NCL {
 		{
 		public:
 			NavigationMap() {}
-			~NavigationMap() {}
+			virtual ~NavigationMap() {}
 
 			virtual bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) const = 0;
 		};
@@ -1,5 +1,10 @@
 #include "NetworkBase.h"
+#include "Compression.h"
+#include "NetworkProfiler.h"
 #include "./enet/enet.h"
+
+#include <new>
+
 NetworkBase::NetworkBase()	{
 	netHandle = nullptr;
 }
@@ -10,6 +15,125 @@ NetworkBase::~NetworkBase()	{
 	}
 }
 
+NetworkBase::Channel NetworkBase::GetChannel(GamePacket::Type type) {
+	switch (type) {
+	case GamePacket::Type::Delta_State:
+	case GamePacket::Type::Full_State:
+	case GamePacket::Type::ClientState:
+	case GamePacket::Type::InputAck:
+		return StateChannel;
+	case GamePacket::Type::PlayerList:
+		return BulkChannel;
+	default:
+		return EventChannel;
+	}
+}
+
+uint32_t NetworkBase::GetPacketFlags(Channel channel) {
+	// 0 is unreliable, but sequenced
+	return channel == StateChannel ? 0 : ENET_PACKET_FLAG_RELIABLE;
+}
+
+void NetworkBase::ConfigurePeer(ENetPeer* peer) {
+	// Anything agreed with the peer's previous owner no longer applies
+	SetPeerFeatures(GetPeerID(peer), 0);
+
+	// ENet's throttle drops unreliable packets as loss rises, which under steady loss
+	// starves the state channel entirely. State is already rate limited by the tick rate,
+	// so keep the throttle fully open
+	enet_peer_throttle_configure(peer, ENET_PEER_PACKET_THROTTLE_INTERVAL, 0, 0);
+	peer->packetThrottle = ENET_PEER_PACKET_THROTTLE_SCALE;
+}
+
+int NetworkBase::GetPeerID(const ENetPeer* peer) const {
+	return (int)(peer - netHandle->peers);
+}
+
+void NetworkBase::SetPeerFeatures(int peer, enet_uint8 features) {
+	if (peer < 0) {
+		return;
+	}
+	if ((size_t)peer >= peerFeatures.size()) {
+		peerFeatures.resize(peer + 1, 0);
+	}
+	peerFeatures[peer] = features;
+}
+
+enet_uint8 NetworkBase::GetPeerFeatures(int peer) const {
+	return peer >= 0 && (size_t)peer < peerFeatures.size() ? peerFeatures[peer] : 0;
+}
+
+GamePacket& NetworkBase::CompressPacket(GamePacket& packet) {
+	if ((size_t)packet.size < CompressionThreshold || packet.type == GamePacket::Type::Compressed) {
+		return packet;
+	}
+	size_t originalSize = packet.GetTotalSize();
+	compressBuffer.resize(sizeof(CompressedPacket) + Compression::CompressBound(originalSize));
+	auto output = std::span(compressBuffer).subspan(sizeof(CompressedPacket));
+	size_t compressedSize = Compression::Compress(std::span((const enet_uint8*)&packet, originalSize), output);
+	// Not worth it unless the header is paid for
+	if (compressedSize == 0 || sizeof(CompressedPacket) + compressedSize >= originalSize) {
+		return packet;
+	}
+
+	CompressedPacket* compressed = new (compressBuffer.data()) CompressedPacket();
+	compressed->originalSize = (unsigned short)originalSize;
+	compressed->size = (short)(sizeof(CompressedPacket) - sizeof(GamePacket) + compressedSize);
+	if (profiler) {
+		profiler->recordSent(GamePacket::Type::Compressed, compressed->GetTotalSize());
+	}
+	return *compressed;
+}
+
+void NetworkBase::EnableConditioner(const NetworkConditioner::Settings& settings, unsigned int seed) {
+	if (!netHandle) {
+		return;
+	}
+	conditioner = std::make_unique<NetworkConditioner>(netHandle, settings, seed);
+}
+
+void NetworkBase::EnableProfiler() {
+	profiler = std::make_unique<NetworkProfiler>();
+}
+
+uint32_t NetworkBase::GetBytesSent() const {
+	return netHandle ? netHandle->totalSentData : 0;
+}
+
+uint32_t NetworkBase::GetBytesReceived() const {
+	return netHandle ? netHandle->totalReceivedData : 0;
+}
+
+void NetworkBase::SendToPeer(ENetPeer* peer, enet_uint8 channel, ENetPacket* packet) {
+	if (profiler) {
+		profiler->recordPeerSent(GetPeerID(peer), packet->dataLength);
+	}
+	if (conditioner) {
+		return conditioner->send(peer, channel, packet);
+	}
+	enet_peer_send(peer, channel, packet);
+}
+
+void NetworkBase::Broadcast(enet_uint8 channel, ENetPacket* packet) {
+	if (profiler) {
+		for (size_t i = 0; i < netHandle->peerCount; i++) {
+			if (netHandle->peers[i].state == ENET_PEER_STATE_CONNECTED) {
+				profiler->recordPeerSent((int)i, packet->dataLength);
+			}
+		}
+	}
+	if (conditioner) {
+		return conditioner->broadcast(channel, packet);
+	}
+	enet_host_broadcast(netHandle, channel, packet);
+}
+
+void NetworkBase::UpdateConditioner() {
+	if (conditioner) {
+		conditioner->update();
+	}
+}
+
 void NetworkBase::Initialise() {
 	enet_initialize();
 }
@@ -18,41 +142,95 @@ void NetworkBase::Destroy() {
 	enet_deinitialize();
 }
 
-bool NetworkBase::ProcessPacket(GamePacket* packet, int peerID) {
-	PacketHandlerIterator firstHandler;
-	PacketHandlerIterator lastHandler;
-	bool hasHandler = GetPacketHandlers(packet->type, firstHandler, lastHandler);
-	if (!hasHandler) {
-		std::cerr << __FUNCTION__ << " no handler for packet type " << (short)packet->type << std::endl;
+void NetworkBase::RegisterPacketHandler(GamePacket::Type msgID, PacketReceiver* receiver) {
+	size_t type = (size_t)msgID;
+	if (type >= PacketTypeCount) {
+		throw std::runtime_error("Can't register a handler for an invalid packet type");
+	}
+	// Append to the end of this type's range, and shift every later range along one
+	packetHandlers.insert(packetHandlers.begin() + handlerStart[type + 1], receiver);
+	for (size_t i = type + 1; i < handlerStart.size(); i++) {
+		handlerStart[i]++;
+	}
+}
+
+bool NetworkBase::ProcessPacket(std::span<enet_uint8> buffer, int peerID) {
+	if (buffer.size() < sizeof(GamePacket)) {
+		std::cerr << __FUNCTION__ << " packet too small for a header" << std::endl;
+		return false;
+	}
+	const GamePacket* packet = reinterpret_cast<const GamePacket*>(buffer.data());
+	// A well-formed packet will have its size set correctly
+	if (packet->size < 0 || buffer.size() < (size_t)packet->GetTotalSize()) {
+		std::cerr << __FUNCTION__ << " packet size " << packet->size << " overruns the buffer" << std::endl;
+		return false;
+	}
+	size_t type = (size_t)packet->type;
+	if (type >= PacketTypeCount) {
+		std::cerr << __FUNCTION__ << " unknown packet type " << type << std::endl;
+		return false;
+	}
+	if (packet->type == GamePacket::Type::Compressed) {
+		return ProcessCompressedPacket(buffer.first(packet->GetTotalSize()), peerID);
+	}
+
+	auto handlers = GetPacketHandlers(packet->type);
+	if (handlers.empty()) {
+		std::cerr << __FUNCTION__ << " no handler for packet type " << type << std::endl;
 		return false;
 	}
 
-	for (auto i = firstHandler; i != lastHandler; i++) {
-		i->second->ReceivePacket(packet->type, packet, peerID);
+	auto view = buffer.first(packet->GetTotalSize());
+	if (profiler) {
+		profiler->recordReceived(packet->type, view.size());
+	}
+	NetworkProfiler::ScopedTimer timer(profiler.get(), packet->type, false);
+	for (PacketReceiver* handler : handlers) {
+		handler->ReceivePacket(packet->type, view, peerID);
 	}
 	return true;
 }
 
+bool NetworkBase::ProcessCompressedPacket(std::span<enet_uint8> buffer, int peerID) {
+	auto compressed = GamePacket::View<CompressedPacket>(buffer);
+	if (!compressed || compressed->originalSize < sizeof(GamePacket)) {
+		std::cerr << __FUNCTION__ << " malformed compressed packet" << std::endl;
+		return false;
+	}
+	if (profiler) {
+		profiler->recordReceived(GamePacket::Type::Compressed, buffer.size());
+	}
+	// Unwrapping in place means handlers can't be given another compressed packet
+	decompressBuffer.resize(compressed->originalSize);
+	if (!Compression::Decompress(compressed->compressedData(), decompressBuffer)) {
+		std::cerr << __FUNCTION__ << " compressed packet failed to decompress" << std::endl;
+		return false;
+	}
+	const GamePacket* packet = reinterpret_cast<const GamePacket*>(decompressBuffer.data());
+	if (packet->type == GamePacket::Type::Compressed || packet->size < 0 || (size_t)packet->GetTotalSize() != decompressBuffer.size()) {
+		std::cerr << __FUNCTION__ << " compressed packet holds a malformed packet" << std::endl;
+		return false;
+	}
+	return ProcessPacket(std::span(decompressBuffer), peerID);
+}
+
 bool NetworkBase::ProcessPackedPackets(std::span<enet_uint8> buffer, int peerID)
 {
-	int count = 0;
-	auto totalSize = buffer.size();
 	while (!buffer.empty()) {
 		// Safety checks - ensure we have enough data to read the packet in full
 		// If not, we have a buffer overrun and should stop processing
 		if (buffer.size() < sizeof(GamePacket)) {
-			throw std::runtime_error("Buffer overrun while reading packet header");
+			std::cerr << __FUNCTION__ << " buffer overrun while reading packet header" << std::endl;
+			return false;
 		}
-		GamePacket* packet = reinterpret_cast<GamePacket*>(buffer.data());
-		// A well-formed packet will have its size set correctly
-		if (buffer.size() < packet->GetTotalSize()) {
-			throw std::runtime_error("Buffer overrun while reading packet payload");
+		const GamePacket* packet = reinterpret_cast<const GamePacket*>(buffer.data());
+		if (packet->size < 0 || buffer.size() < (size_t)packet->GetTotalSize()) {
+			std::cerr << __FUNCTION__ << " buffer overrun while reading packet payload" << std::endl;
+			return false;
 		}
-		ProcessPacket(packet, peerID);
-		buffer = buffer.subspan(packet->GetTotalSize());
-		count++;
+		auto packetSize = packet->GetTotalSize();
+		ProcessPacket(buffer.first(packetSize), peerID);
+		buffer = buffer.subspan(packetSize);
 	}
-
-	//std::cout << "Processed " << count << " packets in " << totalSize << " bytes\n";
 	return true;
 }
@@ -1,12 +1,21 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <span>
 #include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "NetworkConditioner.h"
 
 struct _ENetHost;
 struct _ENetPeer;
 struct _ENetEvent;
+struct _ENetPacket;
 using enet_uint8 = unsigned char;
+class NetworkProfiler;
 
 struct GamePacket {
 	// Strongly typed enum for packet types
@@ -50,6 +59,15 @@ struct GamePacket {
 		// @see: PlayerListPacket
 		PlayerList,
 
+		// The server's state for a client's own player, along with the
+		// last input it applied. Used for prediction and reconciliation
+		// @see: InputAckPacket
+		InputAck,
+
+		// Another packet, compressed. Unwrapped before dispatch, so never reaches handlers
+		// @see: CompressedPacket
+		Compressed,
+
 		PayloadEnd, // Marker for packets that have payloads
 
 		// Only sent to servers, a new client has connected
@@ -69,6 +87,10 @@ struct GamePacket {
 		// End of game
 		GameEnd,
 
+		// Number of packet types, not a real packet
+		// Anything at or above this is rejected on receive
+		Count,
+
 		// Hello,
 		// Message,
 		// ClientState, //received from a client, informs that its received packet n
@@ -84,9 +106,20 @@ struct GamePacket {
 		, type(type)
 	{}
 
-	int GetTotalSize() {
+	int GetTotalSize() const {
 		return sizeof(GamePacket) + size;
 	}
+
+	// View a received packet as a specific type, in place in the receive buffer
+	// Returns nullptr if the packet is too small to be a T
+	// Variable length packets can pass the smallest valid size
+	template <typename T>
+	static T* View(std::span<enet_uint8> packet, size_t minSize = sizeof(T)) {
+		if (packet.size() < minSize) {
+			return nullptr;
+		}
+		return reinterpret_cast<T*>(packet.data());
+	}
 };
 
 struct StringPacket : public GamePacket {
@@ -94,7 +127,8 @@ struct StringPacket : public GamePacket {
 	char data[256];
 
 	StringPacket(std::string_view message) : GamePacket(Type::String_Message) {
-		if (message.length() > sizeof(data)) {
+		// Leave room for the terminator
+		if (message.length() >= sizeof(data)) {
 			throw std::runtime_error("String too long for packet data!");
 		};
 
@@ -103,14 +137,33 @@ struct StringPacket : public GamePacket {
 		data[message.length()] = 0;
 	}
 
-	std::string toString() const {
-		return std::string(data);
+	// packetSize is the size received, a packet from the network can stop short of
+	// the end of data, or leave out the terminator
+	std::string toString(size_t packetSize) const {
+		size_t available = packetSize > sizeof(GamePacket) ? std::min(packetSize - sizeof(GamePacket), sizeof(data)) : 0;
+		return std::string(data, strnlen(data, available));
+	}
+};
+
+// Header for a compressed packet, followed by the compressed bytes
+// Built by NetworkBase when sending, see NetworkBase::CompressionThreshold
+struct CompressedPacket : public GamePacket {
+	// Total size of the packet once decompressed, header included
+	unsigned short originalSize;
+
+	CompressedPacket() : GamePacket(Type::Compressed), originalSize(0) {}
+
+	std::span<const enet_uint8> compressedData() const {
+		return std::span(reinterpret_cast<const enet_uint8*>(this) + sizeof(CompressedPacket), GetTotalSize() - sizeof(CompressedPacket));
 	}
 };
 
 class PacketReceiver {
 public:
-	virtual void ReceivePacket(GamePacket::Type type, GamePacket* payload, int source = -1) = 0;
+	// packet is the whole packet, header included, and points straight into
+	// the receive buffer. It's only valid for the duration of the call
+	// Its length is exactly GetTotalSize(), use GamePacket::View to read it
+	virtual void ReceivePacket(GamePacket::Type type, std::span<enet_uint8> packet, int source = -1) = 0;
 };
 
 class NetworkBase	{
@@ -126,33 +179,112 @@ public:
 		return (d << 24) | (c << 16) | (b << 8) | a;
 	}
 
-	void RegisterPacketHandler(GamePacket::Type msgID, PacketReceiver* receiver) {
-		packetHandlers.insert(std::make_pair(msgID, receiver));
+	// ENet sequences each channel separately, so a stall waiting for a resend
+	// on one channel never holds up the others
+	enum Channel : enet_uint8 {
+		// Unreliable and sequenced. Newer state replaces older, so losing some is fine
+		// and late packets are dropped rather than applied out of order
+		StateChannel,
+		// Reliable and ordered. Game events that must arrive
+		EventChannel,
+		// Reliable and ordered. Large, infrequent data, kept apart so it doesn't delay events
+		BulkChannel,
+
+		ChannelCount
+	};
+
+	// Which channel each packet type is sent on
+	static Channel GetChannel(GamePacket::Type type);
+	// ENet flags for packets sent on a channel
+	static uint32_t GetPacketFlags(Channel channel);
+
+	// Unreliable packets larger than this are fragmented by ENet, and sent reliably
+	// Queued state is split into packets under this size instead
+	static const constexpr size_t MaxUnreliableSize = 1200;
+
+	// Optional protocol features, agreed per peer when a client says hello
+	enum Feature : enet_uint8 {
+		CompressionFeature = 1 << 0,
+	};
+	static const constexpr enet_uint8 SupportedFeatures = CompressionFeature;
+
+	// Packets with a payload at least this big are compressed when sent to peers that
+	// support it. Smaller ones rarely shrink enough to pay for the extra header
+	static const constexpr size_t CompressionThreshold = 128;
+
+	// Features a peer has agreed to. Cleared when it connects or disconnects
+	void SetPeerFeatures(int peer, enet_uint8 features);
+	enet_uint8 GetPeerFeatures(int peer) const;
+
+	// Handlers for the same type are called in the order they were registered
+	void RegisterPacketHandler(GamePacket::Type msgID, PacketReceiver* receiver);
+
+	// Simulate a bad connection on this host, see NetworkConditioner
+	void EnableConditioner(const NetworkConditioner::Settings& settings, unsigned int seed = std::random_device{}());
+	const NetworkConditioner* GetConditioner() const {
+		return conditioner.get();
+	}
+
+	// Count traffic by type, peer and tick, see NetworkProfiler
+	void EnableProfiler();
+	NetworkProfiler* GetProfiler() const {
+		return profiler.get();
 	}
+
+	// Totals from ENet, including protocol overhead
+	uint32_t GetBytesSent() const;
+	uint32_t GetBytesReceived() const;
 protected:
 	NetworkBase();
 	~NetworkBase();
 
-	bool ProcessPacket(GamePacket* p, int peerID = -1);
+	// All outgoing packets go through these, so they can be conditioned and profiled
+	void SendToPeer(_ENetPeer* peer, enet_uint8 channel, _ENetPacket* packet);
+	void Broadcast(enet_uint8 channel, _ENetPacket* packet);
+	// Release any conditioned packets that are due
+	void UpdateConditioner();
+	// Called on each newly connected peer
+	void ConfigurePeer(_ENetPeer* peer);
+	int GetPeerID(const _ENetPeer* peer) const;
+
+	// Returns either packet, or a CompressedPacket holding it if that's smaller
+	// The compressed copy is only valid until the next call
+	GamePacket& CompressPacket(GamePacket& packet);
+
+	// Dispatch a single packet, checking it's well formed first
+	// Returns false if it was malformed or nothing handled it
+	bool ProcessPacket(std::span<enet_uint8> packet, int peerID = -1);
+	// For payloadless packets generated locally
+	bool ProcessPacket(GamePacket& packet, int peerID = -1) {
+		return ProcessPacket(std::span((enet_uint8*)&packet, sizeof(GamePacket)), peerID);
+	}
 	// Process a list of packets that have been packed into a single data buffer
 	// This ensures they are processed in the order they were queued for sending
+	// Stops and returns false at the first malformed packet
 	bool ProcessPackedPackets(std::span<enet_uint8> buffer, int peerID = -1);
+	// Decompress a CompressedPacket and process what it holds
+	bool ProcessCompressedPacket(std::span<enet_uint8> buffer, int peerID);
 
-	using PacketHandlerMap = std::multimap<GamePacket::Type, PacketReceiver*>;
-	using PacketHandlerIterator = PacketHandlerMap::const_iterator;
+	static const constexpr size_t PacketTypeCount = (size_t)GamePacket::Type::Count;
 
-	bool GetPacketHandlers(GamePacket::Type msgID, PacketHandlerIterator& first, PacketHandlerIterator& last) const {
-		auto range = packetHandlers.equal_range(msgID);
-
-		if (range.first == packetHandlers.end()) {
-			return false; //no handlers for this message type!
-		}
-		first	= range.first;
-		last	= range.second;
-		return true;
+	std::span<PacketReceiver* const> GetPacketHandlers(GamePacket::Type msgID) const {
+		size_t type = (size_t)msgID;
+		return std::span(packetHandlers).subspan(handlerStart[type], handlerStart[type + 1] - handlerStart[type]);
 	}
 
 	_ENetHost* netHandle;
 
-	PacketHandlerMap packetHandlers;
+	// Flat dispatch table, built as handlers are registered
+	// Handlers for type t are packetHandlers[handlerStart[t]] up to packetHandlers[handlerStart[t + 1]]
+	std::vector<PacketReceiver*> packetHandlers;
+	std::array<unsigned short, PacketTypeCount + 1> handlerStart{};
+
+	std::unique_ptr<NetworkConditioner> conditioner;
+	std::unique_ptr<NetworkProfiler> profiler;
+
+	// Indexed by peer ID
+	std::vector<enet_uint8> peerFeatures;
+	// Scratch space for CompressPacket, and for unwrapping received packets
+	std::vector<enet_uint8> compressBuffer;
+	std::vector<enet_uint8> decompressBuffer;
 };
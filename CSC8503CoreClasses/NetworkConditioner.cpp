@@ -0,0 +1,115 @@
+#include "NetworkConditioner.h"
+
+#include <map>
+
+#include "./enet/enet.h"
+
+namespace {
+	// ENet's intercept callback only gives us the host
+	std::map<ENetHost*, NetworkConditioner*> conditioners;
+}
+
+NetworkConditioner::NetworkConditioner(ENetHost* host, const Settings& settings, unsigned int seed)
+	: host(host), settings(settings), rng(seed) {
+	linkFreeAt = Clock::now();
+	lastReliableSendAt = linkFreeAt;
+	if (settings.loss > 0) {
+		conditioners[host] = this;
+		host->intercept = interceptCallback;
+	}
+}
+
+NetworkConditioner::~NetworkConditioner() {
+	auto it = conditioners.find(host);
+	if (it != conditioners.end() && it->second == this) {
+		// The host may have gone already, so don't touch it
+		conditioners.erase(it);
+	}
+	while (!pending.empty()) {
+		enet_packet_destroy(pending.top().packet);
+		pending.pop();
+	}
+}
+
+int NetworkConditioner::interceptCallback(ENetHost* host, ENetEvent* event) {
+	auto it = conditioners.find(host);
+	if (it == conditioners.end()) {
+		return 0;
+	}
+	// 1 tells ENet we've handled the datagram, so it's never seen
+	return it->second->shouldDrop() ? 1 : 0;
+}
+
+bool NetworkConditioner::shouldDrop() {
+	if (random01() < settings.loss) {
+		dropped++;
+		return true;
+	}
+	return false;
+}
+
+void NetworkConditioner::send(ENetPeer* peer, enet_uint8 channel, ENetPacket* packet) {
+	enqueue(peer, channel, packet);
+}
+
+void NetworkConditioner::broadcast(enet_uint8 channel, ENetPacket* packet) {
+	enqueue(nullptr, channel, packet);
+}
+
+void NetworkConditioner::enqueue(ENetPeer* peer, enet_uint8 channel, ENetPacket* packet) {
+	using Milliseconds = std::chrono::duration<float, std::milli>;
+	auto now = Clock::now();
+	bool reliable = packet->flags & ENET_PACKET_FLAG_RELIABLE;
+
+	// Bandwidth is modelled as time spent putting the packet on the wire,
+	// anything sent while the link is busy waits its turn
+	auto sendAt = now;
+	if (settings.bandwidth > 0) {
+		linkFreeAt = std::max(linkFreeAt, now);
+		linkFreeAt += std::chrono::duration_cast<Clock::duration>(
+			std::chrono::duration<float>((float)packet->dataLength / settings.bandwidth)
+		);
+		sendAt = linkFreeAt;
+	}
+
+	float delay = settings.latency + settings.jitter * random01();
+	if (!reliable && settings.reorder > 0 && random01() < settings.reorder) {
+		// Hold it back long enough for the next few packets to overtake it
+		delay += std::max(settings.latency, 10.0f);
+		reordered++;
+	}
+	sendAt += std::chrono::duration_cast<Clock::duration>(Milliseconds(delay));
+
+	if (reliable) {
+		sendAt = std::max(sendAt, lastReliableSendAt);
+		lastReliableSendAt = sendAt;
+	}
+
+	pending.push({ sendAt, nextSequence++, peer, channel, packet });
+
+	if (!reliable && settings.duplicate > 0 && random01() < settings.duplicate) {
+		ENetPacket* copy = enet_packet_create(packet->data, packet->dataLength, packet->flags);
+		auto copyAt = sendAt + std::chrono::duration_cast<Clock::duration>(Milliseconds(settings.jitter * random01()));
+		pending.push({ copyAt, nextSequence++, peer, channel, copy });
+		duplicated++;
+	}
+}
+
+void NetworkConditioner::update() {
+	auto now = Clock::now();
+	while (!pending.empty() && pending.top().sendAt <= now) {
+		dispatch(pending.top());
+		pending.pop();
+	}
+}
+
+void NetworkConditioner::dispatch(const PendingPacket& p) {
+	if (p.peer == nullptr) {
+		enet_host_broadcast(host, p.channel, p.packet);
+		return;
+	}
+	// The peer may have disconnected while the packet was waiting
+	if (enet_peer_send(p.peer, p.channel, p.packet) < 0 && p.packet->referenceCount == 0) {
+		enet_packet_destroy(p.packet);
+	}
+}
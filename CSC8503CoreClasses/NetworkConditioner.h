@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <queue>
+#include <random>
+#include <vector>
+
+struct _ENetHost;
+struct _ENetPeer;
+struct _ENetPacket;
+struct _ENetEvent;
+using enet_uint8 = unsigned char;
+
+// Simulates a bad connection between ENet and NetworkBase, for testing
+// Loss is applied to incoming datagrams inside ENet, so reliable packets are
+// resent just like they would be on a real network. Everything else is applied
+// to outgoing packets before they're handed to ENet
+class NetworkConditioner {
+public:
+	struct Settings {
+		// One way delay in milliseconds
+		float latency = 0;
+		// Random extra delay, up to this many milliseconds
+		float jitter = 0;
+		// Fractions from 0 to 1
+		float loss = 0;
+		// Duplication and reordering only affect unreliable packets,
+		// ENet would hide them on reliable ones anyway
+		float duplicate = 0;
+		float reorder = 0;
+		// Outgoing bytes per second, 0 for unlimited
+		// Packets over the limit are queued rather than dropped
+		int bandwidth = 0;
+
+		bool isEnabled() const {
+			return latency > 0 || jitter > 0 || loss > 0 || duplicate > 0 || reorder > 0 || bandwidth > 0;
+		}
+	};
+
+	NetworkConditioner(_ENetHost* host, const Settings& settings, unsigned int seed = std::random_device{}());
+	~NetworkConditioner();
+
+	// Queue a packet to be sent to a peer once its simulated delay is up
+	// Takes ownership of the packet, same as enet_peer_send
+	void send(_ENetPeer* peer, enet_uint8 channel, _ENetPacket* packet);
+	// Same as send, but to every peer on the host
+	void broadcast(enet_uint8 channel, _ENetPacket* packet);
+
+	// Hand any packets that are due over to ENet
+	// Call before enet_host_service, which does the actual sending
+	void update();
+
+	const Settings& getSettings() const {
+		return settings;
+	}
+
+	size_t getQueuedCount() const {
+		return pending.size();
+	}
+	int getDroppedCount() const {
+		return dropped;
+	}
+	int getDuplicatedCount() const {
+		return duplicated;
+	}
+	int getReorderedCount() const {
+		return reordered;
+	}
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct PendingPacket {
+		Clock::time_point sendAt;
+		// Ties are broken by queue order, so packets without jitter stay in order
+		unsigned int sequence;
+		// nullptr to broadcast
+		_ENetPeer* peer;
+		enet_uint8 channel;
+		_ENetPacket* packet;
+
+		bool operator>(const PendingPacket& other) const {
+			return sendAt != other.sendAt ? sendAt > other.sendAt : sequence > other.sequence;
+		}
+	};
+
+	void enqueue(_ENetPeer* peer, enet_uint8 channel, _ENetPacket* packet);
+	void dispatch(const PendingPacket& pending);
+
+	static int interceptCallback(_ENetHost* host, _ENetEvent* event);
+	bool shouldDrop();
+
+	float random01() {
+		return std::uniform_real_distribution<float>(0.0f, 1.0f)(rng);
+	}
+
+	_ENetHost* host;
+	Settings settings;
+	std::mt19937 rng;
+
+	std::priority_queue<PendingPacket, std::vector<PendingPacket>, std::greater<PendingPacket>> pending;
+	unsigned int nextSequence = 0;
+	// When the simulated link will have finished sending everything queued
+	Clock::time_point linkFreeAt;
+	// Reliable packets must leave in order, or ENet will happily deliver them out of order
+	Clock::time_point lastReliableSendAt;
+
+	int dropped = 0;
+	int duplicated = 0;
+	int reordered = 0;
+};
@@ -3,7 +3,8 @@
 using namespace NCL;
 using namespace CSC8503;
 
-NetworkObject::NetworkObject(GameObject& o, Id id) : object(o)	{
+NetworkObject::NetworkObject(GameObject& o, Id id, SnapshotHistory& history) : object(o), history(history)	{
+	historySlot = history.addObject();
 	deltaErrors = 0;
 	fullErrors  = 0;
 	networkID   = id;
@@ -41,8 +42,6 @@ bool NetworkObject::ReadDeltaPacket(DeltaPacket &p) {
 		std::cout << "DeltaPacket for object " << networkID << " is out of date!\n";
 		return false;
 	}
-	UpdateStateHistory(p.fullID);
-
 	Vector3 fullPos = lastFullState.position;
 	Quaternion fullOr = lastFullState.orientation;
 
@@ -55,6 +54,9 @@ bool NetworkObject::ReadDeltaPacket(DeltaPacket &p) {
 	fullOr.z += ((float)p.orientation[2] / DeltaOrientationFactor);
 	fullOr.w += ((float)p.orientation[3] / DeltaOrientationFactor);
 
+	if (predicted) {
+		return true;
+	}
 	object.GetTransform().SetPosition(fullPos);
 	object.GetTransform().SetOrientation(fullOr);
 	return true;
@@ -66,6 +68,9 @@ bool NetworkObject::ReadFullPacket(FullPacket &p) {
 		return false;
 	}
 	lastFullState = p.fullState;
+	if (predicted) {
+		return true;
+	}
 	object.GetTransform().SetPosition(lastFullState.position);
 	object.GetTransform().SetOrientation(lastFullState.orientation);
 	return true;
@@ -115,7 +120,7 @@ bool NetworkObject::WriteFullPacket(GamePacket**p) {
 	lastFullState = createNetworkState(lastFullState.stateID + 1);
 	fp->fullState = lastFullState;
 	fp->objectID = networkID;
-	stateHistory.push_back(lastFullState);
+	history.record(historySlot, lastFullState);
 	*p = fp;
 	return true;
 }
@@ -125,21 +130,7 @@ NetworkState& NetworkObject::GetLatestNetworkState() {
 }
 
 bool NetworkObject::GetNetworkState(int stateID, NetworkState& state) {
-	auto it = std::find_if(stateHistory.begin(), stateHistory.end(), [&](NetworkState& s) {
-		return s.stateID == stateID;
-	});
-	if (it == stateHistory.end()) {
-		return false;
-	}
-	state = *it;
-	return true;
-}
-
-// Drop states that are older than the given ID
-void NetworkObject::UpdateStateHistory(int minID) {
-	std::erase_if(stateHistory, [&](NetworkState& state) {
-		return state.stateID < minID;
-	});
+	return history.get(historySlot, stateID, state);
 }
 
 int NetworkObject::getDeltaError(const NetworkState& from) const {
@@ -2,12 +2,15 @@
 #include "GameObject.h"
 #include "NetworkBase.h"
 #include "NetworkState.h"
+#include "SnapshotHistory.h"
 
 namespace NCL::CSC8503 {
 	class GameObject;
 
 	struct FullPacket : public GamePacket {
 		int		objectID = -1;
+		// Server tick the state was sent on
+		int		serverTick = -1;
 		// The full state of the object
 		NetworkState fullState;
 
@@ -28,6 +31,8 @@ namespace NCL::CSC8503 {
 		// Reject this delta if it doesn't match the last full state
 		int		fullID		= -1;
 		int		objectID	= -1;
+		// Server tick the state was sent on
+		int		serverTick	= -1;
 		PositionType	pos[3];
 		char	orientation[4];
 
@@ -42,7 +47,8 @@ namespace NCL::CSC8503 {
 		using Id = unsigned int;
 		const static constexpr Id MaxId = std::numeric_limits<Id>::max();
 
-		NetworkObject(GameObject& o, Id id);
+		// Full states sent are recorded in history, which is shared with the rest of the world
+		NetworkObject(GameObject& o, Id id, SnapshotHistory& history);
 		virtual ~NetworkObject();
 
 		Id getId() const {
@@ -54,8 +60,6 @@ namespace NCL::CSC8503 {
 		//Called by servers
 		virtual bool WritePacket(GamePacket** p, bool deltaFrame, int stateID);
 
-		void UpdateStateHistory(int minID);
-
 		// Get how far the current state is from the last full state
 		// Fairly arbitary metric, intended to detect what kind of state to send,
 		// if any
@@ -68,6 +72,19 @@ namespace NCL::CSC8503 {
 			return lastDeltaState;
 		}
 
+		// Predicted objects are simulated locally, and corrected by
+		// reconciliation rather than snapping to every snapshot
+		void setPredicted(bool value) {
+			predicted = value;
+		}
+		bool isPredicted() const {
+			return predicted;
+		}
+
+		int getHistorySlot() const {
+			return historySlot;
+		}
+
 	protected:
 		NetworkState createNetworkState(int id);
 
@@ -86,11 +103,14 @@ namespace NCL::CSC8503 {
 		NetworkState lastFullState;
 		NetworkState lastDeltaState;
 
-		std::vector<NetworkState> stateHistory;
+		SnapshotHistory& history;
+		int historySlot;
 
 		int deltaErrors;
 		int fullErrors;
 
+		bool predicted = false;
+
 		Id networkID;
 	};
 }
@@ -0,0 +1,350 @@
+#include "NetworkProfiler.h"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "Debug.h"
+
+using namespace NCL;
+
+namespace {
+	const char* typeNames[] = {
+		"String_Message",
+		"Delta_State",
+		"Full_State",
+		"ObjectDestroy",
+		"ClientState",
+		"Message",
+		"PlayerDisconnected",
+		"ClientHello",
+		"ServerHello",
+		"PlayerList",
+		"InputAck",
+		"Compressed",
+		"PayloadEnd",
+		"Server_ClientConnect",
+		"Server_ClientDisconnect",
+		"Client_ClientConnect",
+		"Client_ClientDisconnect",
+		"Shutdown",
+		"Reset",
+		"GameEnd",
+	};
+	static_assert(std::size(typeNames) == NetworkProfiler::TypeCount, "Every packet type needs a name");
+
+	const char* inputEventNames[] = {
+		"received",
+		"redundant",
+		"duplicate",
+		"late",
+		"lost",
+		"starved",
+		"skipped",
+	};
+	static_assert(std::size(inputEventNames) == NetworkProfiler::InputEventCount, "Every input event needs a name");
+
+	uint64_t bucketUpperNanos(int bucket) {
+		return 1ull << (bucket + NetworkProfiler::FirstBucketBits);
+	}
+
+	std::string formatBytes(double bytes) {
+		std::stringstream ss;
+		ss << std::fixed << std::setprecision(1);
+		if (bytes >= 1024 * 1024) {
+			ss << bytes / (1024 * 1024) << "MB";
+		} else if (bytes >= 1024) {
+			ss << bytes / 1024 << "KB";
+		} else {
+			ss << bytes << "B";
+		}
+		return ss.str();
+	}
+}
+
+void NetworkProfiler::Timing::add(uint64_t nanos) {
+	count++;
+	totalNanos += nanos;
+	maxNanos = std::max(maxNanos, nanos);
+	int bucket = std::clamp((int)std::bit_width(nanos) - FirstBucketBits, 0, HistogramBuckets - 1);
+	histogram[bucket]++;
+}
+
+uint64_t NetworkProfiler::Timing::percentileNanos(float p) const {
+	uint64_t target = (uint64_t)(p * count);
+	uint64_t seen = 0;
+	for (int i = 0; i < HistogramBuckets; i++) {
+		seen += histogram[i];
+		if (seen > target) {
+			return bucketUpperNanos(i);
+		}
+	}
+	return maxNanos;
+}
+
+void NetworkProfiler::recordSent(GamePacket::Type type, size_t bytes) {
+	if ((size_t)type < TypeCount) {
+		types[(size_t)type].sent.add(bytes);
+	}
+}
+
+void NetworkProfiler::recordReceived(GamePacket::Type type, size_t bytes) {
+	if ((size_t)type < TypeCount) {
+		types[(size_t)type].received.add(bytes);
+	}
+}
+
+void NetworkProfiler::recordPeerSent(int peer, size_t bytes) {
+	getPeer(peer).sent.add(bytes);
+	current.sent.add(bytes);
+}
+
+void NetworkProfiler::recordPeerReceived(int peer, size_t bytes) {
+	getPeer(peer).received.add(bytes);
+	current.received.add(bytes);
+}
+
+void NetworkProfiler::recordInput(int peer, InputEvent event, uint64_t count) {
+	if ((size_t)event < InputEventCount) {
+		getPeer(peer).inputs[(size_t)event] += count;
+	}
+}
+
+void NetworkProfiler::recordWriteTime(GamePacket::Type type, uint64_t nanos) {
+	if ((size_t)type < TypeCount) {
+		types[(size_t)type].write.add(nanos);
+	}
+}
+
+void NetworkProfiler::recordReadTime(GamePacket::Type type, uint64_t nanos) {
+	if ((size_t)type < TypeCount) {
+		types[(size_t)type].read.add(nanos);
+	}
+}
+
+void NetworkProfiler::endTick() {
+	recentTicks[tickCount % RecentTickCount] = current;
+	tickCount++;
+	if (keepTickHistory) {
+		tickHistory.push_back(current);
+	}
+	current = TickStats();
+}
+
+NetworkProfiler::PeerStats& NetworkProfiler::getPeer(int peer) {
+	// Peer IDs are indices into the ENet host's peers, so stay small
+	size_t index = std::max(peer, 0);
+	if (index >= peers.size()) {
+		peers.resize(index + 1);
+	}
+	return peers[index];
+}
+
+NetworkProfiler::TickStats NetworkProfiler::getRecentTotals(size_t count) const {
+	TickStats totals;
+	size_t start = tickCount - std::min({ count, tickCount, RecentTickCount });
+	for (size_t i = start; i < tickCount; i++) {
+		const TickStats& tick = recentTicks[i % RecentTickCount];
+		totals.sent.packets += tick.sent.packets;
+		totals.sent.bytes += tick.sent.bytes;
+		totals.received.packets += tick.received.packets;
+		totals.received.bytes += tick.received.bytes;
+	}
+	return totals;
+}
+
+double NetworkProfiler::getElapsedSeconds() const {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void NetworkProfiler::drawOverlay(float x, float y) const {
+	const float lineHeight = 3.0f;
+	const Vector4 headingColour = Debug::YELLOW;
+	// Roughly a second at the default tick rate
+	const size_t overlayTicks = 60;
+
+	TickStats recent = getRecentTotals(overlayTicks);
+	size_t recentCount = std::min(overlayTicks, tickCount);
+	Debug::Print("Network, last " + std::to_string(recentCount) + " ticks", Vector2(x, y), headingColour);
+	y += lineHeight;
+	Debug::Print("Sent " + formatBytes((double)recent.sent.bytes) + " in " + std::to_string(recent.sent.packets) + " packets", Vector2(x, y));
+	y += lineHeight;
+	Debug::Print("Received " + formatBytes((double)recent.received.bytes) + " in " + std::to_string(recent.received.packets) + " packets", Vector2(x, y));
+	y += lineHeight;
+
+	// Types that have sent anything, biggest first
+	std::vector<size_t> order;
+	for (size_t i = 0; i < TypeCount; i++) {
+		if (types[i].sent.packets > 0 || types[i].received.packets > 0) {
+			order.push_back(i);
+		}
+	}
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return types[a].sent.bytes + types[a].received.bytes > types[b].sent.bytes + types[b].received.bytes;
+	});
+
+	double ticks = (double)std::max<size_t>(tickCount, 1);
+	y += lineHeight;
+	Debug::Print("Type: sent/tick received/tick write read", Vector2(x, y), headingColour);
+	y += lineHeight;
+	for (size_t i : order) {
+		const TypeStats& stats = types[i];
+		std::stringstream ss;
+		ss << std::fixed << std::setprecision(2) << typeNames[i] << ": "
+			<< formatBytes(stats.sent.bytes / ticks) << " "
+			<< formatBytes(stats.received.bytes / ticks) << " "
+			<< stats.write.meanNanos() / 1000 << "us "
+			<< stats.read.meanNanos() / 1000 << "us";
+		Debug::Print(ss.str(), Vector2(x, y));
+		y += lineHeight;
+	}
+
+	y += lineHeight;
+	Debug::Print("Peer: sent/tick received/tick", Vector2(x, y), headingColour);
+	y += lineHeight;
+	for (size_t i = 0; i < peers.size(); i++) {
+		if (peers[i].sent.packets == 0 && peers[i].received.packets == 0) {
+			continue;
+		}
+		Debug::Print(std::to_string(i) + ": " + formatBytes(peers[i].sent.bytes / ticks) + " "
+			+ formatBytes(peers[i].received.bytes / ticks), Vector2(x, y));
+		y += lineHeight;
+	}
+
+	// Only servers buffer input, so clients skip this
+	bool anyInputs = std::any_of(peers.begin(), peers.end(), [](const PeerStats& peer) {
+		return peer.inputs[(size_t)InputEvent::Received] > 0;
+	});
+	if (!anyInputs) {
+		return;
+	}
+	y += lineHeight;
+	std::string heading = "Inputs:";
+	for (const char* name : inputEventNames) {
+		heading += std::string(" ") + name;
+	}
+	Debug::Print(heading, Vector2(x, y), headingColour);
+	y += lineHeight;
+	for (size_t i = 0; i < peers.size(); i++) {
+		if (peers[i].inputs[(size_t)InputEvent::Received] == 0) {
+			continue;
+		}
+		std::string line = std::to_string(i) + ":";
+		for (uint64_t count : peers[i].inputs) {
+			line += " " + std::to_string(count);
+		}
+		Debug::Print(line, Vector2(x, y));
+		y += lineHeight;
+	}
+}
+
+bool NetworkProfiler::writeCsv(const std::string& path) const {
+	std::ofstream file(path);
+	if (!file) {
+		return false;
+	}
+	file << "kind,name,sent_packets,sent_bytes,received_packets,received_bytes,"
+		"write_count,write_mean_ns,write_p95_ns,write_max_ns,read_count,read_mean_ns,read_p95_ns,read_max_ns";
+	for (const char* name : inputEventNames) {
+		file << ",inputs_" << name;
+	}
+	file << "\n";
+	const std::string noInputs(InputEventCount, ',');
+	for (size_t i = 0; i < TypeCount; i++) {
+		const TypeStats& stats = types[i];
+		file << "type," << typeNames[i] << ","
+			<< stats.sent.packets << "," << stats.sent.bytes << ","
+			<< stats.received.packets << "," << stats.received.bytes << ","
+			<< stats.write.count << "," << stats.write.meanNanos() << "," << stats.write.percentileNanos(0.95f) << "," << stats.write.maxNanos << ","
+			<< stats.read.count << "," << stats.read.meanNanos() << "," << stats.read.percentileNanos(0.95f) << "," << stats.read.maxNanos << noInputs << "\n";
+	}
+	for (size_t i = 0; i < peers.size(); i++) {
+		file << "peer," << i << ","
+			<< peers[i].sent.packets << "," << peers[i].sent.bytes << ","
+			<< peers[i].received.packets << "," << peers[i].received.bytes << ",,,,,,,,";
+		for (uint64_t count : peers[i].inputs) {
+			file << "," << count;
+		}
+		file << "\n";
+	}
+	for (size_t i = 0; i < tickHistory.size(); i++) {
+		file << "tick," << i << ","
+			<< tickHistory[i].sent.packets << "," << tickHistory[i].sent.bytes << ","
+			<< tickHistory[i].received.packets << "," << tickHistory[i].received.bytes << ",,,,,,,," << noInputs << "\n";
+	}
+	return (bool)file;
+}
+
+bool NetworkProfiler::writeJson(const std::string& path) const {
+	std::ofstream file(path);
+	if (!file) {
+		return false;
+	}
+	auto writeCounter = [&](const Counter& counter) {
+		file << "{\"packets\": " << counter.packets << ", \"bytes\": " << counter.bytes << "}";
+	};
+	auto writeTiming = [&](const Timing& timing) {
+		file << "{\"count\": " << timing.count << ", \"meanNs\": " << timing.meanNanos()
+			<< ", \"maxNs\": " << timing.maxNanos << ", \"histogram\": [";
+		for (int i = 0; i < HistogramBuckets; i++) {
+			file << (i ? ", " : "") << timing.histogram[i];
+		}
+		file << "]}";
+	};
+
+	file << "{\n\t\"seconds\": " << getElapsedSeconds() << ",\n\t\"ticks\": " << tickCount << ",\n";
+	file << "\t\"histogramBucketUpperNs\": [";
+	for (int i = 0; i < HistogramBuckets; i++) {
+		file << (i ? ", " : "") << bucketUpperNanos(i);
+	}
+	file << "],\n\t\"types\": [\n";
+	for (size_t i = 0; i < TypeCount; i++) {
+		const TypeStats& stats = types[i];
+		file << "\t\t{\"name\": \"" << typeNames[i] << "\", \"sent\": ";
+		writeCounter(stats.sent);
+		file << ", \"received\": ";
+		writeCounter(stats.received);
+		file << ", \"write\": ";
+		writeTiming(stats.write);
+		file << ", \"read\": ";
+		writeTiming(stats.read);
+		file << "}" << (i + 1 < TypeCount ? "," : "") << "\n";
+	}
+	file << "\t],\n\t\"peers\": [\n";
+	for (size_t i = 0; i < peers.size(); i++) {
+		file << "\t\t{\"id\": " << i << ", \"sent\": ";
+		writeCounter(peers[i].sent);
+		file << ", \"received\": ";
+		writeCounter(peers[i].received);
+		file << ", \"inputs\": {";
+		for (size_t j = 0; j < InputEventCount; j++) {
+			file << (j ? ", " : "") << "\"" << inputEventNames[j] << "\": " << peers[i].inputs[j];
+		}
+		file << "}}" << (i + 1 < peers.size() ? "," : "") << "\n";
+	}
+	// Per tick totals as parallel arrays, to keep the file a manageable size
+	file << "\t],\n\t\"perTick\": {\n";
+	auto writeSeries = [&](const char* name, auto member, bool last) {
+		file << "\t\t\"" << name << "\": [";
+		for (size_t i = 0; i < tickHistory.size(); i++) {
+			file << (i ? ", " : "") << member(tickHistory[i]);
+		}
+		file << "]" << (last ? "" : ",") << "\n";
+	};
+	writeSeries("sentPackets", [](const TickStats& t) { return t.sent.packets; }, false);
+	writeSeries("sentBytes", [](const TickStats& t) { return t.sent.bytes; }, false);
+	writeSeries("receivedPackets", [](const TickStats& t) { return t.received.packets; }, false);
+	writeSeries("receivedBytes", [](const TickStats& t) { return t.received.bytes; }, true);
+	file << "\t}\n}\n";
+	return (bool)file;
+}
+
+const char* NetworkProfiler::GetTypeName(GamePacket::Type type) {
+	return (size_t)type < TypeCount ? typeNames[(size_t)type] : "Unknown";
+}
+
+const char* NetworkProfiler::GetInputEventName(InputEvent event) {
+	return (size_t)event < InputEventCount ? inputEventNames[(size_t)event] : "unknown";
+}
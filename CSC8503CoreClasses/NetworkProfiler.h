@@ -0,0 +1,192 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "NetworkBase.h"
+
+// Counts what a NetworkBase sends and receives, by packet type, by peer and by tick
+// Sizes are of game packets as handed to ENet, so don't include ENet's own overhead
+// NetworkBase::GetBytesSent/Received has the totals with overhead
+class NetworkProfiler {
+public:
+	static const constexpr size_t TypeCount = (size_t)GamePacket::Type::Count;
+
+	// Timing histograms have a bucket per power of two nanoseconds
+	// Bucket 0 is anything under 128ns, the last is anything over ~2ms
+	static const constexpr int HistogramBuckets = 16;
+	static const constexpr int FirstBucketBits = 7;
+	// Finished ticks kept for getRecentTotals, whether or not the full history is
+	static const constexpr size_t RecentTickCount = 256;
+
+	struct Counter {
+		uint64_t packets = 0;
+		uint64_t bytes = 0;
+
+		void add(size_t size) {
+			packets++;
+			bytes += size;
+		}
+	};
+
+	struct Timing {
+		uint64_t count = 0;
+		uint64_t totalNanos = 0;
+		uint64_t maxNanos = 0;
+		std::array<uint32_t, HistogramBuckets> histogram{};
+
+		void add(uint64_t nanos);
+		double meanNanos() const {
+			return count ? (double)totalNanos / count : 0.0;
+		}
+		// Upper bound of the bucket the percentile falls in
+		uint64_t percentileNanos(float p) const;
+	};
+
+	struct TypeStats {
+		Counter sent;
+		Counter received;
+		// Time spent writing the packet, as reported by the game
+		Timing write;
+		// Time spent in handlers for the packet
+		Timing read;
+	};
+
+	// What happened to inputs a peer sent, as reported by the game's input buffering
+	enum class InputEvent {
+		// Arrived in time to be applied
+		Received,
+		// A copy of an input that had already arrived, repeated by a later packet
+		// Expected whenever the previous packet got through
+		Redundant,
+		// A whole packet that had already arrived, duplicated by the network
+		Duplicate,
+		// Arrived after its tick had been simulated without it
+		Late,
+		// Never arrived in time, the previous input was repeated in its place
+		Lost,
+		// Nothing was buffered for a tick, so the peer's last input carried on
+		Starved,
+		// Dropped unapplied, to stop the buffer growing when the peer runs fast
+		Skipped,
+
+		Count
+	};
+	static const constexpr size_t InputEventCount = (size_t)InputEvent::Count;
+
+	struct PeerStats {
+		Counter sent;
+		Counter received;
+		std::array<uint64_t, InputEventCount> inputs{};
+	};
+
+	struct TickStats {
+		Counter sent;
+		Counter received;
+	};
+
+	// Times a scope and records it against a packet type
+	// Does nothing without a profiler, so can be left in place
+	class ScopedTimer {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		ScopedTimer(NetworkProfiler* profiler, GamePacket::Type type, bool write = true)
+			: profiler(profiler), type(type), write(write) {
+			if (profiler) {
+				start = Clock::now();
+			}
+		}
+		~ScopedTimer() {
+			stop();
+		}
+
+		// Record now rather than at the end of the scope
+		void stop() {
+			if (!profiler) {
+				return;
+			}
+			auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+			write ? profiler->recordWriteTime(type, nanos) : profiler->recordReadTime(type, nanos);
+			profiler = nullptr;
+		}
+
+		// The type may not be known until the packet's been written
+		void setType(GamePacket::Type newType) {
+			type = newType;
+		}
+	private:
+		NetworkProfiler* profiler;
+		GamePacket::Type type;
+		bool write;
+		Clock::time_point start;
+	};
+
+	// Game packets. A packet broadcast to every peer counts once
+	// Compressed packets count under their own type at full size, and under Compressed as sent
+	void recordSent(GamePacket::Type type, size_t bytes);
+	void recordReceived(GamePacket::Type type, size_t bytes);
+	// ENet packets, which may hold several game packets. Tick totals count these
+	void recordPeerSent(int peer, size_t bytes);
+	void recordPeerReceived(int peer, size_t bytes);
+
+	void recordInput(int peer, InputEvent event, uint64_t count = 1);
+
+	void recordWriteTime(GamePacket::Type type, uint64_t nanos);
+	void recordReadTime(GamePacket::Type type, uint64_t nanos);
+
+	// Close off the current tick's counters and start the next
+	void endTick();
+
+	const TypeStats& getTypeStats(GamePacket::Type type) const {
+		return types[(size_t)type];
+	}
+	const std::vector<PeerStats>& getPeerStats() const {
+		return peers;
+	}
+	// Keep every finished tick for writeCsv and writeJson, not just the last RecentTickCount
+	// Grows by a few dozen bytes a tick, so only turn it on when the stats will be written
+	void setKeepTickHistory(bool keep) {
+		keepTickHistory = keep;
+	}
+	// Every tick finished while keeping history, oldest first
+	const std::vector<TickStats>& getTickStats() const {
+		return tickHistory;
+	}
+	size_t getTickCount() const {
+		return tickCount;
+	}
+	const TickStats& getCurrentTick() const {
+		return current;
+	}
+
+	// Totals over the last count ticks, up to RecentTickCount
+	TickStats getRecentTotals(size_t count) const;
+
+	double getElapsedSeconds() const;
+
+	// Draw a summary with Debug::Print, starting at the given screen position
+	void drawOverlay(float x, float y) const;
+
+	// Returns false if the file couldn't be written
+	bool writeCsv(const std::string& path) const;
+	bool writeJson(const std::string& path) const;
+
+	static const char* GetTypeName(GamePacket::Type type);
+	static const char* GetInputEventName(InputEvent event);
+private:
+	PeerStats& getPeer(int peer);
+
+	std::array<TypeStats, TypeCount> types;
+	std::vector<PeerStats> peers;
+	// Indexed by tick % RecentTickCount
+	std::array<TickStats, RecentTickCount> recentTicks;
+	size_t tickCount = 0;
+	std::vector<TickStats> tickHistory;
+	bool keepTickHistory = false;
+	TickStats current;
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+};
@@ -148,6 +148,40 @@ void PhysicsSystem::Update(float dt) {
 	}
 }
 
+void PhysicsSystem::SimulateObject(GameObject& object, float dt) {
+	PhysicsObject* physicsObject = object.GetPhysicsObject();
+	if (physicsObject == nullptr) {
+		return;
+	}
+	if (staticsTree == nullptr) {
+		rebuildStaticsTree();
+	}
+
+	// Forces are held for the whole frame, same as Update
+	while (dt > 0) {
+		float stepDT = std::min(dt, realDT);
+		integrateObjectAccel(*physicsObject, stepDT);
+
+		object.UpdateBroadphaseAABB();
+		Vector3 halfSizes;
+		object.GetBroadphaseAABB(halfSizes);
+		auto& staticsLeaf = staticsTree->GetContainingNode(object.GetTransform().GetPosition(), halfSizes);
+		QuadTreeNode<GameObject*>::QuadTreeFunc func = [&](std::list<QuadTreeEntry<GameObject*>>& staticData) {
+			for (auto& entry : staticData) {
+				CollisionDetection::CollisionInfo info;
+				if (CollisionDetection::ObjectIntersection(&object, entry.object, info)) {
+					ResolveCollision(*info.a, *info.b, info.point);
+				}
+			}
+		};
+		staticsLeaf.OperateOnContents(func);
+
+		integrateObjectVelocity(object.GetTransform(), *physicsObject, stepDT, pow(globalDamping, stepDT));
+		dt -= stepDT;
+	}
+	physicsObject->ClearForces();
+}
+
 /*
 Later on we're going to need to keep track of collisions
 across multiple frames, so we store them in a set.
@@ -24,6 +24,11 @@ namespace NCL {
 
 			void Update(float dt);
 
+			// Step a single object forward by dt, using the same fixed timestep as Update
+			// Only collides with statics, the rest of the world is left untouched
+			// Used to replay predicted input without advancing everything else
+			void SimulateObject(GameObject& object, float dt);
+
 			void SetGlobalDamping(float d) {
 				globalDamping = d;
 			}
@@ -0,0 +1,88 @@
+#include "RenderCulling.h"
+
+#include <stdexcept>
+
+#include "GameObject.h"
+#include "RenderObject.h"
+
+using namespace NCL::CSC8503;
+
+RenderCuller::RenderCuller(WorkerPool* pool) : pool(pool) {
+}
+
+void RenderCuller::cull(const GameWorld& world, std::span<View> views) {
+	if (views.size() > MaxViews) {
+		throw std::runtime_error("RenderCuller: too many views");
+	}
+	GameObjectIterator first;
+	GameObjectIterator last;
+	world.GetObjectIterators(first, last);
+	size_t count = last - first;
+	size_t chunkCount = (count + ChunkSize - 1) / ChunkSize;
+	if (chunks.size() < chunkCount) {
+		chunks.resize(chunkCount);
+	}
+
+	auto cullRange = [&](size_t begin, size_t end) {
+		cullChunk(first + begin, first + end, views, chunks[begin / ChunkSize]);
+	};
+	if (pool) {
+		pool->parallelFor(count, ChunkSize, cullRange);
+	} else {
+		for (size_t begin = 0; begin < count; begin += ChunkSize) {
+			cullRange(begin, std::min(begin + ChunkSize, count));
+		}
+	}
+
+	// Merged in chunk order, so the lists come out the same however the chunks were run
+	totalCount = 0;
+	unboundedCount = 0;
+	for (View& view : views) {
+		view.visible.clear();
+		view.culled = 0;
+	}
+	for (size_t c = 0; c < chunkCount; c++) {
+		const ChunkResult& result = chunks[c];
+		for (size_t v = 0; v < views.size(); v++) {
+			views[v].visible.insert(views[v].visible.end(), result.visible[v].begin(), result.visible[v].end());
+			views[v].culled += result.culled[v];
+		}
+		totalCount += result.total;
+		unboundedCount += result.unbounded;
+	}
+}
+
+void RenderCuller::cullChunk(GameObjectIterator first, GameObjectIterator last, std::span<View> views, ChunkResult& result) const {
+	for (size_t v = 0; v < views.size(); v++) {
+		result.visible[v].clear();
+		result.culled[v] = 0;
+	}
+	result.total = 0;
+	result.unbounded = 0;
+
+	for (auto i = first; i != last; ++i) {
+		const GameObject& object = **i;
+		RenderObject* renderObject = object.GetRenderObject();
+		if (!object.IsActive() || !renderObject) {
+			continue;
+		}
+		result.total++;
+
+		Vector3 halfSize;
+		if (!object.GetBroadphaseAABB(halfSize)) {
+			result.unbounded++;
+			for (size_t v = 0; v < views.size(); v++) {
+				result.visible[v].push_back(renderObject);
+			}
+			continue;
+		}
+		Vector3 position = renderObject->GetTransform()->GetPosition();
+		for (size_t v = 0; v < views.size(); v++) {
+			if (views[v].frustum.AABBInsideFrustum(position, halfSize)) {
+				result.visible[v].push_back(renderObject);
+			} else {
+				result.culled[v]++;
+			}
+		}
+	}
+}
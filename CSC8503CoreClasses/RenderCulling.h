@@ -0,0 +1,67 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "Frustum.h"
+#include "GameWorld.h"
+#include "WorkerPool.h"
+
+namespace NCL::CSC8503 {
+	class RenderObject;
+
+	// Finds the objects each view can see, splitting the world across a WorkerPool
+	// Objects are tested by their broadphase AABB, so are only culled if their
+	// bounding volume covers what's drawn. Objects without one are always visible
+	// Needs no GL, so can be run headless
+	class RenderCuller {
+	public:
+		// Objects per job, enough to cover the cost of handing out a chunk
+		static const constexpr size_t ChunkSize = 256;
+		// Views culled in one pass, camera and shadow map for now
+		static const constexpr size_t MaxViews = 4;
+
+		struct View {
+			Maths::Frustum frustum;
+			// Filled in world order, same as a serial loop would
+			// Not const, as the renderer picks each visible object's LOD
+			std::vector<RenderObject*> visible;
+			size_t culled = 0;
+		};
+
+		// Culls serially if pool is nullptr
+		explicit RenderCuller(WorkerPool* pool = &WorkerPool::Get());
+
+		// Fills in each view's visible list from active objects with a RenderObject
+		void cull(const GameWorld& world, std::span<View> views);
+
+		void setPool(WorkerPool* newPool) {
+			pool = newPool;
+		}
+
+		// From the last cull, objects that could have been drawn
+		size_t getTotalCount() const {
+			return totalCount;
+		}
+		// From the last cull, objects drawn in every view as they had no bounding volume
+		size_t getUnboundedCount() const {
+			return unboundedCount;
+		}
+	private:
+		struct ChunkResult {
+			std::vector<RenderObject*> visible[MaxViews];
+			size_t culled[MaxViews];
+			size_t total;
+			size_t unbounded;
+		};
+
+		void cullChunk(GameObjectIterator first, GameObjectIterator last, std::span<View> views, ChunkResult& result) const;
+
+		WorkerPool* pool;
+		// Kept between frames so the lists don't need reallocating
+		std::vector<ChunkResult> chunks;
+
+		size_t totalCount = 0;
+		size_t unboundedCount = 0;
+	};
+}
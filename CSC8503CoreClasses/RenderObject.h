@@ -2,10 +2,16 @@
 #include "Texture.h"
 #include "Shader.h"
 #include "Mesh.h"
+#include "LodSelector.h"
+#include "CpuSkinner.h"
 
 namespace NCL {
 	using namespace NCL::Rendering;
 
+	namespace Rendering {
+		class Pose;
+	}
+
 	namespace CSC8503 {
 		class Transform;
 		using namespace Maths;
@@ -15,6 +21,9 @@ namespace NCL {
 		public:
 			RenderObject(Transform* parentTransform, Mesh* mesh, Texture* tex, Shader* shader);
 			~RenderObject();
+			// Moves take any skin with them, copies would have to share it
+			RenderObject(RenderObject&&) = default;
+			RenderObject& operator=(RenderObject&&) = default;
 
 			void SetDefaultTexture(Texture* t) {
 				texture = t;
@@ -24,8 +33,9 @@ namespace NCL {
 				return texture;
 			}
 
+			// A skinned object draws its own copy of the mesh, once the renderer has made one
 			Mesh*	GetMesh() const {
-				return mesh;
+				return skin && skin->mesh ? skin->mesh.get() : mesh;
 			}
 
 			Transform*		GetTransform() const {
@@ -44,12 +54,46 @@ namespace NCL {
 				return colour;
 			}
 
+			// Which of the mesh's LODs to draw, picked by the renderer each frame
+			LodState& GetLodState() {
+				return lodState;
+			}
+			const LodState& GetLodState() const {
+				return lodState;
+			}
+			uint32_t GetLodLevel() const {
+				return lodState.level;
+			}
+
+			// Skinned objects are posed on the CPU by the renderer each frame they're
+			// visible, from the rigged mesh they were made with and pose, which must
+			// outlive the object and be evaluated before the frame is drawn
+			// The skinned copy is the object's own, so it's never instanced with others
+			struct Skin {
+				const Pose*		pose;
+				// Made by the renderer, the first frame the object is visible
+				UniqueMesh		mesh;
+				SkinnedVertices	vertices;
+			};
+			void SetPose(const Pose* pose) {
+				skin = pose ? std::make_unique<Skin>(Skin{ pose }) : nullptr;
+			}
+			Skin* GetSkin() const {
+				return skin.get();
+			}
+			// The rigged mesh, before any skinning
+			Mesh* GetBindMesh() const {
+				return mesh;
+			}
+
 		protected:
 			Mesh*		mesh;
 			Texture*	texture;
 			Shader*		shader;
 			Transform*	transform;
 			Vector4		colour;
+			LodState	lodState;
+			std::unique_ptr<Skin>	skin;
 		};
 	}
 }
@@ -0,0 +1,150 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <array>
+
+#include "RenderObject.h"
+#include "Transform.h"
+
+using namespace NCL;
+using namespace NCL::CSC8503;
+
+namespace {
+	const int PassShift = 64 - RenderQueue::PassBits;
+	// Where state and depth go, depending on which sorts first
+	const int UpperShift = RenderQueue::DepthBits;
+	const int LowerShift = 0;
+
+	uint64_t mask(int bits) {
+		return (uint64_t(1) << bits) - 1;
+	}
+}
+
+void RenderQueue::begin(const Vector3& newViewPosition, float newMaxDepth) {
+	items.clear();
+	viewPosition = newViewPosition;
+	maxDepth = std::max(newMaxDepth, 0.001f);
+}
+
+void RenderQueue::add(Pass pass, const RenderObject& object) {
+	uint64_t state;
+	if (pass == Pass::Shadow) {
+		state = getId(meshIds, object.GetMesh(), MeshBits);
+	} else {
+		state = getId(shaderIds, object.GetShader(), ShaderBits);
+		state = (state << TextureBits) | getId(textureIds, object.GetDefaultTexture(), TextureBits);
+		state = (state << MeshBits) | getId(meshIds, object.GetMesh(), MeshBits);
+	}
+	state = (state << LodBits) | std::min<uint64_t>(object.GetLodLevel(), mask(LodBits));
+
+	uint64_t depth = getDepth(object);
+	uint64_t key = (uint64_t)pass << PassShift;
+	if (pass == Pass::Transparent) {
+		// Furthest first, then by state for draws at the same depth
+		key |= (mask(DepthBits) - depth) << (PassShift - DepthBits);
+		key |= state << LowerShift;
+	} else {
+		key |= state << UpperShift;
+		key |= depth << LowerShift;
+	}
+	items.push_back({ key, &object });
+}
+
+void RenderQueue::add(Pass pass, std::span<const RenderObject* const> objects) {
+	for (const RenderObject* object : objects) {
+		add(pass, *object);
+	}
+}
+
+void RenderQueue::sort() {
+	RadixSort(items, scratch);
+
+	// Passes are the top bits, so are contiguous once sorted
+	auto passOf = [](const Item& item) {
+		return (size_t)(item.key >> PassShift);
+	};
+	size_t i = 0;
+	for (size_t pass = 0; pass <= (size_t)Pass::Count; pass++) {
+		while (i < items.size() && passOf(items[i]) < pass) {
+			i++;
+		}
+		passStarts[pass] = i;
+	}
+	passStarts[(size_t)Pass::Count] = items.size();
+}
+
+std::span<const RenderQueue::Item> RenderQueue::getItems(Pass pass) const {
+	size_t begin = passStarts[(size_t)pass];
+	size_t end = passStarts[(size_t)pass + 1];
+	return std::span<const Item>(items).subspan(begin, end - begin);
+}
+
+void RenderQueue::RadixSort(std::vector<Item>& items, std::vector<Item>& scratch) {
+	const int DigitBits = 8;
+	const int DigitCount = 64 / DigitBits;
+	const size_t Buckets = size_t(1) << DigitBits;
+
+	// Histograms for every digit in one pass over the keys
+	std::array<std::array<size_t, Buckets>, DigitCount> counts{};
+	for (const Item& item : items) {
+		for (int d = 0; d < DigitCount; d++) {
+			counts[d][(item.key >> (d * DigitBits)) & (Buckets - 1)]++;
+		}
+	}
+
+	scratch.resize(items.size());
+	for (int d = 0; d < DigitCount; d++) {
+		std::array<size_t, Buckets>& count = counts[d];
+		// Every key has the same digit here, so this pass wouldn't move anything
+		if (std::find(count.begin(), count.end(), items.size()) != count.end()) {
+			continue;
+		}
+		size_t offset = 0;
+		for (size_t& bucket : count) {
+			size_t bucketCount = bucket;
+			bucket = offset;
+			offset += bucketCount;
+		}
+		int shift = d * DigitBits;
+		for (const Item& item : items) {
+			scratch[count[(item.key >> shift) & (Buckets - 1)]++] = item;
+		}
+		items.swap(scratch);
+	}
+}
+
+uint64_t RenderQueue::getId(std::unordered_map<const void*, uint64_t>& ids, const void* resource, int bits) {
+	// 0 is kept for nothing bound
+	if (!resource) {
+		return 0;
+	}
+	auto [i, added] = ids.try_emplace(resource, ids.size() + 1);
+	return (i->second - 1) % mask(bits) + 1;
+}
+
+uint64_t RenderQueue::getDepth(const RenderObject& object) const {
+	float distance = Vector::Length(object.GetTransform()->GetPosition() - viewPosition);
+	float scaled = std::clamp(distance / maxDepth, 0.0f, 1.0f);
+	return (uint64_t)(scaled * (float)mask(DepthBits));
+}
+
+RenderQueue::StateChange RenderQueue::getChange(Pass pass, const RenderObject& object, bool first,
+	const Rendering::Shader*& shader, const Rendering::Texture*& texture, const Rendering::Mesh*& mesh, uint32_t& lod) {
+	StateChange change;
+	// The shadow pass binds its own shader, and no textures
+	if (pass == Pass::Shadow) {
+		change.shader = first;
+		change.texture = false;
+	} else {
+		change.shader = first || object.GetShader() != shader;
+		// Samplers are set per shader, so a new shader needs its texture bound again
+		change.texture = change.shader || object.GetDefaultTexture() != texture;
+	}
+	change.mesh = first || object.GetMesh() != mesh;
+	change.lod = change.mesh || object.GetLodLevel() != lod;
+	shader = object.GetShader();
+	texture = object.GetDefaultTexture();
+	mesh = object.GetMesh();
+	lod = object.GetLodLevel();
+	return change;
+}
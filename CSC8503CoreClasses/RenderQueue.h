@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "Vector.h"
+
+namespace NCL::Rendering {
+	class Mesh;
+	class Shader;
+	class Texture;
+}
+
+namespace NCL::CSC8503 {
+	class RenderObject;
+
+	// Orders a frame's draws to need as few state changes as possible
+	// Each draw gets a 64 bit key, and sorting the keys groups draws by shader,
+	// then texture, then mesh, nearest first within each group. Transparent
+	// draws are sorted furthest first instead, as blending needs them in order.
+	// Draws of one mesh at different LODs are kept apart, as they draw different indices
+	// Knows nothing about the graphics API, so can be run headless
+	class RenderQueue {
+	public:
+		// Passes are drawn in this order
+		enum class Pass : uint8_t {
+			Shadow,
+			Opaque,
+			Transparent,
+			Count
+		};
+
+		struct Item {
+			uint64_t key;
+			const RenderObject* object;
+		};
+
+		// What needs binding before an item can be drawn
+		struct StateChange {
+			bool shader;
+			bool texture;
+			bool mesh;
+			// Same mesh, but a different range of its indices
+			bool lod;
+		};
+
+		struct Stats {
+			size_t draws = 0;
+			size_t shaderChanges = 0;
+			size_t textureChanges = 0;
+			size_t meshChanges = 0;
+		};
+
+		// Key layout, from the top bit down. For transparent draws, depth and the state fields swap places
+		static const constexpr int PassBits = 2;
+		static const constexpr int ShaderBits = 12;
+		static const constexpr int TextureBits = 12;
+		static const constexpr int MeshBits = 12;
+		static const constexpr int LodBits = 2;
+		static const constexpr int DepthBits = 24;
+		static_assert(PassBits + ShaderBits + TextureBits + MeshBits + LodBits + DepthBits == 64);
+
+		// Starts a new frame, draws are nearest first from viewPosition out to maxDepth
+		void begin(const Maths::Vector3& viewPosition, float maxDepth);
+
+		// The shadow pass only has one shader and no textures, so only sorts by mesh
+		void add(Pass pass, const RenderObject& object);
+		void add(Pass pass, std::span<const RenderObject* const> objects);
+
+		void sort();
+
+		// Only valid after sort
+		std::span<const Item> getItems(Pass pass) const;
+
+		// Calls func(item, change) for each item in pass in order, with what changed
+		// since the last item. The first item of a pass always changes everything
+		template <typename F>
+		Stats forEachDraw(Pass pass, F&& func) const {
+			Stats stats;
+			const Rendering::Shader* shader = nullptr;
+			const Rendering::Texture* texture = nullptr;
+			const Rendering::Mesh* mesh = nullptr;
+			uint32_t lod = 0;
+			bool first = true;
+			for (const Item& item : getItems(pass)) {
+				StateChange change = getChange(pass, *item.object, first, shader, texture, mesh, lod);
+				first = false;
+				stats.draws++;
+				stats.shaderChanges += change.shader;
+				stats.textureChanges += change.texture;
+				stats.meshChanges += change.mesh;
+				func(item, change);
+			}
+			return stats;
+		}
+
+		// Sorts by key with an 8 bit LSD radix sort, skipping digits every key shares
+		// scratch is resized to fit, so can be reused to avoid allocating
+		static void RadixSort(std::vector<Item>& items, std::vector<Item>& scratch);
+	private:
+		// IDs are handed out on first sight and kept between frames, so steady state adds don't allocate
+		// Resources past the field's range share IDs, which only costs some grouping
+		uint64_t getId(std::unordered_map<const void*, uint64_t>& ids, const void* resource, int bits);
+		uint64_t getDepth(const RenderObject& object) const;
+		static StateChange getChange(Pass pass, const RenderObject& object, bool first,
+			const Rendering::Shader*& shader, const Rendering::Texture*& texture, const Rendering::Mesh*& mesh, uint32_t& lod);
+
+		std::vector<Item> items;
+		std::vector<Item> scratch;
+		// Start of each pass in items after sorting, with one past the end
+		size_t passStarts[(size_t)Pass::Count + 1] = {};
+
+		std::unordered_map<const void*, uint64_t> shaderIds;
+		std::unordered_map<const void*, uint64_t> textureIds;
+		std::unordered_map<const void*, uint64_t> meshIds;
+
+		Maths::Vector3 viewPosition;
+		float maxDepth = 1.0f;
+	};
+}
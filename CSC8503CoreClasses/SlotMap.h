@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace NCL::CSC8503 {
+	// Values stored densely for iteration, looked up in O(1) by handle
+	// Handles stay valid until their value is erased, after which they're
+	// rejected by a generation check rather than finding whatever reused the slot
+	// Erasing moves the last value into the gap, so iteration order isn't preserved
+	// A slot is retired rather than reused once its generation runs out, so a stale handle
+	// can never match a later value. Retired slots still count towards MaxSize
+	template <typename T>
+	class SlotMap {
+	public:
+		// Index and generation packed into 31 bits, so handles fit in a non-negative int
+		using Handle = uint32_t;
+		static const constexpr int IndexBits = 20;
+		static const constexpr int GenerationBits = 11;
+		static const constexpr uint32_t IndexMask = (1u << IndexBits) - 1;
+		static const constexpr uint32_t GenerationMask = (1u << GenerationBits) - 1;
+		static const constexpr size_t MaxSize = IndexMask;
+		static const constexpr Handle InvalidHandle = ~0u;
+
+		using Iterator = typename std::vector<T>::const_iterator;
+
+		Handle insert(T value) {
+			uint32_t index;
+			if (freeHead != InvalidIndex) {
+				index = freeHead;
+				freeHead = slots[index].dense;
+			} else {
+				if (slots.size() >= MaxSize) {
+					return InvalidHandle;
+				}
+				index = (uint32_t)slots.size();
+				slots.push_back({ 0, 0 });
+			}
+			slots[index].dense = (uint32_t)values.size();
+			values.push_back(std::move(value));
+			denseToSlot.push_back(index);
+			return makeHandle(index, slots[index].generation);
+		}
+
+		// Returns false if the handle was stale
+		bool erase(Handle handle) {
+			if (!contains(handle)) {
+				return false;
+			}
+			uint32_t index = handle & IndexMask;
+			uint32_t dense = slots[index].dense;
+
+			// Fill the gap with the last value
+			uint32_t last = (uint32_t)values.size() - 1;
+			if (dense != last) {
+				values[dense] = std::move(values[last]);
+				denseToSlot[dense] = denseToSlot[last];
+				slots[denseToSlot[dense]].dense = dense;
+			}
+			values.pop_back();
+			denseToSlot.pop_back();
+
+			release(index);
+			return true;
+		}
+
+		bool contains(Handle handle) const {
+			uint32_t index = handle & IndexMask;
+			return index < slots.size()
+				&& slots[index].generation == (handle >> IndexBits)
+				&& slots[index].dense < values.size()
+				&& denseToSlot[slots[index].dense] == index;
+		}
+
+		// nullptr if the handle is stale
+		T* get(Handle handle) {
+			return contains(handle) ? &values[slots[handle & IndexMask].dense] : nullptr;
+		}
+		const T* get(Handle handle) const {
+			return contains(handle) ? &values[slots[handle & IndexMask].dense] : nullptr;
+		}
+
+		// Handle for the value at a dense position, for use while iterating
+		Handle handleAt(size_t dense) const {
+			uint32_t index = denseToSlot[dense];
+			return makeHandle(index, slots[index].generation);
+		}
+
+		// Reorder the dense values, handles are unaffected
+		template <typename Rng>
+		void shuffle(Rng& rng) {
+			for (size_t i = values.size(); i > 1; i--) {
+				size_t j = std::uniform_int_distribution<size_t>(0, i - 1)(rng);
+				std::swap(values[i - 1], values[j]);
+				std::swap(denseToSlot[i - 1], denseToSlot[j]);
+				slots[denseToSlot[i - 1]].dense = (uint32_t)(i - 1);
+				slots[denseToSlot[j]].dense = (uint32_t)j;
+			}
+		}
+
+		// Invalidates every handle, including ones from before the clear,
+		// as slots are kept and their generations bumped
+		void clear() {
+			for (uint32_t index : denseToSlot) {
+				release(index);
+			}
+			values.clear();
+			denseToSlot.clear();
+		}
+
+		size_t size() const {
+			return values.size();
+		}
+		bool empty() const {
+			return values.empty();
+		}
+
+		const std::vector<T>& dense() const {
+			return values;
+		}
+		Iterator begin() const {
+			return values.begin();
+		}
+		Iterator end() const {
+			return values.end();
+		}
+	private:
+		static const constexpr uint32_t InvalidIndex = ~0u;
+
+		static Handle makeHandle(uint32_t index, uint32_t generation) {
+			return (generation << IndexBits) | index;
+		}
+
+		// Invalidate a slot's handles, and free it for reuse if it has generations left
+		void release(uint32_t index) {
+			if (slots[index].generation == GenerationMask) {
+				// Wrapping would make handles from its first use valid again
+				slots[index].dense = InvalidIndex;
+				return;
+			}
+			slots[index].generation++;
+			slots[index].dense = freeHead;
+			freeHead = index;
+		}
+
+		struct Slot {
+			// Position in values while in use, next free slot otherwise
+			uint32_t dense;
+			uint32_t generation;
+		};
+
+		std::vector<T> values;
+		std::vector<uint32_t> denseToSlot;
+		std::vector<Slot> slots;
+		uint32_t freeHead = InvalidIndex;
+	};
+}
@@ -0,0 +1,61 @@
+#include "SnapshotHistory.h"
+
+#include <algorithm>
+
+#include "NetworkState.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+static_assert((SnapshotHistory::MaxStates & (SnapshotHistory::MaxStates - 1)) == 0, "MaxStates must be a power of two");
+
+int SnapshotHistory::addObject() {
+	if (!freeSlots.empty()) {
+		int slot = freeSlots.back();
+		freeSlots.pop_back();
+		return slot;
+	}
+	int slot = (int)(entries.size() / MaxStates);
+	entries.resize(entries.size() + MaxStates);
+	return slot;
+}
+
+void SnapshotHistory::removeObject(int slot) {
+	if (!isValid(slot)) {
+		return;
+	}
+	auto start = entries.begin() + (size_t)slot * MaxStates;
+	std::fill(start, start + MaxStates, Entry());
+	freeSlots.push_back(slot);
+}
+
+void SnapshotHistory::record(int slot, const NetworkState& state) {
+	if (!isValid(slot) || state.stateID < 0) {
+		return;
+	}
+	Entry& entry = entries[(size_t)slot * MaxStates + (state.stateID & (MaxStates - 1))];
+	entry.stateID = state.stateID;
+	entry.position = state.position;
+	entry.orientation = state.orientation;
+}
+
+bool SnapshotHistory::get(int slot, int stateID, NetworkState& state) const {
+	if (!isValid(slot) || stateID < minStateID || stateID < 0) {
+		return false;
+	}
+	const Entry& entry = entries[(size_t)slot * MaxStates + (stateID & (MaxStates - 1))];
+	// The slot in the ring has been reused by a newer state
+	if (entry.stateID != stateID) {
+		return false;
+	}
+	state.stateID = entry.stateID;
+	state.position = entry.position;
+	state.orientation = entry.orientation;
+	return true;
+}
+
+void SnapshotHistory::clear() {
+	entries.clear();
+	freeSlots.clear();
+	minStateID = 0;
+}
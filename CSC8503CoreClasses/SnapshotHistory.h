@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+namespace NCL::CSC8503 {
+	using namespace Maths;
+	class NetworkState;
+
+	// The full states recently sent for every networked object, so deltas
+	// can be written against them
+	// Shared by the whole network world rather than kept per object, so it's
+	// one allocation that never shifts, and expiring old states is a single compare
+	class SnapshotHistory {
+	public:
+		// Deltas can be written against any of the last MaxStates full states
+		// an object sent, anything older needs a new full state
+		// Must be a power of two
+		static const constexpr int MaxStates = 32;
+
+		// Reserve space for an object's states, returns the slot to use for it
+		// Slots from removed objects are reused
+		int addObject();
+		// Forget an object's states and free its slot
+		void removeObject(int slot);
+
+		void record(int slot, const NetworkState& state);
+
+		// False if the state was never recorded, has been overwritten, or has expired
+		bool get(int slot, int stateID, NetworkState& state) const;
+
+		// Every state older than minID is expired. Nothing is moved or freed
+		void expire(int minID) {
+			minStateID = minID;
+		}
+
+		void clear();
+
+		size_t objectCount() const {
+			return entries.size() / MaxStates - freeSlots.size();
+		}
+	private:
+		// Slots handed out before a clear are no longer valid
+		bool isValid(int slot) const {
+			return slot >= 0 && (size_t)(slot + 1) * MaxStates <= entries.size();
+		}
+
+		struct Entry {
+			int stateID = -1;
+			Vector3 position;
+			Quaternion orientation;
+		};
+
+		// MaxStates entries per slot, indexed by stateID % MaxStates, so an
+		// object's states are contiguous
+		std::vector<Entry> entries;
+		std::vector<int> freeSlots;
+		int minStateID = 0;
+	};
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+namespace NCL::CSC8503 {
+	// Vertices written straight into place, ready to copy to the GPU as one block
+	// Storage only grows, so once it has seen a frame's worth of vertices
+	// later frames fill the same memory without allocating
+	template <typename T>
+	class VertexArena {
+	public:
+		VertexArena(size_t capacity = 0) {
+			storage.resize(capacity);
+		}
+
+		// Space for count more vertices, to be written before the next allocate
+		std::span<T> allocate(size_t count) {
+			if (used + count > storage.size()) {
+				storage.resize(std::max(storage.size() * 2, used + count));
+			}
+			std::span<T> space(storage.data() + used, count);
+			used += count;
+			return space;
+		}
+
+		void clear() {
+			used = 0;
+		}
+		// Drops everything after the first count vertices
+		void truncate(size_t count) {
+			used = std::min(used, count);
+		}
+
+		std::span<T> getVertices() {
+			return std::span<T>(storage.data(), used);
+		}
+		std::span<const T> getVertices() const {
+			return std::span<const T>(storage.data(), used);
+		}
+		size_t capacity() const {
+			return storage.size();
+		}
+	private:
+		std::vector<T> storage;
+		size_t used = 0;
+	};
+}
@@ -0,0 +1,103 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+using namespace NCL::CSC8503;
+
+namespace {
+	// Set while a thread is running chunks, so nested parallelFors run inline rather than deadlock
+	thread_local bool inParallelFor = false;
+}
+
+WorkerPool::WorkerPool(size_t threadCount) {
+	for (size_t i = 0; i < threadCount; i++) {
+		threads.emplace_back([this]() { workerLoop(); });
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+size_t WorkerPool::DefaultThreadCount() {
+	unsigned int cores = std::thread::hardware_concurrency();
+	return cores > 1 ? cores - 1 : 0;
+}
+
+WorkerPool& WorkerPool::Get() {
+	static WorkerPool pool;
+	return pool;
+}
+
+void WorkerPool::parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& func) {
+	chunkSize = std::max<size_t>(chunkSize, 1);
+	size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+	if (chunkCount <= 1 || threads.empty() || inParallelFor) {
+		for (size_t begin = 0; begin < count; begin += chunkSize) {
+			func(begin, std::min(begin + chunkSize, count));
+		}
+		return;
+	}
+
+	std::lock_guard callerLock(callerMutex);
+	Job job;
+	job.func = &func;
+	job.count = count;
+	job.chunkSize = chunkSize;
+	job.chunkCount = chunkCount;
+	job.chunksLeft = chunkCount;
+	{
+		std::lock_guard lock(mutex);
+		current = &job;
+		generation++;
+	}
+	wake.notify_all();
+
+	runChunks(job);
+
+	std::unique_lock lock(mutex);
+	finished.wait(lock, [&]() { return job.chunksLeft == 0 && job.workers == 0; });
+	current = nullptr;
+}
+
+void WorkerPool::runChunks(Job& job) {
+	inParallelFor = true;
+	for (size_t chunk = job.nextChunk++; chunk < job.chunkCount; chunk = job.nextChunk++) {
+		size_t begin = chunk * job.chunkSize;
+		(*job.func)(begin, std::min(begin + job.chunkSize, job.count));
+		job.chunksLeft--;
+	}
+	inParallelFor = false;
+}
+
+void WorkerPool::workerLoop() {
+	uint64_t seen = 0;
+	std::unique_lock lock(mutex);
+	while (true) {
+		wake.wait(lock, [&]() { return stopping || generation != seen; });
+		if (stopping) {
+			return;
+		}
+		seen = generation;
+		// The job may have finished before this thread woke
+		Job* job = current;
+		if (!job) {
+			continue;
+		}
+		job->workers++;
+		lock.unlock();
+
+		runChunks(*job);
+
+		lock.lock();
+		job->workers--;
+		finished.notify_all();
+	}
+}
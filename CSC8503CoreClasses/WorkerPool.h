@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NCL::CSC8503 {
+	// A fixed set of threads for splitting a loop into chunks
+	// The calling thread works through chunks too, so nothing sits idle waiting
+	// Work is expected to be short, a few milliseconds at most, as the caller blocks until it's done
+	class WorkerPool {
+	public:
+		// Defaults to a thread per core, less one for the caller
+		explicit WorkerPool(size_t threadCount = DefaultThreadCount());
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		// Calls func(begin, end) over [0, count) in chunks of at most chunkSize,
+		// returning once every chunk is done. Chunks run in any order, on any thread
+		// Runs inline if there's only one chunk, or if called from inside another parallelFor
+		void parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& func);
+
+		size_t getThreadCount() const {
+			return threads.size();
+		}
+
+		static size_t DefaultThreadCount();
+		// Shared by anything that doesn't need its own, created on first use
+		static WorkerPool& Get();
+	private:
+		struct Job {
+			const std::function<void(size_t, size_t)>* func;
+			size_t count;
+			size_t chunkSize;
+			size_t chunkCount;
+			std::atomic<size_t> nextChunk = 0;
+			std::atomic<size_t> chunksLeft;
+			// Workers that have picked the job up, the job can't end while they might touch it
+			int workers = 0;
+		};
+
+		void workerLoop();
+		void runChunks(Job& job);
+
+		std::vector<std::thread> threads;
+		// One job at a time
+		std::mutex callerMutex;
+
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable finished;
+		Job* current = nullptr;
+		// Bumped for each job, so workers know there's something new
+		uint64_t generation = 0;
+		bool stopping = false;
+	};
+}
@@ -0,0 +1,54 @@
+#include "WorldHistory.h"
+
+#include <algorithm>
+
+#include "GameObject.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+void WorldHistory::record(int tick, const std::vector<GameObject*>& objects) {
+	Frame& frame = frames[tick % MaxFrames];
+	frame.tick = tick;
+	frame.objects.clear();
+	frame.positions.clear();
+	frame.halfSizes.clear();
+	frame.orientations.clear();
+
+	for (GameObject* object : objects) {
+		Vector3 halfSizes;
+		// Nothing to hit without a volume
+		if (!object->GetBroadphaseAABB(halfSizes)) {
+			continue;
+		}
+		frame.objects.push_back(object);
+		frame.positions.push_back(object->GetTransform().GetPosition());
+		frame.halfSizes.push_back(halfSizes);
+		frame.orientations.push_back(object->GetTransform().GetOrientation());
+	}
+}
+
+const WorldHistory::Frame* WorldHistory::getFrame(int tick) const {
+	if (tick < 0) {
+		return nullptr;
+	}
+	const Frame& frame = frames[tick % MaxFrames];
+	return frame.tick == tick ? &frame : nullptr;
+}
+
+void WorldHistory::removeObject(GameObject* object) {
+	for (Frame& frame : frames) {
+		// Null rather than erase, keeps the arrays in step
+		std::replace(frame.objects.begin(), frame.objects.end(), object, (GameObject*)nullptr);
+	}
+}
+
+void WorldHistory::clear() {
+	for (Frame& frame : frames) {
+		frame.tick = -1;
+		frame.objects.clear();
+		frame.positions.clear();
+		frame.halfSizes.clear();
+		frame.orientations.clear();
+	}
+}
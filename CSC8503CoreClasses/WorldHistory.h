@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+namespace NCL::CSC8503 {
+	using namespace Maths;
+	class GameObject;
+
+	// Short history of where every collidable object was on recent ticks
+	// Used for lag compensation, so the server can test rays against what
+	// a client actually saw rather than where things are now
+	class WorldHistory {
+	public:
+		// ~0.5 seconds at the default tick rate. Anyone with a worse ping
+		// than that gets the current world instead
+		static const constexpr int MaxFrames = 32;
+
+		// Stored structure-of-arrays, so the broadphase pass over a frame
+		// only touches the bounds
+		struct Frame {
+			int tick = -1;
+			std::vector<GameObject*> objects;
+			std::vector<Vector3> positions;
+			std::vector<Vector3> halfSizes;
+			std::vector<Quaternion> orientations;
+
+			size_t size() const {
+				return objects.size();
+			}
+		};
+
+		void record(int tick, const std::vector<GameObject*>& objects);
+
+		// nullptr if the tick is too old, or hasn't happened yet
+		const Frame* getFrame(int tick) const;
+
+		// Forget an object, it must not be rewound once deleted
+		void removeObject(GameObject* object);
+
+		void clear();
+	private:
+		// Indexed by tick % MaxFrames. Vectors are reused between ticks to avoid
+		// allocating once the world has settled
+		std::array<Frame, MaxFrames> frames;
+	};
+}
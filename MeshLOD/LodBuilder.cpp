@@ -0,0 +1,88 @@
+#include "LodBuilder.h"
+#include "MeshSimplifier.h"
+#include "MshLoader.h"
+
+#include <algorithm>
+
+using namespace NCL;
+using namespace Rendering;
+using namespace Maths;
+
+size_t LodBuilder::Build(Mesh& mesh, const LodSettings& settings) {
+	const std::vector<Vector3>& positions = mesh.GetPositionData();
+	if (mesh.GetPrimitiveType() != GeometryPrimitive::Triangles || positions.empty()) {
+		return 0;
+	}
+	size_t triangles = mesh.GetPrimitiveCount();
+
+	std::vector<size_t> targets;
+	size_t target = triangles;
+	while (targets.size() < settings.maxLevels) {
+		target = (size_t)(target * settings.reduction);
+		if (target < settings.minTriangles) {
+			break;
+		}
+		targets.push_back(target);
+	}
+	if (targets.empty()) {
+		return 0;
+	}
+
+	Vector3 centre;
+	for (const Vector3& p : positions) {
+		centre += p;
+	}
+	centre = centre / (float)positions.size();
+	float radius = 0.0f;
+	for (const Vector3& p : positions) {
+		radius = std::max(radius, Vector::Length(p - centre));
+	}
+
+	float maxError = settings.maxError * radius;
+	std::vector<MeshSimplifier::Level> levels = MeshSimplifier::Simplify(mesh, targets, maxError);
+
+	std::vector<unsigned int> indices = mesh.GetIndexData();
+	if (indices.empty()) {
+		for (unsigned int i = 0; i < mesh.GetVertexCount(); ++i) {
+			indices.push_back(i);
+		}
+	}
+	// Without submeshes the whole index buffer is drawn, which would now include the levels
+	if (mesh.GetSubMeshCount() == 0) {
+		mesh.AddSubMesh(0, (int)indices.size(), 0);
+	}
+
+	std::vector<MeshLod> lods;
+	size_t previous = triangles;
+	for (const MeshSimplifier::Level& level : levels) {
+		// Simplify stops on its collapses' estimated errors, which can be under the level's measured one
+		if (level.error > maxError) {
+			break;
+		}
+		size_t count = level.indices.size() / 3;
+		if (count > previous * settings.minReduction) {
+			continue;
+		}
+		previous = count;
+
+		MeshLod lod;
+		lod.error = level.error;
+		for (const SubMesh& sm : level.subMeshes) {
+			lod.subMeshes.push_back({ sm.start + (int)indices.size(), sm.count, 0 });
+		}
+		indices.insert(indices.end(), level.indices.begin(), level.indices.end());
+		lods.push_back(lod);
+	}
+	mesh.SetVertexIndices(indices);
+	mesh.SetLods(lods);
+	return lods.size();
+}
+
+void NCL::Rendering::LoadMeshWithLods(const std::string& name, Mesh& mesh, const LodSettings& settings) {
+	MshLoader::LoadMesh(name, mesh, LodBuilder::Version);
+	mesh.SetPrimitiveType(GeometryPrimitive::Triangles);
+	// Meshes converted by msh2bin come with their LODs
+	if (mesh.GetLods().empty()) {
+		LodBuilder::Build(mesh, settings);
+	}
+}
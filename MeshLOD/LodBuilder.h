@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+
+#include "Mesh.h"
+
+namespace NCL::Rendering {
+	// How LodBuilder picks levels
+	struct LodSettings {
+		// Each level aims for this fraction of the previous level's triangles
+		float	reduction		= 0.5f;
+		// Most levels to add beyond the full mesh
+		size_t	maxLevels		= 3;
+		// Levels that can't get below this fraction of the previous level aren't worth drawing
+		float	minReduction	= 0.8f;
+		// Furthest a level may stray from the full mesh, as a fraction of the mesh's radius
+		float	maxError		= 0.1f;
+		// Don't simplify below this many triangles
+		size_t	minTriangles	= 32;
+	};
+
+	// Gives a mesh a chain of simplified levels, sharing its vertices
+	// Must run before the mesh is uploaded, as it grows the index buffer
+	class LodBuilder	{
+	public:
+		// Bump whenever Build's output changes, so levels cached by an older one are rebuilt
+		static const constexpr uint32_t Version = 2;
+
+		// Appends each level's indices to mesh and records them as its LODs
+		// Returns how many levels were added
+		static size_t Build(Mesh& mesh, const LodSettings& settings = {});
+	};
+
+	// Reads a mesh file as triangles, building its LODs if the file doesn't have them
+	// Doesn't touch the GPU, so it's safe to call from any thread
+	void LoadMeshWithLods(const std::string& name, Mesh& mesh, const LodSettings& settings = {});
+}
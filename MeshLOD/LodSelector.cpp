@@ -0,0 +1,87 @@
+#include "LodSelector.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace NCL;
+using namespace Rendering;
+
+namespace {
+	// Stops objects at the camera dividing by zero
+	const float MinDistance = 0.01f;
+}
+
+LodSelector::LodSelector(float pixelTolerance, float hysteresis) : pixelTolerance(pixelTolerance), hysteresis(hysteresis) {
+}
+
+void LodSelector::BeginFrame(float screenHeight, float fieldOfView, float dt) {
+	const float DegreesToRadians = 3.14159265f / 180.0f;
+	pixelScale	= screenHeight / (2.0f * std::tan(fieldOfView * 0.5f * DegreesToRadians));
+	frameTime	= dt;
+	frame++;
+
+	std::fill(levelCounts.begin(), levelCounts.end(), 0);
+	animatedCount		= 0;
+	triangleCount		= 0;
+	fullTriangleCount	= 0;
+}
+
+uint32_t LodSelector::Select(const Mesh& mesh, float distance, float scale, LodState& state) {
+	if (state.frame == frame) {
+		return state.level;
+	}
+	if (state.frame == 0) {
+		state.phase = nextPhase++;
+	}
+	state.frame = frame;
+
+	uint32_t count	= (uint32_t)mesh.GetLodCount();
+	uint32_t level	= std::min(state.level, count - 1);
+	float pixels	= pixelScale * scale / std::max(distance, MinDistance);
+
+	// Finer while the current level is visibly off, then coarser while the next is comfortably not
+	while (level > 0 && mesh.GetLodError(level) * pixels > pixelTolerance) {
+		level--;
+	}
+	while (level + 1 < count && mesh.GetLodError(level + 1) * pixels <= pixelTolerance * (1.0f - hysteresis)) {
+		level++;
+	}
+	state.level = level;
+
+	state.bankedTime += frameTime;
+	if ((frame + state.phase) % AnimationInterval(level) == 0) {
+		state.animationDelta	= state.bankedTime;
+		state.bankedTime		= 0.0f;
+		animatedCount++;
+	}
+	else {
+		state.animationDelta = 0.0f;
+	}
+
+	if (levelCounts.size() < count) {
+		levelCounts.resize(count, 0);
+	}
+	levelCounts[level]++;
+	triangleCount		+= TriangleCount(mesh, level);
+	fullTriangleCount	+= TriangleCount(mesh, 0);
+	return level;
+}
+
+size_t LodSelector::TriangleCount(const Mesh& mesh, uint32_t level) {
+	// The levels' indices are after the full mesh's, so it can't just count the index buffer
+	if (level == 0 && mesh.GetSubMeshCount() == 0) {
+		return mesh.GetPrimitiveCount();
+	}
+	size_t indices = 0;
+	if (level == 0) {
+		for (unsigned int i = 0; i < mesh.GetSubMeshCount(); ++i) {
+			indices += mesh.GetSubMesh(i)->count;
+		}
+	}
+	else {
+		for (const SubMesh& sm : mesh.GetLods()[level - 1].subMeshes) {
+			indices += sm.count;
+		}
+	}
+	return indices / 3;
+}
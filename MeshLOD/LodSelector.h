@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Mesh.h"
+
+namespace NCL::Rendering {
+	// What a LodSelector remembers about one drawn object between frames
+	struct LodState {
+		uint32_t	level			= 0;
+		// How far to advance the object's animation this frame, 0 on frames it skips
+		float		animationDelta	= 0.0f;
+		// Time skipped since the object last animated, all released when it next does
+		float		bankedTime		= 0.0f;
+		// Spreads objects that skip frames evenly across them
+		uint32_t	phase			= 0;
+		// Last frame the object was selected in, 0 if never
+		uint64_t	frame			= 0;
+	};
+
+	// Picks which of a mesh's LODs to draw, from how big its error would look on screen
+	// The coarsest level that moves the surface less than pixelTolerance is used.
+	// Levels only get coarser once they are well inside the tolerance, so objects
+	// near a switching distance don't flicker between levels.
+	// Distant objects also animate less often, every 2^level frames
+	class LodSelector	{
+	public:
+		LodSelector(float pixelTolerance = 1.0f, float hysteresis = 0.25f);
+
+		// fieldOfView is vertical, in degrees. dt is this frame's time step
+		void BeginFrame(float screenHeight, float fieldOfView, float dt);
+
+		// distance is from the camera, scale the object's largest scale axis
+		// Selecting the same state again in one frame returns the same level
+		uint32_t Select(const Mesh& mesh, float distance, float scale, LodState& state);
+
+		static uint32_t AnimationInterval(uint32_t level) {
+			return 1u << level;
+		}
+		// Triangles drawn for every submesh of mesh at level
+		static size_t TriangleCount(const Mesh& mesh, uint32_t level);
+
+		void SetPixelTolerance(float tolerance) {
+			pixelTolerance = tolerance;
+		}
+		float GetPixelTolerance() const {
+			return pixelTolerance;
+		}
+
+		// Objects selected at each level this frame
+		const std::vector<size_t>& GetLevelCounts() const {
+			return levelCounts;
+		}
+		// Objects whose animation advances this frame
+		size_t GetAnimatedCount() const {
+			return animatedCount;
+		}
+		// Triangles drawn by this frame's selections, and what they'd be at full detail
+		size_t GetTriangleCount() const {
+			return triangleCount;
+		}
+		size_t GetFullTriangleCount() const {
+			return fullTriangleCount;
+		}
+
+	protected:
+		float pixelTolerance;
+		float hysteresis;
+
+		// Screen pixels covered by one unit at a distance of one unit
+		float		pixelScale	= 1.0f;
+		float		frameTime	= 0.0f;
+		uint64_t	frame		= 0;
+		uint32_t	nextPhase	= 0;
+
+		std::vector<size_t>	levelCounts;
+		size_t				animatedCount		= 0;
+		size_t				triangleCount		= 0;
+		size_t				fullTriangleCount	= 0;
+	};
+}
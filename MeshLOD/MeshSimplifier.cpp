@@ -0,0 +1,590 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+using namespace NCL;
+using namespace Rendering;
+using namespace Maths;
+
+namespace {
+	// Cosine of the most a triangle's normal may turn in one collapse, past this it's close to folding over
+	const float MaxNormalTurn = 0.2f;
+	// Seam and border edges get a plane at right angles to them, so sliding off them costs as much as
+	// rising out of the surface. Weighted up, as they only have one or two edges each to hold them
+	const double ConstraintWeight = 4.0;
+
+	struct Quadric {
+		double a2 = 0, ab = 0, ac = 0, ad = 0;
+		double b2 = 0, bc = 0, bd = 0;
+		double c2 = 0, cd = 0;
+		double d2 = 0;
+		// Area of the surface planes summed in, so errors come out as distances
+		double area = 0;
+
+		void AddPlane(const Vector3& n, const Vector3& point, double weight) {
+			double a = n.x, b = n.y, c = n.z;
+			double d = -(a * point.x + b * point.y + c * point.z);
+			a2 += weight * a * a; ab += weight * a * b; ac += weight * a * c; ad += weight * a * d;
+			b2 += weight * b * b; bc += weight * b * c; bd += weight * b * d;
+			c2 += weight * c * c; cd += weight * c * d;
+			d2 += weight * d * d;
+		}
+
+		Quadric& operator+=(const Quadric& q) {
+			a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+			b2 += q.b2; bc += q.bc; bd += q.bd;
+			c2 += q.c2; cd += q.cd;
+			d2 += q.d2;
+			area += q.area;
+			return *this;
+		}
+
+		double Evaluate(const Vector3& p) const {
+			double x = p.x, y = p.y, z = p.z;
+			return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+				+ b2 * y * y + 2 * bc * y * z + 2 * bd * y
+				+ c2 * z * z + 2 * cd * z
+				+ d2;
+		}
+	};
+
+	struct Triangle {
+		// Original vertex indices
+		uint32_t corners[3];
+		uint32_t subMesh;
+		bool removed;
+	};
+
+	// Moves every vertex at position from onto position to
+	struct Collapse {
+		float		error;
+		uint32_t	from;
+		uint32_t	to;
+		uint32_t	fromVersion;
+		uint32_t	toVersion;
+
+		bool operator>(const Collapse& c) const {
+			return error > c.error;
+		}
+	};
+
+	struct PositionHash {
+		size_t operator()(const Vector3& p) const {
+			uint32_t bits[3];
+			memcpy(bits, &p, sizeof(bits));
+			return (size_t)bits[0] * 73856093u ^ (size_t)bits[1] * 19349663u ^ (size_t)bits[2] * 83492791u;
+		}
+	};
+	struct PositionEqual {
+		bool operator()(const Vector3& a, const Vector3& b) const {
+			return memcmp(&a, &b, sizeof(Vector3)) == 0;
+		}
+	};
+
+	Vector3 TriangleNormal(const Vector3& a, const Vector3& b, const Vector3& c) {
+		return Vector::Cross(b - a, c - a);
+	}
+
+	Vector3 ClosestPointOnTriangle(const Vector3& p, const Vector3& a, const Vector3& b, const Vector3& c) {
+		Vector3 ab = b - a;
+		Vector3 ac = c - a;
+		Vector3 ap = p - a;
+		float d1 = Vector::Dot(ab, ap);
+		float d2 = Vector::Dot(ac, ap);
+		if (d1 <= 0.0f && d2 <= 0.0f) {
+			return a;
+		}
+		Vector3 bp = p - b;
+		float d3 = Vector::Dot(ab, bp);
+		float d4 = Vector::Dot(ac, bp);
+		if (d3 >= 0.0f && d4 <= d3) {
+			return b;
+		}
+		float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+			return a + ab * (d1 / (d1 - d3));
+		}
+		Vector3 cp = p - c;
+		float d5 = Vector::Dot(ab, cp);
+		float d6 = Vector::Dot(ac, cp);
+		if (d6 >= 0.0f && d5 <= d6) {
+			return c;
+		}
+		float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+			return a + ac * (d2 / (d2 - d6));
+		}
+		float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+			return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+		}
+		float denom = 1.0f / (va + vb + vc);
+		return a + ab * (vb * denom) + ac * (vc * denom);
+	}
+
+	class Collapser {
+	public:
+		Collapser(const Mesh& mesh) : positions(mesh.GetPositionData()) {
+			WeldPositions();
+			BuildTriangles(mesh);
+			BuildQuadrics();
+		}
+
+		std::vector<MeshSimplifier::Level> Run(std::span<const size_t> targets, float maxError) {
+			std::vector<MeshSimplifier::Level> levels;
+			size_t nextTarget	= 0;
+			bool   changed		= false;
+			while (nextTarget < targets.size() && !queue.empty()) {
+				Collapse c = queue.top();
+				queue.pop();
+				if (c.error > maxError) {
+					break;
+				}
+				if (removed[c.from] || removed[c.to] || version[c.from] != c.fromVersion || version[c.to] != c.toVersion) {
+					continue;
+				}
+				if (!TryCollapse(c.from, c.to)) {
+					continue;
+				}
+				changed = true;
+				while (nextTarget < targets.size() && liveTriangles <= targets[nextTarget]) {
+					levels.push_back(TakeLevel(levels.empty() ? 0.0f : levels.back().error));
+					nextTarget++;
+					changed = false;
+				}
+			}
+			// Ran out of collapses, what got done is still worth a level
+			if (nextTarget < targets.size() && changed) {
+				levels.push_back(TakeLevel(levels.empty() ? 0.0f : levels.back().error));
+			}
+			return levels;
+		}
+
+	protected:
+		void WeldPositions() {
+			std::unordered_map<Vector3, uint32_t, PositionHash, PositionEqual> ids;
+			weldOf.resize(positions.size());
+			for (size_t v = 0; v < positions.size(); v++) {
+				auto [i, added] = ids.try_emplace(positions[v], (uint32_t)weldedPositions.size());
+				if (added) {
+					weldedPositions.push_back(positions[v]);
+				}
+				weldOf[v] = i->second;
+			}
+			trianglesOf.resize(weldedPositions.size());
+			quadrics.resize(weldedPositions.size());
+			removed.resize(weldedPositions.size(), false);
+			locked.resize(weldedPositions.size(), false);
+			version.resize(weldedPositions.size(), 0);
+			collapsedInto.resize(weldedPositions.size());
+			for (uint32_t w = 0; w < collapsedInto.size(); w++) {
+				collapsedInto[w] = w;
+			}
+		}
+
+		void BuildTriangles(const Mesh& mesh) {
+			const std::vector<unsigned int>& indices = mesh.GetIndexData();
+			auto index = [&](size_t i) {
+				return indices.empty() ? (uint32_t)i : indices[i];
+			};
+			size_t indexCount = indices.empty() ? mesh.GetVertexCount() : indices.size();
+
+			std::vector<SubMesh> subMeshes;
+			for (unsigned int s = 0; s < mesh.GetSubMeshCount(); s++) {
+				subMeshes.push_back(*mesh.GetSubMesh(s));
+			}
+			if (subMeshes.empty()) {
+				subMeshes.push_back({ 0, (int)indexCount, 0 });
+			}
+			subMeshCount = subMeshes.size();
+
+			for (size_t s = 0; s < subMeshes.size(); s++) {
+				const SubMesh& sm = subMeshes[s];
+				for (size_t i = sm.start; i + 2 < (size_t)(sm.start + sm.count) && i + 2 < indexCount; i += 3) {
+					Triangle t = { { index(i) + sm.base, index(i + 1) + sm.base, index(i + 2) + sm.base }, (uint32_t)s, false };
+					uint32_t a = weldOf[t.corners[0]];
+					uint32_t b = weldOf[t.corners[1]];
+					uint32_t c = weldOf[t.corners[2]];
+					// Nothing to draw, and would confuse which triangles share an edge
+					if (a == b || b == c || c == a) {
+						continue;
+					}
+					uint32_t id = (uint32_t)triangles.size();
+					triangles.push_back(t);
+					trianglesOf[a].push_back(id);
+					trianglesOf[b].push_back(id);
+					trianglesOf[c].push_back(id);
+				}
+			}
+			liveTriangles = triangles.size();
+		}
+
+		void BuildQuadrics() {
+			struct EdgeUse {
+				uint32_t triangle;
+				// Original vertices at each end, ordered as the key
+				uint32_t first;
+				uint32_t second;
+			};
+			std::unordered_map<uint64_t, std::vector<EdgeUse>> edges;
+
+			for (uint32_t t = 0; t < triangles.size(); t++) {
+				const Triangle& tri = triangles[t];
+				Vector3 p[3];
+				for (int i = 0; i < 3; i++) {
+					p[i] = weldedPositions[weldOf[tri.corners[i]]];
+				}
+				Vector3 normal = TriangleNormal(p[0], p[1], p[2]);
+				float length = Vector::Length(normal);
+				if (length > 0.0f) {
+					Quadric q;
+					q.area = length * 0.5;
+					q.AddPlane(normal / length, p[0], q.area);
+					for (int i = 0; i < 3; i++) {
+						quadrics[weldOf[tri.corners[i]]] += q;
+					}
+				}
+				for (int i = 0; i < 3; i++) {
+					uint32_t v0 = tri.corners[i];
+					uint32_t v1 = tri.corners[(i + 1) % 3];
+					uint32_t a	= weldOf[v0];
+					uint32_t b	= weldOf[v1];
+					if (a > b) {
+						std::swap(a, b);
+						std::swap(v0, v1);
+					}
+					edges[((uint64_t)a << 32) | b].push_back({ t, v0, v1 });
+				}
+			}
+
+			for (const auto& [key, uses] : edges) {
+				uint32_t a = (uint32_t)(key >> 32);
+				uint32_t b = (uint32_t)key;
+				if (uses.size() > 2) {
+					// Not a surface here, so any collapse could tear it
+					locked[a] = true;
+					locked[b] = true;
+					continue;
+				}
+				bool border = uses.size() == 1;
+				bool seam	= !border && (uses[0].first != uses[1].first || uses[0].second != uses[1].second);
+				if (border || seam) {
+					Vector3 pa = weldedPositions[a];
+					Vector3 pb = weldedPositions[b];
+					Vector3 edge = pb - pa;
+					for (const EdgeUse& use : uses) {
+						const Triangle& tri = triangles[use.triangle];
+						Vector3 normal = TriangleNormal(weldedPositions[weldOf[tri.corners[0]]], weldedPositions[weldOf[tri.corners[1]]], weldedPositions[weldOf[tri.corners[2]]]);
+						Vector3 side = Vector::Cross(edge, normal);
+						float length = Vector::Length(side);
+						if (length <= 0.0f) {
+							continue;
+						}
+						Quadric q;
+						q.AddPlane(side / length, pa, ConstraintWeight * Vector::Dot(edge, edge));
+						quadrics[a] += q;
+						quadrics[b] += q;
+					}
+				}
+				Push(a, b);
+				Push(b, a);
+			}
+		}
+
+		void Push(uint32_t from, uint32_t to) {
+			if (locked[from]) {
+				return;
+			}
+			Quadric q = quadrics[from];
+			q += quadrics[to];
+			double cost = std::max(q.Evaluate(weldedPositions[to]), 0.0);
+			float error = (float)std::sqrt(cost / std::max(q.area, 1e-12));
+			queue.push({ error, from, to, version[from], version[to] });
+		}
+
+		int CornerOf(const Triangle& t, uint32_t welded) const {
+			for (int i = 0; i < 3; i++) {
+				if (weldOf[t.corners[i]] == welded) {
+					return i;
+				}
+			}
+			return -1;
+		}
+
+		bool TryCollapse(uint32_t from, uint32_t to) {
+			edgeTriangles.clear();
+			otherTriangles.clear();
+			for (uint32_t t : trianglesOf[from]) {
+				if (triangles[t].removed) {
+					continue;
+				}
+				(CornerOf(triangles[t], to) >= 0 ? edgeTriangles : otherTriangles).push_back(t);
+			}
+			if (edgeTriangles.empty()) {
+				return false;
+			}
+
+			// Each of from's split vertices needs a partner across the edge to become, or the seam would tear
+			wedgeMap.clear();
+			for (uint32_t t : edgeTriangles) {
+				const Triangle& tri = triangles[t];
+				uint32_t fromVertex = tri.corners[CornerOf(tri, from)];
+				uint32_t toVertex	= tri.corners[CornerOf(tri, to)];
+				if (!FindWedge(fromVertex)) {
+					wedgeMap.push_back({ fromVertex, toVertex });
+				}
+			}
+			for (uint32_t t : otherTriangles) {
+				const Triangle& tri = triangles[t];
+				if (!FindWedge(tri.corners[CornerOf(tri, from)])) {
+					return false;
+				}
+			}
+
+			// Only the vertices opposite the edge may be shared neighbours, any more and the surface pinches
+			neighbours.clear();
+			for (uint32_t t : trianglesOf[from]) {
+				AddNeighbours(t, from, to, 1);
+			}
+			for (uint32_t t : trianglesOf[to]) {
+				AddNeighbours(t, to, from, 2);
+			}
+			std::sort(neighbours.begin(), neighbours.end());
+			neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+			size_t shared = 0;
+			for (size_t i = 0; i + 1 < neighbours.size(); i++) {
+				shared += neighbours[i].first == neighbours[i + 1].first;
+			}
+			if (shared > edgeTriangles.size()) {
+				return false;
+			}
+
+			const Vector3& target = weldedPositions[to];
+			for (uint32_t t : otherTriangles) {
+				const Triangle& tri = triangles[t];
+				Vector3 before[3];
+				Vector3 after[3];
+				for (int i = 0; i < 3; i++) {
+					uint32_t w = weldOf[tri.corners[i]];
+					before[i]	= weldedPositions[w];
+					after[i]	= w == from ? target : before[i];
+				}
+				Vector3 oldNormal = TriangleNormal(before[0], before[1], before[2]);
+				Vector3 newNormal = TriangleNormal(after[0], after[1], after[2]);
+				float lengths = Vector::Length(oldNormal) * Vector::Length(newNormal);
+				if (lengths <= 0.0f || Vector::Dot(oldNormal, newNormal) < MaxNormalTurn * lengths) {
+					return false;
+				}
+			}
+
+			for (uint32_t t : edgeTriangles) {
+				triangles[t].removed = true;
+			}
+			liveTriangles -= edgeTriangles.size();
+			for (uint32_t t : otherTriangles) {
+				Triangle& tri = triangles[t];
+				uint32_t& corner = tri.corners[CornerOf(tri, from)];
+				corner = *FindWedge(corner);
+				trianglesOf[to].push_back(t);
+			}
+			trianglesOf[from].clear();
+			std::erase_if(trianglesOf[to], [&](uint32_t t) {
+				return triangles[t].removed;
+			});
+
+			quadrics[to] += quadrics[from];
+			removed[from]		= true;
+			collapsedInto[from]	= to;
+			version[to]++;
+
+			// Costs involving to have changed, so queue its edges again
+			neighbours.clear();
+			for (uint32_t t : trianglesOf[to]) {
+				AddNeighbours(t, to, to, 0);
+			}
+			std::sort(neighbours.begin(), neighbours.end());
+			neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+			for (const auto& [n, side] : neighbours) {
+				Push(n, to);
+				Push(to, n);
+			}
+			return true;
+		}
+
+		const uint32_t* FindWedge(uint32_t fromVertex) const {
+			for (const auto& [from, to] : wedgeMap) {
+				if (from == fromVertex) {
+					return &to;
+				}
+			}
+			return nullptr;
+		}
+
+		// Adds t's corners other than centre and skip, tagged with side
+		void AddNeighbours(uint32_t t, uint32_t centre, uint32_t skip, int side) {
+			const Triangle& tri = triangles[t];
+			if (tri.removed) {
+				return;
+			}
+			for (uint32_t corner : tri.corners) {
+				uint32_t w = weldOf[corner];
+				if (w != centre && w != skip) {
+					neighbours.push_back({ w, side });
+				}
+			}
+		}
+
+		// The live vertex that w has been collapsed into, w itself if it hasn't been
+		uint32_t Survivor(uint32_t w) {
+			uint32_t survivor = w;
+			while (collapsedInto[survivor] != survivor) {
+				survivor = collapsedInto[survivor];
+			}
+			// Shortened, so later levels needn't follow the whole chain again
+			while (collapsedInto[w] != survivor) {
+				w = std::exchange(collapsedInto[w], survivor);
+			}
+			return survivor;
+		}
+
+		float DistanceSquared(const Vector3& p, const Triangle& t) const {
+			Vector3 closest = ClosestPointOnTriangle(p, weldedPositions[weldOf[t.corners[0]]],
+				weldedPositions[weldOf[t.corners[1]]], weldedPositions[weldOf[t.corners[2]]]);
+			return Vector::LengthSquared(p - closest);
+		}
+
+		// Nearest the live triangles around vertex come to p, FLT_MAX if there are none
+		float FanDistanceSquared(const Vector3& p, uint32_t vertex) const {
+			float nearest = FLT_MAX;
+			for (uint32_t t : trianglesOf[vertex]) {
+				if (!triangles[t].removed) {
+					nearest = std::min(nearest, DistanceSquared(p, triangles[t]));
+				}
+			}
+			return nearest;
+		}
+
+		// Furthest any original position is from the surface as it is now, as MeasureError finds
+		// The quadric errors are averages over each vertex's planes, so they can be well under how
+		// far the surface has really moved, and LodSelector needs a real distance. The triangles
+		// around the vertex a position was collapsed into give an upper bound on its distance, then
+		// those around their corners a closer one. Only positions whose bounds beat the worst found
+		// so far are checked against every triangle, so the full search is done for few of them
+		float LevelError() {
+			std::vector<std::pair<float, uint32_t>> bounds;
+			for (uint32_t w = 0; w < weldedPositions.size(); w++) {
+				uint32_t survivor = Survivor(w);
+				// Still a corner of the surface, so it can't be any closer
+				if (survivor == w && FanDistanceSquared(weldedPositions[w], w) != FLT_MAX) {
+					continue;
+				}
+				bounds.push_back({ FanDistanceSquared(weldedPositions[w], survivor), w });
+			}
+			std::sort(bounds.begin(), bounds.end(), std::greater<>());
+
+			float worst = 0.0f;
+			for (const auto& [bound, w] : bounds) {
+				if (bound <= worst) {
+					break;
+				}
+				const Vector3& p = weldedPositions[w];
+				float nearest = bound;
+				for (uint32_t t : trianglesOf[Survivor(w)]) {
+					if (!triangles[t].removed) {
+						for (uint32_t corner : triangles[t].corners) {
+							nearest = std::min(nearest, FanDistanceSquared(p, weldOf[corner]));
+						}
+					}
+				}
+				if (nearest <= worst) {
+					continue;
+				}
+				// Can stop as soon as it's clear this position won't be the worst
+				for (size_t t = 0; t < triangles.size() && nearest > worst; t++) {
+					if (!triangles[t].removed) {
+						nearest = std::min(nearest, DistanceSquared(p, triangles[t]));
+					}
+				}
+				// Nothing left to measure against
+				if (nearest != FLT_MAX) {
+					worst = std::max(worst, nearest);
+				}
+			}
+			return std::sqrt(worst);
+		}
+
+		// Levels never claim to be closer than the one before, so a finer level is never chosen over a coarser one
+		MeshSimplifier::Level TakeLevel(float previousError) {
+			MeshSimplifier::Level level;
+			level.error = std::max(LevelError(), previousError);
+			level.indices.reserve(liveTriangles * 3);
+			// Triangles are stored in submesh order, so each submesh's survivors come out together
+			size_t t = 0;
+			for (uint32_t s = 0; s < subMeshCount; s++) {
+				SubMesh sm;
+				sm.start = (int)level.indices.size();
+				for (; t < triangles.size() && triangles[t].subMesh == s; t++) {
+					if (!triangles[t].removed) {
+						level.indices.insert(level.indices.end(), triangles[t].corners, triangles[t].corners + 3);
+					}
+				}
+				sm.count = (int)level.indices.size() - sm.start;
+				level.subMeshes.push_back(sm);
+			}
+			return level;
+		}
+
+		const std::vector<Vector3>&	positions;
+		std::vector<uint32_t>		weldOf;
+		std::vector<Vector3>		weldedPositions;
+
+		std::vector<Triangle>				triangles;
+		std::vector<std::vector<uint32_t>>	trianglesOf;
+		size_t								liveTriangles = 0;
+		size_t								subMeshCount = 0;
+
+		std::vector<Quadric>	quadrics;
+		std::vector<bool>		removed;
+		std::vector<bool>		locked;
+		std::vector<uint32_t>	version;
+		// Where each removed vertex went, followed to its survivor when measuring a level
+		std::vector<uint32_t>	collapsedInto;
+
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+
+		// Scratch space for TryCollapse
+		std::vector<uint32_t>							edgeTriangles;
+		std::vector<uint32_t>							otherTriangles;
+		std::vector<std::pair<uint32_t, uint32_t>>		wedgeMap;
+		std::vector<std::pair<uint32_t, int>>			neighbours;
+	};
+}
+
+std::vector<MeshSimplifier::Level> MeshSimplifier::Simplify(const Mesh& mesh, std::span<const size_t> targetTriangles, float maxError) {
+	if (mesh.GetPrimitiveType() != GeometryPrimitive::Triangles || mesh.GetVertexCount() == 0) {
+		return {};
+	}
+	Collapser collapser(mesh);
+	return collapser.Run(targetTriangles, maxError);
+}
+
+float MeshSimplifier::MeasureError(const Mesh& mesh, const Level& level) {
+	const std::vector<Vector3>& positions = mesh.GetPositionData();
+	float worst = 0.0f;
+	for (const Vector3& p : positions) {
+		float nearest = FLT_MAX;
+		for (size_t i = 0; i + 2 < level.indices.size(); i += 3) {
+			Vector3 closest = ClosestPointOnTriangle(p, positions[level.indices[i]], positions[level.indices[i + 1]], positions[level.indices[i + 2]]);
+			nearest = std::min(nearest, Vector::LengthSquared(p - closest));
+		}
+		worst = std::max(worst, nearest);
+	}
+	return std::sqrt(worst);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Mesh.h"
+
+namespace NCL::Rendering {
+	// Reduces a triangle mesh with quadric error metrics (Garland and Heckbert)
+	// Edges are collapsed by moving one end onto the other, so every level still
+	// indexes the mesh's original vertices and can share its vertex buffers.
+	// Vertices split for UV or normal seams are treated as one, and only collapse
+	// along the seam, so textures don't tear
+	class MeshSimplifier	{
+	public:
+		struct Level {
+			// Indices into the original vertices, with each submesh's triangles together
+			std::vector<unsigned int>	indices;
+			// One per original submesh, starting from the beginning of indices
+			std::vector<SubMesh>		subMeshes;
+			// No original vertex is further than this from the level's surface, in model space
+			float						error = 0.0f;
+		};
+
+		// Simplifies mesh once, taking a level as it passes each triangle count
+		// targetTriangles should be in decreasing order. Stops early if no collapse
+		// is left below maxError, so the last levels may have more triangles than asked for
+		static std::vector<Level> Simplify(const Mesh& mesh, std::span<const size_t> targetTriangles, float maxError);
+
+		// Furthest any of the original mesh's vertices lie from level's surface
+		// Brute force, so only for checking small meshes
+		static float MeasureError(const Mesh& mesh, const Level& level);
+	};
+}
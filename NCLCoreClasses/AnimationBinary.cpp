@@ -0,0 +1,97 @@
+#include "AnimationBinary.h"
+#include "BinaryFile.h"
+#include "MeshAnimation.h"
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace NCL;
+using namespace Rendering;
+
+namespace {
+	const BinaryFile::Format Format = {
+		{ 'N', 'C', 'L', 'A', 'N', 'I', 'M', '\0' }, AnimationBinary::Version, "binary animation", "convert it again with msh2bin"
+	};
+
+	struct Header {
+		char		magic[8];
+		uint32_t	version;
+		uint32_t	jointCount;
+		uint32_t	frameCount;
+		float		frameRate;
+		uint32_t	stride;
+		uint32_t	padding;
+	};
+	static_assert(sizeof(Header) == 32);
+
+	size_t RangesSize(size_t stride) {
+		return AnimationKeys::ComponentCount * stride * 2 * sizeof(float);
+	}
+
+	size_t KeysOffset(size_t stride) {
+		return BinaryFile::Align(sizeof(Header) + RangesSize(stride), AnimationBinary::KeyAlignment);
+	}
+
+	size_t KeysSize(size_t frameCount, size_t stride) {
+		return frameCount * AnimationKeys::ComponentCount * stride * sizeof(uint16_t);
+	}
+}
+
+void AnimationBinary::Save(const std::string& path, const MeshAnimation& animation) {
+	const AnimationKeys& keys = animation.GetKeys();
+	if (!keys.data) {
+		throw std::runtime_error("Animation for " + path + " has no keys to save");
+	}
+
+	Header header = BinaryFile::NewHeader<Header>(Format);
+	header.jointCount	= (uint32_t)animation.GetJointCount();
+	header.frameCount	= (uint32_t)animation.GetFrameCount();
+	header.frameRate	= animation.GetFrameRate();
+	header.stride		= (uint32_t)keys.stride;
+
+	size_t keysOffset	= KeysOffset(keys.stride);
+	size_t keysSize		= KeysSize(header.frameCount, keys.stride);
+	std::vector<char> file(keysOffset + keysSize, 0);
+	memcpy(file.data(), &header, sizeof(Header));
+	memcpy(file.data() + sizeof(Header), keys.ranges.data(), RangesSize(keys.stride));
+	memcpy(file.data() + keysOffset, keys.data, keysSize);
+	BinaryFile::Write(Format, path, file);
+}
+
+void AnimationBinary::Load(const std::string& path, MeshAnimation& animation) {
+	Header header;
+	MappedFile file = BinaryFile::Open(Format, path, header);
+	std::span<const char> bytes = file.GetBytes();
+	// Stride and frame count both come from the file, so they're checked against its size
+	// one at a time, as multiplying them out could wrap around to something small
+	if (header.stride < header.jointCount || header.stride % 4 != 0 || header.stride > bytes.size()
+		|| bytes.size() < KeysOffset(header.stride)) {
+		BinaryFile::Damaged(Format, path);
+	}
+	size_t frameSize = KeysSize(1, header.stride);
+	if (frameSize != 0 && header.frameCount > (bytes.size() - KeysOffset(header.stride)) / frameSize) {
+		BinaryFile::Damaged(Format, path);
+	}
+
+	AnimationKeys& keys = animation.keys;
+	keys.stride = header.stride;
+	keys.ranges.resize(AnimationKeys::ComponentCount * keys.stride * 2);
+	memcpy(keys.ranges.data(), bytes.data() + sizeof(Header), RangesSize(keys.stride));
+	// The keys stay in the file, which lives as long as the animation
+	keys.data = (const uint16_t*)(bytes.data() + KeysOffset(keys.stride));
+
+	animation.jointCount	= header.jointCount;
+	animation.frameCount	= header.frameCount;
+	animation.frameRate		= header.frameRate;
+	animation.allJoints.clear();
+	animation.ownedKeys.clear();
+	animation.keyFile		= std::move(file);
+}
+
+std::string AnimationBinary::PathFor(const std::string& anmPath) {
+	return BinaryFile::PathFor(anmPath, Extension);
+}
+
+bool AnimationBinary::IsUpToDate(const std::string& anmPath) {
+	return BinaryFile::IsUpToDate(Format, PathFor(anmPath), anmPath);
+}
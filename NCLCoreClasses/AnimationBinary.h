@@ -0,0 +1,36 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace NCL::Rendering {
+	class MeshAnimation;
+
+	// Animations converted ahead of time from .anm text by msh2bin, see BinaryFile
+	// A header is followed by each joint's ranges, then the quantised keys of
+	// every frame, laid out as in AnimationKeys so they're used in place
+	class AnimationBinary	{
+	public:
+		static const constexpr uint32_t Version = 1;
+		static constexpr const char* Extension = ".anmbin";
+		// Keys start on this boundary, so they can be loaded four joints at a time
+		static const constexpr size_t KeyAlignment = 16;
+
+		// Throws if the file can't be written
+		static void Save(const std::string& path, const MeshAnimation& animation);
+		// Throws if the file is missing, from another version, or damaged
+		static void Load(const std::string& path, MeshAnimation& animation);
+
+		// The converted file for a .anm, beside it with the extension swapped
+		static std::string PathFor(const std::string& anmPath);
+		// True if anmPath has been converted by this version since it was last changed
+		static bool IsUpToDate(const std::string& anmPath);
+	};
+}
@@ -0,0 +1,127 @@
+#include "AnimationSampler.h"
+#include "MeshAnimation.h"
+#include "Float4.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace NCL;
+using namespace Rendering;
+using namespace Maths;
+using namespace Maths::Simd;
+
+namespace {
+#ifdef NCL_FLOAT4_SSE
+	// Four raw keys, widened to floats
+	Float4 LoadRaw(const uint16_t* p) {
+		__m128i raw = _mm_loadl_epi64((const __m128i*)p);
+		return { _mm_cvtepi32_ps(_mm_unpacklo_epi16(raw, _mm_setzero_si128())) };
+	}
+	// Negates value in the joints where sign is negative
+	Float4 FlipWhereNegative(Float4 value, Float4 sign) {
+		__m128 negative = _mm_cmplt_ps(sign.v, _mm_setzero_ps());
+		return { _mm_xor_ps(value.v, _mm_and_ps(negative, _mm_set1_ps(-0.0f))) };
+	}
+#else
+	Float4 LoadRaw(const uint16_t* p)			{ return { (float)p[0], (float)p[1], (float)p[2], (float)p[3] }; }
+	Float4 FlipWhereNegative(Float4 value, Float4 sign) {
+		return Each([&](int i) { return sign.v[i] < 0.0f ? -value.v[i] : value.v[i]; });
+	}
+#endif
+}
+
+void AnimationSampler::Sample(const Instance& instance) {
+	const MeshAnimation& animation	= *instance.animation;
+	const AnimationKeys& keys		= animation.GetKeys();
+	size_t frameCount = animation.GetFrameCount();
+	if (!keys.data || frameCount == 0) {
+		return;
+	}
+
+	float position = std::fmod(instance.time * animation.GetFrameRate(), (float)frameCount);
+	if (position < 0.0f) {
+		position += frameCount;
+	}
+	size_t frameA	= std::min((size_t)position, frameCount - 1);
+	// The last frame blends back into the first, as animations loop
+	size_t frameB	= (frameA + 1) % frameCount;
+	Float4 t		= Splat(position - frameA);
+
+	const uint16_t* rawA	= keys.GetFrame(frameA);
+	const uint16_t* rawB	= keys.GetFrame(frameB);
+	size_t stride			= keys.stride;
+	size_t jointCount		= animation.GetJointCount();
+
+	for (size_t first = 0; first < jointCount; first += 4) {
+		// Decodes a component of both frames for these four joints
+		Float4 a[AnimationKeys::ComponentCount];
+		Float4 b[AnimationKeys::ComponentCount];
+		for (int c = 0; c < AnimationKeys::ComponentCount; c++) {
+			Float4 offset	= Load(keys.GetOffsets((AnimationKeys::Component)c) + first);
+			Float4 step		= Load(keys.GetSteps((AnimationKeys::Component)c) + first);
+			a[c] = offset + LoadRaw(rawA + c * stride + first) * step;
+			b[c] = offset + LoadRaw(rawB + c * stride + first) * step;
+		}
+
+		// Takes the short way round, which only matters when looping back to the first frame
+		Float4 dot = a[AnimationKeys::RotationX] * b[AnimationKeys::RotationX] + a[AnimationKeys::RotationY] * b[AnimationKeys::RotationY]
+			+ a[AnimationKeys::RotationZ] * b[AnimationKeys::RotationZ] + a[AnimationKeys::RotationW] * b[AnimationKeys::RotationW];
+		Float4 blended[AnimationKeys::ComponentCount];
+		for (int c = 0; c < AnimationKeys::ComponentCount; c++) {
+			bool rotation = c <= AnimationKeys::RotationW;
+			blended[c] = Lerp(a[c], rotation ? FlipWhereNegative(b[c], dot) : b[c], t);
+		}
+
+		Float4 length = ReciprocalSqrt(blended[AnimationKeys::RotationX] * blended[AnimationKeys::RotationX]
+			+ blended[AnimationKeys::RotationY] * blended[AnimationKeys::RotationY]
+			+ blended[AnimationKeys::RotationZ] * blended[AnimationKeys::RotationZ]
+			+ blended[AnimationKeys::RotationW] * blended[AnimationKeys::RotationW]);
+		Float4 x = blended[AnimationKeys::RotationX] * length;
+		Float4 y = blended[AnimationKeys::RotationY] * length;
+		Float4 z = blended[AnimationKeys::RotationZ] * length;
+		Float4 w = blended[AnimationKeys::RotationW] * length;
+
+		// As Quaternion::RotationMatrix, with each axis scaled
+		Float4 one = Splat(1.0f);
+		Float4 two = Splat(2.0f);
+		Float4 xx = x * x, yy = y * y, zz = z * z;
+		Float4 xy = x * y, xz = x * z, yz = y * z;
+		Float4 xw = x * w, yw = y * w, zw = z * w;
+		Float4 sx = blended[AnimationKeys::ScaleX];
+		Float4 sy = blended[AnimationKeys::ScaleY];
+		Float4 sz = blended[AnimationKeys::ScaleZ];
+
+		float columns[12][4];
+		Store(columns[0],	(one - two * (yy + zz)) * sx);
+		Store(columns[1],	two * (xy + zw) * sx);
+		Store(columns[2],	two * (xz - yw) * sx);
+		Store(columns[3],	two * (xy - zw) * sy);
+		Store(columns[4],	(one - two * (xx + zz)) * sy);
+		Store(columns[5],	two * (yz + xw) * sy);
+		Store(columns[6],	two * (xz + yw) * sz);
+		Store(columns[7],	two * (yz - xw) * sz);
+		Store(columns[8],	(one - two * (xx + yy)) * sz);
+		Store(columns[9],	blended[AnimationKeys::PositionX]);
+		Store(columns[10],	blended[AnimationKeys::PositionY]);
+		Store(columns[11],	blended[AnimationKeys::PositionZ]);
+
+		size_t count = std::min<size_t>(4, jointCount - first);
+		for (size_t lane = 0; lane < count; lane++) {
+			Matrix4 joint;
+			for (int col = 0; col < 4; col++) {
+				for (int row = 0; row < 3; row++) {
+					joint.array[col][row] = columns[col * 3 + row][lane];
+				}
+				joint.array[col][3] = col == 3 ? 1.0f : 0.0f;
+			}
+			size_t index = first + lane;
+			instance.palette[index] = instance.inverseBindPose ? joint * instance.inverseBindPose[index] : joint;
+		}
+	}
+}
+
+void AnimationSampler::Sample(std::span<const Instance> instances) {
+	for (const Instance& instance : instances) {
+		Sample(instance);
+	}
+}
@@ -0,0 +1,36 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include <span>
+
+#include "Matrix.h"
+
+namespace NCL::Rendering {
+	class MeshAnimation;
+
+	// Joint matrices at any point in an animation, blended between the frames either side
+	// Works straight from the quantised keys, four joints at a time using SSE where the
+	// platform has it. Rotations are normalised lerps, which for neighbouring frames are
+	// indistinguishable from slerps, and positions and scales are plain lerps
+	class AnimationSampler	{
+	public:
+		struct Instance {
+			const MeshAnimation*	animation;
+			// Seconds into the animation, wrapping around at the end
+			float					time;
+			// Filled with one matrix per joint
+			Maths::Matrix4*			palette;
+			// If set, each joint is multiplied by its inverse bind pose, ready for skinning
+			const Maths::Matrix4*	inverseBindPose = nullptr;
+		};
+
+		static void Sample(const Instance& instance);
+		static void Sample(std::span<const Instance> instances);
+	};
+}
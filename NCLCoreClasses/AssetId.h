@@ -0,0 +1,75 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace NCL {
+	// 64 bit FNV-1a, constexpr so literals can be hashed at compile time
+	// Pass a previous hash as seed to hash several pieces as one
+	constexpr uint64_t HashBytes(std::string_view bytes, uint64_t seed = 0xcbf29ce484222325ull) {
+		uint64_t hash = seed;
+		for (char c : bytes) {
+			hash ^= (uint8_t)c;
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	// An asset's path, interned as a hash so lookups compare one integer instead of strings
+	struct AssetId {
+		uint64_t hash = 0;
+
+		static constexpr AssetId FromPath(std::string_view path) {
+			return { HashBytes(path) };
+		}
+		// One ID for a pair of assets used together, like a shader's stages
+		static constexpr AssetId Combine(AssetId first, AssetId second) {
+			char bytes[sizeof(second.hash)];
+			for (size_t i = 0; i < sizeof(bytes); i++) {
+				bytes[i] = (char)(second.hash >> (i * 8));
+			}
+			return { HashBytes(std::string_view(bytes, sizeof(bytes)), first.hash) };
+		}
+
+		constexpr bool operator==(const AssetId&) const = default;
+	};
+
+	// A path with its ID. String literals are hashed at compile time, anything else when converted
+	// Only views the path, so don't keep one longer than the string it came from
+	class AssetPath {
+	public:
+		template <size_t N>
+		consteval AssetPath(const char (&literal)[N]) : path(literal, N - 1), id(AssetId::FromPath(path)) {
+		}
+		AssetPath(const std::string& path) : path(path), id(AssetId::FromPath(path)) {
+		}
+
+		constexpr std::string_view GetPath() const {
+			return path;
+		}
+		constexpr AssetId GetId() const {
+			return id;
+		}
+	protected:
+		std::string_view	path;
+		AssetId				id;
+	};
+}
+
+template <>
+struct std::hash<NCL::AssetId> {
+	// Already well mixed, so it can be used as is
+	size_t operator()(const NCL::AssetId& id) const {
+		return (size_t)id.hash;
+	}
+};
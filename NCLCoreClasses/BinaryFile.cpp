@@ -0,0 +1,76 @@
+#include "BinaryFile.h"
+
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+using namespace NCL;
+
+namespace {
+	// Format names are lower case to fit mid sentence, this starts one
+	std::string Capitalised(const char* name) {
+		std::string result = name;
+		if (!result.empty()) {
+			result[0] = (char)std::toupper((unsigned char)result[0]);
+		}
+		return result;
+	}
+
+	bool Matches(const BinaryFile::Format& format, const char* start) {
+		uint32_t version;
+		memcpy(&version, start + sizeof(format.magic), sizeof(version));
+		return memcmp(start, format.magic, sizeof(format.magic)) == 0 && version == format.version;
+	}
+}
+
+MappedFile BinaryFile::Open(const Format& format, const std::string& path, size_t headerSize) {
+	MappedFile file(path);
+	if (!file.IsOpen()) {
+		throw std::runtime_error("Couldn't open " + std::string(format.name) + " " + path);
+	}
+	std::span<const char> bytes = file.GetBytes();
+	if (bytes.size() < headerSize || memcmp(bytes.data(), format.magic, sizeof(format.magic)) != 0) {
+		throw std::runtime_error("File " + path + " is not a " + format.name + " file!");
+	}
+	if (!Matches(format, bytes.data())) {
+		throw std::runtime_error(Capitalised(format.name) + " " + path + " has incompatible version, " + format.rebuild);
+	}
+	return file;
+}
+
+void BinaryFile::Damaged(const Format& format, const std::string& path) {
+	throw std::runtime_error(Capitalised(format.name) + " " + path + " is damaged!");
+}
+
+void BinaryFile::Write(const Format& format, const std::string& path, std::span<const char> bytes) {
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	out.write(bytes.data(), bytes.size());
+	if (!out) {
+		throw std::runtime_error("Couldn't write " + std::string(format.name) + " " + path);
+	}
+}
+
+std::string BinaryFile::PathFor(const std::string& sourcePath, const char* extension) {
+	return std::filesystem::path(sourcePath).replace_extension(extension).string();
+}
+
+bool BinaryFile::IsUpToDate(const Format& format, const std::string& binaryPath, const std::string& sourcePath) {
+	std::error_code error;
+	auto binaryTime = std::filesystem::last_write_time(binaryPath, error);
+	if (error) {
+		return false;
+	}
+	// Just the magic and version, so a file from another version is rebuilt rather than failing to load
+	char start[sizeof(format.magic) + sizeof(format.version)];
+	if (!ReadHeader(format, binaryPath, start, sizeof(start))) {
+		return false;
+	}
+	auto sourceTime = std::filesystem::last_write_time(sourcePath, error);
+	return error || binaryTime >= sourceTime;
+}
+
+bool BinaryFile::ReadHeader(const Format& format, const std::string& path, void* header, size_t headerSize) {
+	std::ifstream file(path, std::ios::binary);
+	return file.read((char*)header, headerSize) && Matches(format, (const char*)header);
+}
@@ -0,0 +1,82 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+
+#include "MappedFile.h"
+
+namespace NCL {
+	// What the formats converted ahead of time have in common: each file starts with
+	// an 8 byte magic and a version, is written in one go, and is read in place from
+	// a memory mapped file. Little endian, as every platform we build for is
+	namespace BinaryFile {
+		// A format's header has to start with char magic[8], then uint32_t version
+		struct Format {
+			char		magic[8];
+			uint32_t	version;
+			// What the format is called in errors, e.g. "binary mesh"
+			const char*	name;
+			// How to replace a file from another version, e.g. "convert it again with msh2bin"
+			const char*	rebuild;
+		};
+
+		// Rounds offset up to alignment, which must be a power of 2
+		constexpr size_t Align(size_t offset, size_t alignment) {
+			return (offset + alignment - 1) & ~(alignment - 1);
+		}
+
+		// Maps path, and checks it's long enough for headerSize and starts with format's magic and version
+		// Throws if the file is missing, another format, or from another version
+		MappedFile Open(const Format& format, const std::string& path, size_t headerSize);
+
+		// Opens path as above, and copies its header out
+		template <typename Header>
+		MappedFile Open(const Format& format, const std::string& path, Header& header) {
+			static_assert(offsetof(Header, version) == sizeof(Format::magic));
+			MappedFile file = Open(format, path, sizeof(Header));
+			memcpy(&header, file.GetBytes().data(), sizeof(Header));
+			return file;
+		}
+
+		// A zeroed header with format's magic and version filled in
+		template <typename Header>
+		Header NewHeader(const Format& format) {
+			static_assert(offsetof(Header, version) == sizeof(Format::magic));
+			Header header = {};
+			memcpy(header.magic, format.magic, sizeof(format.magic));
+			header.version = format.version;
+			return header;
+		}
+
+		// Throws, for a file whose header or contents don't add up
+		[[noreturn]] void Damaged(const Format& format, const std::string& path);
+
+		// Replaces path with bytes, throws if the file can't be written
+		void Write(const Format& format, const std::string& path, std::span<const char> bytes);
+
+		// The converted file for a source, beside it with the extension swapped
+		std::string PathFor(const std::string& sourcePath, const char* extension);
+		// True if binaryPath has format's magic and version, and has been converted since sourcePath last changed
+		// No source to compare against is fine, the binary can ship on its own
+		bool IsUpToDate(const Format& format, const std::string& binaryPath, const std::string& sourcePath);
+
+		// Reads just the header from path, without mapping the rest
+		// False if it can't be read, or isn't format's magic and version
+		bool ReadHeader(const Format& format, const std::string& path, void* header, size_t headerSize);
+		template <typename Header>
+		bool ReadHeader(const Format& format, const std::string& path, Header& header) {
+			static_assert(offsetof(Header, version) == sizeof(Format::magic));
+			return ReadHeader(format, path, &header, sizeof(Header));
+		}
+	}
+}
@@ -0,0 +1,58 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NCL_FLOAT4_SSE
+#include <emmintrin.h>
+#endif
+
+namespace NCL::Maths::Simd {
+	// Four floats, in one SSE register where we have them and a plain array where we don't
+	// Meant for wide loops over joints and vertices, not for storing
+#ifdef NCL_FLOAT4_SSE
+	struct Float4 {
+		__m128 v;
+	};
+
+	inline Float4 Splat(float f)					{ return { _mm_set1_ps(f) }; }
+	inline Float4 Load(const float* p)				{ return { _mm_loadu_ps(p) }; }
+	inline void Store(float* p, Float4 a)			{ _mm_storeu_ps(p, a.v); }
+	inline Float4 operator+(Float4 a, Float4 b)		{ return { _mm_add_ps(a.v, b.v) }; }
+	inline Float4 operator-(Float4 a, Float4 b)		{ return { _mm_sub_ps(a.v, b.v) }; }
+	inline Float4 operator*(Float4 a, Float4 b)		{ return { _mm_mul_ps(a.v, b.v) }; }
+	inline Float4 ReciprocalSqrt(Float4 a)			{ return { _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(a.v)) }; }
+#else
+	struct Float4 {
+		float v[4];
+	};
+
+	template <typename F>
+	Float4 Each(F&& func) {
+		Float4 result;
+		for (int i = 0; i < 4; i++) {
+			result.v[i] = func(i);
+		}
+		return result;
+	}
+
+	inline Float4 Splat(float f)					{ return { f, f, f, f }; }
+	inline Float4 Load(const float* p)				{ return { p[0], p[1], p[2], p[3] }; }
+	inline void Store(float* p, Float4 a)			{ for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+	inline Float4 operator+(Float4 a, Float4 b)		{ return Each([&](int i) { return a.v[i] + b.v[i]; }); }
+	inline Float4 operator-(Float4 a, Float4 b)		{ return Each([&](int i) { return a.v[i] - b.v[i]; }); }
+	inline Float4 operator*(Float4 a, Float4 b)		{ return Each([&](int i) { return a.v[i] * b.v[i]; }); }
+	inline Float4 ReciprocalSqrt(Float4 a)			{ return Each([&](int i) { return 1.0f / std::sqrt(a.v[i]); }); }
+#endif
+
+	inline Float4 Lerp(Float4 a, Float4 b, Float4 t) {
+		return a + (b - a) * t;
+	}
+}
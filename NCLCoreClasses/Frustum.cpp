@@ -20,43 +20,27 @@ Frustum::Frustum(void) {
 Frustum Frustum::FromViewProjMatrix(const Matrix4& viewProj, float ndcNear, float ndcFar) {
 	Frustum f;
 
-	Matrix4 invMatrix		= Matrix::Inverse(viewProj);
-
-	//Takes NDC coordinates, transforms them into into clip space using the inverse matrix
-	Vector4 topLeftFar		= invMatrix * Vector4(-1.0f, 1.0f, ndcFar, 1.0f);
-	Vector4 topRightFar		= invMatrix * Vector4( 1.0f, 1.0f, ndcFar, 1.0f);
-	Vector4 bottomLeftFar	= invMatrix * Vector4(-1.0f, 1.0f, ndcFar, 1.0f);
-	Vector4 bottomRightFar	= invMatrix * Vector4( 1.0f, 1.0f, ndcFar, 1.0f);
-
-	Vector4 topLeftNear		= invMatrix * Vector4(-1.0f, 1.0f, ndcNear, 1.0f);
-	Vector4 topRightNear	= invMatrix * Vector4( 1.0f, 1.0f, ndcNear, 1.0f);
-	Vector4 bottomLeftNear	= invMatrix * Vector4(-1.0f, 1.0f, ndcNear, 1.0f);
-	Vector4 bottomRightNear = invMatrix * Vector4( 1.0f, 1.0f, ndcNear, 1.0f);
-
-	//To bring them fully into 'world' coodinates, we must divide them by their w component
-
-	topLeftFar		/= topLeftFar.w;
-	topRightFar		/= topRightFar.w;
-	bottomLeftFar	/= bottomLeftFar.w;
-	bottomRightFar	/= bottomRightFar.w;
-
-	topLeftNear		/= topLeftNear.w;
-	topRightNear	/= topRightNear.w;
-	bottomLeftNear	/= bottomLeftNear.w;
-	bottomRightNear /= bottomRightNear.w;
-
-	//Now they are in world space, we can form planes from them, 3 at a time
-	//Note that the order is important, to make sure that the positive half space of the plane
-	//is facing 'in' to the frustum - a point positive to all 6 planes is inside the frustum
-	
-	f.planes[0] = Plane::PlaneFromTri(topLeftFar, bottomLeftFar, bottomLeftNear);	//left plane
-	f.planes[1] = Plane::PlaneFromTri(topRightFar, topRightNear, bottomRightNear);	//right plane
-
-	f.planes[2] = Plane::PlaneFromTri(topLeftFar, topRightFar, topRightNear);			//top plane
-	f.planes[3] = Plane::PlaneFromTri(bottomLeftFar, bottomRightFar, bottomRightNear);	//bottom plane
-
-	f.planes[4] = Plane::PlaneFromTri(topLeftNear, topRightNear, bottomRightNear);	//near plane
-	f.planes[5] = Plane::PlaneFromTri(topLeftFar, topRightFar, bottomRightFar);		//far plane
-
+	//A point p is inside the frustum if its clip space position c = viewProj * p has
+	//-w <= x <= w, -w <= y <= w and ndcNear * w <= z <= ndcFar * w.
+	//Each of those is a dot product of p with a combination of the matrix rows,
+	//which is a plane with its positive half space facing 'in' to the frustum.
+	//Working from the rows directly avoids inverting the matrix, which loses a lot
+	//of precision at the far corners when the near plane is close
+	Vector4 rowX = viewProj.GetRow(0);
+	Vector4 rowY = viewProj.GetRow(1);
+	Vector4 rowZ = viewProj.GetRow(2);
+	Vector4 rowW = viewProj.GetRow(3);
+
+	Vector4 planes[6] = {
+		rowW + rowX,				//left plane
+		rowW - rowX,				//right plane
+		rowW - rowY,				//top plane
+		rowW + rowY,				//bottom plane
+		rowZ - rowW * ndcNear,		//near plane
+		rowW * ndcFar - rowZ		//far plane
+	};
+	for (int p = 0; p < 6; ++p) {
+		f.planes[p] = Plane(Vector3(planes[p]), planes[p].w, true);
+	}
 	return f;
-}
\ No newline at end of file
+}
@@ -10,6 +10,8 @@ https://research.ncl.ac.uk/game/
 #include "Plane.h"
 #include "Matrix.h"
 
+#include <cmath>
+
 namespace NCL::Maths {
 	class Frustum {
 	public:
@@ -26,6 +28,19 @@ namespace NCL::Maths {
 			}
 			return true;
 		}
+
+		// Uses the box's extent along each plane normal, so is as cheap as the sphere test
+		// Can keep a box near a corner of the frustum that's just outside it
+		bool AABBInsideFrustum(const Vector3& position, const Vector3& halfSize) const {
+			for (int p = 0; p < 6; ++p) {
+				Vector3 normal = planes[p].GetNormal();
+				float extent = std::abs(normal.x) * halfSize.x + std::abs(normal.y) * halfSize.y + std::abs(normal.z) * halfSize.z;
+				if (planes[p].DistanceFromPlane(position) <= -extent) {
+					return false;
+				}
+			}
+			return true;
+		}
 	protected:
 		Plane planes[6];
 	};
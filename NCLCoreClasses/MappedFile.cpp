@@ -0,0 +1,97 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace NCL;
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	fileHandle = file;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		Close();
+		return;
+	}
+	mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle) {
+		Close();
+		return;
+	}
+	data = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	size = data ? (size_t)fileSize.QuadPart : 0;
+	if (!data) {
+		Close();
+	}
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		return;
+	}
+	struct stat info;
+	if (fstat(file, &info) == 0 && info.st_size > 0) {
+		void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapped != MAP_FAILED) {
+			data = (const char*)mapped;
+			size = (size_t)info.st_size;
+		}
+	}
+	// The mapping keeps the file alive on its own
+	close(file);
+#endif
+}
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		Close();
+		std::swap(data, other.data);
+		std::swap(size, other.size);
+#ifdef _WIN32
+		std::swap(fileHandle, other.fileHandle);
+		std::swap(mappingHandle, other.mappingHandle);
+#endif
+	}
+	return *this;
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+	if (data) {
+		UnmapViewOfFile(data);
+	}
+	if (mappingHandle) {
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle) {
+		CloseHandle(fileHandle);
+	}
+	mappingHandle	= nullptr;
+	fileHandle		= nullptr;
+#else
+	if (data) {
+		munmap((void*)data, size);
+	}
+#endif
+	data = nullptr;
+	size = 0;
+}
@@ -0,0 +1,48 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include <span>
+#include <string>
+
+namespace NCL {
+	// A whole file mapped read only into memory, so it can be read in place
+	// Pages are only loaded as they're touched, and are shared with the OS file cache
+	class MappedFile	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::string& path);
+		~MappedFile();
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// False if the file couldn't be opened, or is empty
+		bool IsOpen() const {
+			return data != nullptr;
+		}
+		std::span<const char> GetBytes() const {
+			return std::span<const char>(data, size);
+		}
+		size_t GetSize() const {
+			return size;
+		}
+
+	protected:
+		void Close();
+
+		const char*	data = nullptr;
+		size_t		size = 0;
+#ifdef _WIN32
+		void*		fileHandle		= nullptr;
+		void*		mappingHandle	= nullptr;
+#endif
+	};
+}
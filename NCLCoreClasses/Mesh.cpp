@@ -114,6 +114,38 @@ void Mesh::SetVertexSkinIndices(const std::vector<Vector4i>& newSkinIndices) {
 	skinIndices = newSkinIndices;
 }
 
+void Mesh::SetVertexPositions(std::vector<Vector3>&& newVerts) {
+	positions = std::move(newVerts);
+}
+
+void Mesh::SetVertexTextureCoords(std::vector<Vector2>&& newTex) {
+	texCoords = std::move(newTex);
+}
+
+void Mesh::SetVertexColours(std::vector<Vector4>&& newColours) {
+	colours = std::move(newColours);
+}
+
+void Mesh::SetVertexNormals(std::vector<Vector3>&& newNorms) {
+	normals = std::move(newNorms);
+}
+
+void Mesh::SetVertexTangents(std::vector<Vector4>&& newTans) {
+	tangents = std::move(newTans);
+}
+
+void Mesh::SetVertexIndices(std::vector<unsigned int>&& newIndices) {
+	indices = std::move(newIndices);
+}
+
+void Mesh::SetVertexSkinWeights(std::vector<Vector4>&& newSkinWeights) {
+	skinWeights = std::move(newSkinWeights);
+}
+
+void Mesh::SetVertexSkinIndices(std::vector<Vector4i>&& newSkinIndices) {
+	skinIndices = std::move(newSkinIndices);
+}
+
 void Mesh::SetDebugName(const std::string& newName) {
 	debugName = newName;
 }
@@ -142,6 +174,10 @@ void Mesh::SetSubMeshNames(const std::vector < std::string>& newNames) {
 	subMeshNames = newNames;
 }
 
+void Mesh::SetLods(const std::vector<MeshLod>& newLods) {
+	lods = newLods;
+}
+
 void Mesh::CalculateInverseBindPose() {
 	inverseBindPose.resize(bindPose.size());
 
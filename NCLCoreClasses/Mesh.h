@@ -57,6 +57,14 @@ namespace NCL::Rendering {
 		int base  = 0;
 	};
 
+	// A simplified version of a mesh, drawn from the same vertex buffers
+	struct MeshLod {
+		// Ranges of the mesh's index buffer, one per submesh of the full mesh
+		std::vector<SubMesh>	subMeshes;
+		// How far the surface may be from the full mesh's, in model space
+		float					error = 0.0f;
+	};
+
 	class Mesh	{
 	public:		
 		virtual ~Mesh();
@@ -150,6 +158,18 @@ namespace NCL::Rendering {
 		void SetSubMeshes(const std::vector < SubMesh>& meshes);
 		void SetSubMeshNames(const std::vector < std::string>& newnames);
 
+		// Level 0 is the mesh itself, later levels are coarser
+		size_t GetLodCount() const {
+			return lods.size() + 1;
+		}
+		const std::vector<MeshLod>& GetLods() const {
+			return lods;
+		}
+		float GetLodError(size_t level) const {
+			return level == 0 ? 0.0f : lods[level - 1].error;
+		}
+		void SetLods(const std::vector<MeshLod>& newLods);
+
 
 		void SetJointNames(const std::vector < std::string > & newnames);
 		void SetJointParents(const std::vector<int>& newParents);
@@ -173,6 +193,15 @@ namespace NCL::Rendering {
 		const std::vector<int>& GetJointParents()	const {
 			return jointParents;
 		}
+		const std::vector<std::string>& GetJointNames()	const {
+			return jointNames;
+		}
+		const std::vector<SubMesh>& GetSubMeshes()	const {
+			return subMeshes;
+		}
+		const std::vector<std::string>& GetSubMeshNames()	const {
+			return subMeshNames;
+		}
 
 		const std::vector<unsigned int>& GetIndexData()			const { return indices;		}
 
@@ -187,6 +216,16 @@ namespace NCL::Rendering {
 		void SetVertexSkinWeights(const std::vector<Vector4>& newSkinWeights);
 		void SetVertexSkinIndices(const std::vector<Vector4i>& newSkinIndices);
 
+		//Take over data the caller has no further use for, rather than copying it
+		void SetVertexPositions(std::vector<Vector3>&& newVerts);
+		void SetVertexTextureCoords(std::vector<Vector2>&& newTex);
+		void SetVertexColours(std::vector<Vector4>&& newColours);
+		void SetVertexNormals(std::vector<Vector3>&& newNorms);
+		void SetVertexTangents(std::vector<Vector4>&& newTans);
+		void SetVertexIndices(std::vector<unsigned int>&& newIndices);
+		void SetVertexSkinWeights(std::vector<Vector4>&& newSkinWeights);
+		void SetVertexSkinIndices(std::vector<Vector4i>&& newSkinIndices);
+
 		void SetDebugName(const std::string& debugName);
 
 		virtual void UploadToGPU(Rendering::RendererBase* renderer = nullptr) = 0;
@@ -216,6 +255,7 @@ namespace NCL::Rendering {
 		std::vector<unsigned int>	indices;
 		std::vector<SubMesh>		subMeshes;
 		std::vector<std::string>	subMeshNames;
+		std::vector<MeshLod>		lods;
 
 		std::vector<Vector4>		skinWeights;	//Allows us to have 4 weight skinning 
 		std::vector<Vector4i>		skinIndices;
@@ -1,11 +1,49 @@
 #include "MeshAnimation.h"
+#include "AnimationBinary.h"
 #include "Matrix.h"
 #include "Assets.h"
+#include "Quaternion.h"
+
+#include <algorithm>
+#include <cmath>
 
 using namespace NCL;
 using namespace Rendering;
 using namespace Maths;
 
+namespace {
+	// Splits a joint matrix into its rotation, position and scale
+	void Decompose(const Matrix4& m, float* components) {
+		Vector3 axes[3];
+		float scale[3];
+		for (int i = 0; i < 3; i++) {
+			axes[i]		= Vector3(m.array[i][0], m.array[i][1], m.array[i][2]);
+			scale[i]	= Vector::Length(axes[i]);
+		}
+		// A mirrored joint keeps the flip in its first axis
+		if (Vector::Dot(Vector::Cross(axes[0], axes[1]), axes[2]) < 0.0f) {
+			scale[0] = -scale[0];
+		}
+		Matrix3 basis;
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				basis.array[i][j] = scale[i] != 0.0f ? axes[i][j] / scale[i] : (float)(i == j);
+			}
+		}
+		Quaternion rotation(basis);
+		rotation.Normalise();
+
+		components[AnimationKeys::RotationX] = rotation.x;
+		components[AnimationKeys::RotationY] = rotation.y;
+		components[AnimationKeys::RotationZ] = rotation.z;
+		components[AnimationKeys::RotationW] = rotation.w;
+		for (int i = 0; i < 3; i++) {
+			components[AnimationKeys::PositionX + i]	= m.array[3][i];
+			components[AnimationKeys::ScaleX + i]		= scale[i];
+		}
+	}
+}
+
 MeshAnimation::MeshAnimation() {
 	jointCount	= 0;
 	frameCount	= 0;
@@ -17,10 +55,22 @@ MeshAnimation::MeshAnimation(size_t jointCount, size_t frameCount, float frameRa
 	this->frameCount = frameCount;
 	this->frameRate  = frameRate;
 	this->allJoints  = frames;
+	BuildKeys();
 }
 
 MeshAnimation::MeshAnimation(const std::string& filename) : MeshAnimation() {
-	std::ifstream file(Assets::MESHDIR + filename);
+	std::string path = Assets::MESHDIR + filename;
+	if (AnimationBinary::IsUpToDate(path)) {
+		try {
+			AnimationBinary::Load(AnimationBinary::PathFor(path), *this);
+			return;
+		}
+		catch (const std::exception& e) {
+			// A damaged conversion still leaves the text it was made from
+			std::cout << __FUNCTION__ << ": " << e.what() << ", reading " << filename << " instead\n";
+		}
+	}
+	std::ifstream file(path);
 
 	std::string filetype;
 	int fileVersion;
@@ -49,6 +99,7 @@ MeshAnimation::MeshAnimation(const std::string& filename) : MeshAnimation() {
 			allJoints.emplace_back(mat);
 		}
 	}
+	BuildKeys();
 }
 
 MeshAnimation::~MeshAnimation() {
@@ -56,7 +107,7 @@ MeshAnimation::~MeshAnimation() {
 }
 
 const Matrix4* MeshAnimation::GetJointData(size_t frame) const {
-	if (frame >= frameCount) {
+	if (frame >= frameCount || allJoints.empty()) {
 		return nullptr;
 	}
 	int matStart = frame * jointCount;
@@ -64,4 +115,68 @@ const Matrix4* MeshAnimation::GetJointData(size_t frame) const {
 	Matrix4* dataStart = (Matrix4*)allJoints.data();
 
 	return dataStart + matStart;
-}
\ No newline at end of file
+}
+
+void MeshAnimation::BuildKeys() {
+	const size_t componentCount = AnimationKeys::ComponentCount;
+	if (frameCount == 0 || allJoints.size() < frameCount * jointCount) {
+		return;
+	}
+	keys.stride = (jointCount + 3) & ~(size_t)3;
+
+	std::vector<float> decomposed(frameCount * jointCount * componentCount);
+	for (size_t i = 0; i < frameCount * jointCount; i++) {
+		float* components = &decomposed[i * componentCount];
+		Decompose(allJoints[i], components);
+		// q and -q are the same rotation, so pick whichever is nearer the last frame's
+		// to keep each joint's range small
+		if (i >= jointCount) {
+			const float* previous = components - jointCount * componentCount;
+			float dot = 0.0f;
+			for (int c = AnimationKeys::RotationX; c <= AnimationKeys::RotationW; c++) {
+				dot += components[c] * previous[c];
+			}
+			if (dot < 0.0f) {
+				for (int c = AnimationKeys::RotationX; c <= AnimationKeys::RotationW; c++) {
+					components[c] = -components[c];
+				}
+			}
+		}
+	}
+
+	// Padding decodes as the identity, with nothing to step
+	keys.ranges.assign(componentCount * keys.stride * 2, 0.0f);
+	for (size_t joint = jointCount; joint < keys.stride; joint++) {
+		keys.ranges[AnimationKeys::RotationW * keys.stride + joint] = 1.0f;
+		for (int i = 0; i < 3; i++) {
+			keys.ranges[(AnimationKeys::ScaleX + i) * keys.stride + joint] = 1.0f;
+		}
+	}
+	for (size_t joint = 0; joint < jointCount; joint++) {
+		for (size_t c = 0; c < componentCount; c++) {
+			float low	= INFINITY;
+			float high	= -INFINITY;
+			for (size_t frame = 0; frame < frameCount; frame++) {
+				float value = decomposed[(frame * jointCount + joint) * componentCount + c];
+				low		= std::min(low, value);
+				high	= std::max(high, value);
+			}
+			keys.ranges[c * keys.stride + joint]						= low;
+			keys.ranges[(componentCount + c) * keys.stride + joint]	= (high - low) / 65535.0f;
+		}
+	}
+
+	ownedKeys.assign(frameCount * componentCount * keys.stride, 0);
+	for (size_t frame = 0; frame < frameCount; frame++) {
+		for (size_t joint = 0; joint < jointCount; joint++) {
+			for (size_t c = 0; c < componentCount; c++) {
+				float value		= decomposed[(frame * jointCount + joint) * componentCount + c];
+				float offset	= keys.ranges[c * keys.stride + joint];
+				float step		= keys.ranges[(componentCount + c) * keys.stride + joint];
+				float raw		= step > 0.0f ? std::round((value - offset) / step) : 0.0f;
+				ownedKeys[(frame * componentCount + c) * keys.stride + joint] = (uint16_t)std::clamp(raw, 0.0f, 65535.0f);
+			}
+		}
+	}
+	keys.data = ownedKeys.data();
+}
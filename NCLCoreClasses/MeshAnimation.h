@@ -7,21 +7,58 @@ Comments and queries to: richard-gordon.davison AT ncl.ac.uk
 https://research.ncl.ac.uk/game/
 */
 #pragma once
+#include <cstdint>
+
 #include "Vector.h"
 #include "Matrix.h"
+#include "MappedFile.h"
 
 namespace NCL::Rendering {
 	using UniqueMeshAnim = std::unique_ptr<class MeshAnimation>;
 	using SharedMeshAnim = std::shared_ptr<class MeshAnimation>;
 
+	// Every joint's rotation, position and scale in every frame, quantised to 16 bits
+	// Each frame holds one array per component covering every joint, so joints can be
+	// decoded four at a time. A value decodes as offset + raw * step, with each joint
+	// having its own range per component
+	struct AnimationKeys {
+		enum Component {
+			RotationX, RotationY, RotationZ, RotationW,
+			PositionX, PositionY, PositionZ,
+			ScaleX, ScaleY, ScaleZ,
+			ComponentCount
+		};
+
+		// Joints per array, rounded up to a multiple of 4. Padding decodes as the identity
+		size_t			stride	= 0;
+		// ComponentCount arrays of stride offsets, followed by the same for steps
+		std::vector<float>	ranges;
+		// ComponentCount * stride values per frame, in the mapped file if loaded from one
+		const uint16_t*	data	= nullptr;
+
+		const float* GetOffsets(Component component) const {
+			return ranges.data() + component * stride;
+		}
+		const float* GetSteps(Component component) const {
+			return ranges.data() + (ComponentCount + component) * stride;
+		}
+		const uint16_t* GetFrame(size_t frame) const {
+			return data + frame * ComponentCount * stride;
+		}
+	};
+
 	class MeshAnimation	{
 	public:
 		MeshAnimation();
 		MeshAnimation(size_t jointCount, size_t frameCount, float frameRate, std::vector<Maths::Matrix4>& frames);
+		// Prefers a .anmbin converted by msh2bin, if one is up to date
 		MeshAnimation(const std::string& filename);
 
 		virtual ~MeshAnimation();
 
+		MeshAnimation(const MeshAnimation&) = delete;
+		MeshAnimation& operator=(const MeshAnimation&) = delete;
+
 		size_t GetJointCount() const {
 			return jointCount;
 		}
@@ -42,14 +79,30 @@ namespace NCL::Rendering {
 			return frameCount / (float)frameRate;
 		}
 
+		// Whole frames as matrices, for animations made from matrices or loaded from text
+		// Null for binary animations, which are sampled through their keys
 		const Maths::Matrix4* GetJointData(size_t frame) const;
 
+		const AnimationKeys& GetKeys() const {
+			return keys;
+		}
+
 	protected:
+		friend class AnimationBinary;
+
+		// Quantises allJoints into keys
+		void BuildKeys();
+
 		size_t		jointCount;
 		size_t		frameCount;
 		float		frameRate;
 
 		std::vector<Maths::Matrix4>		allJoints;
+
+		AnimationKeys			keys;
+		// Where keys.data lives: built from matrices, or read in place from a binary file
+		std::vector<uint16_t>	ownedKeys;
+		MappedFile				keyFile;
 	};
 }
 
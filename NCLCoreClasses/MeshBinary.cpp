@@ -0,0 +1,293 @@
+#include "MeshBinary.h"
+#include "BinaryFile.h"
+#include "Mesh.h"
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace NCL;
+using namespace Rendering;
+using namespace Maths;
+
+namespace {
+	const BinaryFile::Format Format = {
+		{ 'N', 'C', 'L', 'M', 'E', 'S', 'H', '\0' }, MeshBinary::Version, "binary mesh", "convert it again with msh2bin"
+	};
+
+	struct Header {
+		char		magic[8];
+		uint32_t	version;
+		uint32_t	primitiveType;
+		uint32_t	vertexCount;
+		uint32_t	indexCount;
+		uint32_t	chunkCount;
+		// LodBuilder::Version of the LODs in the file, 0 if it has none
+		uint32_t	lodVersion;
+	};
+	static_assert(sizeof(Header) == 32);
+
+	struct ChunkEntry {
+		uint32_t	type;
+		// Elements in the chunk: vertices, indices, strings or LODs
+		uint32_t	count;
+		uint64_t	offset;
+		uint64_t	size;
+	};
+	static_assert(sizeof(ChunkEntry) == 24);
+
+	// Each LOD is this, followed by its submeshes
+	struct LodEntry {
+		float		error;
+		uint32_t	subMeshCount;
+	};
+
+	size_t Align(size_t offset) {
+		return BinaryFile::Align(offset, MeshBinary::ChunkAlignment);
+	}
+
+	// Gathers chunks, then writes the table and data out in one go
+	class Writer {
+	public:
+		void Add(MeshBinary::Chunk type, uint32_t count, const void* data, size_t size) {
+			if (size == 0) {
+				return;
+			}
+			entries.push_back({ (uint32_t)type, count, 0, size });
+			const char* bytes = (const char*)data;
+			chunkData.emplace_back(bytes, bytes + size);
+		}
+		template <typename T>
+		void Add(MeshBinary::Chunk type, const std::vector<T>& elements) {
+			Add(type, (uint32_t)elements.size(), elements.data(), elements.size() * sizeof(T));
+		}
+		void Add(MeshBinary::Chunk type, const std::vector<std::string>& strings) {
+			std::vector<char> packed;
+			for (const std::string& s : strings) {
+				packed.insert(packed.end(), s.begin(), s.end());
+				packed.push_back('\0');
+			}
+			Add(type, (uint32_t)strings.size(), packed.data(), packed.size());
+		}
+
+		void Write(const std::string& path, const Header& baseHeader) {
+			Header header = baseHeader;
+			header.chunkCount = (uint32_t)entries.size();
+
+			size_t offset = Align(sizeof(Header) + entries.size() * sizeof(ChunkEntry));
+			for (ChunkEntry& entry : entries) {
+				entry.offset = offset;
+				offset = Align(offset + entry.size);
+			}
+			std::vector<char> file(offset, 0);
+			memcpy(file.data(), &header, sizeof(Header));
+			memcpy(file.data() + sizeof(Header), entries.data(), entries.size() * sizeof(ChunkEntry));
+			for (size_t i = 0; i < entries.size(); i++) {
+				memcpy(file.data() + entries[i].offset, chunkData[i].data(), chunkData[i].size());
+			}
+			BinaryFile::Write(Format, path, file);
+		}
+	private:
+		std::vector<ChunkEntry>			entries;
+		std::vector<std::vector<char>>	chunkData;
+	};
+
+	// Copies a chunk's array out of the mapped file, checking it holds what the header says
+	template <typename T>
+	std::vector<T> ReadArray(const MappedFile& file, const ChunkEntry& entry, size_t expectedCount, const std::string& path) {
+		if (entry.count != expectedCount || entry.size != expectedCount * sizeof(T)) {
+			throw std::runtime_error("Mesh " + path + " has a chunk of the wrong size!");
+		}
+		const T* first = (const T*)(file.GetBytes().data() + entry.offset);
+		return std::vector<T>(first, first + entry.count);
+	}
+
+	std::vector<std::string> ReadStrings(const MappedFile& file, const ChunkEntry& entry, const std::string& path) {
+		std::vector<std::string> strings;
+		const char* at	= file.GetBytes().data() + entry.offset;
+		const char* end	= at + entry.size;
+		while (at < end && strings.size() < entry.count) {
+			const char* terminator = (const char*)memchr(at, '\0', end - at);
+			if (!terminator) {
+				break;
+			}
+			strings.emplace_back(at, terminator);
+			at = terminator + 1;
+		}
+		if (strings.size() != entry.count) {
+			throw std::runtime_error("Mesh " + path + " has a damaged string chunk!");
+		}
+		return strings;
+	}
+
+	std::vector<MeshLod> ReadLods(const MappedFile& file, const ChunkEntry& entry, const std::string& path) {
+		std::vector<MeshLod> lods;
+		const char* at	= file.GetBytes().data() + entry.offset;
+		const char* end	= at + entry.size;
+		for (uint32_t i = 0; i < entry.count; i++) {
+			LodEntry lodEntry;
+			if ((size_t)(end - at) < sizeof(LodEntry)) {
+				throw std::runtime_error("Mesh " + path + " has a damaged LOD chunk!");
+			}
+			memcpy(&lodEntry, at, sizeof(LodEntry));
+			at += sizeof(LodEntry);
+			if ((size_t)(end - at) < lodEntry.subMeshCount * sizeof(SubMesh)) {
+				throw std::runtime_error("Mesh " + path + " has a damaged LOD chunk!");
+			}
+			MeshLod& lod = lods.emplace_back();
+			lod.error = lodEntry.error;
+			lod.subMeshes.resize(lodEntry.subMeshCount);
+			memcpy(lod.subMeshes.data(), at, lodEntry.subMeshCount * sizeof(SubMesh));
+			at += lodEntry.subMeshCount * sizeof(SubMesh);
+		}
+		return lods;
+	}
+
+	// Undoes a load that failed part way, so falling back to the text starts from an empty mesh
+	void Clear(Mesh& mesh) {
+		mesh.SetVertexPositions(std::vector<Vector3>());
+		mesh.SetVertexTextureCoords(std::vector<Vector2>());
+		mesh.SetVertexColours(std::vector<Vector4>());
+		mesh.SetVertexNormals(std::vector<Vector3>());
+		mesh.SetVertexTangents(std::vector<Vector4>());
+		mesh.SetVertexSkinWeights(std::vector<Vector4>());
+		mesh.SetVertexSkinIndices(std::vector<Vector4i>());
+		mesh.SetVertexIndices(std::vector<unsigned int>());
+		mesh.SetSubMeshes({});
+		mesh.SetSubMeshNames({});
+		mesh.SetJointNames({});
+		mesh.SetJointParents({});
+		mesh.SetBindPose({});
+		mesh.SetInverseBindPose({});
+		mesh.SetLods({});
+	}
+
+	// Each range has to lie within the index buffer, or the vertices for an unindexed mesh,
+	// and every index it draws has to be a real vertex once its base is added
+	void CheckSubMeshes(const std::vector<SubMesh>& subMeshes, const Mesh& mesh, size_t vertexCount, const std::string& path) {
+		const std::vector<unsigned int>& indices = mesh.GetIndexData();
+		size_t rangeLimit = indices.empty() ? vertexCount : indices.size();
+		for (const SubMesh& subMesh : subMeshes) {
+			if (subMesh.start < 0 || subMesh.count < 0 || subMesh.base < 0
+				|| (size_t)subMesh.start + (size_t)subMesh.count > rangeLimit) {
+				throw std::runtime_error("Mesh " + path + " has a submesh outside its index buffer!");
+			}
+			if (indices.empty()) {
+				continue;
+			}
+			for (int i = subMesh.start; i < subMesh.start + subMesh.count; i++) {
+				if ((size_t)indices[i] + (size_t)subMesh.base >= vertexCount) {
+					throw std::runtime_error("Mesh " + path + " has an index past its last vertex!");
+				}
+			}
+		}
+	}
+
+	// Fills mesh from the chunks in the table, then checks nothing in them points outside the mesh
+	void ReadChunks(const MappedFile& file, const std::vector<ChunkEntry>& entries, const Header& header, const std::string& path, Mesh& mesh) {
+		using Chunk = MeshBinary::Chunk;
+		std::span<const char> bytes = file.GetBytes();
+		mesh.SetPrimitiveType((GeometryPrimitive::Type)header.primitiveType);
+		for (const ChunkEntry& entry : entries) {
+			if (entry.offset % MeshBinary::ChunkAlignment != 0 || entry.offset > bytes.size() || entry.size > bytes.size() - entry.offset) {
+				throw std::runtime_error("Mesh " + path + " has a chunk outside the file!");
+			}
+			switch ((Chunk)entry.type) {
+				case Chunk::Positions:		mesh.SetVertexPositions(ReadArray<Vector3>(file, entry, header.vertexCount, path));		break;
+				case Chunk::TexCoords:		mesh.SetVertexTextureCoords(ReadArray<Vector2>(file, entry, header.vertexCount, path));	break;
+				case Chunk::Colours:		mesh.SetVertexColours(ReadArray<Vector4>(file, entry, header.vertexCount, path));		break;
+				case Chunk::Normals:		mesh.SetVertexNormals(ReadArray<Vector3>(file, entry, header.vertexCount, path));		break;
+				case Chunk::Tangents:		mesh.SetVertexTangents(ReadArray<Vector4>(file, entry, header.vertexCount, path));		break;
+				case Chunk::SkinWeights:	mesh.SetVertexSkinWeights(ReadArray<Vector4>(file, entry, header.vertexCount, path));	break;
+				case Chunk::SkinIndices:	mesh.SetVertexSkinIndices(ReadArray<Vector4i>(file, entry, header.vertexCount, path));	break;
+				case Chunk::Indices:		mesh.SetVertexIndices(ReadArray<unsigned int>(file, entry, header.indexCount, path));	break;
+				case Chunk::SubMeshes:		mesh.SetSubMeshes(ReadArray<SubMesh>(file, entry, entry.count, path));					break;
+				case Chunk::SubMeshNames:	mesh.SetSubMeshNames(ReadStrings(file, entry, path));									break;
+				case Chunk::JointNames:		mesh.SetJointNames(ReadStrings(file, entry, path));										break;
+				case Chunk::JointParents:	mesh.SetJointParents(ReadArray<int>(file, entry, entry.count, path));					break;
+				case Chunk::BindPose:		mesh.SetBindPose(ReadArray<Matrix4>(file, entry, entry.count, path));					break;
+				case Chunk::InverseBindPose:mesh.SetInverseBindPose(ReadArray<Matrix4>(file, entry, entry.count, path));			break;
+				case Chunk::Lods:			mesh.SetLods(ReadLods(file, entry, path));												break;
+				default: break;
+			}
+		}
+
+		// The GPU would read whatever lies past the vertex buffer, so a damaged file can't get that far
+		for (unsigned int index : mesh.GetIndexData()) {
+			if (index >= header.vertexCount) {
+				throw std::runtime_error("Mesh " + path + " has an index past its last vertex!");
+			}
+		}
+		CheckSubMeshes(mesh.GetSubMeshes(), mesh, header.vertexCount, path);
+		for (const MeshLod& lod : mesh.GetLods()) {
+			CheckSubMeshes(lod.subMeshes, mesh, header.vertexCount, path);
+		}
+	}
+}
+
+void MeshBinary::Save(const std::string& path, const Mesh& mesh, uint32_t lodVersion) {
+	Header header = BinaryFile::NewHeader<Header>(Format);
+	header.primitiveType	= (uint32_t)mesh.GetPrimitiveType();
+	header.vertexCount		= (uint32_t)mesh.GetVertexCount();
+	header.indexCount		= (uint32_t)mesh.GetIndexCount();
+	header.lodVersion		= mesh.GetLods().empty() ? 0 : lodVersion;
+
+	Writer writer;
+	writer.Add(Chunk::Positions,		mesh.GetPositionData());
+	writer.Add(Chunk::TexCoords,		mesh.GetTextureCoordData());
+	writer.Add(Chunk::Colours,			mesh.GetColourData());
+	writer.Add(Chunk::Normals,			mesh.GetNormalData());
+	writer.Add(Chunk::Tangents,			mesh.GetTangentData());
+	writer.Add(Chunk::SkinWeights,		mesh.GetSkinWeightData());
+	writer.Add(Chunk::SkinIndices,		mesh.GetSkinIndexData());
+	writer.Add(Chunk::Indices,			mesh.GetIndexData());
+	writer.Add(Chunk::SubMeshes,		mesh.GetSubMeshes());
+	writer.Add(Chunk::SubMeshNames,		mesh.GetSubMeshNames());
+	writer.Add(Chunk::JointNames,		mesh.GetJointNames());
+	writer.Add(Chunk::JointParents,		mesh.GetJointParents());
+	writer.Add(Chunk::BindPose,			mesh.GetBindPose());
+	writer.Add(Chunk::InverseBindPose,	mesh.GetInverseBindPose());
+
+	std::vector<char> lodData;
+	for (const MeshLod& lod : mesh.GetLods()) {
+		LodEntry entry = { lod.error, (uint32_t)lod.subMeshes.size() };
+		const char* entryBytes		= (const char*)&entry;
+		const char* subMeshBytes	= (const char*)lod.subMeshes.data();
+		lodData.insert(lodData.end(), entryBytes, entryBytes + sizeof(LodEntry));
+		lodData.insert(lodData.end(), subMeshBytes, subMeshBytes + lod.subMeshes.size() * sizeof(SubMesh));
+	}
+	writer.Add(Chunk::Lods, (uint32_t)mesh.GetLods().size(), lodData.data(), lodData.size());
+
+	writer.Write(path, header);
+}
+
+void MeshBinary::Load(const std::string& path, Mesh& mesh) {
+	Header header;
+	MappedFile file = BinaryFile::Open(Format, path, header);
+	std::span<const char> bytes = file.GetBytes();
+	if (bytes.size() < sizeof(Header) + (size_t)header.chunkCount * sizeof(ChunkEntry)) {
+		throw std::runtime_error("Mesh " + path + " has a damaged chunk table!");
+	}
+	std::vector<ChunkEntry> entries(header.chunkCount);
+	memcpy(entries.data(), bytes.data() + sizeof(Header), entries.size() * sizeof(ChunkEntry));
+
+	try {
+		ReadChunks(file, entries, header, path, mesh);
+	}
+	catch (...) {
+		Clear(mesh);
+		throw;
+	}
+}
+
+std::string MeshBinary::PathFor(const std::string& mshPath) {
+	return BinaryFile::PathFor(mshPath, Extension);
+}
+
+bool MeshBinary::IsUpToDate(const std::string& mshPath, uint32_t lodVersion) {
+	if (!BinaryFile::IsUpToDate(Format, PathFor(mshPath), mshPath)) {
+		return false;
+	}
+	Header header;
+	return BinaryFile::ReadHeader(Format, PathFor(mshPath), header)
+		&& (lodVersion == 0 || header.lodVersion == 0 || header.lodVersion == lodVersion);
+}
@@ -0,0 +1,57 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace NCL::Rendering {
+	class Mesh;
+
+	// Meshes converted ahead of time from .msh text by msh2bin, see BinaryFile
+	// A header and chunk table are followed by each chunk's data, one array per
+	// vertex attribute, aligned so the arrays can be copied straight out
+	class MeshBinary	{
+	public:
+		static const constexpr uint32_t Version = 2;
+		static constexpr const char* Extension = ".mshbin";
+		// Every chunk starts on this boundary, enough for any vector type
+		static const constexpr size_t ChunkAlignment = 16;
+
+		enum class Chunk : uint32_t {
+			Positions,
+			TexCoords,
+			Colours,
+			Normals,
+			Tangents,
+			SkinWeights,
+			SkinIndices,
+			Indices,
+			SubMeshes,
+			SubMeshNames,
+			JointNames,
+			JointParents,
+			BindPose,
+			InverseBindPose,
+			// Levels from LodBuilder, whose indices are in the Indices chunk after the full mesh's
+			Lods
+		};
+
+		// lodVersion is the LodBuilder::Version that built mesh's LODs, if it has any
+		// Throws if the file can't be written
+		static void Save(const std::string& path, const Mesh& mesh, uint32_t lodVersion = 0);
+		// Throws if the file is missing, from another version, or damaged, leaving mesh empty
+		static void Load(const std::string& path, Mesh& mesh);
+
+		// The converted file for a .msh, beside it with the extension swapped
+		static std::string PathFor(const std::string& mshPath);
+		// True if mshPath has been converted by this version since it was last changed
+		// Unless lodVersion is 0, LODs built by any other LodBuilder::Version are out of date too
+		static bool IsUpToDate(const std::string& mshPath, uint32_t lodVersion = 0);
+	};
+}
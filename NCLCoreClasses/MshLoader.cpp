@@ -7,12 +7,28 @@
 #include "Maths.h"
 
 #include "Mesh.h"
+#include "MeshBinary.h"
 
 using namespace NCL;
 using namespace Rendering;
 using namespace Maths;
 
-void MshLoader::LoadMesh(const std::string& filename, Mesh& destinationMesh) {
+void MshLoader::LoadMesh(const std::string& filename, Mesh& destinationMesh, uint32_t lodVersion) {
+	std::string path = Assets::MESHDIR + filename;
+	if (MeshBinary::IsUpToDate(path, lodVersion)) {
+		try {
+			MeshBinary::Load(MeshBinary::PathFor(path), destinationMesh);
+			return;
+		}
+		catch (const std::exception& e) {
+			// A damaged conversion still leaves the text it was made from
+			std::cout << __FUNCTION__ << ": " << e.what() << ", reading " << filename << " instead\n";
+		}
+	}
+	LoadTextMesh(filename, destinationMesh);
+}
+
+void MshLoader::LoadTextMesh(const std::string& filename, Mesh& destinationMesh) {
 	std::ifstream file(Assets::MESHDIR + filename);
 
 	std::string filetype;
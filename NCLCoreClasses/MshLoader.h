@@ -43,7 +43,11 @@ namespace NCL::Rendering {
 	};
 
 	public:
-		static void LoadMesh(const std::string& filename, Mesh& destinationMesh);
+		// Uses the file's msh2bin conversion instead if there is an up to date one
+		// lodVersion is passed to MeshBinary::IsUpToDate, to ignore conversions with LODs from another LodBuilder
+		static void LoadMesh(const std::string& filename, Mesh& destinationMesh, uint32_t lodVersion = 0);
+		// Always parses the .msh text
+		static void LoadTextMesh(const std::string& filename, Mesh& destinationMesh);
 
 	protected:
 		static void* ReadVertexData(GeometryChunkData dataType, GeometryChunkTypes chunkType, int numVertices);
@@ -191,4 +191,54 @@ void SimpleFont::BuildInterleavedVerticesForString(const std::string& text, cons
 
 		currentX += charData.xAdvance;
 	}
-}
\ No newline at end of file
+}
+
+void SimpleFont::WriteInterleavedVerticesForString(const std::string& text, const Maths::Vector2& startPos, const Maths::Vector4& colour, float size, std::span<InterleavedTextVertex> vertices) {
+	int endChar = startChar + numChars;
+
+	float currentX = 0.0f;
+	float currentY = startPos.y;
+
+	InterleavedTextVertex* v = vertices.data();
+
+	for (size_t i = 0; i < text.length(); ++i) {
+		int charIndex = (int)text[i];
+
+		if (charIndex == '\n') {
+			currentX = 0.0f;
+			currentY += 4;
+		}
+
+		if (charIndex < startChar) {
+			continue;
+		}
+		if (charIndex > endChar) {
+			continue;
+		}
+		FontChar& charData = allCharData[charIndex - startChar];
+
+		float charWidth = (float)((charData.x1 - charData.x0) / texWidth) * size;
+		float charHeight = (float)(charData.y1 - charData.y0);
+
+		float xStart = startPos.x + ((charData.xOff + currentX) * texWidthRecip) * size;
+		float xEnd = xStart + charWidth;
+		float yBottom = currentY + ((charHeight + charData.yOff) * texHeightRecip) * size;
+		float yTop = yBottom - (charHeight * texHeightRecip) * size;
+
+		float u0 = charData.x0 * texWidthRecip;
+		float u1 = charData.x1 * texWidthRecip;
+		float v0 = charData.y0 * texHeightRecip;
+		float v1 = charData.y1 * texHeightRecip;
+
+		v[0] = { Vector2(xStart, yBottom), Vector2(u0, v1), colour };
+		v[1] = { Vector2(xStart, yTop), Vector2(u0, v0), colour };
+		v[2] = { Vector2(xEnd, yTop), Vector2(u1, v0), colour };
+
+		v[3] = { Vector2(xEnd, yTop), Vector2(u1, v0), colour };
+		v[4] = { Vector2(xEnd, yBottom), Vector2(u1, v1), colour };
+		v[5] = { Vector2(xStart, yBottom), Vector2(u0, v1), colour };
+		v += 6;
+
+		currentX += charData.xAdvance;
+	}
+}
@@ -8,6 +8,7 @@ https://research.ncl.ac.uk/game/
 */
 #pragma once
 #include "Vector.h"
+#include <span>
 
 namespace NCL {
 	namespace Rendering {
@@ -27,6 +28,8 @@ namespace NCL {
 			int  GetVertexCountForString(const std::string& text);
 			void BuildVerticesForString(const std::string& text, const Maths::Vector2& startPos, const Maths::Vector4& colour, float size, std::vector<Maths::Vector3>& positions, std::vector<Maths::Vector2>& texCoords, std::vector<Maths::Vector4>& colours);
 			void BuildInterleavedVerticesForString(const std::string& text, const Maths::Vector2& startPos, const Maths::Vector4& colour, float size, std::vector<InterleavedTextVertex>& vertices);
+			//Writes the same vertices as BuildVerticesForString, interleaved, into space for GetVertexCountForString of them
+			void WriteInterleavedVerticesForString(const std::string& text, const Maths::Vector2& startPos, const Maths::Vector4& colour, float size, std::span<InterleavedTextVertex> vertices);
 			
 			const Texture* GetTexture() const {
 				return &texture;
@@ -0,0 +1,44 @@
+#include "StreamRing.h"
+#include <algorithm>
+
+using namespace NCL::Rendering;
+
+namespace {
+	// Keeps every region start aligned for anything a graphics API is likely to ask for
+	const size_t RegionAlignment = 256;
+
+	size_t AlignUp(size_t value, size_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+StreamRing::StreamRing(size_t regionSize, size_t regionCount) : regionCount(std::max<size_t>(regionCount, 1)) {
+	Resize(regionSize);
+}
+
+size_t StreamRing::BeginFrame() {
+	region	= (region + 1) % regionCount;
+	head	= 0;
+	return region;
+}
+
+size_t StreamRing::Allocate(size_t size, size_t alignment) {
+	size_t regionStart	= region * regionSize;
+	size_t offset		= AlignUp(regionStart + head, std::max<size_t>(alignment, 1));
+	if (offset + size > regionStart + regionSize) {
+		return NoSpace;
+	}
+	head		= offset + size - regionStart;
+	peakUsed	= std::max(peakUsed, head);
+	return offset;
+}
+
+size_t StreamRing::EndFrame() {
+	return region;
+}
+
+void StreamRing::Resize(size_t newRegionSize) {
+	regionSize	= AlignUp(std::max<size_t>(newRegionSize, 1), RegionAlignment);
+	region		= 0;
+	head		= 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+
+namespace NCL::Rendering {
+	// Hands out space in a buffer that is rewritten every frame
+	// The buffer is split into regions, and each frame writes only to its own
+	// region. With three regions, the CPU can fill one while the GPU still
+	// reads from the two frames before it, so neither waits on the other.
+	// Knows nothing about the graphics API, the caller fences each region
+	class StreamRing {
+	public:
+		static const constexpr size_t NoSpace = ~size_t(0);
+
+		StreamRing(size_t regionSize, size_t regionCount = 3);
+
+		// Moves on to the next region, which the caller must wait for the GPU to finish with
+		size_t BeginFrame();
+		// Offset from the start of the buffer, or NoSpace if the frame's region is full
+		size_t Allocate(size_t size, size_t alignment = 16);
+		// The region written this frame, which the caller should fence
+		size_t EndFrame();
+
+		// Empties every region, for when the buffer is recreated at a new size
+		void Resize(size_t newRegionSize);
+
+		size_t GetRegionSize() const {
+			return regionSize;
+		}
+		size_t GetRegionCount() const {
+			return regionCount;
+		}
+		size_t GetBufferSize() const {
+			return regionSize * regionCount;
+		}
+		size_t GetCurrentRegion() const {
+			return region;
+		}
+		// Bytes used in the current region, including alignment padding
+		size_t GetFrameUsed() const {
+			return head;
+		}
+		// Most bytes any frame has needed
+		size_t GetPeakUsed() const {
+			return peakUsed;
+		}
+
+	protected:
+		size_t regionSize;
+		size_t regionCount;
+		size_t region	= 0;
+		size_t head		= 0;
+		size_t peakUsed = 0;
+	};
+}
@@ -0,0 +1,123 @@
+#include "TextureBinary.h"
+#include "BinaryFile.h"
+#include "TextureLoader.h"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+using namespace NCL;
+using namespace Rendering;
+
+namespace {
+	const BinaryFile::Format Format = {
+		{ 'N', 'C', 'L', 'T', 'E', 'X', '\0', '\0' }, TextureBinary::Version, "baked texture", "bake it again with msh2bin"
+	};
+
+	struct Header {
+		char		magic[8];
+		uint32_t	version;
+		uint32_t	format;
+		uint32_t	width;
+		uint32_t	height;
+		uint32_t	levelCount;
+		uint32_t	padding;
+	};
+	static_assert(sizeof(Header) == 32);
+
+	struct LevelEntry {
+		uint64_t	offset;
+		uint64_t	size;
+	};
+	static_assert(sizeof(LevelEntry) == 16);
+
+	size_t Align(size_t offset) {
+		return BinaryFile::Align(offset, TextureBinary::LevelAlignment);
+	}
+}
+
+void TextureBinary::Bake(const std::string& path, const uint8_t* rgba, uint32_t width, uint32_t height, TextureFormat format) {
+	std::vector<std::vector<uint8_t>> mips = TextureCompressor::BuildMipChain(rgba, width, height);
+
+	Header header = BinaryFile::NewHeader<Header>(Format);
+	header.format		= (uint32_t)format;
+	header.width		= width;
+	header.height		= height;
+	header.levelCount	= (uint32_t)mips.size();
+
+	std::vector<LevelEntry> entries(mips.size());
+	std::vector<std::vector<uint8_t>> levels(mips.size());
+	size_t offset = Align(sizeof(Header) + entries.size() * sizeof(LevelEntry));
+	for (size_t i = 0; i < mips.size(); i++) {
+		uint32_t levelWidth		= TextureCompressor::LevelSize(width, (uint32_t)i);
+		uint32_t levelHeight	= TextureCompressor::LevelSize(height, (uint32_t)i);
+		levels[i] = TextureCompressor::Compress(format, mips[i].data(), levelWidth, levelHeight);
+		entries[i] = { offset, levels[i].size() };
+		offset = Align(offset + levels[i].size());
+	}
+
+	std::vector<char> file(offset, 0);
+	memcpy(file.data(), &header, sizeof(Header));
+	memcpy(file.data() + sizeof(Header), entries.data(), entries.size() * sizeof(LevelEntry));
+	for (size_t i = 0; i < levels.size(); i++) {
+		memcpy(file.data() + entries[i].offset, levels[i].data(), levels[i].size());
+	}
+	BinaryFile::Write(Format, path, file);
+}
+
+void TextureBinary::Load(const std::string& path, Image& image) {
+	Header header;
+	MappedFile file = BinaryFile::Open(Format, path, header);
+	std::span<const char> bytes = file.GetBytes();
+	if (header.format > (uint32_t)TextureFormat::BC7 || header.levelCount == 0
+		|| header.levelCount > TextureCompressor::LevelCount(header.width, header.height)
+		|| bytes.size() < sizeof(Header) + header.levelCount * sizeof(LevelEntry)) {
+		BinaryFile::Damaged(Format, path);
+	}
+
+	image.format	= (TextureFormat)header.format;
+	image.width		= header.width;
+	image.height	= header.height;
+	image.levels.resize(header.levelCount);
+	for (uint32_t i = 0; i < header.levelCount; i++) {
+		LevelEntry entry;
+		memcpy(&entry, bytes.data() + sizeof(Header) + i * sizeof(LevelEntry), sizeof(LevelEntry));
+		Level& level	= image.levels[i];
+		level.width		= TextureCompressor::LevelSize(header.width, i);
+		level.height	= TextureCompressor::LevelSize(header.height, i);
+		if (entry.size != TextureCompressor::ImageSize(image.format, level.width, level.height)
+			|| entry.offset > bytes.size() || entry.size > bytes.size() - entry.offset) {
+			BinaryFile::Damaged(Format, path);
+		}
+		level.data = bytes.data() + entry.offset;
+		level.size = entry.size;
+	}
+	// The levels stay in the file, which lives as long as the image
+	image.file = std::move(file);
+}
+
+bool TextureBinary::LoadFunction(const std::string& path, char*& outData, uint32_t& width, uint32_t& height, uint32_t& channels, int& flags) {
+	Image* image = new Image();
+	try {
+		Load(path, *image);
+	}
+	catch (const std::exception& e) {
+		std::cout << __FUNCTION__ << " " << e.what() << "\n";
+		delete image;
+		return false;
+	}
+	outData		= (char*)image;
+	width		= image->width;
+	height		= image->height;
+	channels	= 4;
+	flags		|= TextureLoader::BakedImage;
+	return true;
+}
+
+std::string TextureBinary::PathFor(const std::string& imagePath) {
+	return BinaryFile::PathFor(imagePath, Extension);
+}
+
+bool TextureBinary::IsUpToDate(const std::string& imagePath) {
+	return BinaryFile::IsUpToDate(Format, PathFor(imagePath), imagePath);
+}
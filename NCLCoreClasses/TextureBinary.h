@@ -0,0 +1,60 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "TextureCompressor.h"
+
+namespace NCL::Rendering {
+	// Textures baked ahead of time from images by msh2bin, see BinaryFile, with every
+	// mip level already built and block compressed, ready to hand straight to the GPU
+	// A header and level table are followed by each level's data, used in place
+	class TextureBinary	{
+	public:
+		static const constexpr uint32_t Version = 1;
+		static constexpr const char* Extension = ".texbin";
+		// Every level starts on this boundary
+		static const constexpr size_t LevelAlignment = 16;
+
+		struct Level {
+			const char*	data;
+			size_t		size;
+			uint32_t	width;
+			uint32_t	height;
+		};
+
+		// A loaded texture, whose levels point into the file it keeps mapped
+		struct Image {
+			TextureFormat		format	= TextureFormat::RGBA8;
+			uint32_t			width	= 0;
+			uint32_t			height	= 0;
+			// Largest first
+			std::vector<Level>	levels;
+			MappedFile			file;
+		};
+
+		// Builds the mip chain of an RGBA image and compresses every level into format
+		// Throws if the file can't be written
+		static void Bake(const std::string& path, const uint8_t* rgba, uint32_t width, uint32_t height, TextureFormat format);
+		// Throws if the file is missing, from another version, or damaged
+		static void Load(const std::string& path, Image& image);
+
+		// For TextureLoader::RegisterTextureLoadFunction. Fills outData with a new Image
+		// and sets TextureLoader::BakedImage in flags, see TextureLoader::GetBakedImage
+		static bool LoadFunction(const std::string& path, char*& outData, uint32_t& width, uint32_t& height, uint32_t& channels, int& flags);
+
+		// The baked file for an image, beside it with the extension swapped
+		static std::string PathFor(const std::string& imagePath);
+		// True if imagePath has been baked by this version since it was last changed
+		static bool IsUpToDate(const std::string& imagePath);
+	};
+}
@@ -0,0 +1,555 @@
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace NCL;
+using namespace Rendering;
+
+namespace {
+	size_t BlockBytes(TextureFormat format) {
+		return format == TextureFormat::BC1 ? 8 : 16;
+	}
+
+	// The line through the block's pixels that best fits them, in the first channels channels
+	void PrincipalAxis(const uint8_t pixels[64], int channels, float mean[4], float axis[4]) {
+		for (int c = 0; c < 4; c++) {
+			mean[c] = 0.0f;
+			axis[c] = 0.0f;
+			for (int i = 0; i < 16; i++) {
+				mean[c] += pixels[i * 4 + c];
+			}
+			mean[c] /= 16.0f;
+		}
+		float covariance[4][4] = {};
+		for (int i = 0; i < 16; i++) {
+			for (int a = 0; a < channels; a++) {
+				for (int b = 0; b < channels; b++) {
+					covariance[a][b] += (pixels[i * 4 + a] - mean[a]) * (pixels[i * 4 + b] - mean[b]);
+				}
+			}
+		}
+		// Power iteration, starting from the channel that varies most
+		int widest = 0;
+		for (int c = 1; c < channels; c++) {
+			if (covariance[c][c] > covariance[widest][widest]) {
+				widest = c;
+			}
+		}
+		if (covariance[widest][widest] <= 0.0f) {
+			return;
+		}
+		for (int c = 0; c < channels; c++) {
+			axis[c] = covariance[widest][c];
+		}
+		for (int iteration = 0; iteration < 8; iteration++) {
+			float next[4] = {};
+			float length = 0.0f;
+			for (int a = 0; a < channels; a++) {
+				for (int b = 0; b < channels; b++) {
+					next[a] += covariance[a][b] * axis[b];
+				}
+				length += next[a] * next[a];
+			}
+			if (length <= 0.0f) {
+				return;
+			}
+			length = std::sqrt(length);
+			for (int c = 0; c < channels; c++) {
+				axis[c] = next[c] / length;
+			}
+		}
+	}
+
+	// The furthest pixels along the axis either side of the mean
+	void AxisExtents(const uint8_t pixels[64], int channels, const float mean[4], const float axis[4], float low[4], float high[4]) {
+		float lowT = FLT_MAX;
+		float highT = -FLT_MAX;
+		for (int i = 0; i < 16; i++) {
+			float t = 0.0f;
+			for (int c = 0; c < channels; c++) {
+				t += (pixels[i * 4 + c] - mean[c]) * axis[c];
+			}
+			lowT = std::min(lowT, t);
+			highT = std::max(highT, t);
+		}
+		for (int c = 0; c < 4; c++) {
+			low[c] = mean[c] + axis[c] * lowT;
+			high[c] = mean[c] + axis[c] * highT;
+		}
+	}
+
+	int Distance(const uint8_t* pixel, const int* colour, int channels) {
+		int distance = 0;
+		for (int c = 0; c < channels; c++) {
+			int d = pixel[c] - colour[c];
+			distance += d * d;
+		}
+		return distance;
+	}
+
+	uint16_t To565(const float colour[3]) {
+		int r = std::clamp((int)std::lround(colour[0] * 31.0f / 255.0f), 0, 31);
+		int g = std::clamp((int)std::lround(colour[1] * 63.0f / 255.0f), 0, 63);
+		int b = std::clamp((int)std::lround(colour[2] * 31.0f / 255.0f), 0, 31);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	void From565(uint16_t packed, int colour[3]) {
+		int r = (packed >> 11) & 31;
+		int g = (packed >> 5) & 63;
+		int b = packed & 31;
+		colour[0] = (r << 3) | (r >> 2);
+		colour[1] = (g << 2) | (g >> 4);
+		colour[2] = (b << 3) | (b >> 2);
+	}
+
+	// Both endpoints and the two colours a third of the way between them
+	void ColourPalette(uint16_t c0, uint16_t c1, bool fourColours, int palette[4][4]) {
+		From565(c0, palette[0]);
+		From565(c1, palette[1]);
+		for (int c = 0; c < 3; c++) {
+			if (fourColours) {
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			else {
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		palette[0][3] = palette[1][3] = palette[2][3] = 255;
+		palette[3][3] = fourColours ? 255 : 0;
+	}
+
+	// Picks the nearest palette entry for every pixel, returning the total error
+	int ColourIndices(const uint8_t pixels[64], uint16_t c0, uint16_t c1, uint32_t& indices) {
+		indices = 0;
+		if (c0 == c1) {
+			int colour[3];
+			From565(c0, colour);
+			int error = 0;
+			for (int i = 0; i < 16; i++) {
+				error += Distance(&pixels[i * 4], colour, 3);
+			}
+			return error;
+		}
+		int palette[4][4];
+		ColourPalette(c0, c1, true, palette);
+		int error = 0;
+		for (int i = 0; i < 16; i++) {
+			int best = 0;
+			int bestDistance = Distance(&pixels[i * 4], palette[0], 3);
+			for (int p = 1; p < 4; p++) {
+				int distance = Distance(&pixels[i * 4], palette[p], 3);
+				if (distance < bestDistance) {
+					best = p;
+					bestDistance = distance;
+				}
+			}
+			indices |= (uint32_t)best << (2 * i);
+			error += bestDistance;
+		}
+		return error;
+	}
+
+	// Always four colours, c0 ordered above c1 as BC1 needs
+	void EncodeColour(const uint8_t pixels[64], uint8_t out[8]) {
+		float mean[4], axis[4], low[4], high[4];
+		PrincipalAxis(pixels, 3, mean, axis);
+		AxisExtents(pixels, 3, mean, axis, low, high);
+
+		uint16_t c0 = To565(high);
+		uint16_t c1 = To565(low);
+		uint32_t indices;
+		int error = ColourIndices(pixels, c0, c1, indices);
+
+		// Least squares fit of the endpoints to the chosen indices, kept if it does better
+		if (c0 != c1) {
+			const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+			float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+			float ax[3] = {}, bx[3] = {};
+			for (int i = 0; i < 16; i++) {
+				float a = weights[(indices >> (2 * i)) & 3];
+				float b = 1.0f - a;
+				aa += a * a;
+				bb += b * b;
+				ab += a * b;
+				for (int c = 0; c < 3; c++) {
+					ax[c] += a * pixels[i * 4 + c];
+					bx[c] += b * pixels[i * 4 + c];
+				}
+			}
+			float determinant = aa * bb - ab * ab;
+			if (std::abs(determinant) > 1e-6f) {
+				float fitHigh[3], fitLow[3];
+				for (int c = 0; c < 3; c++) {
+					fitHigh[c] = (ax[c] * bb - bx[c] * ab) / determinant;
+					fitLow[c] = (bx[c] * aa - ax[c] * ab) / determinant;
+				}
+				uint16_t fit0 = To565(fitHigh);
+				uint16_t fit1 = To565(fitLow);
+				uint32_t fitIndices;
+				int fitError = ColourIndices(pixels, std::max(fit0, fit1), std::min(fit0, fit1), fitIndices);
+				if (fitError < error) {
+					c0 = std::max(fit0, fit1);
+					c1 = std::min(fit0, fit1);
+					indices = fitIndices;
+					error = fitError;
+				}
+			}
+		}
+		if (c0 < c1) {
+			std::swap(c0, c1);
+			ColourIndices(pixels, c0, c1, indices);
+		}
+
+		out[0] = c0 & 0xFF;
+		out[1] = c0 >> 8;
+		out[2] = c1 & 0xFF;
+		out[3] = c1 >> 8;
+		for (int b = 0; b < 4; b++) {
+			out[4 + b] = (indices >> (8 * b)) & 0xFF;
+		}
+	}
+
+	void DecodeColour(const uint8_t block[8], bool alwaysFourColours, uint8_t pixels[64]) {
+		uint16_t c0 = block[0] | (block[1] << 8);
+		uint16_t c1 = block[2] | (block[3] << 8);
+		uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+		int palette[4][4];
+		ColourPalette(c0, c1, alwaysFourColours || c0 > c1, palette);
+		for (int i = 0; i < 16; i++) {
+			const int* colour = palette[(indices >> (2 * i)) & 3];
+			for (int c = 0; c < 4; c++) {
+				pixels[i * 4 + c] = (uint8_t)colour[c];
+			}
+		}
+	}
+
+	// Eight alphas from the highest to the lowest in the block
+	void EncodeAlpha(const uint8_t pixels[64], uint8_t out[8]) {
+		int high = 0;
+		int low = 255;
+		for (int i = 0; i < 16; i++) {
+			high = std::max<int>(high, pixels[i * 4 + 3]);
+			low = std::min<int>(low, pixels[i * 4 + 3]);
+		}
+		out[0] = (uint8_t)high;
+		out[1] = (uint8_t)low;
+		uint64_t indices = 0;
+		if (high > low) {
+			int palette[8] = { high, low };
+			for (int k = 2; k < 8; k++) {
+				palette[k] = ((8 - k) * high + (k - 1) * low) / 7;
+			}
+			for (int i = 0; i < 16; i++) {
+				int alpha = pixels[i * 4 + 3];
+				int best = 0;
+				for (int k = 1; k < 8; k++) {
+					if (std::abs(palette[k] - alpha) < std::abs(palette[best] - alpha)) {
+						best = k;
+					}
+				}
+				indices |= (uint64_t)best << (3 * i);
+			}
+		}
+		for (int b = 0; b < 6; b++) {
+			out[2 + b] = (indices >> (8 * b)) & 0xFF;
+		}
+	}
+
+	void DecodeAlpha(const uint8_t block[8], uint8_t pixels[64]) {
+		int palette[8] = { block[0], block[1] };
+		if (palette[0] > palette[1]) {
+			for (int k = 2; k < 8; k++) {
+				palette[k] = ((8 - k) * palette[0] + (k - 1) * palette[1]) / 7;
+			}
+		}
+		else {
+			for (int k = 2; k < 6; k++) {
+				palette[k] = ((6 - k) * palette[0] + (k - 1) * palette[1]) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+		uint64_t indices = 0;
+		for (int b = 0; b < 6; b++) {
+			indices |= (uint64_t)block[2 + b] << (8 * b);
+		}
+		for (int i = 0; i < 16; i++) {
+			pixels[i * 4 + 3] = (uint8_t)palette[(indices >> (3 * i)) & 7];
+		}
+	}
+
+	// BC7 packs its fields from the lowest bit of the first byte up
+	struct BitWriter {
+		uint8_t*	out;
+		int			position = 0;
+
+		void Put(uint32_t value, int bits) {
+			for (int b = 0; b < bits; b++, position++) {
+				if ((value >> b) & 1) {
+					out[position >> 3] |= (uint8_t)(1 << (position & 7));
+				}
+			}
+		}
+	};
+
+	struct BitReader {
+		const uint8_t*	in;
+		int				position = 0;
+
+		uint32_t Get(int bits) {
+			uint32_t value = 0;
+			for (int b = 0; b < bits; b++, position++) {
+				value |= (uint32_t)((in[position >> 3] >> (position & 7)) & 1) << b;
+			}
+			return value;
+		}
+	};
+
+	const int BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	void BC7Palette(const int endpoint0[4], const int endpoint1[4], int palette[16][4]) {
+		for (int k = 0; k < 16; k++) {
+			for (int c = 0; c < 4; c++) {
+				palette[k][c] = ((64 - BC7Weights[k]) * endpoint0[c] + BC7Weights[k] * endpoint1[c] + 32) >> 6;
+			}
+		}
+	}
+}
+
+uint32_t TextureCompressor::LevelCount(uint32_t width, uint32_t height) {
+	uint32_t levels = 1;
+	for (uint32_t size = std::max(width, height); size > 1; size >>= 1) {
+		levels++;
+	}
+	return levels;
+}
+
+std::vector<std::vector<uint8_t>> TextureCompressor::BuildMipChain(const uint8_t* rgba, uint32_t width, uint32_t height) {
+	std::vector<std::vector<uint8_t>> levels;
+	levels.emplace_back(rgba, rgba + (size_t)width * height * 4);
+	while (width > 1 || height > 1) {
+		const std::vector<uint8_t>& source = levels.back();
+		uint32_t nextWidth	= std::max(width / 2, 1u);
+		uint32_t nextHeight	= std::max(height / 2, 1u);
+		std::vector<uint8_t> next((size_t)nextWidth * nextHeight * 4);
+		for (uint32_t y = 0; y < nextHeight; y++) {
+			uint32_t y0 = std::min(y * 2, height - 1);
+			uint32_t y1 = std::min(y * 2 + 1, height - 1);
+			for (uint32_t x = 0; x < nextWidth; x++) {
+				uint32_t x0 = std::min(x * 2, width - 1);
+				uint32_t x1 = std::min(x * 2 + 1, width - 1);
+				for (int c = 0; c < 4; c++) {
+					int sum = source[((size_t)y0 * width + x0) * 4 + c] + source[((size_t)y0 * width + x1) * 4 + c]
+						+ source[((size_t)y1 * width + x0) * 4 + c] + source[((size_t)y1 * width + x1) * 4 + c];
+					next[((size_t)y * nextWidth + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+				}
+			}
+		}
+		levels.push_back(std::move(next));
+		width	= nextWidth;
+		height	= nextHeight;
+	}
+	return levels;
+}
+
+size_t TextureCompressor::ImageSize(TextureFormat format, uint32_t width, uint32_t height) {
+	if (format == TextureFormat::RGBA8) {
+		return (size_t)width * height * 4;
+	}
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * BlockBytes(format);
+}
+
+TextureFormat TextureCompressor::ChooseFormat(const uint8_t* rgba, uint32_t width, uint32_t height) {
+	for (size_t i = 0; i < (size_t)width * height; i++) {
+		if (rgba[i * 4 + 3] != 255) {
+			return TextureFormat::BC3;
+		}
+	}
+	return TextureFormat::BC1;
+}
+
+std::vector<uint8_t> TextureCompressor::Compress(TextureFormat format, const uint8_t* rgba, uint32_t width, uint32_t height) {
+	if (format == TextureFormat::RGBA8) {
+		return std::vector<uint8_t>(rgba, rgba + ImageSize(format, width, height));
+	}
+	std::vector<uint8_t> out(ImageSize(format, width, height), 0);
+	size_t blockBytes = BlockBytes(format);
+	uint8_t* block = out.data();
+	for (uint32_t by = 0; by < height; by += 4) {
+		for (uint32_t bx = 0; bx < width; bx += 4) {
+			uint8_t pixels[64];
+			for (uint32_t y = 0; y < 4; y++) {
+				for (uint32_t x = 0; x < 4; x++) {
+					size_t source = ((size_t)std::min(by + y, height - 1) * width + std::min(bx + x, width - 1)) * 4;
+					memcpy(&pixels[(y * 4 + x) * 4], &rgba[source], 4);
+				}
+			}
+			switch (format) {
+				case TextureFormat::BC1: CompressBC1Block(pixels, block); break;
+				case TextureFormat::BC3: CompressBC3Block(pixels, block); break;
+				case TextureFormat::BC7: CompressBC7Block(pixels, block); break;
+				default: break;
+			}
+			block += blockBytes;
+		}
+	}
+	return out;
+}
+
+std::vector<uint8_t> TextureCompressor::Decompress(TextureFormat format, const uint8_t* data, uint32_t width, uint32_t height) {
+	if (format == TextureFormat::RGBA8) {
+		return std::vector<uint8_t>(data, data + ImageSize(format, width, height));
+	}
+	std::vector<uint8_t> out((size_t)width * height * 4);
+	size_t blockBytes = BlockBytes(format);
+	const uint8_t* block = data;
+	for (uint32_t by = 0; by < height; by += 4) {
+		for (uint32_t bx = 0; bx < width; bx += 4) {
+			uint8_t pixels[64];
+			switch (format) {
+				case TextureFormat::BC1: DecompressBC1Block(block, pixels); break;
+				case TextureFormat::BC3: DecompressBC3Block(block, pixels); break;
+				case TextureFormat::BC7: DecompressBC7Block(block, pixels); break;
+				default: break;
+			}
+			for (uint32_t y = 0; y < 4 && by + y < height; y++) {
+				for (uint32_t x = 0; x < 4 && bx + x < width; x++) {
+					memcpy(&out[((size_t)(by + y) * width + bx + x) * 4], &pixels[(y * 4 + x) * 4], 4);
+				}
+			}
+			block += blockBytes;
+		}
+	}
+	return out;
+}
+
+void TextureCompressor::CompressBC1Block(const uint8_t pixels[64], uint8_t out[8]) {
+	EncodeColour(pixels, out);
+}
+
+void TextureCompressor::CompressBC3Block(const uint8_t pixels[64], uint8_t out[16]) {
+	EncodeAlpha(pixels, out);
+	EncodeColour(pixels, out + 8);
+}
+
+void TextureCompressor::CompressBC7Block(const uint8_t pixels[64], uint8_t out[16]) {
+	float mean[4], axis[4], low[4], high[4];
+	PrincipalAxis(pixels, 4, mean, axis);
+	AxisExtents(pixels, 4, mean, axis, low, high);
+
+	// Endpoints are 7 bits a channel, plus a shared lowest bit each, so every pair of those bits is tried
+	int bestError = INT32_MAX;
+	int bestQuantised[2][4] = {};
+	int bestP[2] = {};
+	int bestIndices[16] = {};
+	for (int p0 = 0; p0 < 2; p0++) {
+		for (int p1 = 0; p1 < 2; p1++) {
+			int quantised[2][4];
+			int endpoints[2][4];
+			for (int c = 0; c < 4; c++) {
+				quantised[0][c] = std::clamp((int)std::lround((low[c] - p0) / 2.0f), 0, 127);
+				quantised[1][c] = std::clamp((int)std::lround((high[c] - p1) / 2.0f), 0, 127);
+				endpoints[0][c] = (quantised[0][c] << 1) | p0;
+				endpoints[1][c] = (quantised[1][c] << 1) | p1;
+			}
+			int palette[16][4];
+			BC7Palette(endpoints[0], endpoints[1], palette);
+
+			int error = 0;
+			int indices[16];
+			for (int i = 0; i < 16; i++) {
+				int best = 0;
+				int bestDistance = Distance(&pixels[i * 4], palette[0], 4);
+				for (int k = 1; k < 16; k++) {
+					int distance = Distance(&pixels[i * 4], palette[k], 4);
+					if (distance < bestDistance) {
+						best = k;
+						bestDistance = distance;
+					}
+				}
+				indices[i] = best;
+				error += bestDistance;
+			}
+			if (error < bestError) {
+				bestError = error;
+				memcpy(bestQuantised, quantised, sizeof(quantised));
+				bestP[0] = p0;
+				bestP[1] = p1;
+				memcpy(bestIndices, indices, sizeof(indices));
+			}
+		}
+	}
+
+	// The first pixel's index is stored without its top bit, so it must be under 8
+	// The weights are symmetric, so swapping the endpoints and flipping every index
+	// gives exactly the same colours
+	if (bestIndices[0] >= 8) {
+		std::swap(bestQuantised[0], bestQuantised[1]);
+		std::swap(bestP[0], bestP[1]);
+		for (int& index : bestIndices) {
+			index = 15 - index;
+		}
+	}
+
+	memset(out, 0, 16);
+	BitWriter writer{ out };
+	writer.Put(1 << 6, 7);
+	for (int c = 0; c < 4; c++) {
+		writer.Put(bestQuantised[0][c], 7);
+		writer.Put(bestQuantised[1][c], 7);
+	}
+	writer.Put(bestP[0], 1);
+	writer.Put(bestP[1], 1);
+	writer.Put(bestIndices[0], 3);
+	for (int i = 1; i < 16; i++) {
+		writer.Put(bestIndices[i], 4);
+	}
+}
+
+void TextureCompressor::DecompressBC1Block(const uint8_t block[8], uint8_t pixels[64]) {
+	DecodeColour(block, false, pixels);
+}
+
+void TextureCompressor::DecompressBC3Block(const uint8_t block[16], uint8_t pixels[64]) {
+	DecodeColour(block + 8, true, pixels);
+	DecodeAlpha(block, pixels);
+}
+
+void TextureCompressor::DecompressBC7Block(const uint8_t block[16], uint8_t pixels[64]) {
+	if ((block[0] & 0x7F) != 0x40) {
+		for (int i = 0; i < 16; i++) {
+			pixels[i * 4 + 0] = 255;
+			pixels[i * 4 + 1] = 0;
+			pixels[i * 4 + 2] = 255;
+			pixels[i * 4 + 3] = 255;
+		}
+		return;
+	}
+	BitReader reader{ block };
+	reader.Get(7);
+	int endpoints[2][4];
+	for (int c = 0; c < 4; c++) {
+		endpoints[0][c] = reader.Get(7) << 1;
+		endpoints[1][c] = reader.Get(7) << 1;
+	}
+	int p0 = reader.Get(1);
+	int p1 = reader.Get(1);
+	for (int c = 0; c < 4; c++) {
+		endpoints[0][c] |= p0;
+		endpoints[1][c] |= p1;
+	}
+	int palette[16][4];
+	BC7Palette(endpoints[0], endpoints[1], palette);
+	for (int i = 0; i < 16; i++) {
+		int index = reader.Get(i == 0 ? 3 : 4);
+		for (int c = 0; c < 4; c++) {
+			pixels[i * 4 + c] = (uint8_t)palette[index][c];
+		}
+	}
+}
@@ -0,0 +1,60 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace NCL::Rendering {
+	enum class TextureFormat : uint32_t {
+		// Plain 8 bit RGBA, for anything that shouldn't be compressed
+		RGBA8,
+		// 4 bits a pixel, colour only
+		BC1,
+		// 8 bits a pixel, BC1 colour with a separate alpha block
+		BC3,
+		// 8 bits a pixel, higher quality colour and alpha
+		BC7
+	};
+
+	// Builds mip chains and block compresses them, for baking textures ahead of time
+	// Images are 8 bit RGBA, rows top to bottom. Compressed formats work on 4x4 pixel
+	// blocks, with edge pixels repeated to fill blocks hanging off the image. BC7
+	// blocks are only ever written in mode 6, a single pair of RGBA endpoints with 16
+	// steps between them, which keeps the encoder small at some cost in quality
+	class TextureCompressor	{
+	public:
+		// Each level half the size of the last down to 1x1, averaging 2x2 pixels
+		static std::vector<std::vector<uint8_t>> BuildMipChain(const uint8_t* rgba, uint32_t width, uint32_t height);
+
+		static uint32_t LevelSize(uint32_t size, uint32_t level) {
+			uint32_t s = size >> level;
+			return s ? s : 1;
+		}
+		static uint32_t LevelCount(uint32_t width, uint32_t height);
+
+		// Bytes a width by height image takes in format
+		static size_t ImageSize(TextureFormat format, uint32_t width, uint32_t height);
+		// BC3 if any pixel is translucent, otherwise BC1
+		static TextureFormat ChooseFormat(const uint8_t* rgba, uint32_t width, uint32_t height);
+
+		static std::vector<uint8_t> Compress(TextureFormat format, const uint8_t* rgba, uint32_t width, uint32_t height);
+		// Back to RGBA, to check what compression lost
+		static std::vector<uint8_t> Decompress(TextureFormat format, const uint8_t* data, uint32_t width, uint32_t height);
+
+		// One block of 16 pixels, row by row
+		static void CompressBC1Block(const uint8_t pixels[64], uint8_t out[8]);
+		static void CompressBC3Block(const uint8_t pixels[64], uint8_t out[16]);
+		static void CompressBC7Block(const uint8_t pixels[64], uint8_t out[16]);
+
+		static void DecompressBC1Block(const uint8_t block[8], uint8_t pixels[64]);
+		static void DecompressBC3Block(const uint8_t block[16], uint8_t pixels[64]);
+		// Only mode 6 is understood, other modes decode to magenta
+		static void DecompressBC7Block(const uint8_t block[16], uint8_t pixels[64]);
+	};
+}
@@ -18,7 +18,7 @@ using namespace Rendering;
 
 std::map<std::string, TextureLoadFunction> TextureLoader::fileHandlers;
 
-bool TextureLoader::LoadTexture(const std::string& filename, char*& outData, uint32_t& width, uint32_t& height, uint32_t& channels, int& flags) {
+bool TextureLoader::LoadTexture(const std::string& filename, char*& outData, uint32_t& width, uint32_t& height, uint32_t& channels, int& flags, bool allowBaked) {
 	if (filename.empty()) {
 		return false;
 	}
@@ -33,6 +33,16 @@ bool TextureLoader::LoadTexture(const std::string& filename, char*& outData, uin
 
 	std::string realPath = isAbsolute ? filename : Assets::TEXTUREDIR + filename;
 
+	auto baked = fileHandlers.find(TextureBinary::Extension);
+	// A baked image comes back with BakedImage set in flags, making outData a TextureBinary::Image
+	// rather than malloc'd pixels, so it must be freed by DeleteTextureData with those flags
+	if (allowBaked && it != baked && baked != fileHandlers.end() && TextureBinary::IsUpToDate(realPath)) {
+		if (baked->second(TextureBinary::PathFor(realPath), outData, width, height, channels, flags)) {
+			return true;
+		}
+		// A damaged or incompatible bake still leaves the image it was made from
+	}
+
 	if (it != fileHandlers.end()) {
 		//There's a custom handler function for this, just use that
 		return it->second(realPath, outData, width, height, channels, flags);
@@ -67,6 +77,14 @@ std::string TextureLoader::GetFileExtension(const std::string& fileExtension) {
 	return ext.string();
 }
 
-void TextureLoader::DeleteTextureData(char* data) {
+const TextureBinary::Image* TextureLoader::GetBakedImage(const char* data, int flags) {
+	return (flags & BakedImage) ? (const TextureBinary::Image*)data : nullptr;
+}
+
+void TextureLoader::DeleteTextureData(char* data, int flags) {
+	if (flags & BakedImage) {
+		delete (TextureBinary::Image*)data;
+		return;
+	}
 	free(data);
 }
\ No newline at end of file
@@ -10,6 +10,8 @@ https://research.ncl.ac.uk/game/
 #include <map>
 #include <functional>
 
+#include "TextureBinary.h"
+
 
 namespace NCL {
 	namespace Rendering {
@@ -22,11 +24,23 @@ namespace NCL {
 
 	class TextureLoader	{
 	public:
-		static bool LoadTexture(const std::string& filename, char*& outData, uint32_t& width, uint32_t& height, uint32_t& channels, int& flags);
+		// Set in flags by a load function whose outData isn't plain pixels
+		enum Flags {
+			// outData is a TextureBinary::Image, with every mip level in its own format
+			BakedImage = 1 << 0
+		};
+
+		// If a load function is registered for TextureBinary::Extension, images with an
+		// up to date baked copy beside them load that instead, unless allowBaked is false
+		static bool LoadTexture(const std::string& filename, char*& outData, uint32_t& width, uint32_t& height, uint32_t& channels, int& flags, bool allowBaked = true);
 
 		static void RegisterTextureLoadFunction(TextureLoadFunction f, const std::string&fileExtension);
 
-		static void DeleteTextureData(char* data);
+		// The baked texture in outData if flags say there is one, or null for plain pixels
+		static const Rendering::TextureBinary::Image* GetBakedImage(const char* data, int flags);
+
+		// flags must be the ones LoadTexture gave back with data, as they say who allocated it
+		static void DeleteTextureData(char* data, int flags);
 	protected:
 
 		static std::string GetFileExtension(const std::string& fileExtension);
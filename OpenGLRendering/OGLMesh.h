@@ -24,6 +24,11 @@ namespace NCL::Rendering {
 		void UploadToGPU(Rendering::RendererBase* renderer = nullptr) override;
 		void UpdateGPUBuffers(unsigned int startVertex, unsigned int vertexCount);
 
+		// False until UploadToGPU succeeds, so meshes still loading can be skipped
+		bool IsUploaded() const {
+			return vao != 0;
+		}
+
 	protected:
 		GLuint	GetVAO()			const { return vao;			}
 		void	BindVertexAttribute(int attribSlot, int bufferID, int bindingID, int elementCount, int elementSize, int elementOffset);
@@ -0,0 +1,149 @@
+/******************************************************************************
+This file is part of the Newcastle OpenGL Tutorial Series
+
+Author:Rich Davison
+Contact:richgdavison@gmail.com
+License: MIT (see LICENSE file at the top of the source tree)
+*/////////////////////////////////////////////////////////////////////////////
+#include "OGLProgramCache.h"
+#include "AssetId.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace NCL;
+using namespace NCL::Rendering;
+
+std::string				OGLProgramCache::directory;
+uint64_t				OGLProgramCache::driverHash = 0;
+OGLProgramCache::Stats	OGLProgramCache::stats;
+
+namespace {
+	const char Magic[8] = { 'N', 'C', 'L', 'P', 'R', 'O', 'G', '\0' };
+	const uint32_t Version = 1;
+
+	struct Header {
+		char		magic[8];
+		uint32_t	version;
+		uint32_t	binaryFormat;
+		uint64_t	key;
+		uint64_t	length;
+	};
+	static_assert(sizeof(Header) == 32);
+
+	std::string GetString(GLenum name) {
+		const char* value = (const char*)glGetString(name);
+		return value ? value : "";
+	}
+}
+
+void OGLProgramCache::SetDirectory(const std::string& newDirectory) {
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	if (formats == 0) {
+		std::cout << __FUNCTION__ << ": Driver can't save program binaries, shaders will build from source\n";
+		directory.clear();
+		return;
+	}
+	directory = newDirectory;
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	std::string driver = GetString(GL_VENDOR) + "\n" + GetString(GL_RENDERER) + "\n" + GetString(GL_VERSION);
+	driverHash = HashBytes(driver);
+}
+
+bool OGLProgramCache::IsEnabled() {
+	return !directory.empty();
+}
+
+uint64_t OGLProgramCache::Key(std::span<const std::string> sources) {
+	uint64_t hash = driverHash;
+	for (const std::string& source : sources) {
+		// The length between stages, so moving text from one stage to the next changes the key
+		uint64_t length = source.size();
+		hash = HashBytes(std::string_view((const char*)&length, sizeof(length)), hash);
+		hash = HashBytes(source, hash);
+	}
+	return hash;
+}
+
+std::string OGLProgramCache::PathFor(uint64_t key) {
+	std::ostringstream name;
+	name << std::hex << std::setw(16) << std::setfill('0') << key << ".glprog";
+	return (std::filesystem::path(directory) / name.str()).string();
+}
+
+bool OGLProgramCache::Load(uint64_t key, GLuint program) {
+	if (!IsEnabled()) {
+		stats.misses++;
+		return false;
+	}
+	std::string path = PathFor(key);
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		stats.misses++;
+		return false;
+	}
+
+	std::error_code error;
+	uint64_t fileSize = std::filesystem::file_size(path, error);
+	Header header;
+	file.read((char*)&header, sizeof(Header));
+	bool valid = file && !error && memcmp(header.magic, Magic, sizeof(Magic)) == 0 && header.version == Version
+		&& header.key == key && header.length == fileSize - sizeof(Header);
+	std::vector<char> binary;
+	if (valid) {
+		binary.resize(header.length);
+		file.read(binary.data(), binary.size());
+		valid = file.gcount() == (std::streamsize)binary.size();
+	}
+
+	GLint linked = GL_FALSE;
+	if (valid) {
+		glProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	}
+	if (linked != GL_TRUE) {
+		// Damaged, or the driver has changed in a way its strings don't show
+		file.close();
+		std::filesystem::remove(path, error);
+		stats.rejected++;
+		return false;
+	}
+	stats.hits++;
+	return true;
+}
+
+void OGLProgramCache::Save(uint64_t key, GLuint program) {
+	if (!IsEnabled()) {
+		return;
+	}
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return;
+	}
+	std::vector<char> binary(length);
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(program, length, &length, &binaryFormat, binary.data());
+
+	Header header = {};
+	memcpy(header.magic, Magic, sizeof(Magic));
+	header.version		= Version;
+	header.binaryFormat	= binaryFormat;
+	header.key			= key;
+	header.length		= (uint64_t)length;
+
+	std::ofstream file(PathFor(key), std::ios::binary | std::ios::trunc);
+	file.write((const char*)&header, sizeof(Header));
+	file.write(binary.data(), length);
+	if (!file) {
+		std::cout << __FUNCTION__ << ": Couldn't write " << PathFor(key) << "\n";
+	}
+}
@@ -0,0 +1,62 @@
+/******************************************************************************
+This file is part of the Newcastle OpenGL Tutorial Series
+
+Author:Rich Davison
+Contact:richgdavison@gmail.com
+License: MIT (see LICENSE file at the top of the source tree)
+*/////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "glad/gl.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace NCL::Rendering {
+	// Linked shader programs saved with glGetProgramBinary, so later runs can skip compiling and linking
+	// Each program is keyed by a hash of its preprocessed sources and the driver's vendor, renderer
+	// and version strings, so editing a shader or updating the driver gives it a new entry. Drivers
+	// may still refuse a binary, in which case the program is built from source and saved again
+	class OGLProgramCache	{
+	public:
+		struct Stats {
+			// Loaded from a saved binary
+			size_t	hits		= 0;
+			// Built from source, with no binary saved or the cache off
+			size_t	misses		= 0;
+			// Built from source, as the driver refused the saved binary
+			size_t	rejected	= 0;
+			// Spent loading and building every program so far
+			double	seconds		= 0.0;
+		};
+
+		// Turns the cache on, saving programs into directory. Needs a GL context
+		// Off if the driver has no binary formats, in which case programs always build from source
+		static void SetDirectory(const std::string& directory);
+		static bool IsEnabled();
+
+		// One key for a program's stages, empty strings for unused stages
+		static uint64_t Key(std::span<const std::string> sources);
+
+		// Fills program from its saved binary, which links it
+		// False if there isn't one, or the driver refuses it
+		static bool Load(uint64_t key, GLuint program);
+		// Call on a linked program, whose GL_PROGRAM_BINARY_RETRIEVABLE_HINT was set before linking
+		static void Save(uint64_t key, GLuint program);
+
+		static void AddTime(double seconds) {
+			stats.seconds += seconds;
+		}
+		static const Stats& GetStats() {
+			return stats;
+		}
+
+	protected:
+		static std::string PathFor(uint64_t key);
+
+		static std::string	directory;
+		// Hash of the driver strings, mixed into every key
+		static uint64_t		driverHash;
+		static Stats		stats;
+	};
+}
@@ -127,27 +127,34 @@ void OGLRenderer::DrawBoundMesh(int subLayer, int numInstances) {
 		std::cout << __FUNCTION__ << " has been called without a bound mesh!\n";
 		return;
 	}
-	if (!activeShader) {
-		std::cout << __FUNCTION__ << " has been called without a bound shader!\n";
-		return;
-	}
-	GLuint	mode	= 0;
-	int		count	= 0;
-	int		offset	= 0;
+	SubMesh range;
 
 	if (boundMesh->GetSubMeshCount() == 0) {
 		if (boundMesh->GetIndexCount() > 0) {
-			count = boundMesh->GetIndexCount();
+			range.count = boundMesh->GetIndexCount();
 		}
 		else{
-			count = boundMesh->GetVertexCount();
+			range.count = boundMesh->GetVertexCount();
 		}
 	}
 	else {
-		const SubMesh* m = boundMesh->GetSubMesh(subLayer);
-		offset = m->start;
-		count  = m->count;
+		range = *boundMesh->GetSubMesh(subLayer);
+	}
+	DrawBoundSubMesh(range, numInstances);
+}
+
+void OGLRenderer::DrawBoundSubMesh(const SubMesh& range, int numInstances) {
+	if (!boundMesh) {
+		std::cout << __FUNCTION__ << " has been called without a bound mesh!\n";
+		return;
+	}
+	if (!activeShader) {
+		std::cout << __FUNCTION__ << " has been called without a bound shader!\n";
+		return;
 	}
+	GLuint	mode	= 0;
+	int		count	= range.count;
+	int		offset	= range.start;
 
 	//Ordered the same as the GeometryPrimitive enum in Mesh
 	static GLenum primitiveLookup[] = {
@@ -187,7 +194,7 @@ void OGLRenderer::BindTextureToShader(const OGLTexture& t, const std::string& un
 		return;//Debug message time!
 	}
 
-	GLuint slot = glGetUniformLocation(activeShader->GetProgramID(), uniform.c_str());
+	GLint slot = activeShader->GetUniformLocation(uniform);
 
 	if (slot < 0) {
 
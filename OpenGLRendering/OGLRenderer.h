@@ -31,6 +31,7 @@ namespace NCL::UnixCode {
 namespace NCL::Rendering {
 
 	class Mesh;
+	struct SubMesh;
 	class Shader;
 	class Texture;
 
@@ -67,6 +68,8 @@ namespace NCL::Rendering {
 		void BindBufferAsSSBO(const OGLBuffer& b, uint32_t slotID);
 
 		void DrawBoundMesh(int subLayer = 0, int numInstances = 1);
+		// Draws an arbitrary range of the bound mesh's indices, such as a LOD level's submesh
+		void DrawBoundSubMesh(const SubMesh& range, int numInstances = 1);
 #ifdef _WIN32
 		void InitWithWin32(Window& w);
 		void DestroyWithWin32();
@@ -6,7 +6,9 @@ Contact:richgdavison@gmail.com
 License: MIT (see LICENSE file at the top of the source tree)
 */////////////////////////////////////////////////////////////////////////////
 #include "OGLShader.h"
+#include "OGLProgramCache.h"
 #include "Assets.h"
+#include "GameTimer.h"
 
 using namespace NCL;
 using namespace NCL::Rendering;
@@ -46,20 +48,38 @@ OGLShader::~OGLShader()	{
 }
 
 void OGLShader::ReloadShader() {
+	GameTimer timer;
 	DeleteIDs();
 	programID = glCreateProgram();
-	string fileContents = "";
+
+	// Every stage is read first, as the cache is keyed by all of them
+	string sources[(int)ShaderStages::MAX_SIZE];
 	for (int i = 0; i < (int)ShaderStages::MAX_SIZE; ++i) {
 		if (!shaderFiles[i].empty()) {
-			Assets::ReadTextFile(Assets::SHADERDIR + shaderFiles[i], fileContents);
-			Preprocessor(fileContents);
+			Assets::ReadTextFile(Assets::SHADERDIR + shaderFiles[i], sources[i]);
+			Preprocessor(sources[i]);
+		}
+	}
+	uint64_t cacheKey = OGLProgramCache::Key(sources);
+	if (OGLProgramCache::Load(cacheKey, programID)) {
+		for (int i = 0; i < (int)ShaderStages::MAX_SIZE; ++i) {
+			shaderValid[i] = shaderFiles[i].empty() ? 0 : GL_TRUE;
+		}
+		programValid = GL_TRUE;
+		std::cout << "Shader " << shaderFiles[ShaderStages::Vertex] << " loaded from cache!" << "\n";
+		timer.Tick();
+		OGLProgramCache::AddTime(timer.GetTimeDeltaSeconds());
+		return;
+	}
 
+	for (int i = 0; i < (int)ShaderStages::MAX_SIZE; ++i) {
+		if (!shaderFiles[i].empty()) {
 			shaderIDs[i] = glCreateShader(shaderTypes[i]);
 
 			std::cout << "Reading " << shaderNames[i] << " shader " << shaderFiles[i] << "\n";
 
-			const char* stringData	 = fileContents.c_str();
-			int			stringLength = (int)fileContents.length();
+			const char* stringData	 = sources[i].c_str();
+			int			stringLength = (int)sources[i].length();
 			glShaderSource(shaderIDs[i], 1, &stringData, &stringLength);
 			glCompileShader(shaderIDs[i]);
 
@@ -75,6 +95,9 @@ void OGLShader::ReloadShader() {
 			PrintCompileLog(shaderIDs[i]);
 		}
 	}
+	if (OGLProgramCache::IsEnabled()) {
+		glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
 	glLinkProgram(programID);
 	glGetProgramiv(programID, GL_LINK_STATUS, &programValid);
 
@@ -85,10 +108,24 @@ void OGLShader::ReloadShader() {
 	}
 	else {
 		std::cout << "Shader loaded!" << "\n";
+		OGLProgramCache::Save(cacheKey, programID);
+	}
+	timer.Tick();
+	OGLProgramCache::AddTime(timer.GetTimeDeltaSeconds());
+}
+
+GLint OGLShader::GetUniformLocation(std::string_view name) const {
+	auto i = uniformLocations.find(name);
+	if (i == uniformLocations.end()) {
+		std::string key(name);
+		GLint location = glGetUniformLocation(programID, key.c_str());
+		i = uniformLocations.emplace(std::move(key), location).first;
 	}
+	return i->second;
 }
 
 void	OGLShader::DeleteIDs() {
+	uniformLocations.clear();
 	if (!programID) {
 		return;
 	}
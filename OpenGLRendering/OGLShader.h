@@ -9,6 +9,9 @@ License: MIT (see LICENSE file at the top of the source tree)
 #include "Shader.h"
 #include "glad/gl.h"
 
+#include <string_view>
+#include <unordered_map>
+
 namespace NCL::Rendering {
 	using UniqueOGLShader = std::unique_ptr<class OGLShader>;
 	using SharedOGLShader = std::shared_ptr<class OGLShader>;
@@ -28,6 +31,10 @@ namespace NCL::Rendering {
 			return programID;
 		}
 
+		// Cached after the first lookup of each name, so is cheap enough to call per draw
+		// -1 if the shader doesn't use the uniform
+		GLint GetUniformLocation(std::string_view name) const;
+
 		static void	PrintCompileLog(GLuint object);
 		static void	PrintLinkLog(GLuint program);
 
@@ -40,5 +47,14 @@ namespace NCL::Rendering {
 		GLuint	shaderIDs[(int)ShaderStages::MAX_SIZE];
 		int		shaderValid[(int)ShaderStages::MAX_SIZE];
 		int		programValid;
+
+		// Looked up by string_view without building a string
+		struct NameHash {
+			using is_transparent = void;
+			size_t operator()(std::string_view name) const {
+				return std::hash<std::string_view>{}(name);
+			}
+		};
+		mutable std::unordered_map<std::string, GLint, NameHash, std::equal_to<>> uniformLocations;
 	};
 }
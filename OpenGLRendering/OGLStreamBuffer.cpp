@@ -0,0 +1,93 @@
+/******************************************************************************
+This file is part of the Newcastle OpenGL Tutorial Series
+
+Author:Rich Davison
+Contact:richgdavison@gmail.com
+License: MIT (see LICENSE file at the top of the source tree)
+*/////////////////////////////////////////////////////////////////////////////
+#include "OGLStreamBuffer.h"
+
+#include <algorithm>
+
+using namespace NCL;
+using namespace Rendering;
+
+namespace {
+	const GLbitfield MapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	// Long enough to never trip on a working GPU, short enough to not hang on a lost one
+	const GLuint64 FenceTimeout = 1000000000;
+}
+
+OGLStreamBuffer::OGLStreamBuffer(size_t regionSize, size_t regionCount) : ring(regionSize, regionCount) {
+	buffer		= 0;
+	mappedData	= nullptr;
+	fences.resize(ring.GetRegionCount(), nullptr);
+	CreateStorage(ring.GetRegionSize());
+}
+
+OGLStreamBuffer::~OGLStreamBuffer() {
+	ReleaseStorage();
+	glDeleteBuffers(1, &buffer);
+	glDeleteBuffers((GLsizei)retiredBuffers.size(), retiredBuffers.data());
+}
+
+void OGLStreamBuffer::BeginFrame() {
+	GLsync& fence = fences[ring.BeginFrame()];
+	if (!fence) {
+		return;
+	}
+	GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FenceTimeout);
+	if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED) {
+		std::cout << __FUNCTION__ << " gave up waiting for the GPU to finish with a stream buffer region\n";
+	}
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+OGLStreamBuffer::Allocation OGLStreamBuffer::Allocate(size_t size, size_t alignment) {
+	size_t offset = ring.Allocate(size, alignment);
+	if (offset == StreamRing::NoSpace) {
+		// Draws already made this frame still read the old buffer, so it's only deleted once they're submitted
+		size_t frameUsed = ring.GetFrameUsed();
+		ReleaseStorage();
+		retiredBuffers.push_back(buffer);
+		CreateStorage(std::max(ring.GetRegionSize() * 2, frameUsed + size + alignment));
+		offset = ring.Allocate(size, alignment);
+	}
+	return { buffer, offset, mappedData + offset };
+}
+
+void OGLStreamBuffer::EndFrame() {
+	GLsync& fence = fences[ring.EndFrame()];
+	if (fence) {
+		glDeleteSync(fence);
+	}
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	glDeleteBuffers((GLsizei)retiredBuffers.size(), retiredBuffers.data());
+	retiredBuffers.clear();
+}
+
+void OGLStreamBuffer::CreateStorage(size_t regionSize) {
+	ring.Resize(regionSize);
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferStorage(GL_ARRAY_BUFFER, ring.GetBufferSize(), nullptr, MapFlags);
+	mappedData = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, ring.GetBufferSize(), MapFlags);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void OGLStreamBuffer::ReleaseStorage() {
+	// A new buffer has nothing in flight, so the old fences no longer matter
+	for (GLsync& fence : fences) {
+		if (fence) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	mappedData = nullptr;
+}
@@ -0,0 +1,53 @@
+/******************************************************************************
+This file is part of the Newcastle OpenGL Tutorial Series
+
+Author:Rich Davison
+Contact:richgdavison@gmail.com
+License: MIT (see LICENSE file at the top of the source tree)
+*/////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "glad/gl.h"
+#include "StreamRing.h"
+
+namespace NCL::Rendering {
+	// A buffer for data that is rewritten every frame, such as debug lines or instance data
+	// Mapped once for its whole life and written straight into, with a fence
+	// per StreamRing region, so there are no per frame buffer reallocations or copies
+	class OGLStreamBuffer	{
+	public:
+		struct Allocation {
+			GLuint	buffer;
+			size_t	offset;
+			void*	data;
+		};
+
+		OGLStreamBuffer(size_t regionSize, size_t regionCount = 3);
+		~OGLStreamBuffer();
+
+		// Waits until the GPU has finished reading the region this frame will write to
+		void BeginFrame();
+		// Space that stays valid until the end of the frame. If the region is full,
+		// the buffer is recreated larger, so the buffer can differ between allocations
+		Allocation Allocate(size_t size, size_t alignment = 16);
+		// Fences off everything written this frame
+		void EndFrame();
+
+		const StreamRing& GetRing() const {
+			return ring;
+		}
+
+	protected:
+		void CreateStorage(size_t regionSize);
+		// Unmaps the buffer, leaving it to the caller to delete
+		void ReleaseStorage();
+
+		StreamRing	ring;
+		GLuint		buffer;
+		char*		mappedData;
+		// One per region, null once waited on
+		std::vector<GLsync> fences;
+
+		// Replaced buffers, deleted once the frame using them is submitted
+		std::vector<GLuint> retiredBuffers;
+	};
+}
@@ -13,6 +13,14 @@ License: MIT (see LICENSE file at the top of the source tree)
 using namespace NCL;
 using namespace NCL::Rendering;
 
+//S3TC is an extension, but one every desktop driver has
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT		0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT	0x83F3
+#endif
+
 OGLTexture::OGLTexture()	{
 	glGenTextures(1, &texID);
 }
@@ -27,9 +35,12 @@ OGLTexture::~OGLTexture()	{
 
 UniqueOGLTexture OGLTexture::TextureFromData(char* data, uint32_t width, uint32_t height, uint32_t channels) {
 	UniqueOGLTexture tex = std::make_unique<OGLTexture>();
-	tex->dimensions = { width, height };
+	tex->SetData(data, width, height, channels);
+	return tex;
+}
 
-	int dataSize = width * height * channels; //This always assumes data is 1 byte per channel
+void OGLTexture::SetData(char* data, uint32_t width, uint32_t height, uint32_t channels) {
+	dimensions = { width, height };
 
 	int sourceType = GL_RGB;
 
@@ -40,7 +51,7 @@ UniqueOGLTexture OGLTexture::TextureFromData(char* data, uint32_t width, uint32_
 		case 4: sourceType = GL_RGBA; break;
 	}
 
-	glBindTexture(GL_TEXTURE_2D, tex->texID);
+	glBindTexture(GL_TEXTURE_2D, texID);
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, sourceType, GL_UNSIGNED_BYTE, data);
 
@@ -50,8 +61,51 @@ UniqueOGLTexture OGLTexture::TextureFromData(char* data, uint32_t width, uint32_
 	glGenerateMipmap(GL_TEXTURE_2D);
 
 	glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-	return tex;
+void OGLTexture::SetImage(const TextureBinary::Image& image) {
+	dimensions = { image.width, image.height };
+
+	glBindTexture(GL_TEXTURE_2D, texID);
+
+	UploadImage(GL_TEXTURE_2D, image);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void OGLTexture::SetLoadedData(char* data, uint32_t width, uint32_t height, uint32_t channels, int flags) {
+	if (const TextureBinary::Image* image = TextureLoader::GetBakedImage(data, flags)) {
+		SetImage(*image);
+	}
+	else {
+		SetData(data, width, height, channels);
+	}
+}
+
+void OGLTexture::UploadImage(GLenum target, const TextureBinary::Image& image) {
+	GLenum format = 0;
+	switch (image.format) {
+		case TextureFormat::BC1: format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;	break;
+		case TextureFormat::BC3: format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;	break;
+		case TextureFormat::BC7: format = GL_COMPRESSED_RGBA_BPTC_UNORM;	break;
+		default: break;
+	}
+	for (size_t i = 0; i < image.levels.size(); ++i) {
+		const TextureBinary::Level& level = image.levels[i];
+		if (format) {
+			glCompressedTexImage2D(target, (GLint)i, format, level.width, level.height, 0, (GLsizei)level.size, level.data);
+		}
+		else {
+			glTexImage2D(target, (GLint)i, GL_RGBA, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, level.data);
+		}
+	}
+	//Cubemap faces share their texture's parameters, which are set once all faces are in
+	if (target == GL_TEXTURE_2D) {
+		glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, (GLint)image.levels.size() - 1);
+	}
 }
 
 UniqueOGLTexture OGLTexture::TextureFromFile(const std::string&name) {
@@ -62,13 +116,76 @@ UniqueOGLTexture OGLTexture::TextureFromFile(const std::string&name) {
 	int flags			= 0;
 	TextureLoader::LoadTexture(name, texData, width, height, channels, flags);  
 
-	UniqueOGLTexture glTex = TextureFromData(texData, width, height, channels);
+	UniqueOGLTexture glTex = std::make_unique<OGLTexture>();
+	glTex->SetLoadedData(texData, width, height, channels, flags);
 
-	free(texData);
+	TextureLoader::DeleteTextureData(texData, flags);
 
 	return glTex;
 }
 
+bool OGLTexture::UploadCubemapFaces(std::span<const std::string, 6> filenames, bool& baked) {
+	char* texData[6]		= { nullptr };
+	uint32_t width[6]		= { 0 };
+	uint32_t height[6]		= { 0 };
+	uint32_t channels[6]	= { 0 };
+	int flags[6]			= { 0 };
+
+	auto load = [&](bool allowBaked) {
+		bool loaded = true;
+		for (int i = 0; i < 6; ++i) {
+			loaded &= TextureLoader::LoadTexture(filenames[i], texData[i], width[i], height[i], channels[i], flags[i], allowBaked);
+		}
+		return loaded;
+	};
+	auto release = [&]() {
+		for (int i = 0; i < 6; ++i) {
+			if (texData[i]) {
+				TextureLoader::DeleteTextureData(texData[i], flags[i]);
+			}
+			texData[i]	= nullptr;
+			flags[i]	= 0;
+		}
+	};
+
+	bool loaded = load(true);
+	const TextureBinary::Image* first = TextureLoader::GetBakedImage(texData[0], flags[0]);
+	bool anyBaked = false;
+	baked = loaded;
+	for (int i = 0; i < 6; ++i) {
+		const TextureBinary::Image* image = TextureLoader::GetBakedImage(texData[i], flags[i]);
+		anyBaked |= image != nullptr;
+		baked &= image && first && image->format == first->format && image->levels.size() == first->levels.size();
+	}
+	if (loaded && anyBaked && !baked) {
+		std::cout << __FUNCTION__ << " cubemap faces aren't all baked alike, decoding them all\n";
+		release();
+		loaded = load(false);
+	}
+	for (int i = 1; loaded && i < 6; ++i) {
+		if (width[i] != width[0] || height[i] != height[0]) {
+			std::cout << __FUNCTION__ << " cubemap input textures don't match in size?\n";
+			loaded = false;
+		}
+	}
+	if (!loaded) {
+		release();
+		return false;
+	}
+
+	GLenum type = channels[0] == 4 ? GL_RGBA : GL_RGB;
+	for (int i = 0; i < 6; ++i) {
+		if (baked) {
+			UploadImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, *TextureLoader::GetBakedImage(texData[i], flags[i]));
+		}
+		else {
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width[i], height[i], 0, type, GL_UNSIGNED_BYTE, texData[i]);
+		}
+	}
+	release();
+	return true;
+}
+
 UniqueOGLTexture OGLTexture::LoadCubemap(
 	const std::string& xPosFile, 
 	const std::string& xNegFile, 
@@ -77,38 +194,30 @@ UniqueOGLTexture OGLTexture::LoadCubemap(
 	const std::string& zPosFile, 
 	const std::string& zNegFile) {
 
-	const std::string* filenames[6] = {&xPosFile,&xNegFile,&yPosFile,&yNegFile,&zPosFile,&zNegFile};
-	uint32_t width[6] = { 0 };
-	uint32_t height[6] = { 0 };
-	uint32_t channels[6] = { 0 };
-	int flags[6] = { 0 };
-
-	std::vector<char*> texData(6, nullptr);
-
-	for (int i = 0; i < 6; ++i) {
-		TextureLoader::LoadTexture(*filenames[i], texData[i], width[i], height[i], channels[i], flags[i]);
-		if (i > 0 && (width[i] != width[0] || height[0] != height[0])) {
-			std::cout << __FUNCTION__ << " cubemap input textures don't match in size?\n";
-			return nullptr;
-		}
-	}
+	const std::string filenames[6] = { xPosFile, xNegFile, yPosFile, yNegFile, zPosFile, zNegFile };
 
 	UniqueOGLTexture tex = std::make_unique<OGLTexture>();
-	tex->dimensions = { width[0], height[0] };
-
 	glBindTexture(GL_TEXTURE_CUBE_MAP, tex->GetObjectID());
 
-	GLenum type = channels[0] == 4 ? GL_RGBA : GL_RGB;
-
-	for (int i = 0; i < 6; ++i) {
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width[i], height[i], 0, type, GL_UNSIGNED_BYTE, texData[i]);
+	//Baked faces bring their own mip levels, and compressed ones can't have them generated
+	bool baked = false;
+	if (!UploadCubemapFaces(filenames, baked)) {
+		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		return nullptr;
 	}
+	GLint width		= 0;
+	GLint height	= 0;
+	glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_WIDTH, &width);
+	glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_HEIGHT, &height);
+	tex->dimensions = { (uint32_t)width, (uint32_t)height };
 
 	glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+	if (!baked) {
+		glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+	}
 	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
 	return tex;
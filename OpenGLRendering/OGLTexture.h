@@ -6,7 +6,10 @@ Contact:richgdavison@gmail.com
 License: MIT (see LICENSE file at the top of the source tree)
 */////////////////////////////////////////////////////////////////////////////
 #pragma once
+#include <span>
+
 #include "Texture.h"
+#include "TextureBinary.h"
 #include "glad/gl.h"
 
 namespace NCL::Rendering {
@@ -20,9 +23,24 @@ namespace NCL::Rendering {
 		~OGLTexture();
 
 		static UniqueOGLTexture TextureFromData(char* data, uint32_t width, uint32_t height, uint32_t channels);
+		// Replaces the texture's contents, keeping its ID so anything using it sees the new image
+		void SetData(char* data, uint32_t width, uint32_t height, uint32_t channels);
+		// As SetData, from a baked texture with its own mip levels
+		void SetImage(const TextureBinary::Image& image);
+		// As SetData or SetImage, depending on what TextureLoader::LoadTexture gave back
+		void SetLoadedData(char* data, uint32_t width, uint32_t height, uint32_t channels, int flags);
+
+		// Uploads every level of image to target, which may be a cubemap face
+		static void UploadImage(GLenum target, const TextureBinary::Image& image);
 
 		static UniqueOGLTexture TextureFromFile(const std::string&name);
 
+		// Loads six images, +X -X +Y -Y +Z -Z, into the bound GL_TEXTURE_CUBE_MAP
+		// Baked copies are only used if all six are baked in the same format, as the faces of
+		// one texture can't differ, otherwise every face is decoded. baked says which it was
+		// Returns false if a face is missing, or they don't match in size
+		static bool UploadCubemapFaces(std::span<const std::string, 6> filenames, bool& baked);
+
 		static UniqueOGLTexture LoadCubemap(
 			const std::string& xPosFile,
 			const std::string& xNegFile,
@@ -0,0 +1,81 @@
+#include "CpuSkinner.h"
+#include "Float4.h"
+
+#include <algorithm>
+
+using namespace NCL;
+using namespace Rendering;
+using namespace Maths;
+using namespace Maths::Simd;
+
+namespace {
+	Vector3 ToVector3(Float4 a) {
+		float v[4];
+		Store(v, a);
+		return Vector3(v[0], v[1], v[2]);
+	}
+}
+
+void CpuSkinner::Skin(const Mesh& mesh, std::span<const Matrix4> palette, SkinnedVertices& out) {
+	Resize(mesh, out);
+	SkinRange(mesh, palette, out, 0, mesh.GetVertexCount());
+}
+
+void CpuSkinner::Resize(const Mesh& mesh, SkinnedVertices& out) {
+	size_t vertexCount = mesh.GetVertexCount();
+	out.positions.resize(vertexCount);
+	out.normals.resize(mesh.GetNormalData().size() == vertexCount ? vertexCount : 0);
+	out.tangents.resize(mesh.GetTangentData().size() == vertexCount ? vertexCount : 0);
+}
+
+void CpuSkinner::SkinRange(const Mesh& mesh, std::span<const Matrix4> palette, SkinnedVertices& out, size_t begin, size_t end) {
+	const std::vector<Vector3>& positions	= mesh.GetPositionData();
+	const std::vector<Vector3>& normals		= mesh.GetNormalData();
+	const std::vector<Vector4>& tangents	= mesh.GetTangentData();
+	const std::vector<Vector4>& weights		= mesh.GetSkinWeightData();
+	const std::vector<Vector4i>& indices	= mesh.GetSkinIndexData();
+	end = std::min(end, positions.size());
+
+	// Nothing to skin with, so the mesh stays as it is
+	if (weights.size() != positions.size() || indices.size() != positions.size()) {
+		std::copy(positions.begin() + begin, positions.begin() + end, out.positions.begin() + begin);
+		if (!out.normals.empty()) {
+			std::copy(normals.begin() + begin, normals.begin() + end, out.normals.begin() + begin);
+		}
+		if (!out.tangents.empty()) {
+			std::copy(tangents.begin() + begin, tangents.begin() + end, out.tangents.begin() + begin);
+		}
+		return;
+	}
+
+	bool doNormals	= !out.normals.empty();
+	bool doTangents	= !out.tangents.empty();
+	for (size_t v = begin; v < end; v++) {
+		// The palette blended by this vertex's weights
+		Float4 columns[4] = { Splat(0.0f), Splat(0.0f), Splat(0.0f), Splat(0.0f) };
+		for (int i = 0; i < 4; i++) {
+			float weight = weights[v][i];
+			if (weight == 0.0f) {
+				continue;
+			}
+			const Matrix4& joint = palette[indices[v][i]];
+			Float4 w = Splat(weight);
+			for (int col = 0; col < 4; col++) {
+				columns[col] = columns[col] + Load(joint.array[col]) * w;
+			}
+		}
+
+		const Vector3& p = positions[v];
+		out.positions[v] = ToVector3(columns[0] * Splat(p.x) + columns[1] * Splat(p.y) + columns[2] * Splat(p.z) + columns[3]);
+		if (doNormals) {
+			const Vector3& n = normals[v];
+			out.normals[v] = Vector::Normalise(ToVector3(columns[0] * Splat(n.x) + columns[1] * Splat(n.y) + columns[2] * Splat(n.z)));
+		}
+		if (doTangents) {
+			const Vector4& t = tangents[v];
+			Vector3 skinned = Vector::Normalise(ToVector3(columns[0] * Splat(t.x) + columns[1] * Splat(t.y) + columns[2] * Splat(t.z)));
+			// w is the bitangent's handedness, which skinning doesn't change
+			out.tangents[v] = Vector4(skinned.x, skinned.y, skinned.z, t.w);
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <span>
+#include <vector>
+
+#include "Mesh.h"
+
+namespace NCL::Rendering {
+	// A rigged mesh's vertices after skinning, in model space
+	struct SkinnedVertices {
+		std::vector<Maths::Vector3>	positions;
+		// Empty if the mesh has none
+		std::vector<Maths::Vector3>	normals;
+		std::vector<Maths::Vector4>	tangents;
+	};
+
+	// Skins a mesh's vertices on the CPU, for renderers without a skinning shader
+	// Each vertex is moved by the weighted sum of up to four joints of a palette,
+	// blended a column at a time with SSE where we have it. Normals and tangents
+	// use the same blend and are renormalised
+	class CpuSkinner	{
+	public:
+		// Sizes out to match mesh, then skins every vertex
+		static void Skin(const Mesh& mesh, std::span<const Maths::Matrix4> palette, SkinnedVertices& out);
+
+		// Sizes out to match mesh, without skinning anything
+		static void Resize(const Mesh& mesh, SkinnedVertices& out);
+		// Skins vertices [begin, end) into an out already sized by Resize
+		// Separate ranges can be skinned on separate threads
+		static void SkinRange(const Mesh& mesh, std::span<const Maths::Matrix4> palette, SkinnedVertices& out, size_t begin, size_t end);
+	};
+}
@@ -0,0 +1,61 @@
+#include "Pose.h"
+#include "AnimationSampler.h"
+#include "Float4.h"
+#include "MeshAnimation.h"
+
+#include <stdexcept>
+
+using namespace NCL;
+using namespace Rendering;
+using namespace Maths;
+using namespace Maths::Simd;
+
+Pose::Pose(const Skeleton& skeleton)
+	: skeleton(&skeleton)
+	, local(skeleton.GetLocalBindPose())
+	, model(skeleton.GetBindPose())
+	, palette(skeleton.GetJointCount()) {
+	BuildPalette();
+}
+
+void Pose::Evaluate() {
+	const std::vector<int>& parents = skeleton->GetParents();
+	// Parents come first, so each joint's parent is already in model space
+	for (uint32_t joint : skeleton->GetOrder()) {
+		int parent = parents[joint];
+		if (parent < 0) {
+			model[joint] = local[joint];
+		}
+		else {
+			Multiply(model[parent], local[joint], model[joint]);
+		}
+	}
+	BuildPalette();
+}
+
+void Pose::Sample(const MeshAnimation& animation, float time) {
+	if (animation.GetJointCount() != skeleton->GetJointCount()) {
+		throw std::runtime_error("Animation doesn't have the same joints as the skeleton it's posing");
+	}
+	AnimationSampler::Sample({ &animation, time, model.data() });
+	BuildPalette();
+}
+
+void Pose::BuildPalette() {
+	const std::vector<Matrix4>& inverseBindPose = skeleton->GetInverseBindPose();
+	for (size_t joint = 0; joint < model.size(); joint++) {
+		Multiply(model[joint], inverseBindPose[joint], palette[joint]);
+	}
+}
+
+void Pose::Multiply(const Matrix4& a, const Matrix4& b, Matrix4& out) {
+	// Matrices are column major, so each column of out is a's columns weighted by a column of b
+	Float4 columns[4] = {
+		Load(a.array[0]), Load(a.array[1]), Load(a.array[2]), Load(a.array[3])
+	};
+	for (int col = 0; col < 4; col++) {
+		Float4 result = columns[0] * Splat(b.array[col][0]) + columns[1] * Splat(b.array[col][1])
+			+ columns[2] * Splat(b.array[col][2]) + columns[3] * Splat(b.array[col][3]);
+		Store(out.array[col], result);
+	}
+}
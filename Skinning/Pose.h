@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+
+#include "Skeleton.h"
+
+namespace NCL::Rendering {
+	class MeshAnimation;
+
+	// One posed instance of a skeleton, and the skinning palette it gives
+	// Set each joint's transform relative to its parent then Evaluate, or Sample
+	// an animation, whose frames are already in model space. The palette is each
+	// model space joint times its inverse bind pose, ready for skinning
+	class Pose	{
+	public:
+		// Starts in the bind pose, with an identity palette
+		explicit Pose(const Skeleton& skeleton);
+
+		// Each joint relative to its parent, used by the next Evaluate
+		std::vector<Maths::Matrix4>& GetLocalTransforms() {
+			return local;
+		}
+		const std::vector<Maths::Matrix4>& GetLocalTransforms() const {
+			return local;
+		}
+
+		// Composes the local transforms down the hierarchy, then builds the palette
+		void Evaluate();
+		// Poses the joints at time seconds into animation, which must have the skeleton's joints
+		void Sample(const MeshAnimation& animation, float time);
+
+		const std::vector<Maths::Matrix4>& GetModelTransforms() const {
+			return model;
+		}
+		const std::vector<Maths::Matrix4>& GetPalette() const {
+			return palette;
+		}
+		const Skeleton& GetSkeleton() const {
+			return *skeleton;
+		}
+
+		// out = a * b, a column at a time with SSE where we have it. out may not be a or b
+		static void Multiply(const Maths::Matrix4& a, const Maths::Matrix4& b, Maths::Matrix4& out);
+
+	protected:
+		void BuildPalette();
+
+		const Skeleton*				skeleton;
+		std::vector<Maths::Matrix4>	local;
+		std::vector<Maths::Matrix4>	model;
+		std::vector<Maths::Matrix4>	palette;
+	};
+}
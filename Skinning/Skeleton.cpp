@@ -0,0 +1,62 @@
+#include "Skeleton.h"
+
+#include <stdexcept>
+
+using namespace NCL;
+using namespace Rendering;
+using namespace Maths;
+
+Skeleton::Skeleton(const Mesh& mesh) {
+	size_t jointCount = mesh.GetBindPose().size();
+	if (jointCount == 0) {
+		throw std::runtime_error("Skeleton needs a rigged mesh, this one has no bind pose");
+	}
+
+	bindPose = mesh.GetBindPose();
+	inverseBindPose = mesh.GetInverseBindPose();
+	if (inverseBindPose.size() != jointCount) {
+		inverseBindPose.resize(jointCount);
+		for (size_t joint = 0; joint < jointCount; joint++) {
+			inverseBindPose[joint] = Matrix::Inverse(bindPose[joint]);
+		}
+	}
+
+	// Meshes without parents are a flat set of roots
+	parents = mesh.GetJointParents();
+	parents.resize(jointCount, -1);
+	for (int parent : parents) {
+		if (parent >= (int)jointCount) {
+			throw std::runtime_error("Mesh has a joint parent that isn't one of its joints");
+		}
+	}
+
+	// Children after parents: each pass adds the joints whose parents are already placed
+	std::vector<bool> placed(jointCount, false);
+	order.reserve(jointCount);
+	while (order.size() < jointCount) {
+		size_t before = order.size();
+		for (size_t joint = 0; joint < jointCount; joint++) {
+			if (!placed[joint] && (parents[joint] < 0 || placed[parents[joint]])) {
+				order.push_back((uint32_t)joint);
+				placed[joint] = true;
+			}
+		}
+		if (order.size() == before) {
+			throw std::runtime_error("Mesh joint parents form a loop");
+		}
+	}
+
+	localBindPose.resize(jointCount);
+	for (size_t joint = 0; joint < jointCount; joint++) {
+		int parent = parents[joint];
+		localBindPose[joint] = parent < 0 ? bindPose[joint] : inverseBindPose[parent] * bindPose[joint];
+	}
+
+	for (const Vector4i& indices : mesh.GetSkinIndexData()) {
+		for (int i = 0; i < 4; i++) {
+			if (indices[i] < 0 || indices[i] >= (int)jointCount) {
+				throw std::runtime_error("Mesh has a vertex skinned to a joint it doesn't have");
+			}
+		}
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Mesh.h"
+
+namespace NCL::Rendering {
+	// A rigged mesh's joint hierarchy, sorted so it can be walked in one pass
+	// Bind poses are in model space, as in .msh files. Each joint's local bind
+	// transform is relative to its parent, the starting point for posing it
+	class Skeleton	{
+	public:
+		// Throws if the joint parents don't form a tree, or vertices use joints the mesh doesn't have
+		explicit Skeleton(const Mesh& mesh);
+
+		size_t GetJointCount() const {
+			return parents.size();
+		}
+		// Every joint comes after its parent
+		const std::vector<uint32_t>& GetOrder() const {
+			return order;
+		}
+		// -1 for roots
+		const std::vector<int>& GetParents() const {
+			return parents;
+		}
+		const std::vector<Maths::Matrix4>& GetBindPose() const {
+			return bindPose;
+		}
+		const std::vector<Maths::Matrix4>& GetInverseBindPose() const {
+			return inverseBindPose;
+		}
+		const std::vector<Maths::Matrix4>& GetLocalBindPose() const {
+			return localBindPose;
+		}
+
+	protected:
+		std::vector<uint32_t>		order;
+		std::vector<int>			parents;
+		std::vector<Maths::Matrix4>	bindPose;
+		std::vector<Maths::Matrix4>	inverseBindPose;
+		std::vector<Maths::Matrix4>	localBindPose;
+	};
+}
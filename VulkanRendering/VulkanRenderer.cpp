@@ -21,6 +21,10 @@ using namespace NCL::Win32Code;
 #define VMA_IMPLEMENTATION
 #include "vma/vk_mem_alloc.h"
 
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
 using namespace NCL;
 using namespace Rendering;
 using namespace Vulkan;
@@ -50,7 +54,7 @@ VulkanRenderer::VulkanRenderer(Window& window, const VulkanInitialisation& vkIni
 
 	OnWindowResize(window.GetScreenSize().x, window.GetScreenSize().y);
 
-	pipelineCache = device.createPipelineCache(vk::PipelineCacheCreateInfo());
+	InitPipelineCache(vkInit);
 
 	frameCmds = swapChainList[currentSwap]->cmdBuffer;
 }
@@ -84,6 +88,7 @@ VulkanRenderer::~VulkanRenderer() {
 	device.destroyCommandPool(commandPools[CommandType::AsyncCompute]);
 
 	device.destroyRenderPass(defaultRenderPass);
+	SavePipelineCache();
 	device.destroyPipelineCache(pipelineCache);
 	device.destroy(); //Destroy everything except instance before this gets destroyed!
 
@@ -762,4 +767,64 @@ VkBool32 VulkanRenderer::DebugCallbackFunction(
 
 
 	return false;
-}
\ No newline at end of file
+}
+
+void VulkanRenderer::InitPipelineCache(const VulkanInitialisation& vkInit) {
+	std::vector<char> data;
+	if (!vkInit.pipelineCacheFile.empty()) {
+		std::ifstream file(vkInit.pipelineCacheFile, std::ios::binary);
+		data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	// Drivers should reject another GPU's cache themselves, but not all do, so check it's ours first
+	VkPipelineCacheHeaderVersionOne header = {};
+	if (!data.empty()) {
+		bool valid = data.size() >= sizeof(header);
+		if (valid) {
+			memcpy(&header, data.data(), sizeof(header));
+			valid = header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+				&& header.vendorID == deviceProperties.vendorID
+				&& header.deviceID == deviceProperties.deviceID
+				&& memcmp(header.pipelineCacheUUID, deviceProperties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+		}
+		if (!valid) {
+			std::cout << __FUNCTION__ << ": Pipeline cache " << vkInit.pipelineCacheFile << " is from another GPU or driver, starting a new one\n";
+			data.clear();
+		}
+	}
+
+	if (!data.empty()) {
+		try {
+			pipelineCache = device.createPipelineCache(vk::PipelineCacheCreateInfo({}, data.size(), data.data()));
+			std::cout << __FUNCTION__ << ": Loaded " << data.size() / 1024 << "KB pipeline cache\n";
+			return;
+		}
+		catch (vk::SystemError& e) {
+			std::cout << __FUNCTION__ << ": Pipeline cache " << vkInit.pipelineCacheFile << " was rejected, starting a new one: " << e.what() << "\n";
+		}
+	}
+	pipelineCache = device.createPipelineCache(vk::PipelineCacheCreateInfo());
+}
+
+void VulkanRenderer::SavePipelineCache() {
+	if (vkInit.pipelineCacheFile.empty()) {
+		return;
+	}
+	std::vector<uint8_t> data = device.getPipelineCacheData(pipelineCache);
+
+	// Written beside the old cache and swapped in, so a crash part way through can't leave half a cache behind
+	std::filesystem::path path(vkInit.pipelineCacheFile);
+	std::filesystem::path temp = path;
+	temp += ".tmp";
+	std::error_code error;
+	std::filesystem::create_directories(path.parent_path(), error);
+	{
+		std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+		file.write((const char*)data.data(), data.size());
+		if (!file) {
+			std::cout << __FUNCTION__ << ": Couldn't write pipeline cache " << temp << "\n";
+			return;
+		}
+	}
+	std::filesystem::rename(temp, path, error);
+}
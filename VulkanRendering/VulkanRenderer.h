@@ -84,6 +84,9 @@ namespace NCL::Rendering::Vulkan {
 		bool				autoBeginDynamicRendering = true;
 		bool				useOpenGLCoordinates = false;
 		bool				skipDynamicState = false;
+
+		// Where the pipeline cache is kept between runs, empty to start from nothing each run
+		std::string			pipelineCacheFile;
 	};
 
 	class VulkanRenderer : public RendererBase {
@@ -127,6 +130,14 @@ namespace NCL::Rendering::Vulkan {
 			return defaultDescriptorPool;
 		}
 
+		// Pass to pipeline builders, so pipelines built in earlier runs are reused
+		vk::PipelineCache GetPipelineCache() const {
+			return pipelineCache;
+		}
+		// Writes the pipeline cache to vkInit.pipelineCacheFile, if there is one
+		// Also done on destruction, but call it yourself if this renderer might not be destroyed
+		void	SavePipelineCache();
+
 		FrameState const& GetFrameState() const {
 			return *(swapChainList[currentSwap]);
 		}
@@ -185,6 +196,8 @@ namespace NCL::Rendering::Vulkan {
 		bool	InitGPUDevice(const VulkanInitialisation& vkInit);
 		bool	InitSurface();
 		void	InitMemoryAllocator(const VulkanInitialisation& vkInit);
+		// Starts from the saved cache if it was made by this GPU and driver
+		void	InitPipelineCache(const VulkanInitialisation& vkInit);
 		uint32_t	InitBufferChain(vk::CommandBuffer  cmdBuffer);
 
 		static VkBool32 DebugCallbackFunction(
@@ -170,7 +170,7 @@ void TextureBuilder::EndTexture(const std::string& debugName, vk::UniqueCommandB
         CmdBufferEndSubmitWait(usingBuffer, sourceDevice, queue);
         for (int i = 0; i < job.faceCount; ++i) {
             if (job.dataOwnership[i]) {
-                TextureLoader::DeleteTextureData(job.dataSrcs[i]);
+                TextureLoader::DeleteTextureData(job.dataSrcs[i], job.dataFlags[i]);
             }
         }
     }
@@ -207,6 +207,7 @@ UniqueVulkanTexture TextureBuilder::BuildFromFile(const std::string& filename) {
     TextureJob job;
     job.faceCount = 1;
     job.dataSrcs[0] = texData;
+    job.dataFlags[0] = flags;
     job.dataOwnership[0] = true;
     job.image = tex->GetImage();
     job.endLayout = layout;
@@ -249,6 +250,7 @@ UniqueVulkanTexture TextureBuilder::BuildCubemapFromFile(
 
     for (int i = 0; i < 6; ++i) {
         TextureLoader::LoadTexture(*filenames[i], job.dataSrcs[i], dimensions[i].x, dimensions[i].y, channels[i], flags[i]);
+        job.dataFlags[i] = flags[i];
         job.dataOwnership[i] = true;
     }
 
@@ -395,7 +397,7 @@ void	TextureBuilder::WaitForProcessing() {
         sourceDevice.destroyFence(i.workFence);
 
         for (int j = 0; j < 6; ++j) {
-            TextureLoader::DeleteTextureData(i.dataSrcs[j]);
+            TextureLoader::DeleteTextureData(i.dataSrcs[j], i.dataFlags[j]);
         }
     }
     activeJobs.clear();
@@ -71,6 +71,8 @@ namespace NCL::Rendering::Vulkan {
 			uint32_t faceCount		= 0;
 
 			char* dataSrcs[6]		= { nullptr };
+			// From TextureLoader::LoadTexture, needed to free dataSrcs
+			int dataFlags[6]		= { 0 };
 			bool dataOwnership[6]	= { false };
 
 			TextureJob() {
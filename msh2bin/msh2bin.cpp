@@ -0,0 +1,177 @@
+// Converts .msh text meshes and .anm text animations to the binary formats their loaders prefer,
+// and bakes .png textures with their mip levels, block compressed
+// With no files named, converts every .msh and .anm in the meshes directory and every .png in the textures directory
+
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AnimationBinary.h"
+#include "Assets.h"
+#include "LodBuilder.h"
+#include "Mesh.h"
+#include "MeshAnimation.h"
+#include "MeshBinary.h"
+#include "MshLoader.h"
+#include "TextureBinary.h"
+#include "TextureLoader.h"
+
+using namespace NCL;
+using namespace Rendering;
+
+namespace {
+	// Only the CPU side data is needed
+	class ConvertedMesh : public Mesh {
+	public:
+		void UploadToGPU(RendererBase* renderer) override {}
+	};
+
+	void printUsage(const char* name) {
+		std::cout << "Usage: " << name << " [options] [file.msh|file.anm|file.png...]\n"
+			<< "Files are relative to " << Assets::MESHDIR << ", and each is written beside its .msh as "
+			<< MeshBinary::Extension << ", or its .anm as " << AnimationBinary::Extension << "\n"
+			<< "Images are relative to " << Assets::TEXTUREDIR << ", and baked beside themselves as " << TextureBinary::Extension << "\n"
+			<< "  -n, --no-lods  Don't build levels of detail, leaving them to be built at load time\n"
+			<< "      --bc7      Bake textures as BC7, rather than BC1, or BC3 for those with alpha\n"
+			<< "      --rgba     Bake textures uncompressed, with only their mip levels\n"
+			<< "  -h, --help     Show this message\n";
+	}
+
+	const char* FormatNames[] = { "RGBA8", "BC1", "BC3", "BC7" };
+
+	// Reads an image decoded, never its baked copy
+	char* readImage(const std::string& file, uint32_t& width, uint32_t& height, int& flags) {
+		char* data			= nullptr;
+		uint32_t channels	= 0;
+		if (!TextureLoader::LoadTexture(file, data, width, height, channels, flags, false)) {
+			throw std::runtime_error("Couldn't read image " + file);
+		}
+		return data;
+	}
+
+	// The faces of a cubemap are one texture, so have to share a format, and it has to suit them all:
+	// BC3 if any face in the directory is translucent, otherwise BC1
+	TextureFormat cubemapFormat(const std::filesystem::path& directory) {
+		static std::map<std::filesystem::path, TextureFormat> chosen;
+		auto found = chosen.find(directory);
+		if (found != chosen.end()) {
+			return found->second;
+		}
+		TextureFormat format = TextureFormat::BC1;
+		for (const auto& entry : std::filesystem::directory_iterator(Assets::TEXTUREDIR + directory.generic_string())) {
+			if (entry.path().extension() != ".png" || format == TextureFormat::BC3) {
+				continue;
+			}
+			uint32_t width	= 0;
+			uint32_t height	= 0;
+			int flags		= 0;
+			char* data = readImage((directory / entry.path().filename()).generic_string(), width, height, flags);
+			format = TextureCompressor::ChooseFormat((const uint8_t*)data, width, height);
+			TextureLoader::DeleteTextureData(data, flags);
+		}
+		chosen.emplace(directory, format);
+		return format;
+	}
+
+	void bakeTexture(const std::string& file, std::optional<TextureFormat> format) {
+		std::string imagePath	= Assets::TEXTUREDIR + file;
+		std::string binaryPath	= TextureBinary::PathFor(imagePath);
+		uint32_t width	= 0;
+		uint32_t height	= 0;
+		int flags		= 0;
+		char* data = readImage(file, width, height, flags);
+		const uint8_t* rgba = (const uint8_t*)data;
+		std::filesystem::path directory = std::filesystem::path(file).parent_path();
+		TextureFormat chosen = format ? *format
+			: directory.filename() == "Cubemap" ? cubemapFormat(directory)
+			: TextureCompressor::ChooseFormat(rgba, width, height);
+		try {
+			TextureBinary::Bake(binaryPath, rgba, width, height, chosen);
+		}
+		catch (...) {
+			TextureLoader::DeleteTextureData(data, flags);
+			throw;
+		}
+		TextureLoader::DeleteTextureData(data, flags);
+		std::cout << file << ": " << std::filesystem::file_size(imagePath) / 1024 << "KB -> "
+			<< std::filesystem::file_size(binaryPath) / 1024 << "KB, " << width << "x" << height << " "
+			<< FormatNames[(int)chosen] << ", " << TextureCompressor::LevelCount(width, height) << " levels\n";
+	}
+}
+
+int main(int argc, char** argv) {
+	bool buildLods = true;
+	std::optional<TextureFormat> textureFormat;
+	std::vector<std::string> files;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-h" || arg == "--help") {
+			printUsage(argv[0]);
+			return 0;
+		} else if (arg == "-n" || arg == "--no-lods") {
+			buildLods = false;
+		} else if (arg == "--bc7") {
+			textureFormat = TextureFormat::BC7;
+		} else if (arg == "--rgba") {
+			textureFormat = TextureFormat::RGBA8;
+		} else if (arg.starts_with("-")) {
+			std::cerr << "Unknown option " << arg << "\n";
+			printUsage(argv[0]);
+			return 1;
+		} else {
+			files.push_back(arg);
+		}
+	}
+	if (files.empty()) {
+		for (const auto& entry : std::filesystem::directory_iterator(Assets::MESHDIR)) {
+			if (entry.path().extension() == ".msh" || entry.path().extension() == ".anm") {
+				files.push_back(entry.path().filename().string());
+			}
+		}
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(Assets::TEXTUREDIR)) {
+			if (entry.path().extension() == ".png") {
+				files.push_back(std::filesystem::relative(entry.path(), Assets::TEXTUREDIR).generic_string());
+			}
+		}
+	}
+
+	int failures = 0;
+	for (const std::string& file : files) {
+		try {
+			if (std::filesystem::path(file).extension() == ".png") {
+				bakeTexture(file, textureFormat);
+				continue;
+			}
+			if (std::filesystem::path(file).extension() == ".anm") {
+				std::string textPath	= Assets::MESHDIR + file;
+				std::string binaryPath	= AnimationBinary::PathFor(textPath);
+				// Removed first, so the text is read rather than an old conversion
+				std::filesystem::remove(binaryPath);
+				MeshAnimation animation(file);
+				AnimationBinary::Save(binaryPath, animation);
+				std::cout << file << ": " << std::filesystem::file_size(textPath) / 1024 << "KB -> "
+					<< std::filesystem::file_size(binaryPath) / 1024 << "KB, " << animation.GetJointCount() << " joints, "
+					<< animation.GetFrameCount() << " frames\n";
+				continue;
+			}
+			ConvertedMesh mesh;
+			MshLoader::LoadTextMesh(file, mesh);
+			size_t lods = buildLods ? LodBuilder::Build(mesh) : 0;
+
+			std::string textPath	= Assets::MESHDIR + file;
+			std::string binaryPath	= MeshBinary::PathFor(textPath);
+			MeshBinary::Save(binaryPath, mesh, LodBuilder::Version);
+			std::cout << file << ": " << std::filesystem::file_size(textPath) / 1024 << "KB -> "
+				<< std::filesystem::file_size(binaryPath) / 1024 << "KB, " << lods << " LODs\n";
+		}
+		catch (const std::exception& e) {
+			std::cerr << file << ": " << e.what() << "\n";
+			failures++;
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}